@@ -0,0 +1,93 @@
+/*
+ * Render a sequence of frames of a HexGridVisual with no window and no X server, saving
+ * each as a PNG. Run it on a compute node (or anywhere) with
+ *
+ *   ./hexgrid_headless [nframes] [width] [height] [sync]
+ *
+ * Frames are saved with an asynchronous morph::gl::frame_capture, unless sync is 1, in
+ * which case each is saved with Visual::saveImage (for comparison of the frame rates).
+ *
+ * and make a movie from the frames with, for example,
+ *
+ *   ffmpeg -framerate 25 -i hexgrid_headless_%04d.png hexgrid.mp4
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+
+// Include the headless visual in place of morph/Visual.h
+#include <morph/headless/visheadless.h>
+#include <morph/gl/frame_capture.h>
+#include <morph/HexGridVisual.h>
+#include <morph/HexGrid.h>
+#include <morph/mathconst.h>
+
+int main (int argc, char** argv)
+{
+    int nframes = argc > 1 ? std::stoi (argv[1]) : 50;
+    int width = argc > 2 ? std::stoi (argv[2]) : 1280;
+    int height = argc > 3 ? std::stoi (argv[3]) : 720;
+    bool sync = argc > 4 ? std::stoi (argv[4]) == 1 : false;
+
+    // The framebuffer can be any size that the GL implementation allows
+    morph::headless::visual<morph::gl::version_4_1> v (width, height, "hexgrid_headless");
+    v.showCoordArrows = false;
+    v.showTitle = false;
+    v.backgroundWhite();
+    // Record what each model costs to build, upload and draw
+    v.setProfiling (true);
+    v.lightingEffects();
+    v.setSceneTrans (morph::vec<float>{ 0.0f, 0.0f, -3.2f });
+    v.setSceneRotation (morph::Quaternion<float>(morph::vec<float>{1.0f, 0.0f, 0.0f}, -morph::mathconst<float>::pi_over_4));
+
+    morph::HexGrid hg (0.01f, 3.0f, 0.0f);
+    hg.setCircularBoundary (0.6f);
+    std::cout << "Number of hexes in grid: " << hg.num() << std::endl;
+
+    std::vector<float> data (hg.num(), 0.0f);
+    auto wave = [&hg, &data](float t) {
+        for (unsigned int h = 0; h < hg.num(); ++h) {
+            float r = std::sqrt (hg.d_x[h] * hg.d_x[h] + hg.d_y[h] * hg.d_y[h]);
+            data[h] = 0.05f * std::sin (30.0f * r - t) * std::exp (-2.0f * r);
+        }
+    };
+    wave (0.0f);
+
+    auto hgv = std::make_unique<morph::HexGridVisual<float, morph::gl::version_4_1>>(&hg, morph::vec<float>{0,0,0});
+    v.bindmodel (hgv);
+    hgv->cm.setType (morph::ColourMapType::Batlow);
+    // Keep the same colour and height scaling for every frame
+    hgv->zScale.setParams (1.0f, 0.0f);
+    hgv->colourScale.compute_scaling (-0.05f, 0.05f);
+    hgv->setScalarData (&data);
+    hgv->finalize();
+    auto hgvp = v.addVisualModel (hgv);
+
+    // Read each frame back through a ring of pixel buffer objects and encode on worker threads
+    morph::gl::frame_capture cap;
+
+    auto t0 = std::chrono::steady_clock::now();
+    char fname[64];
+    for (int f = 0; f < nframes; ++f) {
+        wave (morph::mathconst<float>::two_pi * static_cast<float>(f) / 25.0f);
+        hgvp->updateData (&data);
+        v.render();
+        std::snprintf (fname, sizeof fname, "hexgrid_headless_%04d.png", f);
+        if (sync) {
+            if (v.saveImage (fname)[0] < 0) { return 1; }
+        } else {
+            cap.capture (fname);
+        }
+    }
+    if (cap.finish() > 0) { return 1; }
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "Saved " << nframes << " frames of " << width << "x" << height << " pixels in "
+              << std::chrono::duration<double>(t1 - t0).count() << " s\n";
+    std::cout << v.profileReport();
+
+    return 0;
+}
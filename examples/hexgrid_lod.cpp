@@ -0,0 +1,52 @@
+/*
+ * A HexGridVisual of two million hexes with level-of-detail meshes. Zoomed out, the hexes
+ * are merged into super-hexes about two pixels across, so the frame rate holds even on a
+ * software rasterizer. Zoom in (scroll) to see the level fall until the full resolution
+ * mesh is built.
+ */
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include <morph/Visual.h>
+#include <morph/HexGridVisual.h>
+#include <morph/HexGrid.h>
+
+int main()
+{
+    morph::Visual v (1024, 768, "Level of detail");
+    v.lightingEffects();
+    v.render_on_demand = true;
+
+    morph::HexGrid hg (0.0008f, 3.0f, 0.0f);
+    hg.setCircularBoundary (0.6f);
+    std::cout << "Number of hexes in grid: " << hg.num() << std::endl;
+
+    std::vector<float> data (hg.num(), 0.0f);
+    for (unsigned int h = 0; h < hg.num(); ++h) {
+        float r = std::sqrt (hg.d_x[h] * hg.d_x[h] + hg.d_y[h] * hg.d_y[h]);
+        // Fine stripes that are only resolved when zoomed in
+        data[h] = 0.05f * std::sin (40.0f * r) * std::exp (-2.0f * r) + 0.005f * std::sin (2000.0f * hg.d_x[h]);
+    }
+
+    auto hgv = std::make_unique<morph::HexGridVisual<float>>(&hg, morph::vec<float>{0,0,0});
+    v.bindmodel (hgv);
+    hgv->cm.setType (morph::ColourMapType::Batlow);
+    hgv->lod = true;         // Merge hexes that would be smaller than...
+    hgv->lod_pixels = 2.0f;  // ...two pixels on screen
+    hgv->setScalarData (&data);
+    hgv->finalize();         // With lod, the mesh is built in the first render
+    auto hgvp = v.addVisualModel (hgv);
+
+    unsigned int level = hgvp->get_lod_level();
+    while (v.readyToFinish == false) {
+        v.waitevents (0.018);
+        v.render();
+        if (hgvp->get_lod_level() != level) {
+            level = hgvp->get_lod_level();
+            std::cout << "Level of detail " << level << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Decouple a fast simulation loop from the display with Visual::max_fps and
+ * Visual::render_on_demand.
+ *
+ * The 'simulation' relaxes a field on a HexGrid towards a target, taking many thousands of
+ * small steps per second. render() is called after every step, but draws at most max_fps
+ * frames per second, and, once the field has stopped changing, draws nothing at all until
+ * the view is changed with the mouse or keyboard.
+ */
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+#include <morph/Visual.h>
+#include <morph/HexGridVisual.h>
+#include <morph/HexGrid.h>
+
+int main()
+{
+    morph::Visual v (1024, 768, "Render on demand");
+    v.lightingEffects();
+    v.render_on_demand = true; // Only draw when something has changed...
+    v.max_fps = 30.0f;         // ...and then no more than 30 times per second
+
+    morph::HexGrid hg (0.02f, 4.0f, 0.0f);
+    hg.setCircularBoundary (1.0f);
+
+    std::vector<float> target (hg.num(), 0.0f);
+    std::vector<float> field (hg.num(), 0.0f);
+    for (unsigned int h = 0; h < hg.num(); ++h) {
+        float r = std::sqrt (hg.d_x[h] * hg.d_x[h] + hg.d_y[h] * hg.d_y[h]);
+        target[h] = 0.1f * std::cos (12.0f * r) * std::exp (-2.0f * r);
+    }
+
+    auto hgv = std::make_unique<morph::HexGridVisual<float>>(&hg, morph::vec<float>{0,0,0});
+    v.bindmodel (hgv);
+    hgv->zScale.setParams (1.0f, 0.0f);
+    hgv->colourScale.compute_scaling (-0.1f, 0.1f);
+    hgv->setScalarData (&field);
+    hgv->finalize();
+    auto hgvp = v.addVisualModel (hgv);
+
+    using sc = std::chrono::steady_clock;
+    sc::time_point t0 = sc::now();
+    unsigned long long steps = 0;
+    unsigned long long last_steps = 0;
+    float change = 1.0f;
+    while (v.readyToFinish == false) {
+        v.poll();
+
+        // One simulation step
+        change = 0.0f;
+        for (unsigned int h = 0; h < hg.num(); ++h) {
+            float d = 0.0001f * (target[h] - field[h]);
+            field[h] += d;
+            change = std::max (change, std::abs (d));
+        }
+        ++steps;
+
+        // Rebuilding the model is costly, so only do it when a frame would be drawn, and only
+        // while the field is still changing visibly.
+        if (change > 1e-7f && v.frameDue()) { hgvp->updateData (&field); }
+        v.render();
+
+        if (std::chrono::duration<double>(sc::now() - t0).count() > 2.0) {
+            std::cout << (steps - last_steps) / 2 << " steps/s; max change per step " << change << std::endl;
+            last_steps = steps;
+            t0 = sc::now();
+        }
+    }
+
+    return 0;
+}
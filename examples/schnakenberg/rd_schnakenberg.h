@@ -85,6 +85,7 @@ public:
      */
     void save()
     {
+        MORPH_RD_PROFILE_SCOPE (this->profiler, morph::rd_phase::save, 2 * this->nhex * sizeof(Flt));
         std::stringstream fname;
         fname << this->logpath << "/dat_";
         fname.width(5);
@@ -109,6 +110,7 @@ public:
     {
         std::vector<Flt> lapA(this->nhex, 0.0);
         this->compute_laplace (A_, lapA);
+        MORPH_RD_PROFILE_SCOPE (this->profiler, morph::rd_phase::reaction, 0);
 #pragma omp parallel for
         for (unsigned int h=0; h<this->nhex; ++h) {
             dAdt[h] = this->k1 - (this->k2 * A_[h])
@@ -123,6 +125,7 @@ public:
     {
         std::vector<Flt> lapB(this->nhex, 0.0);
         this->compute_laplace (B_, lapB);
+        MORPH_RD_PROFILE_SCOPE (this->profiler, morph::rd_phase::reaction, 0);
 #pragma omp parallel for
         for (unsigned int h=0; h<this->nhex; ++h) {
             // G = k4        - k3 A^2 B
@@ -135,6 +138,7 @@ public:
      */
     void step()
     {
+        MORPH_RD_PROFILE_STEP (this->profiler, this->nhex);
         this->stepCount++;
 
         // 1. 4th order Runge-Kutta computation for A
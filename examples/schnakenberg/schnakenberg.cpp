@@ -313,6 +313,7 @@ int main (int argc, char **argv)
 
 #ifdef COMPILE_PLOTTING
         if ((RD.stepCount % plotevery) == 0) {
+            MORPH_RD_PROFILE_SCOPE (RD.profiler, morph::rd_phase::visualise, 0);
             // These two lines update the data for the two hex grids. That leads to
             // the CPU recomputing the OpenGL vertices for the visualizations.
             hgv1p->updateData (&(RD.A));
@@ -376,6 +377,13 @@ int main (int argc, char **argv)
         cerr << "Warning: Something went wrong writing a copy of the params.json: " << conf.emsg << endl;
     }
 
+#ifdef MORPH_RD_PROFILE
+    // Per-phase timings and throughput, for tracking performance between runs
+    RD.profiler.save_json (logpath + "/profile.json");
+    cout << "Throughput: " << RD.profiler.cell_updates_per_second() << " cell updates/s, "
+         << RD.profiler.gigabytes_per_second() << " GB/s\n";
+#endif
+
 #ifdef COMPILE_PLOTTING
     cout << "Ctrl-c or press x in graphics window to exit.\n";
     v1.keepOpen();
@@ -39,7 +39,8 @@ namespace morph {
     enum class CartVisMode
     {
         Triangles, // Render triangles with a triangle vertex at the centre of each Rect.
-        RectInterp  // Render each rect as an actual rectangle made of 4 triangles.
+        RectInterp, // Render each rect as an actual rectangle made of 4 triangles.
+        Texture    // Render a rectangular CartGrid as one flat quad, with the data in a texture, colour mapped in the shader
     };
 
     //! The template argument T is the type of the data which this HexGridVisual
@@ -64,9 +65,47 @@ namespace morph {
             // Note: VisualModel::finalize() should be called before rendering
         }
 
+        //! Common function for setting up the z and colour scaling
+        void setupScaling()
+        {
+            if (this->scalarData != nullptr) {
+                this->dcopy.resize (this->scalarData->size());
+                this->zScale.transform (*(this->scalarData), dcopy);
+                this->dcolour.resize (this->scalarData->size());
+                this->colourScale.transform (*(this->scalarData), dcolour);
+            } else if (this->vectorData != nullptr) {
+                this->dcopy.resize (this->vectorData->size());
+                this->dcolour.resize (this->vectorData->size());
+                this->dcolour2.resize (this->vectorData->size());
+                this->dcolour3.resize (this->vectorData->size());
+                std::vector<float> veclens(dcopy);
+                for (unsigned int i = 0; i < this->vectorData->size(); ++i) {
+                    veclens[i] = (*this->vectorData)[i].length();
+                    this->dcolour[i] = (*this->vectorData)[i][0];
+                    this->dcolour2[i] = (*this->vectorData)[i][1];
+                    // Could also extract a third colour for Trichrome vs Duochrome (or for raw RGB signal)
+                    this->dcolour3[i] = (*this->vectorData)[i][2];
+                }
+                this->zScale.transform (veclens, this->dcopy);
+
+                // Handle case where this->cm.getType() == morph::ColourMapType::RGB and there is
+                // exactly one colour. ColourMapType::RGB assumes R/G/B data all in range 0->1
+                // ALREADY and therefore they don't need to be re-scaled with this->colourScale.
+                if (this->cm.getType() != morph::ColourMapType::RGB) {
+                    this->colourScale.transform (this->dcolour, this->dcolour);
+                    // Dual axis colour maps like Duochrome and HSV will need to use colourScale2 to
+                    // transform their second colour/axis,
+                    this->colourScale2.transform (this->dcolour2, this->dcolour2);
+                    // Similarly for Triple axis maps
+                    this->colourScale3.transform (this->dcolour3, this->dcolour3);
+                } // else assume dcolour/dcolour2/dcolour3 are all in range 0->1 (or 0-255) already
+            }
+        }
+
         //! Do the computations to initialize the vertices that will represent the HexGrid.
         virtual void initializeVertices()
         {
+            this->setup_datums();
             // Optionally compute an offset to ensure that the cartgrid is centred about the mv_offset.
             if (this->centralize == true) {
                 float left_lim = -this->cg->width()/2.0f;
@@ -74,8 +113,15 @@ namespace morph {
                 this->centering_offset[0] = left_lim - this->cg->d_x[0];
                 this->centering_offset[1] = bot_lim - this->cg->d_y[0];
             }
+            this->built_nrect = 0;
+            const CartVisMode mode = this->vis_mode();
 
-            switch (this->cartVisMode) {
+            switch (mode) {
+            case CartVisMode::Texture:
+            {
+                this->initializeVerticesTexture();
+                break;
+            }
             case CartVisMode::Triangles:
             {
                 this->initializeVerticesTris();
@@ -89,6 +135,11 @@ namespace morph {
             }
             }
 
+            // Record the layout of the rect vertices for update_data_in_place()
+            this->built_nrect = this->cg->num();
+            this->built_mode = mode;
+            this->built_centralize = this->centralize;
+
             if (this->showborder == true) {
                 // Draw around the outside.
                 morph::vec<float, 4> cg_extents = this->cg->get_extents(); // {xmin, xmax, ymin, ymax}
@@ -118,41 +169,20 @@ namespace morph {
             this->idx = 0;
             unsigned int nrect = this->cg->num();
 
-            if (this->scalarData != nullptr) {
-                this->dcopy.resize (this->scalarData->size());
-                this->zScale.transform (*(this->scalarData), dcopy);
-                this->dcolour.resize (this->scalarData->size());
-                this->colourScale.transform (*(this->scalarData), dcolour);
-            } else if (this->vectorData != nullptr) {
-                this->dcopy.resize (this->vectorData->size());
-                this->dcolour.resize (this->vectorData->size());
-                this->dcolour2.resize (this->vectorData->size());
-                this->dcolour3.resize (this->vectorData->size());
-                std::vector<float> veclens(dcopy);
-                for (unsigned int i = 0; i < this->vectorData->size(); ++i) {
-                    veclens[i] = (*this->vectorData)[i].length();
-                    this->dcolour[i] = (*this->vectorData)[i][0];
-                    this->dcolour2[i] = (*this->vectorData)[i][1];
-                    // Could also extract a third colour for Trichrome vs Duochrome
-                    this->dcolour3[i] = (*this->vectorData)[i][2];
-                }
-                this->zScale.transform (veclens, this->dcopy);
-                if (this->cm.getType() != morph::ColourMapType::RGB) {
-                    this->colourScale.transform (this->dcolour, this->dcolour);
-                    this->colourScale2.transform (this->dcolour2, this->dcolour2);
-                    this->colourScale3.transform (this->dcolour3, this->dcolour3);
-                }
-            }
+            this->setupScaling();
 
-            for (unsigned int ri = 0; ri < nrect; ++ri) {
+            this->build_elements (nrect, [this](morph::mesh_chunk& m, std::size_t ri) {
                 std::array<float, 3> clr = this->setColour (ri);
                 this->vertex_push (this->cg->d_x[ri]+centering_offset[0],
-                                   this->cg->d_y[ri]+centering_offset[1], dcopy[ri], this->vertexPositions);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            }
-
-            // Build indices based on neighbour relations in the CartGrid
+                                   this->cg->d_y[ri]+centering_offset[1], dcopy[ri], m.positions);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (0.0f, 0.0f, 1.0f, m.normals);
+                ++m.idx;
+            }, 1u, 0u);
+
+            // Build indices based on neighbour relations in the CartGrid. These refer to
+            // other rects' vertices, so they are made serially, after the vertices.
+            this->indices.reserve (this->indices.size() + 6u * nrect);
             for (unsigned int ri = 0; ri < nrect; ++ri) {
                 if (R_HAS_NNE(ri) && R_HAS_NE(ri)) {
                     this->indices.push_back (ri);
@@ -166,8 +196,6 @@ namespace morph {
                     this->indices.push_back (R_NSW(ri));
                 }
             }
-
-            this->idx += nrect;
         }
 
         //! Show a set of hexes at the zero?
@@ -186,52 +214,22 @@ namespace morph {
             unsigned int nrect = this->cg->num();
             this->idx = 0;
 
-            if (this->scalarData != nullptr) {
-                this->dcopy.resize (this->scalarData->size());
-                this->zScale.transform (*(this->scalarData), dcopy);
-                this->dcolour.resize (this->scalarData->size());
-                this->colourScale.transform (*(this->scalarData), dcolour);
-            } else if (this->vectorData != nullptr) {
-                this->dcopy.resize (this->vectorData->size());
-                this->dcolour.resize (this->vectorData->size());
-                this->dcolour2.resize (this->vectorData->size());
-                this->dcolour3.resize (this->vectorData->size());
-                std::vector<float> veclens(dcopy);
-                for (unsigned int i = 0; i < this->vectorData->size(); ++i) {
-                    veclens[i] = (*this->vectorData)[i].length();
-                    this->dcolour[i] = (*this->vectorData)[i][0];
-                    this->dcolour2[i] = (*this->vectorData)[i][1];
-                    // Could also extract a third colour for Trichrome vs Duochrome (or for raw RGB signal)
-                    this->dcolour3[i] = (*this->vectorData)[i][2];
-                }
-                this->zScale.transform (veclens, this->dcopy);
+            this->setupScaling();
 
-                // Handle case where this->cm.getType() == morph::ColourMapType::RGB and there is
-                // exactly one colour. ColourMapType::RGB assumes R/G/B data all in range 0->1
-                // ALREADY and therefore they don't need to be re-scaled with this->colourScale.
-                if (this->cm.getType() != morph::ColourMapType::RGB) {
-                    this->colourScale.transform (this->dcolour, this->dcolour);
-                    // Dual axis colour maps like Duochrome and HSV will need to use colourScale2 to
-                    // transform their second colour/axis,
-                    this->colourScale2.transform (this->dcolour2, this->dcolour2);
-                    // Similarly for Triple axis maps
-                    this->colourScale3.transform (this->dcolour3, this->dcolour3);
-                } // else assume dcolour/dcolour2/dcolour3 are all in range 0->1 (or 0-255) already
-            }
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f;
-            float datumNN = 0.0f;
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNS = 0.0f;
-            float datumNSE = 0.0f;
-
-            float datum = 0.0f;
-
-            morph::vec<float> vtx_0, vtx_1, vtx_2;
-            for (unsigned int ri = 0; ri < nrect; ++ri) {
+            this->build_elements (nrect, [&](morph::mesh_chunk& m, std::size_t ri) {
+                float datumC = 0.0f;   // datum at the centre
+                float datumNE = 0.0f;  // datum at the hex to the east.
+                float datumNNE = 0.0f;
+                float datumNN = 0.0f;
+                float datumNNW = 0.0f;
+                float datumNW = 0.0f;
+                float datumNSW = 0.0f;
+                float datumNS = 0.0f;
+                float datumNSE = 0.0f;
+
+                float datum = 0.0f;
+
+                morph::vec<float> vtx_0, vtx_1, vtx_2;
 
                 // Use the linear scaled copy of the data, dcopy.
                 datumC  = dcopy[ri];
@@ -251,7 +249,7 @@ namespace morph {
                 std::array<float, 3> clr = this->setColour (ri);
 
                 // First push the 5 positions of the triangle vertices, starting with the centre
-                this->vertex_push (this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push (this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], datumC, m.positions);
 
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = {{this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], datumC}};
@@ -270,7 +268,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, m.positions);
                 vtx_1 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum}};
 
                 // SE vertex
@@ -287,7 +285,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, m.positions);
                 vtx_2 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum}};
 
 
@@ -302,7 +300,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, m.positions);
 
                 // NW vertex
                 //datum = 0.25f * (datumC + datumNN + datumNW + datumNNW);
@@ -315,7 +313,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, m.positions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note
                 // that there is only one 'layer' of vertices; the back of the
@@ -326,38 +324,38 @@ namespace morph {
                 morph::vec<float> plane2 = vtx_2 - vtx_0;
                 morph::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
 
                 // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
 
                 // Define indices now to produce the 4 triangles in the hex
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
 
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
-            }
+                m.idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+            }, 5u, 12u);
 
 #if 0
             // Show a Flat surface for the zero plane? This is expensively plotting out all the hexes...
@@ -448,7 +446,12 @@ namespace morph {
 #endif
         }
 
-        //! How to render the elements. Triangles are faster. RectInterp more often used.
+        /*!
+         * How to render the elements. Triangles are faster. RectInterp more often used.
+         * Texture is fastest to build and to update but is only for rectangular CartGrids
+         * (others are drawn with RectInterp) viewed flat. It ignores zScale and applies the
+         * colour map in the shader (see data_texture_linear).
+         */
         CartVisMode cartVisMode = CartVisMode::RectInterp;
 
         //! Set this to true to adjust the positions that the CartGridVisual uses to plot
@@ -469,6 +472,8 @@ namespace morph {
         //! An overridable function to set the colour of rect ri
         std::array<float, 3> setColour (unsigned int ri)
         {
+            // With gpu_colourmap, the shader applies the colour map
+            if (this->datum_dims > 0u) { return this->datum_at (ri); }
             std::array<float, 3> clr = { 0.0f, 0.0f, 0.0f };
             if (this->cm.numDatums() == 3) {
                 //if constexpr (std::is_same<std::decay_t<T>, unsigned char>::value == true) {
@@ -487,11 +492,158 @@ namespace morph {
             return clr;
         }
 
+        /*!
+         * Recompute the colours of the rects, and their z positions and normals if dcopy has
+         * changed, in the vertices made by the last initializeVertices(). The border vertices
+         * that follow the rects are left as they are.
+         */
+        bool update_data_in_place() override
+        {
+            unsigned int nrect = this->cg->num();
+            std::size_t datasize = 0;
+            if (this->scalarData != nullptr) {
+                datasize = this->scalarData->size();
+            } else if (this->vectorData != nullptr) {
+                datasize = this->vectorData->size();
+            }
+            if (nrect == 0 || this->built_nrect != nrect || datasize != nrect
+                || this->built_mode != this->vis_mode() || this->built_centralize != this->centralize) {
+                return false;
+            }
+            if (this->built_mode == CartVisMode::Texture) {
+                // Only the data texture changes; it is re-uploaded on the next render
+                this->setupScaling();
+                this->fill_data_texels();
+                return true;
+            }
+            const bool tris = (this->cartVisMode == CartVisMode::Triangles);
+            const std::size_t nv = tris ? 1u : 5u; // vertices per rect
+            if (this->vertexColors.size() < 3u * nv * nrect) { return false; }
+
+            // Keep the z values of the existing vertices to compare with the new ones
+            this->dcopy.swap (this->dcopy_prev);
+            this->setupScaling();
+
+            for (unsigned int ri = 0; ri < nrect; ++ri) {
+                std::array<float, 3> clr = this->setColour (ri);
+                for (std::size_t j = 0; j < nv; ++j) { this->vertex_set (nv * ri + j, clr, this->vertexColors); }
+            }
+
+            if (this->dcopy == this->dcopy_prev) {
+                this->reinit_colour_buffer();
+                return true;
+            }
+
+            if (tris) {
+                for (unsigned int ri = 0; ri < nrect; ++ri) { this->vertexPositions[3u * ri + 2u] = dcopy[ri]; }
+            } else {
+                // As in initializeVerticesRectsInterpolated(). The x and y of each vertex are unchanged.
+                auto vtx = [this](std::size_t vi, float z) {
+                    return morph::vec<float>{ this->vertexPositions[3u * vi], this->vertexPositions[3u * vi + 1u], z };
+                };
+                std::array<float, 5> z;
+                for (unsigned int ri = 0; ri < nrect; ++ri) {
+                    float datumC   = dcopy[ri];
+                    float datumNE  = R_HAS_NE(ri)  ? dcopy[R_NE(ri)] : datumC;
+                    float datumNN  = R_HAS_NN(ri)  ? dcopy[R_NN(ri)] : datumC;
+                    float datumNW  = R_HAS_NW(ri)  ? dcopy[R_NW(ri)] : datumC;
+                    float datumNS  = R_HAS_NS(ri)  ? dcopy[R_NS(ri)] : datumC;
+                    float datumNNE = R_HAS_NNE(ri) ? dcopy[R_NNE(ri)] : datumC;
+                    float datumNNW = R_HAS_NNW(ri) ? dcopy[R_NNW(ri)] : datumC;
+                    float datumNSW = R_HAS_NSW(ri) ? dcopy[R_NSW(ri)] : datumC;
+                    float datumNSE = R_HAS_NSE(ri) ? dcopy[R_NSE(ri)] : datumC;
+                    z[0] = datumC;
+                    z[1] = (R_HAS_NN(ri) && R_HAS_NE(ri) && R_HAS_NNE(ri)) ? 0.25f * (datumC + datumNN + datumNE + datumNNE)
+                    : R_HAS_NE(ri) ? 0.5f * (datumC + datumNE) : R_HAS_NN(ri) ? 0.5f * (datumC + datumNN) : datumC;
+                    z[2] = (R_HAS_NS(ri) && R_HAS_NE(ri) && R_HAS_NSE(ri)) ? 0.25f * (datumC + datumNS + datumNE + datumNSE)
+                    : R_HAS_NE(ri) ? 0.5f * (datumC + datumNE) : R_HAS_NS(ri) ? 0.5f * (datumC + datumNS) : datumC;
+                    z[3] = (R_HAS_NS(ri) && R_HAS_NW(ri) && R_HAS_NSW(ri)) ? 0.25f * (datumC + datumNS + datumNW + datumNSW)
+                    : R_HAS_NW(ri) ? 0.5f * (datumC + datumNW) : R_HAS_NS(ri) ? 0.5f * (datumC + datumNS) : datumC;
+                    z[4] = (R_HAS_NN(ri) && R_HAS_NW(ri) && R_HAS_NNW(ri)) ? 0.25f * (datumC + datumNN + datumNW + datumNNW)
+                    : R_HAS_NW(ri) ? 0.5f * (datumC + datumNW) : R_HAS_NN(ri) ? 0.5f * (datumC + datumNN) : datumC;
+
+                    const std::size_t v0 = 5u * ri;
+                    for (std::size_t j = 0; j < 5; ++j) { this->vertexPositions[3u * (v0 + j) + 2u] = z[j]; }
+                    morph::vec<float> vtx_0 = vtx (v0, z[0]);
+                    morph::vec<float> vnorm = (vtx (v0 + 2, z[2]) - vtx_0).cross (vtx (v0 + 1, z[1]) - vtx_0);
+                    vnorm.renormalize();
+                    for (std::size_t j = 0; j < 5; ++j) { this->vertex_set (v0 + j, vnorm, this->vertexNormals); }
+                }
+            }
+            this->reinit_vertex_buffers();
+            return true;
+        }
+
+        /*!
+         * Initialize as one flat quad covering the CartGrid, textured with the data. Texel
+         * (xi - xi_min, yi - yi_min) holds the datum of the rect at integer coordinates
+         * (xi, yi).
+         */
+        void initializeVerticesTexture()
+        {
+            this->idx = 0;
+            this->setupScaling(); // for the colour scale's autoscaling
+
+            const morph::range<int> xr = morph::MathAlgo::maxmin (this->cg->d_xi);
+            const morph::range<int> yr = morph::MathAlgo::maxmin (this->cg->d_yi);
+            const GLsizei tw = static_cast<GLsizei>(xr.max - xr.min + 1);
+            const std::size_t nrect = this->cg->num();
+            std::vector<std::size_t> elems (nrect);
+            for (std::size_t ri = 0; ri < nrect; ++ri) {
+                elems[(this->cg->d_yi[ri] - yr.min) * tw + (this->cg->d_xi[ri] - xr.min)] = ri;
+            }
+            this->setup_data_texture (tw, static_cast<GLsizei>(yr.max - yr.min + 1), std::move (elems));
+
+            const morph::range<float> xp = morph::MathAlgo::maxmin (this->cg->d_x);
+            const morph::range<float> yp = morph::MathAlgo::maxmin (this->cg->d_y);
+            const float left = xp.min - this->cg->getd() / 2.0f + this->centering_offset[0];
+            const float right = xp.max + this->cg->getd() / 2.0f + this->centering_offset[0];
+            const float bot = yp.min - this->cg->getv() / 2.0f + this->centering_offset[1];
+            const float top = yp.max + this->cg->getv() / 2.0f + this->centering_offset[1];
+            this->vertex_push (left, bot, 0.0f, this->vertexPositions);
+            this->vertex_push (right, bot, 0.0f, this->vertexPositions);
+            this->vertex_push (right, top, 0.0f, this->vertexPositions);
+            this->vertex_push (left, top, 0.0f, this->vertexPositions);
+            this->vertex_push (VisualDataModel<T, glver>::texcoord_at (0.0f, 0.0f), this->vertexColors);
+            this->vertex_push (VisualDataModel<T, glver>::texcoord_at (1.0f, 0.0f), this->vertexColors);
+            this->vertex_push (VisualDataModel<T, glver>::texcoord_at (1.0f, 1.0f), this->vertexColors);
+            this->vertex_push (VisualDataModel<T, glver>::texcoord_at (0.0f, 1.0f), this->vertexColors);
+            for (unsigned int i = 0; i < 4; ++i) { this->vertex_push (this->uz, this->vertexNormals); }
+            this->indices.insert (this->indices.end(), { 0u, 1u, 2u, 0u, 2u, 3u });
+            this->idx = 4;
+        }
+
+        //! True if every point of the bounding rectangle of the CartGrid's rects is a rect
+        bool cg_is_rectangular() const
+        {
+            if (this->cg->num() == 0) { return false; }
+            const morph::range<int> xr = morph::MathAlgo::maxmin (this->cg->d_xi);
+            const morph::range<int> yr = morph::MathAlgo::maxmin (this->cg->d_yi);
+            return static_cast<std::size_t>(xr.max - xr.min + 1) * static_cast<std::size_t>(yr.max - yr.min + 1) == this->cg->num();
+        }
+
+        //! Texture mode needs the colour map in the shader
+        bool colourmap_in_shader() const override
+        {
+            return this->gpu_colourmap || this->cartVisMode == CartVisMode::Texture;
+        }
+
+        //! The mode in which to build the model. Texture falls back to RectInterp where it can't be used.
+        CartVisMode vis_mode() const
+        {
+            if (this->cartVisMode == CartVisMode::Texture && (this->datum_dims == 0u || !this->cg_is_rectangular())) {
+                return CartVisMode::RectInterp;
+            }
+            return this->cartVisMode;
+        }
+
         //! The CartGrid to visualize
         const CartGrid* cg;
 
         //! A copy of the scalarData which can be transformed suitably to be the z value of the surface
         std::vector<float> dcopy;
+        //! The previous dcopy, kept by update_data_in_place()
+        std::vector<float> dcopy_prev;
         //! A copy of the scalarData (or first field of vectorData), scaled to be a colour value
         std::vector<float> dcolour;
         std::vector<float> dcolour2;
@@ -502,6 +654,11 @@ namespace morph {
         // computed x/y/z position for a rectangle, and this means that the rectangle
         // will be centered around mv_offset.
         morph::vec<float, 3> centering_offset = { 0.0f, 0.0f, 0.0f };
+
+        //! The number of rects, mode and centralization of the vertices made by initializeVertices()
+        unsigned int built_nrect = 0;
+        CartVisMode built_mode = CartVisMode::RectInterp;
+        bool built_centralize = false;
     };
 
 } // namespace morph
@@ -8,6 +8,10 @@
 #include <stdexcept>
 #include <cmath>
 #include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <algorithm>
 #include <morph/tools.h>
 #include <morph/vec.h>
 #include <morph/mathconst.h>
@@ -1859,13 +1863,16 @@ namespace morph {
                 throw std::runtime_error ("Unhandled ColourMap data type.");
             }
 
+            return this->convert_unit (datum);
+        }
+
+        //! Convert a datum that has already been scaled into the range [0,1] (or is NaN)
+        std::array<float, 3> convert_unit (float datum) const
+        {
             std::array<float, 3> c = {0.0f, 0.0f, 0.0f};
 
             // Check for nan and return a 'nan' colour for the colour map
-            if constexpr (std::is_same<std::decay_t<T>, double>::value == true
-                          || std::is_same<std::decay_t<T>, float>::value == true) {
-                if (std::isnan(datum) == true) { c = ColourMap<T>::nanColour(this->type); return c; }
-            }
+            if (std::isnan(datum) == true) { c = ColourMap<T>::nanColour(this->type); return c; }
 
             switch (this->type) {
             case ColourMapType::Jet:
@@ -2649,6 +2656,53 @@ namespace morph {
             return c;
         }
 
+        //! The number of entries in the lookup table used by convert_batch
+        static constexpr std::uint32_t lut_size = 4096;
+
+        /*!
+         * Convert the n scalar datums in data into colours, written interleaved (r, g, b,
+         * r, g, b, ...) into rgb, which must have room for 3n floats.
+         *
+         * The colours are those that convert (data[i]) would give, looked up from a table of
+         * lut_size samples of the colour map, so they may differ from convert's by one step of
+         * that table. The table is made on the first call and re-made only when the map type,
+         * hue, saturation or value change. Each element costs a clamp, a scale and a table
+         * read, in chunks that the compiler can vectorise, shared between OpenMP threads.
+         */
+        void convert_batch (const T* data, std::size_t n, float* rgb)
+        {
+            const float* lut = this->lookup_table().data();
+            float inv_range = 1.0f;
+            if constexpr (std::is_integral<std::decay_t<T>>::value == true
+                          && std::is_same<std::decay_t<T>, bool>::value == false) {
+                inv_range = 1.0f / static_cast<float>(this->range_max);
+            }
+            const std::int64_t nn = static_cast<std::int64_t>(n);
+            const std::int64_t nchunks = (nn + lut_chunk - 1) / lut_chunk;
+#pragma omp parallel for schedule(static)
+            for (std::int64_t ci = 0; ci < nchunks; ++ci) {
+                alignas(64) std::uint32_t idx[lut_chunk];
+                const std::int64_t i0 = ci * lut_chunk;
+                const std::uint32_t m = static_cast<std::uint32_t>(std::min (nn - i0, static_cast<std::int64_t>(lut_chunk)));
+                const T* d = data + i0;
+                for (std::uint32_t j = 0; j < m; ++j) { idx[j] = ColourMap<T>::lut_index (d[j], inv_range); }
+                float* o = rgb + 3 * i0;
+                for (std::uint32_t j = 0; j < m; ++j) {
+                    const float* c = lut + 3u * idx[j];
+                    o[3u * j] = c[0];
+                    o[3u * j + 1u] = c[1];
+                    o[3u * j + 2u] = c[2];
+                }
+            }
+        }
+
+        //! Convert the datums in data into interleaved RGB colours in rgb, resizing rgb to match
+        void convert_batch (const std::vector<T>& data, std::vector<float>& rgb)
+        {
+            rgb.resize (3u * data.size());
+            this->convert_batch (data.data(), data.size(), rgb.data());
+        }
+
         //! Getter for type, the ColourMapType of this ColourMap.
         ColourMapType getType() const { return this->type; }
 
@@ -3024,6 +3078,57 @@ namespace morph {
         }
 
     private:
+        //! convert_batch works through its input in chunks of this many datums
+        static constexpr std::int64_t lut_chunk = 256;
+
+        //! The lookup table: lut_size colours for datums 0 to 1, then the NaN colour
+        std::vector<float> lut;
+        //! The state of the map when lut was made (see lut_key)
+        std::array<float, 12> lut_made_for = {};
+
+        //! Everything that affects the colours given by convert_unit
+        std::array<float, 12> lut_key() const
+        {
+            return { static_cast<float>(this->type), this->hue, this->sat, this->val,
+                     this->hue2, this->sat2, this->val2, this->hue3, this->sat3, this->val3,
+                     static_cast<float>(this->hue_rotation), this->hue_reverse_direction ? 1.0f : 0.0f };
+        }
+
+        //! Return the lookup table for convert_batch, (re)making it if the map has changed
+        const std::vector<float>& lookup_table()
+        {
+            const std::array<float, 12> key = this->lut_key();
+            if (!this->lut.empty() && key == this->lut_made_for) { return this->lut; }
+            this->lut.resize (3u * (lut_size + 1u));
+            for (std::uint32_t i = 0; i <= lut_size; ++i) {
+                std::array<float, 3> c = i < lut_size
+                ? this->convert_unit (static_cast<float>(i) / static_cast<float>(lut_size - 1u))
+                : ColourMap<T>::nanColour (this->type);
+                std::copy (c.begin(), c.end(), this->lut.begin() + 3u * i);
+            }
+            this->lut_made_for = key;
+            return this->lut;
+        }
+
+        /*!
+         * The lookup table index for _datum; its position in [0,1] to the nearest table entry,
+         * or lut_size for NaN. Written without branches, so that it vectorises.
+         */
+        static std::uint32_t lut_index (T _datum, float inv_range)
+        {
+            if constexpr (std::is_same<std::decay_t<T>, bool>::value == true) {
+                (void)inv_range;
+                return _datum ? lut_size - 1u : 0u;
+            } else {
+                float datum = static_cast<float>(_datum);
+                if constexpr (std::is_integral<std::decay_t<T>>::value == true) { datum *= inv_range; }
+                // NaN fails both comparisons, so clamps to 0 here and is picked out below
+                const float cl = datum > 1.0f ? 1.0f : (datum >= 0.0f ? datum : 0.0f);
+                const std::uint32_t i = static_cast<std::uint32_t>(cl * static_cast<float>(lut_size - 1u) + 0.5f);
+                return datum != datum ? lut_size : i;
+            }
+        }
+
         /*!
          * @param datum gray value from 0.0 to 1.0
          *
@@ -77,127 +77,77 @@ namespace morph {
                 std::cout << "No data to set up dcolours\n";
             }
 
-            float _x = 0.0f;
-            morph::vec<float> vtx_0; // centre of a Grid element
-            morph::vec<float> vtx_ne, vtx_nw, vtx_se, vtx_sw;
-
             float angle_per_distance = this->angle_to_subtend / (dx[0]+this->grid->width());
 
-            morph::vec<float> centroid = { 0.0f, 0.0f, 0.0f };
-            unsigned long long int c_count = 0;
-            for (unsigned int ri = 0; ri < nrect; ++ri) {
-
-                bool T_border = false;
-                bool B_border = false;
-                bool L_border = false;
-                bool R_border = false;
+            // The rectangles are built in parallel; the frames, which are few, are drawn afterwards
+            this->build_elements (nrect, [&](morph::mesh_chunk& m, std::size_t ri) {
+                // Here we test if we should omit this rectangle.
+                if (std::abs ((*this->grid)[ri][0]+this->centering_offset[0]) > this->max_abs_x) { return; }
 
                 // Use a single colour for each rect, even though rectangle's z
                 // positions are interpolated. Do the _colour_ scaling:
                 std::array<float, 3> clr = this->setColour (ri);
 
-                // First push the 5 positions of the triangle vertices, starting with the centre
-                _x = -((*this->grid)[ri][0]+this->centering_offset[0]); // why mult by -1? Because -x on Grid becomes +angle on CurvyTelly
-
-                // Here we test if we should omit this rectangle.
-                if (std::abs(_x) > this->max_abs_x) { continue; }
-
-                // For central vertex, reduce radius down
-                float rprime = this->radius * std::cos (hx*angle_per_distance);
-                vtx_0 = {
-                    rprime * std::cos (this->rotoff + _x*angle_per_distance),
-                    rprime * std::sin (this->rotoff + _x*angle_per_distance),
-                    (*this->grid)[ri][1]+this->centering_offset[1]
-                };
-                this->vertex_push (vtx_0, this->vertexPositions);
-                centroid += vtx_0;
-                ++c_count;
-                // Use the centre position as the first location for finding the normal vector
-
-                // NE vertex
-                _x += hx;
-                vtx_ne = {
-                    this->radius * std::cos (this->rotoff + _x*angle_per_distance),
-                    this->radius * std::sin (this->rotoff + _x*angle_per_distance),
-                    (*this->grid)[ri][1]+vy+this->centering_offset[1]
-                };
-                this->vertex_push (vtx_ne, this->vertexPositions);
-                centroid += vtx_ne;
-                ++c_count;
-
-                // With the NE vertex, figure out if we're at the top/right
-                if (this->grid->row(ri) == (this->grid->get_h()-1) && this->tb_frames == true) { T_border = true; }
-                if (this->grid->col(ri) == (this->grid->get_w()-1) && this->lr_frames == true) { R_border = true; }
-
-                // SE vertex
-                vtx_se = vtx_ne; // x/y unchanged
-                vtx_se[2] = (*this->grid)[ri][1]-vy+this->centering_offset[1];
-                this->vertex_push (vtx_se, this->vertexPositions);
-                centroid += vtx_se;
-                ++c_count;
-
-                // SW vertex
-                _x = -((*this->grid)[ri][0]+this->centering_offset[0])-hx;
-                vtx_sw = {
-                    this->radius * std::cos (this->rotoff + _x*angle_per_distance),
-                    this->radius * std::sin (this->rotoff + _x*angle_per_distance),
-                    (*this->grid)[ri][1]-vy+this->centering_offset[1] // same as vtx_2[2]
-                };
-                this->vertex_push (vtx_sw, this->vertexPositions);
-                centroid += vtx_sw;
-                ++c_count;
-
-                // With the SW vertex, figure out if we're at the bottom/left
-                if (this->grid->row(ri) == 0 && this->tb_frames == true) { B_border = true; }
-                if (this->grid->col(ri) == 0 && this->lr_frames == true) { L_border = true; }
-
-                // NW vertex
-                vtx_nw = vtx_sw; // x/y unchanged
-                vtx_nw[2] = (*this->grid)[ri][1]+vy+this->centering_offset[1];
-                this->vertex_push (vtx_nw, this->vertexPositions);
-                centroid += vtx_nw;
-                ++c_count;
+                // The 5 positions of the triangle vertices, starting with the centre
+                const std::array<morph::vec<float>, 5> v = this->rect_vertices (ri, hx, vy, angle_per_distance);
+                for (const morph::vec<float>& vtx : v) { this->vertex_push (vtx, m.positions); }
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note
                 // that there is only one 'layer' of vertices; the back of the
                 // GridVisual will be coloured the same as the front. To get lighting
                 // effects to look really good, the back of the surface could need the
                 // opposite normal.
-                morph::vec<float> plane1 = vtx_ne - vtx_0;
-                morph::vec<float> plane2 = vtx_se - vtx_0;
+                morph::vec<float> plane1 = v[1] - v[0];
+                morph::vec<float> plane2 = v[2] - v[0];
                 morph::vec<float> vnorm = plane1.cross (plane2);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                for (unsigned int j = 0; j < 5; ++j) { this->vertex_push (vnorm, m.normals); }
 
                 // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                for (unsigned int j = 0; j < 5; ++j) { this->vertex_push (clr, m.colors); }
 
                 // Define indices now to produce the 4 triangles in the hex
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx+1);
 
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+                m.idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+            }, 5u, 12u);
+
+            // The centroid of the rectangles' vertices
+            morph::vec<float> centroid = { 0.0f, 0.0f, 0.0f };
+            const std::size_t c_count = this->idx;
+            for (std::size_t vi = 0; vi < c_count; ++vi) {
+                centroid += morph::vec<float>{ this->vertexPositions[vi * 3], this->vertexPositions[vi * 3 + 1], this->vertexPositions[vi * 3 + 2] };
+            }
+
+            for (unsigned int ri = 0; ri < nrect; ++ri) {
+                if (std::abs ((*this->grid)[ri][0]+this->centering_offset[0]) > this->max_abs_x) { continue; }
+
+                // Figure out if we're at the top/right or bottom/left
+                const bool T_border = this->grid->row(ri) == (this->grid->get_h()-1) && this->tb_frames == true;
+                const bool R_border = this->grid->col(ri) == (this->grid->get_w()-1) && this->lr_frames == true;
+                const bool B_border = this->grid->row(ri) == 0 && this->tb_frames == true;
+                const bool L_border = this->grid->col(ri) == 0 && this->lr_frames == true;
+                if (!T_border && !R_border && !B_border && !L_border) { continue; }
+
+                const std::array<morph::vec<float>, 5> v = this->rect_vertices (ri, hx, vy, angle_per_distance);
+                const morph::vec<float>& vtx_ne = v[1];
+                const morph::vec<float>& vtx_se = v[2];
+                const morph::vec<float>& vtx_sw = v[3];
+                const morph::vec<float>& vtx_nw = v[4];
 
                 if (T_border) { this->draw_top_border (vtx_nw, vtx_ne); }
                 if (B_border) { this->draw_bottom_border (vtx_sw, vtx_se); }
@@ -238,6 +188,46 @@ namespace morph {
             }
         }
 
+        /*!
+         * The positions of the centre and the NE, SE, SW and NW corners of the rectangle for
+         * Grid element ri, curved around the telly.
+         */
+        std::array<morph::vec<float>, 5> rect_vertices (const std::size_t ri, const float hx, const float vy,
+                                                        const float angle_per_distance) const
+        {
+            std::array<morph::vec<float>, 5> v;
+            // why mult by -1? Because -x on Grid becomes +angle on CurvyTelly
+            float _x = -((*this->grid)[ri][0]+this->centering_offset[0]);
+            // For central vertex, reduce radius down
+            float rprime = this->radius * std::cos (hx*angle_per_distance);
+            v[0] = {
+                rprime * std::cos (this->rotoff + _x*angle_per_distance),
+                rprime * std::sin (this->rotoff + _x*angle_per_distance),
+                (*this->grid)[ri][1]+this->centering_offset[1]
+            };
+            // NE vertex
+            _x += hx;
+            v[1] = {
+                this->radius * std::cos (this->rotoff + _x*angle_per_distance),
+                this->radius * std::sin (this->rotoff + _x*angle_per_distance),
+                (*this->grid)[ri][1]+vy+this->centering_offset[1]
+            };
+            // SE vertex
+            v[2] = v[1]; // x/y unchanged
+            v[2][2] = (*this->grid)[ri][1]-vy+this->centering_offset[1];
+            // SW vertex
+            _x = -((*this->grid)[ri][0]+this->centering_offset[0])-hx;
+            v[3] = {
+                this->radius * std::cos (this->rotoff + _x*angle_per_distance),
+                this->radius * std::sin (this->rotoff + _x*angle_per_distance),
+                (*this->grid)[ri][1]-vy+this->centering_offset[1] // same as vtx_2[2]
+            };
+            // NW vertex
+            v[4] = v[3]; // x/y unchanged
+            v[4][2] = (*this->grid)[ri][1]+vy+this->centering_offset[1];
+            return v;
+        }
+
         // Draw a pixel of the top border
         void draw_top_border (const morph::vec<float> vtx_nw, const morph::vec<float> vtx_ne)
         {
@@ -54,9 +54,9 @@ namespace morph {
         static constexpr bool gv_debug = false;
 
         //! Append a single datum onto the relevant graph. Build on existing data in
-        //! graphDataCoords. Finish up with a call to completeAppend(). didx is the data
-        //! index and counts up from 0. Have to save _abscissa and _ordinate in a local
-        //! copy of the data to be able to rescale.
+        //! graphDataCoords. The vertices for the datum are computed in the next call to
+        //! render(). didx is the data index and counts up from 0. Have to save _abscissa and
+        //! _ordinate in a local copy of the data to be able to rescale.
         void append (const Flt& _abscissa, const Flt& _ordinate, const unsigned int didx)
         {
             this->pendingAppended = true;
@@ -124,44 +124,39 @@ namespace morph {
                 }
             }
 
-            // update graph if necessary
+            // If the axis ranges have changed, then every existing datum has to be re-scaled and
+            // the axes re-drawn. Update the scaling now, so that any further appends are compared
+            // with the new ranges, but leave the rebuild until render(), so that it happens at
+            // most once per frame however many appends change the ranges.
             if (redraw_plot > 0) {
-                this->clear_graph_data();
-
-                // setdata or this function will re-add these
-                this->graphDataCoords.clear();
-                this->datastyles.clear();
-
-                this->pendingAppended = true; // as the graph will be re-drawn
-
                 this->abscissa_scale.reset();
                 this->ord1_scale.reset();
                 this->ord2_scale.reset();
                 this->setlimits (xrange, yrange, y2range);
-
-                if (!this->ord1.empty()) {
-                    // vvec, vvec, datasetstyle
-                    this->setdata (this->absc1, this->ord1, this->ds_ord1);
-                }
-                if (!this->ord2.empty()) {
-                    this->setdata (this->absc2, this->ord2, this->ds_ord2);
-                }
+                this->pendingRebuild = true;
             }
-
-            VisualModel<glver>::clear(); // Get rid of the vertices.
-            this->initializeVertices(); // Re-build
         }
 
-        //! Before calling the base class's render method, check if we have any pending data
+        /*!
+         * Before calling the base class's render method, check if we have any pending data. Data
+         * appended without a change in the axis ranges is drawn incrementally; only the new
+         * markers and line segments are computed and only they are uploaded to the GPU.
+         */
         void render()
         {
-            if (this->pendingAppended == true) {
+            if (this->pendingRebuild == true) {
+                this->rebuild_graph();
+                // Visual has already passed the scene matrix to the old texts; pass it on to the new
+                this->setSceneMatrix (this->scenematrix);
+            } else if (this->pendingAppended == true) {
                 // After adding to graphDataCoords, we have to create the new OpenGL
-                // vertices (CPU side) and update the OpenGL buffers.
+                // vertices (CPU side) and add them to the OpenGL buffers.
+                std::size_t first_vertex = this->vertexPositions.size() / 3u;
+                std::size_t first_index = this->indices.size();
                 this->drawAppendedData();
-                this->reinit_buffers();
-                this->pendingAppended = false;
+                this->append_buffers (first_vertex, first_index);
             }
+            this->pendingAppended = false;
             // Now do the usual drawing stuff from VisualModel:
             VisualModel<glver>::render();
         }
@@ -907,6 +902,29 @@ namespace morph {
         //! Is there pending appended data that needs to be converted into OpenGL shapes?
         bool pendingAppended = false;
 
+        //! Has appended data changed the axis ranges, so that the whole graph must be re-drawn?
+        bool pendingRebuild = false;
+
+        //! Re-scale all of the data in absc1/ord1 and absc2/ord2 and re-draw the whole graph
+        void rebuild_graph()
+        {
+            // Keep a dataset for each axis side in use, even if it has no data yet
+            bool have_left = !this->ord1.empty();
+            bool have_right = !this->ord2.empty();
+            for (const auto& ds : this->datastyles) {
+                if (ds.axisside == morph::axisside::left) { have_left = true; } else { have_right = true; }
+            }
+            // setdata will re-add these
+            this->graphDataCoords.clear();
+            this->datastyles.clear();
+            // The scales were already updated by append()
+            if (have_left) { this->setdata (this->absc1, this->ord1, this->ds_ord1); }
+            if (have_right) { this->setdata (this->absc2, this->ord2, this->ds_ord2); }
+
+            this->reinit_with_clearTexts();
+            this->pendingRebuild = false;
+        }
+
         //! Compute stuff for a graph
         void initializeVertices()
         {
@@ -1087,6 +1105,8 @@ namespace morph {
         //! Draw markers and lines for data points that are being appended to a graph
         void drawAppendedData()
         {
+            // Datasets may have been added by append() since the graph was last drawn
+            this->coords_lengths.resize (this->graphDataCoords.size(), 0u);
             for (unsigned int dsi = 0; dsi < this->graphDataCoords.size(); ++dsi) {
                 // Start is old end:
                 unsigned int coords_start = this->coords_lengths[dsi];
@@ -68,7 +68,8 @@ namespace morph {
         Triangles,  // Render triangles with a triangle vertex at the centre of each Rect.
         RectInterp, // Render each rect as an actual rectangle made of 4 triangles, interpolating heights with neighbours
         Pixels,     // Render each rect as a rectangular pixel, with all z values the same
-        Columns     // Render each rect as a rectangular column, with sides
+        Columns,    // Render each rect as a rectangular column, with sides
+        Texture     // Render the grid as a single flat quad, with the data in a texture that is colour mapped in the shader
     };
 
 } // namespace morph
@@ -0,0 +1,218 @@
+/*
+ * Domain decomposition for morph::HexGrid and morph::CartGrid.
+ *
+ * A GridPartition divides the elements of a grid into nparts contiguous subdomains by
+ * recursive coordinate bisection, and describes one of those subdomains ('this part') in
+ * the form needed to run a stencil computation on it in a separate process: a local
+ * numbering of the elements that this part owns, the ring of 'halo' elements owned by
+ * other parts which are neighbours of owned elements, local neighbour arrays, and the
+ * lists of elements to send to and receive from each neighbouring part.
+ *
+ * The partition is computed from the full grid, identically on every process, so no
+ * communication is needed to agree on it. GridPartition does not itself depend on MPI; see
+ * morph/MpiHalo.h for the halo exchange.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <vector>
+#include <array>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+
+namespace morph {
+
+    // Forward declarations; client code includes whichever grid header it needs.
+    class HexGrid;
+    class CartGrid;
+
+    struct GridPartition
+    {
+        GridPartition() {}
+
+        //! Construct, partitioning the grid g into nparts and describing part number part
+        template <typename G>
+        GridPartition (const G& g, unsigned int _nparts, unsigned int _part) { this->init (g, _nparts, _part); }
+
+        //! Partition the HexGrid or CartGrid g into nparts and describe part number part
+        template <typename G>
+        void init (const G& g, unsigned int _nparts, unsigned int _part)
+        {
+            if (_nparts == 0 || _part >= _nparts) {
+                throw std::runtime_error ("GridPartition::init: part must be less than nparts");
+            }
+            if (g.num() < _nparts) {
+                throw std::runtime_error ("GridPartition::init: more parts than grid elements");
+            }
+            this->nparts = _nparts;
+            this->part = _part;
+            this->nglobal = g.num();
+
+            // Global neighbour arrays, in the order the grid names them
+            std::vector<const std::vector<int>*> gnb;
+            if constexpr (std::is_same<std::decay_t<G>, morph::HexGrid>::value) {
+                gnb = { &g.d_ne, &g.d_nne, &g.d_nnw, &g.d_nw, &g.d_nsw, &g.d_nse };
+            } else if constexpr (std::is_same<std::decay_t<G>, morph::CartGrid>::value) {
+                gnb = { &g.d_ne, &g.d_nne, &g.d_nn, &g.d_nnw, &g.d_nw, &g.d_nsw, &g.d_ns, &g.d_nse };
+            } else {
+                static_assert (std::is_same<std::decay_t<G>, morph::HexGrid>::value,
+                               "GridPartition can be initialised from a HexGrid or a CartGrid");
+            }
+
+            // Assign an owning part to every element
+            this->owner.assign (this->nglobal, 0);
+            std::vector<unsigned int> all (this->nglobal);
+            std::iota (all.begin(), all.end(), 0U);
+            this->bisect (g.d_x, g.d_y, all, 0U, this->nparts);
+
+            // Owned elements come first in the local numbering, in ascending global order
+            this->global_index.clear();
+            for (unsigned int i = 0; i < this->nglobal; ++i) {
+                if (this->owner[i] == static_cast<int>(this->part)) { this->global_index.push_back (i); }
+            }
+            this->nowned = this->global_index.size();
+
+            // The halo is every element owned elsewhere that neighbours an owned element,
+            // also in ascending global order.
+            std::vector<char> inhalo (this->nglobal, 0);
+            for (unsigned int li = 0; li < this->nowned; ++li) {
+                for (auto nb : gnb) {
+                    int gj = (*nb)[this->global_index[li]];
+                    if (gj >= 0 && this->owner[gj] != static_cast<int>(this->part)) { inhalo[gj] = 1; }
+                }
+            }
+            for (unsigned int i = 0; i < this->nglobal; ++i) {
+                if (inhalo[i]) { this->global_index.push_back (i); }
+            }
+            this->nlocal = this->global_index.size();
+
+            std::map<unsigned int, int> local_of;
+            for (unsigned int li = 0; li < this->nlocal; ++li) { local_of[this->global_index[li]] = static_cast<int>(li); }
+
+            // Local neighbour arrays. Neighbours of halo elements are not needed (and may not
+            // be local), so those entries are all -1.
+            this->neighbours.assign (gnb.size(), std::vector<int>(this->nlocal, -1));
+            this->interior.clear();
+            this->border.clear();
+            for (unsigned int li = 0; li < this->nowned; ++li) {
+                bool onborder = false;
+                for (unsigned int d = 0; d < gnb.size(); ++d) {
+                    int gj = (*gnb[d])[this->global_index[li]];
+                    if (gj < 0) { continue; }
+                    int lj = local_of.at (static_cast<unsigned int>(gj));
+                    this->neighbours[d][li] = lj;
+                    if (lj >= static_cast<int>(this->nowned)) { onborder = true; }
+                }
+                if (onborder) { this->border.push_back (li); } else { this->interior.push_back (li); }
+            }
+
+            // Links to the neighbouring parts. We receive each halo element from its owner.
+            // We send each owned element to every other part in whose halo it lies; that is,
+            // every other part which owns one of its neighbours. Both lists are in ascending
+            // global order, so sender and receiver agree on the order without communication.
+            std::map<int, link> lmap;
+            for (unsigned int li = this->nowned; li < this->nlocal; ++li) {
+                int p = this->owner[this->global_index[li]];
+                lmap[p].part = static_cast<unsigned int>(p);
+                lmap[p].recv.push_back (li);
+            }
+            for (unsigned int li = 0; li < this->nowned; ++li) {
+                std::vector<int> sent_to;
+                for (auto nb : gnb) {
+                    int gj = (*nb)[this->global_index[li]];
+                    if (gj < 0) { continue; }
+                    int p = this->owner[gj];
+                    if (p == static_cast<int>(this->part)) { continue; }
+                    if (std::find (sent_to.begin(), sent_to.end(), p) != sent_to.end()) { continue; }
+                    sent_to.push_back (p);
+                    lmap[p].part = static_cast<unsigned int>(p);
+                    lmap[p].send.push_back (li);
+                }
+            }
+            this->links.clear();
+            for (auto& lp : lmap) { this->links.push_back (lp.second); }
+        }
+
+        //! The number of halo elements
+        unsigned int nhalo() const { return this->nlocal - this->nowned; }
+
+        //! The global indices of the elements owned by part p, in ascending order
+        std::vector<unsigned int> owned_by (unsigned int p) const
+        {
+            std::vector<unsigned int> rtn;
+            for (unsigned int i = 0; i < this->nglobal; ++i) {
+                if (this->owner[i] == static_cast<int>(p)) { rtn.push_back (i); }
+            }
+            return rtn;
+        }
+
+        //! Number of parts in the decomposition
+        unsigned int nparts = 1;
+        //! The part described by this object
+        unsigned int part = 0;
+        //! Number of elements in the whole grid
+        unsigned int nglobal = 0;
+        //! Number of elements owned by this part. Local indices [0, nowned) are owned.
+        unsigned int nowned = 0;
+        //! Number of owned plus halo elements. Local indices [nowned, nlocal) are halo.
+        unsigned int nlocal = 0;
+        //! The part that owns each global element
+        std::vector<int> owner;
+        //! The global index of each local element
+        std::vector<unsigned int> global_index;
+        /*!
+         * Local neighbour arrays, in the order of the grid's own neighbour arrays (ne, nne,
+         * nnw, nw, nsw, nse for a HexGrid; ne, nne, nn, nnw, nw, nsw, ns, nse for a
+         * CartGrid). -1 means no neighbour.
+         */
+        std::vector<std::vector<int>> neighbours;
+        //! Owned elements whose neighbours are all owned; these need no halo data
+        std::vector<unsigned int> interior;
+        //! Owned elements with at least one halo neighbour
+        std::vector<unsigned int> border;
+
+        //! Communication with one neighbouring part
+        struct link
+        {
+            //! The neighbouring part
+            unsigned int part = 0;
+            //! Local indices of owned elements to send to part
+            std::vector<unsigned int> send;
+            //! Local indices of halo elements to receive from part
+            std::vector<unsigned int> recv;
+        };
+        //! One link per neighbouring part, in ascending part order
+        std::vector<link> links;
+
+    private:
+        /*!
+         * Recursive coordinate bisection. Assign parts [p0, p0 + np) to the elements idx,
+         * splitting across the longer extent of their bounding box in proportion to the
+         * number of parts on each side.
+         */
+        void bisect (const std::vector<float>& x, const std::vector<float>& y,
+                     std::vector<unsigned int>& idx, unsigned int p0, unsigned int np)
+        {
+            if (np == 1) {
+                for (auto i : idx) { this->owner[i] = static_cast<int>(p0); }
+                return;
+            }
+            auto xr = std::minmax_element (idx.begin(), idx.end(), [&x](unsigned int a, unsigned int b) { return x[a] < x[b]; });
+            auto yr = std::minmax_element (idx.begin(), idx.end(), [&y](unsigned int a, unsigned int b) { return y[a] < y[b]; });
+            const std::vector<float>& c = (x[*xr.second] - x[*xr.first] >= y[*yr.second] - y[*yr.first]) ? x : y;
+            // Order by coordinate, breaking ties by index so that every process agrees
+            std::sort (idx.begin(), idx.end(), [&c](unsigned int a, unsigned int b) { return c[a] < c[b] || (c[a] == c[b] && a < b); });
+            unsigned int np1 = np / 2;
+            std::size_t n1 = idx.size() * np1 / np;
+            std::vector<unsigned int> lo (idx.begin(), idx.begin() + n1);
+            std::vector<unsigned int> hi (idx.begin() + n1, idx.end());
+            this->bisect (x, y, lo, p0, np1);
+            this->bisect (x, y, hi, p0 + np1, np - np1);
+        }
+    };
+
+} // namespace morph
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 namespace morph {
 
@@ -205,33 +206,53 @@ namespace morph {
         //! Do the computations to initialize the vertices that will represent the HexGrid.
         virtual void initializeVertices()
         {
+            this->setup_datums();
             // Optionally compute an offset to ensure that the cartgrid is centred about the mv_offset.
             if (this->centralize == true) { this->centering_offset = -this->grid->centre().plus_one_dim(); }
+            this->built_n = 0;
+            const GridVisMode mode = this->vis_mode();
 
-            switch (this->gridVisMode) {
-            case GridVisMode::Triangles:
-            {
-                this->initializeVerticesTris();
-                break;
-            }
-            case GridVisMode::Columns:
-            {
-                this->initializeVerticesCols();
-                break;
-            }
-            case GridVisMode::Pixels:
-            {
-                this->initializeVerticesPixels();
-                break;
-            }
-            case GridVisMode::RectInterp:
-            default:
-            {
-                this->initializeVerticesRectsInterpolated();
-                break;
-            }
+            if (this->lod_setup() == false) { return; }
+
+            if (this->lod_level > 0u) {
+                this->initializeVerticesCoarse();
+            } else {
+                switch (mode) {
+                case GridVisMode::Texture:
+                {
+                    this->initializeVerticesTexture();
+                    break;
+                }
+                case GridVisMode::Triangles:
+                {
+                    this->initializeVerticesTris();
+                    break;
+                }
+                case GridVisMode::Columns:
+                {
+                    this->initializeVerticesCols();
+                    break;
+                }
+                case GridVisMode::Pixels:
+                {
+                    this->initializeVerticesPixels();
+                    break;
+                }
+                case GridVisMode::RectInterp:
+                default:
+                {
+                    this->initializeVerticesRectsInterpolated();
+                    break;
+                }
+                }
             }
 
+            // Record the layout of the element vertices for update_data_in_place()
+            this->built_n = static_cast<std::size_t>(this->grid->n);
+            this->built_mode = mode;
+            this->built_centralize = this->centralize;
+            this->built_lod_level = this->lod_level;
+
             if (this->showborder == true) {
                 this->drawBorder();
             }
@@ -248,22 +269,68 @@ namespace morph {
 
         // Initialize vertex buffer objects and vertex array object.
 
+        /*!
+         * Initialize as one flat quad covering the grid, textured with the data. The data
+         * texture has one texel per element, in the grid's own element order, and the quad's
+         * texture coordinates are arranged to match the grid's GridOrder. The colour map is
+         * applied in the shader, which also does the nearest or linear filtering.
+         */
+        void initializeVerticesTexture()
+        {
+            this->idx = 0;
+            this->setupScaling(); // for the colour scale's autoscaling
+
+            const morph::vec<float, 4> ext = this->grid->extents();
+            const morph::vec<float, 2> dx = this->grid->get_dx();
+            const float left = ext[0] - dx[0] / 2.0f + this->centering_offset[0];
+            const float right = ext[1] + dx[0] / 2.0f + this->centering_offset[0];
+            const float bot = ext[2] - dx[1] / 2.0f + this->centering_offset[1];
+            const float top = ext[3] + dx[1] / 2.0f + this->centering_offset[1];
+
+            // Texel (tx, ty) is element tx + ty * tw. (fx, fy) is the fractional position across the quad.
+            const GridOrder order = this->grid->get_order();
+            const bool rowmaj = this->grid->rowmaj();
+            const bool fromtop = order == GridOrder::topleft_to_bottomright || order == GridOrder::topleft_to_bottomright_colmaj;
+            auto texcoord = [rowmaj, fromtop](float fx, float fy) {
+                const float fr = fromtop ? 1.0f - fy : fy; // fractional position along the rows
+                return rowmaj ? VisualDataModel<T, glver>::texcoord_at (fx, fr) : VisualDataModel<T, glver>::texcoord_at (fr, fx);
+            };
+            const GLsizei gw = static_cast<GLsizei>(this->grid->get_w());
+            const GLsizei gh = static_cast<GLsizei>(this->grid->get_h());
+            this->setup_data_texture (rowmaj ? gw : gh, rowmaj ? gh : gw);
+
+            this->vertex_push (left, bot, 0.0f, this->vertexPositions);
+            this->vertex_push (right, bot, 0.0f, this->vertexPositions);
+            this->vertex_push (right, top, 0.0f, this->vertexPositions);
+            this->vertex_push (left, top, 0.0f, this->vertexPositions);
+            this->vertex_push (texcoord (0.0f, 0.0f), this->vertexColors);
+            this->vertex_push (texcoord (1.0f, 0.0f), this->vertexColors);
+            this->vertex_push (texcoord (1.0f, 1.0f), this->vertexColors);
+            this->vertex_push (texcoord (0.0f, 1.0f), this->vertexColors);
+            for (unsigned int i = 0; i < 4; ++i) { this->vertex_push (this->uz, this->vertexNormals); }
+            this->indices.insert (this->indices.end(), { 0u, 1u, 2u, 0u, 2u, 3u });
+            this->idx = 4;
+        }
+
         //! Initialize as a minimal, triangled surface
         void initializeVerticesTris()
         {
             this->idx = 0;
             this->setupScaling();
 
-            for (I ri = 0; ri < this->grid->n; ++ri) {
+            this->build_elements (static_cast<std::size_t>(this->grid->n), [this](morph::mesh_chunk& m, std::size_t i) {
+                const I ri = static_cast<I>(i);
                 std::array<float, 3> clr = this->setColour (ri);
                 this->vertex_push ((*this->grid)[ri][0]+centering_offset[0],
-                                   (*this->grid)[ri][1]+centering_offset[1], dcopy[ri], this->vertexPositions);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            }
+                                   (*this->grid)[ri][1]+centering_offset[1], dcopy[ri], m.positions);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (0.0f, 0.0f, 1.0f, m.normals);
+                ++m.idx;
+            }, 1u, 0u);
 
             // Build indices row by row.
             auto dims = this->grid->get_dims();
+            this->indices.reserve (this->indices.size() + 6u * static_cast<std::size_t>(this->grid->n));
             if (this->grid->get_order() == morph::GridOrder::bottomleft_to_topright) {
                 for (I ri = 0; ri < dims[1]-1; ++ri) {
                     for (I ci = 0; ci < dims[0]-1; ++ci) {
@@ -324,8 +391,59 @@ namespace morph {
             } else {
                 throw std::runtime_error ("morph::GridVisual: Unhandled morph::GridOrder");
             }
+        }
+
+        /*!
+         * Initialize for level of detail lod_level > 0 as a triangled surface (like
+         * initializeVerticesTris) of blocks of 2^lod_level by 2^lod_level elements. Each
+         * block has one vertex at the mean position of its elements, with their mean z and
+         * mean colour.
+         */
+        void initializeVerticesCoarse()
+        {
+            this->idx = 0;
+            this->setupScaling();
+
+            const I s = I{1} << this->lod_level;
+            const morph::vec<I, 2> dims = this->grid->get_dims();
+            const I cw = (dims[0] + s - I{1}) / s;
+            const I ch = (dims[1] + s - I{1}) / s;
+            const std::size_t nbins = static_cast<std::size_t>(cw) * ch;
+
+            this->lod_bins.resize (this->grid->n);
+            std::vector<morph::vec<float, 2>> centroid (nbins, { 0.0f, 0.0f });
+            std::vector<unsigned int> count (nbins, 0u);
+            for (I ri = 0; ri < this->grid->n; ++ri) {
+                const std::size_t b = static_cast<std::size_t>(this->grid->row (ri) / s) * cw + this->grid->col (ri) / s;
+                this->lod_bins[ri] = static_cast<unsigned int>(b);
+                centroid[b] += (*this->grid)[ri].as_float();
+                ++count[b];
+            }
 
-            this->idx += this->grid->n;
+            std::vector<float> z;
+            std::vector<std::array<float, 3>> clr;
+            this->lod_means (nbins, this->dcopy, [this](I ri) { return this->setColour (ri); }, z, clr);
+            for (std::size_t b = 0; b < nbins; ++b) {
+                centroid[b] /= static_cast<float>(count[b]);
+                this->vertex_push (centroid[b][0] + centering_offset[0], centroid[b][1] + centering_offset[1], z[b], this->vertexPositions);
+                this->vertex_push (clr[b], this->vertexColors);
+                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
+            }
+
+            // Block rows run up the screen for bottomleft orders and down it for topleft orders
+            const GridOrder order = this->grid->get_order();
+            const bool fromtop = order == GridOrder::topleft_to_bottomright || order == GridOrder::topleft_to_bottomright_colmaj;
+            for (I br = 0; br + I{1} < ch; ++br) {
+                for (I bc = 0; bc + I{1} < cw; ++bc) {
+                    const GLuint ii = static_cast<GLuint>(br * cw + bc);
+                    if (fromtop) {
+                        this->indices.insert (this->indices.end(), { ii, ii + 1u, ii + cw + 1u, ii, ii + cw + 1u, ii + cw });
+                    } else {
+                        this->indices.insert (this->indices.end(), { ii, ii + cw + 1u, ii + 1u, ii, ii + cw, ii + cw + 1u });
+                    }
+                }
+            }
+            this->idx = static_cast<GLuint>(nbins);
         }
 
         //! Initialize as a rectangle made of 4 triangles for each rect, with z position
@@ -340,21 +458,22 @@ namespace morph {
             this->idx = 0;
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f;
-            float datumNN = 0.0f;
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNS = 0.0f;
-            float datumNSE = 0.0f;
+            this->build_elements (static_cast<std::size_t>(this->grid->n), [&](morph::mesh_chunk& m, std::size_t i) {
+                const I ri = static_cast<I>(i);
 
-            float datum = 0.0f;
+                float datumC = 0.0f;   // datum at the centre
+                float datumNE = 0.0f;  // datum at the hex to the east.
+                float datumNNE = 0.0f;
+                float datumNN = 0.0f;
+                float datumNNW = 0.0f;
+                float datumNW = 0.0f;
+                float datumNSW = 0.0f;
+                float datumNS = 0.0f;
+                float datumNSE = 0.0f;
 
-            morph::vec<float> vtx_0, vtx_1, vtx_2;
+                float datum = 0.0f;
 
-            for (I ri = 0; ri < this->grid->n; ++ri) {
+                morph::vec<float> vtx_0, vtx_1, vtx_2;
 
                 // Use the linear scaled copy of the data, dcopy.
                 datumC  = dcopy[ri];
@@ -372,7 +491,7 @@ namespace morph {
                 std::array<float, 3> clr = this->setColour (ri);
 
                 // First push the 5 positions of the triangle vertices, starting with the centre
-                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, m.positions);
 
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = {{(*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC}};
@@ -390,7 +509,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datum, m.positions);
                 vtx_1 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datum}};
 
                 // SE vertex
@@ -405,7 +524,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datum, m.positions);
                 vtx_2 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datum}};
 
 
@@ -419,7 +538,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datum, m.positions);
 
                 // NW vertex
                 if (this->grid->has_nn(ri) && this->grid->has_nw(ri) && this->grid->has_nnw(ri)) {
@@ -431,7 +550,7 @@ namespace morph {
                 } else {
                     datum = datumC;
                 }
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datum, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datum, m.positions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -441,38 +560,38 @@ namespace morph {
                 morph::vec<float> plane2 = vtx_2 - vtx_0;
                 morph::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
 
                 // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
 
                 // Define indices now to produce the 4 triangles in the pixel
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
 
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
-            }
+                m.idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+            }, 5u, 12u);
         }
 
         void initializeVerticesCols()
@@ -484,13 +603,14 @@ namespace morph {
             this->idx = 0;
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNN = 0.0f;
+            this->build_elements (static_cast<std::size_t>(this->grid->n), [&](morph::mesh_chunk& m, std::size_t i) {
+                const I ri = static_cast<I>(i);
 
-            morph::vec<float> vtx_0, vtx_1, vtx_2, vtx_3, vtx_4;
+                float datumC = 0.0f;   // datum at the centre
+                float datumNE = 0.0f;  // datum at the hex to the east.
+                float datumNN = 0.0f;
 
-            for (I ri = 0; ri < this->grid->n; ++ri) {
+                morph::vec<float> vtx_0, vtx_1, vtx_2, vtx_3, vtx_4;
 
                 // Use the linear scaled copy of the data, dcopy.
                 datumC  = dcopy[ri];
@@ -508,48 +628,48 @@ namespace morph {
                 }
 
                 // First push the 5 positions of the triangle vertices, starting with the centre
-                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, m.positions);
 
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = {{(*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC}};
 
                 // NE vertex
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, m.positions);
                 vtx_1 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC}};
 
                 // SE vertex
-                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, m.positions);
                 vtx_2 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC}};
 
 
                 // SW vertex
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, m.positions);
 
                 // NW vertex
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, m.positions);
 
                 // 4 Neighbour East vertices
                 // NE
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, m.positions);
                 // SE
-                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, m.positions);
 
                 // NE
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNE, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNE, m.positions);
                 vtx_3 = {{(*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNE}};
                 // SE
-                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumNE, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumNE, m.positions);
 
                 // 4 Neighbour North vertices
                 // NW high
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, m.positions);
                 // NE high
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, m.positions);
                 // NW low
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumNN, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumNN, m.positions);
                 vtx_4 = {{(*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumNN}};
                 // NE low
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNN, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNN, m.positions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -570,86 +690,86 @@ namespace morph {
                 if (datumNN > datumC) { vnorm_n = -vnorm_n; }
 
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm_e, m.normals);
+                this->vertex_push (vnorm_e, m.normals);
+                this->vertex_push (vnorm_e, m.normals);
+                this->vertex_push (vnorm_e, m.normals);
+                this->vertex_push (vnorm_n, m.normals);
+                this->vertex_push (vnorm_n, m.normals);
+                this->vertex_push (vnorm_n, m.normals);
+                this->vertex_push (vnorm_n, m.normals);
 
                 // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
 
                 if (this->interpolate_colour_sides == true) {
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr_e, this->vertexColors);
-                    this->vertex_push (clr_e, this->vertexColors);
-
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr_n, this->vertexColors);
-                    this->vertex_push (clr_n, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
+                    this->vertex_push (clr, m.colors);
+                    this->vertex_push (clr_e, m.colors);
+                    this->vertex_push (clr_e, m.colors);
+
+                    this->vertex_push (clr, m.colors);
+                    this->vertex_push (clr, m.colors);
+                    this->vertex_push (clr_n, m.colors);
+                    this->vertex_push (clr_n, m.colors);
                 } else {
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
+                    this->vertex_push (this->clr_east_column, m.colors);
+                    this->vertex_push (this->clr_east_column, m.colors);
+                    this->vertex_push (this->clr_east_column, m.colors);
+                    this->vertex_push (this->clr_east_column, m.colors);
+
+                    this->vertex_push (this->clr_north_column, m.colors);
+                    this->vertex_push (this->clr_north_column, m.colors);
+                    this->vertex_push (this->clr_north_column, m.colors);
+                    this->vertex_push (this->clr_north_column, m.colors);
                 }
 
                 // Define indices now to produce the 4 triangles in the pixel
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
 
                 // East face
-                this->indices.push_back (this->idx + 5);
-                this->indices.push_back (this->idx + 6);
-                this->indices.push_back (this->idx + 7);
+                m.indices.push_back (m.idx + 5);
+                m.indices.push_back (m.idx + 6);
+                m.indices.push_back (m.idx + 7);
 
-                this->indices.push_back (this->idx + 6);
-                this->indices.push_back (this->idx + 8);
-                this->indices.push_back (this->idx + 7);
+                m.indices.push_back (m.idx + 6);
+                m.indices.push_back (m.idx + 8);
+                m.indices.push_back (m.idx + 7);
 
                 // North face
-                this->indices.push_back (this->idx + 9);
-                this->indices.push_back (this->idx + 10);
-                this->indices.push_back (this->idx + 11);
+                m.indices.push_back (m.idx + 9);
+                m.indices.push_back (m.idx + 10);
+                m.indices.push_back (m.idx + 11);
 
-                this->indices.push_back (this->idx + 10);
-                this->indices.push_back (this->idx + 12);
-                this->indices.push_back (this->idx + 11);
+                m.indices.push_back (m.idx + 10);
+                m.indices.push_back (m.idx + 12);
+                m.indices.push_back (m.idx + 11);
 
-                this->idx += 13;
-            }
+                m.idx += 13;
+            }, 13u, 24u);
         }
 
         //! Floating pixels
@@ -662,11 +782,12 @@ namespace morph {
             this->idx = 0;
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
+            this->build_elements (static_cast<std::size_t>(this->grid->n), [&](morph::mesh_chunk& m, std::size_t i) {
+                const I ri = static_cast<I>(i);
 
-            morph::vec<float> vtx_0, vtx_1, vtx_2;
+                float datumC = 0.0f;   // datum at the centre
 
-            for (I ri = 0; ri < this->grid->n; ++ri) {
+                morph::vec<float> vtx_0, vtx_1, vtx_2;
 
                 // Use the linear scaled copy of the data, dcopy.
                 datumC  = dcopy[ri];
@@ -676,25 +797,25 @@ namespace morph {
                 std::array<float, 3> clr = this->setColour (ri);
 
                 // First push the 5 positions of the triangle vertices, starting with the centre
-                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC, m.positions);
 
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = {{(*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC}};
 
                 // NE vertex
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, m.positions);
                 vtx_1 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC}};
 
                 // SE vertex
-                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, m.positions);
                 vtx_2 = {{(*this->grid)[ri][0]+hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC}};
 
 
                 // SW vertex
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]-vy+centering_offset[1], datumC, m.positions);
 
                 // NW vertex
-                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0]-hx+centering_offset[0], (*this->grid)[ri][1]+vy+centering_offset[1], datumC, m.positions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -704,41 +825,45 @@ namespace morph {
                 morph::vec<float> plane2 = vtx_2 - vtx_0;
                 morph::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
 
                 // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
+                this->vertex_push (clr, m.colors);
 
                 // Define indices now to produce the 4 triangles in the pixel
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
 
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
-            }
+                m.idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+            }, 5u, 12u);
         }
 
-        //! How to render the elements. Triangles are faster. RectInterp is chosen more often.
+        /*!
+         * How to render the elements. Triangles are faster. RectInterp is chosen more often.
+         * Texture is fastest to build and to update, and suits large grids viewed flat; it
+         * ignores zScale and applies the colour map in the shader (see data_texture_linear).
+         */
         GridVisMode gridVisMode = GridVisMode::RectInterp;
 
         //! Set this to true to adjust the positions that the GridVisual uses to plot the Grid so
@@ -795,6 +920,8 @@ namespace morph {
         //! An overridable function to set the colour of rect ri
         std::array<float, 3> setColour (I ri)
         {
+            // With gpu_colourmap, the shader applies the colour map
+            if (this->datum_dims > 0u) { return this->datum_at (ri); }
             std::array<float, 3> clr = { 0.0f, 0.0f, 0.0f };
             if (this->cm.numDatums() == 3) {
                 if constexpr (std::is_integral<std::decay_t<T>>::value) {
@@ -812,11 +939,195 @@ namespace morph {
             return clr;
         }
 
+        /*!
+         * Recompute the colours of the elements, and their z positions and normals if dcopy
+         * has changed, in the vertices made by the last initializeVertices(). The border, grid
+         * and origin vertices that follow the elements are left as they are.
+         */
+        bool update_data_in_place() override
+        {
+            if (this->grid == nullptr || this->built_n == 0 || this->built_n != static_cast<std::size_t>(this->grid->n)
+                || this->built_mode != this->vis_mode() || this->built_centralize != this->centralize
+                || this->built_lod_level != this->lod_level) {
+                return false;
+            }
+            if (this->built_lod_level > 0u) {
+                // The blocks of initializeVerticesCoarse(). Their normals do not change.
+                const morph::vec<I, 2> dims = this->grid->get_dims();
+                const I s = I{1} << this->built_lod_level;
+                const std::size_t nbins = static_cast<std::size_t>((dims[0] + s - I{1}) / s) * ((dims[1] + s - I{1}) / s);
+                if (this->lod_bins.size() != this->built_n || this->vertexColors.size() < 3u * nbins) { return false; }
+                this->setupScaling();
+                std::vector<float> z;
+                std::vector<std::array<float, 3>> clr;
+                this->lod_means (nbins, this->dcopy, [this](I ri) { return this->setColour (ri); }, z, clr);
+                for (std::size_t b = 0; b < nbins; ++b) {
+                    this->vertex_set (b, clr[b], this->vertexColors);
+                    this->vertexPositions[3u * b + 2u] = z[b];
+                }
+                this->reinit_vertex_buffers();
+                return true;
+            }
+            if (this->built_mode == GridVisMode::Texture) {
+                // Only the data texture changes; it is re-uploaded on the next render
+                this->setupScaling();
+                this->fill_data_texels();
+                return true;
+            }
+            std::size_t nv = 5; // vertices per element
+            if (this->gridVisMode == GridVisMode::Triangles) {
+                nv = 1;
+            } else if (this->gridVisMode == GridVisMode::Columns) {
+                nv = 13;
+            }
+            if (this->vertexColors.size() < 3u * nv * this->built_n) { return false; }
+
+            // Keep the z values of the existing vertices to compare with the new ones
+            this->dcopy.swap (this->dcopy_prev);
+            this->setupScaling();
+
+            const morph::Grid<I, C>& g = *this->grid;
+            for (I ri = 0; ri < g.n; ++ri) {
+                std::array<float, 3> clr = this->setColour (ri);
+                const std::size_t v0 = nv * ri;
+                for (std::size_t j = 0; j < std::min (nv, std::size_t{5}); ++j) { this->vertex_set (v0 + j, clr, this->vertexColors); }
+                if (this->gridVisMode == GridVisMode::Columns) {
+                    std::array<float, 3> clr_e = this->clr_east_column;
+                    std::array<float, 3> clr_n = this->clr_north_column;
+                    std::array<float, 3> clr_es = this->clr_east_column;
+                    std::array<float, 3> clr_ns = this->clr_north_column;
+                    if (this->interpolate_colour_sides == true) {
+                        clr_e = this->setColour (g.has_ne(ri) ? g.index_ne(ri) : ri);
+                        clr_n = this->setColour (g.has_nn(ri) ? g.index_nn(ri) : ri);
+                        clr_es = clr;
+                        clr_ns = clr;
+                    }
+                    this->vertex_set (v0 + 5, clr_es, this->vertexColors);
+                    this->vertex_set (v0 + 6, clr_es, this->vertexColors);
+                    this->vertex_set (v0 + 7, clr_e, this->vertexColors);
+                    this->vertex_set (v0 + 8, clr_e, this->vertexColors);
+                    this->vertex_set (v0 + 9, clr_ns, this->vertexColors);
+                    this->vertex_set (v0 + 10, clr_ns, this->vertexColors);
+                    this->vertex_set (v0 + 11, clr_n, this->vertexColors);
+                    this->vertex_set (v0 + 12, clr_n, this->vertexColors);
+                }
+            }
+
+            if (this->dcopy == this->dcopy_prev) {
+                this->reinit_colour_buffer();
+                return true;
+            }
+
+            // The x and y of the vertices are unchanged, so vertex vi with new z value:
+            auto vtx = [this](std::size_t vi, float z) {
+                return morph::vec<float>{ this->vertexPositions[3u * vi], this->vertexPositions[3u * vi + 1u], z };
+            };
+            std::array<float, 13> z;
+            for (I ri = 0; ri < g.n; ++ri) {
+                const std::size_t v0 = nv * ri;
+                float datumC = dcopy[ri];
+                switch (this->gridVisMode) {
+                case GridVisMode::Triangles:
+                case GridVisMode::Pixels:
+                {
+                    // Flat elements; the normals do not change
+                    z.fill (datumC);
+                    break;
+                }
+                case GridVisMode::Columns:
+                {
+                    float datumNE = g.has_ne(ri) ? dcopy[g.index_ne(ri)] : datumC;
+                    float datumNN = g.has_nn(ri) ? dcopy[g.index_nn(ri)] : datumC;
+                    z.fill (datumC);
+                    z[7] = z[8] = datumNE;
+                    z[11] = z[12] = datumNN;
+                    morph::vec<float> vtx_1 = vtx (v0 + 1, datumC);
+                    morph::vec<float> vtx_2 = vtx (v0 + 2, datumC);
+                    morph::vec<float> vtx_3 = vtx (v0 + 7, datumNE);
+                    morph::vec<float> vtx_4 = vtx (v0 + 11, datumNN);
+                    morph::vec<float> vnorm_e = (vtx_3 - vtx_2).cross (vtx_1 - vtx_2);
+                    if (datumNE > datumC) { vnorm_e = -vnorm_e; }
+                    morph::vec<float> vnorm_n = (vtx_4 - vtx_3).cross (vtx_1 - vtx_3);
+                    if (datumNN > datumC) { vnorm_n = -vnorm_n; }
+                    for (std::size_t j = 5; j < 9; ++j) { this->vertex_set (v0 + j, vnorm_e, this->vertexNormals); }
+                    for (std::size_t j = 9; j < 13; ++j) { this->vertex_set (v0 + j, vnorm_n, this->vertexNormals); }
+                    break;
+                }
+                case GridVisMode::RectInterp:
+                default:
+                {
+                    // As in initializeVerticesRectsInterpolated()
+                    float datumNE =  g.has_ne(ri)  ? dcopy[g.index_ne(ri)] : datumC;
+                    float datumNN =  g.has_nn(ri)  ? dcopy[g.index_nn(ri)] : datumC;
+                    float datumNW =  g.has_nw(ri)  ? dcopy[g.index_nw(ri)] : datumC;
+                    float datumNS =  g.has_ns(ri)  ? dcopy[g.index_ns(ri)] : datumC;
+                    float datumNNE = g.has_nne(ri) ? dcopy[g.index_nne(ri)] : datumC;
+                    float datumNNW = g.has_nnw(ri) ? dcopy[g.index_nnw(ri)] : datumC;
+                    float datumNSW = g.has_nsw(ri) ? dcopy[g.index_nsw(ri)] : datumC;
+                    float datumNSE = g.has_nse(ri) ? dcopy[g.index_nse(ri)] : datumC;
+                    z[0] = datumC;
+                    z[1] = (g.has_nn(ri) && g.has_ne(ri) && g.has_nne(ri)) ? 0.25f * (datumC + datumNN + datumNE + datumNNE)
+                    : g.has_ne(ri) ? 0.5f * (datumC + datumNE) : g.has_nn(ri) ? 0.5f * (datumC + datumNN) : datumC;
+                    z[2] = (g.has_ns(ri) && g.has_ne(ri) && g.has_nse(ri)) ? 0.25f * (datumC + datumNS + datumNE + datumNSE)
+                    : g.has_ne(ri) ? 0.5f * (datumC + datumNE) : g.has_ns(ri) ? 0.5f * (datumC + datumNS) : datumC;
+                    z[3] = (g.has_ns(ri) && g.has_nw(ri) && g.has_nsw(ri)) ? 0.25f * (datumC + datumNS + datumNW + datumNSW)
+                    : g.has_nw(ri) ? 0.5f * (datumC + datumNW) : g.has_ns(ri) ? 0.5f * (datumC + datumNS) : datumC;
+                    z[4] = (g.has_nn(ri) && g.has_nw(ri) && g.has_nnw(ri)) ? 0.25f * (datumC + datumNN + datumNW + datumNNW)
+                    : g.has_nw(ri) ? 0.5f * (datumC + datumNW) : g.has_nn(ri) ? 0.5f * (datumC + datumNN) : datumC;
+                    morph::vec<float> vtx_0 = vtx (v0, z[0]);
+                    morph::vec<float> vnorm = (vtx (v0 + 2, z[2]) - vtx_0).cross (vtx (v0 + 1, z[1]) - vtx_0);
+                    vnorm.renormalize();
+                    for (std::size_t j = 0; j < 5; ++j) { this->vertex_set (v0 + j, vnorm, this->vertexNormals); }
+                    break;
+                }
+                }
+                for (std::size_t j = 0; j < nv; ++j) { this->vertexPositions[3u * (v0 + j) + 2u] = z[j]; }
+            }
+            this->reinit_vertex_buffers();
+            return true;
+        }
+
         //! The morph::Grid<> to visualize
         const morph::Grid<I, C>* grid;
 
+        //! Texture mode needs the colour map in the shader
+        bool colourmap_in_shader() const override
+        {
+            return this->gpu_colourmap || this->gridVisMode == GridVisMode::Texture;
+        }
+
+        //! The Texture mode draws one quad whatever the view, so needs no levels of detail
+        bool lod_supported() const override { return this->vis_mode() != GridVisMode::Texture; }
+
+        //! The on-screen size of an element, the greatest of those at the centre and corners of the grid
+        float lod_element_pixels() const override
+        {
+            if (this->grid == nullptr || this->grid->n == 0) { return -1.0f; }
+            const morph::vec<float, 4> e = this->grid->extents().as_float();
+            const morph::vec<float, 2> dx = this->grid->get_dx().as_float();
+            const std::array<morph::vec<float>, 5> pts = {
+                morph::vec<float>{ 0.5f * (e[0] + e[1]), 0.5f * (e[2] + e[3]), 0.0f },
+                morph::vec<float>{ e[0], e[2], 0.0f }, morph::vec<float>{ e[1], e[2], 0.0f },
+                morph::vec<float>{ e[0], e[3], 0.0f }, morph::vec<float>{ e[1], e[3], 0.0f }
+            };
+            float px = -1.0f;
+            for (const morph::vec<float>& p : pts) {
+                px = std::max (px, this->projected_size (p + this->centering_offset, dx.max()));
+            }
+            return px;
+        }
+
+        //! The mode in which to build the model. Texture falls back to Pixels for colour maps that the shader can't apply.
+        GridVisMode vis_mode() const
+        {
+            if (this->gridVisMode == GridVisMode::Texture && this->datum_dims == 0u) { return GridVisMode::Pixels; }
+            return this->gridVisMode;
+        }
+
         //! A copy of the scalarData which can be transformed suitably to be the z value of the surface
         std::vector<float> dcopy;
+        //! The previous dcopy, kept by update_data_in_place()
+        std::vector<float> dcopy_prev;
         //! A copy of the scalarData (or first field of vectorData), scaled to be a colour value
         std::vector<float> dcolour;
         std::vector<float> dcolour2;
@@ -827,6 +1138,12 @@ namespace morph {
         // computed x/y/z position for a rectangle, and this means that the rectangle
         // will be centered around mv_offset.
         morph::vec<float, 3> centering_offset = { 0.0f, 0.0f, 0.0f };
+
+        //! The number of elements, mode and centralization of the vertices made by initializeVertices()
+        std::size_t built_n = 0;
+        GridVisMode built_mode = GridVisMode::RectInterp;
+        bool built_centralize = false;
+        unsigned int built_lod_level = 0u;
     };
 
 } // namespace morph
@@ -23,30 +23,33 @@ namespace morph {
             this->reliefScale.do_autoscale = true;
         }
 
-        // Update the VisualModel, changing only colours if that's enough, or doing a
-        // full rebuild if we're displaying relief.
+        // Update the VisualModel after a change to pixeldata. The pixel vertices are
+        // re-coloured in place and, if we're displaying relief, moved in or out along their
+        // normals. A full rebuild is needed only if the order, relief or radius has changed
+        // since the last initializeVertices().
         void update()
         {
-            if (this->relief == true) { this->reinit(); }
-            else { this->updateColours(); }
+            if (this->pixels_built() == false || this->relief != this->built_relief || this->r != this->built_r) {
+                this->reinit();
+                return;
+            }
+            this->recolour_pixels();
+            if (this->relief == true) {
+                this->relief_pixels();
+                this->reinit_vertex_buffers();
+            } else {
+                this->reinit_colour_buffer();
+            }
         }
 
         void updateColours()
         {
-            this->vertexColors.clear(); // could potentially just replace values
-            size_t n_data = this->n_pixels();
-            // Scale data
-            morph::vvec<float> scaled_data (this->pixeldata);
-            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
-            this->colourScale.transform (this->pixeldata, scaled_data);
-
-            // Re-colour
-            for (size_t i = 0u; i < n_data; ++i) {
-                auto c = this->cm.convert (scaled_data[i]);
-                this->vertex_push (c, this->vertexColors);
+            if (this->pixels_built() == false) {
+                this->reinit();
+                return;
             }
-
-            // Lastly, this call copies vertexColors (etc) into the OpenGL memory space
+            this->recolour_pixels();
+            // Lastly, this call copies vertexColors into the OpenGL memory space
             this->reinit_colour_buffer();
         }
 
@@ -333,16 +336,30 @@ namespace morph {
          */
         void healpix_triangles_by_nest()
         {
+            // Vertices for any face spheres come first
+            this->pixel_vtx0 = this->idx;
+            this->built_k = this->k;
+            this->built_relief = this->relief;
+            this->built_r = this->r;
+
             // For colours and relief, we scale data
-            morph::vvec<float> scaled_colours (this->pixeldata);
+            morph::vvec<T> scaled_colours (this->pixeldata);
             if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
             this->colourScale.transform (this->pixeldata, scaled_colours);
+            std::vector<float> pixel_rgb;
+            this->cm.convert_batch (scaled_colours, pixel_rgb);
             morph::vvec<float> scaled_relief (this->pixeldata);
             if (this->reliefScale.do_autoscale == true) { this->reliefScale.reset(); }
             this->reliefScale.transform (this->pixeldata, scaled_relief);
 
-            // The first loop creates all the *vertices* using nest scheme.
+            // The first loop creates all the *vertices* using nest scheme. There is one vertex
+            // per pixel, so the arrays are sized first and the pixels are filled in parallel.
             int64_t n_p = this->n_pixels();
+            const std::size_t nv = 3u * static_cast<std::size_t>(this->pixel_vtx0 + n_p);
+            this->vertexPositions.resize (nv);
+            this->vertexColors.resize (nv);
+            this->vertexNormals.resize (nv);
+#pragma omp parallel for schedule(static)
             for (int64_t p = 0; p < n_p; ++p) {
                 // Convert nest index p to angle for this pixel
                 hp::t_ang ang = hp::nest2ang (this->nside, p);
@@ -354,16 +371,22 @@ namespace morph {
                 if (this->relief == true) { _r += scaled_relief[p]; }
                 morph::vec<float> vpf = (morph::vec<double>({pv.x, pv.y, pv.z}) * _r).as_float();
                 // Make a colour from the pixeldata
-                std::array<float, 3> sc = this->cm.convert (scaled_colours[p]);
-                if (this->show_nest_labels) {
-                    this->addLabel (std::to_string(p), (vpf  * this->r * 1.03f),
-                                    morph::TextFeatures(0.025f, morph::colour::black) );
-                }
-                // Add the vertex info for pixel p
-                this->vertex_push (vpf * this->r, this->vertexPositions);
-                this->vertex_push (sc, this->vertexColors);
+                std::array<float, 3> sc = { pixel_rgb[3 * p], pixel_rgb[3 * p + 1], pixel_rgb[3 * p + 2] };
+                // Set the vertex info for pixel p
+                const std::size_t vi = static_cast<std::size_t>(this->pixel_vtx0 + p);
+                this->vertex_set (vi, vpf * this->r, this->vertexPositions);
+                this->vertex_set (vi, sc, this->vertexColors);
                 vpf.renormalize();
-                this->vertex_push (vpf, this->vertexNormals);
+                this->vertex_set (vi, vpf, this->vertexNormals);
+            }
+
+            // Labels need the GL context (for their glyphs), so they are added afterwards
+            if (this->show_nest_labels) {
+                for (int64_t p = 0; p < n_p; ++p) {
+                    const std::size_t vi = static_cast<std::size_t>(this->pixel_vtx0 + p);
+                    morph::vec<float> vp = { this->vertexPositions[3u * vi], this->vertexPositions[3u * vi + 1u], this->vertexPositions[3u * vi + 2u] };
+                    this->addLabel (std::to_string(p), (vp * 1.03f), morph::TextFeatures(0.025f, morph::colour::black));
+                }
             }
 
             // Now draw indices
@@ -416,6 +439,7 @@ namespace morph {
 
         void initializeVertices()
         {
+            this->built_k = -1;
             if (this->pixeldata.size() != static_cast<uint64_t>(this->n_pixels())) {
                 this->pixeldata.resize (this->n_pixels(), 0.0f);
             }
@@ -481,9 +505,52 @@ namespace morph {
         bool show_face_spheres = false;
 
     private:
+        // True if the vertices include one for each pixel at the current order
+        bool pixels_built()
+        {
+            return this->built_k == this->k && this->k > 0
+            && this->vertexColors.size() >= 3u * static_cast<std::size_t>(this->pixel_vtx0 + this->n_pixels());
+        }
+
+        // Re-colour the pixel vertices in place
+        void recolour_pixels()
+        {
+            int64_t n_p = this->n_pixels();
+            morph::vvec<T> scaled_data (this->pixeldata);
+            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            this->colourScale.transform (this->pixeldata, scaled_data);
+            // The pixel colours are contiguous, so convert them all in one go
+            this->cm.convert_batch (scaled_data.data(), static_cast<std::size_t>(n_p),
+                                    this->vertexColors.data() + 3u * static_cast<std::size_t>(this->pixel_vtx0));
+        }
+
+        // Re-position the pixel vertices in place for the current relief. Each vertex
+        // lies along its normal (the unit vector to the pixel centre) at distance
+        // r * (r + relief), as in healpix_triangles_by_nest().
+        void relief_pixels()
+        {
+            int64_t n_p = this->n_pixels();
+            morph::vvec<float> scaled_relief (this->pixeldata);
+            if (this->reliefScale.do_autoscale == true) { this->reliefScale.reset(); }
+            this->reliefScale.transform (this->pixeldata, scaled_relief);
+#pragma omp parallel for schedule(static)
+            for (int64_t p = 0; p < n_p; ++p) {
+                std::size_t vi = static_cast<std::size_t>(this->pixel_vtx0 + p);
+                morph::vec<float> nrm = { this->vertexNormals[3u * vi], this->vertexNormals[3u * vi + 1u], this->vertexNormals[3u * vi + 2u] };
+                this->vertex_set (vi, nrm * ((this->r + scaled_relief[p]) * this->r), this->vertexPositions);
+            }
+        }
+
         // How many sides for the healpix? This is a choice of the user. Default to 3.
         int64_t k = 3; // k is the 'order'
         int64_t nside = 1 << k;
+
+        // The order, relief and radius of the last healpix_triangles_by_nest() and the index
+        // of its first vertex
+        int64_t built_k = -1;
+        bool built_relief = false;
+        float built_r = 1.0f;
+        int64_t pixel_vtx0 = 0;
     };
 
 } // namespace morph
@@ -10,6 +10,9 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 /*
  * Macros for testing neighbours. The step along for neighbours on the
@@ -52,7 +55,8 @@ namespace morph {
     enum class HexVisMode
     {
         Triangles, // Render triangles with a triangle vertex at the centre of each Hex. Fast (x3.7 cf. HexInterp).
-        HexInterp  // Render each hex as an actual hex made of 6 triangles.
+        HexInterp, // Render each hex as an actual hex made of 6 triangles.
+        HexShared  // As HexInterp, but as an indexed mesh whose hex corners are shared by neighbouring hexes (3 vertices per hex, not 7)
         // Could add HexBars - like the Giant's Causeway in Co. Antrim
     };
 
@@ -159,9 +163,25 @@ namespace morph {
         //! HexGrid.
         void initializeVertices()
         {
+            this->setup_datums();
             this->idx = 0;
+            this->built_nhex = 0;
             this->set_datasize();
             if (this->datasize == 0) { return; }
+            if (this->lod_setup() == false) { return; }
+            // HexShared hexes take the colour of their centre vertex, unless interpolate_colours is set
+            this->flat_faces = this->lod_level == 0u && this->hexVisMode == HexVisMode::HexShared && this->interpolate_colours == false;
+            // With ~3 vertices per hex, most of a HexShared mesh is its indices; halve them where possible
+            this->short_indices = this->lod_level == 0u && this->hexVisMode == HexVisMode::HexShared;
+
+            if (this->lod_level > 0u) {
+                this->initializeVerticesCoarse();
+                this->built_nhex = this->hg->num();
+                this->built_mode = this->hexVisMode;
+                this->built_zoom = this->zoom;
+                this->built_lod_level = this->lod_level;
+                return;
+            }
 
             switch (this->hexVisMode) {
             case HexVisMode::Triangles:
@@ -170,12 +190,21 @@ namespace morph {
                 break;
             }
             case HexVisMode::HexInterp:
+            case HexVisMode::HexShared:
             default:
             {
                 this->initializeVerticesHexesInterpolated();
                 break;
             }
             }
+
+            // Record the layout of the hex vertices for update_data_in_place()
+            if (this->dataCoords == nullptr && (this->hexVisMode == HexVisMode::Triangles || this->showhexes == true)) {
+                this->built_nhex = this->hg->num();
+            }
+            this->built_mode = this->hexVisMode;
+            this->built_zoom = this->zoom;
+            this->built_lod_level = 0u;
         }
 
         // Initialize vertex buffer objects and vertex array object.
@@ -190,27 +219,30 @@ namespace morph {
 
             std::array<float, 3> blkclr = {0,0,0};
 
-            for (unsigned int hi = 0; hi < nhex; ++hi) {
+            this->build_elements (nhex, [this, blkclr](morph::mesh_chunk& m, std::size_t hi) {
                 std::array<float, 3> clr = this->setColour (hi);
                 // If dataCoords has been populated, use these for hex positions, allowing for
                 // mapping of the 2D HexGrid onto a 3D manifold.
                 if (this->dataCoords == nullptr) {
                     this->vertex_push (this->zoom*this->hg->d_x[hi],
                                        this->zoom*this->hg->d_y[hi],
-                                       this->zoom*dcopy[hi], this->vertexPositions);
+                                       this->zoom*dcopy[hi], m.positions);
 
                 } else { // Otherwise use the positions directly in the HexGrid:
-                    this->vertex_push ((*this->dataCoords)[hi], this->vertexPositions);
+                    this->vertex_push ((*this->dataCoords)[hi], m.positions);
                 }
                 if (this->markedHexes.count(hi)) {
-                    this->vertex_push (blkclr, this->vertexColors);
+                    this->vertex_push (blkclr, m.colors);
                 } else {
-                    this->vertex_push (clr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
                 }
-                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            }
+                this->vertex_push (0.0f, 0.0f, 1.0f, m.normals);
+                ++m.idx;
+            }, 1u, 0u);
 
-            // Build indices based on neighbour relations in the HexGrid
+            // Build indices based on neighbour relations in the HexGrid. These refer to
+            // other hexes' vertices, so they are made serially, after the vertices.
+            this->indices.reserve (this->indices.size() + 6u * nhex);
             for (unsigned int hi = 0; hi < nhex; ++hi) {
                 if (HAS_NNE(hi) && HAS_NE(hi)) {
                     //std::cout << "1st triangle " << hi << "->" << NNE(hi) << "->" << NE(hi) << std::endl;
@@ -229,12 +261,114 @@ namespace morph {
             this->idx = nhex;
         }
 
+        /*!
+         * Initialize for level of detail lod_level > 0. The hexes are binned into a coarse
+         * hex lattice whose hex-to-hex distance is 2^lod_level times that of the HexGrid,
+         * and the mesh is a triangled surface (as initializeVerticesTris) with one vertex per
+         * super-hex, at the mean position of its hexes, with their mean z and mean colour.
+         * markedHexes, zerogrid and showoverlap are not drawn at these levels.
+         */
+        void initializeVerticesCoarse()
+        {
+            unsigned int nhex = this->hg->num();
+            this->setupScaling();
+
+            // Axial coordinates (q, r) of the pointy-topped super-hex that contains each hex centre
+            const float lr = this->hg->getd() * static_cast<float>(1u << this->lod_level) * morph::mathconst<float>::one_over_root_3;
+            std::vector<int> qr (2u * nhex);
+            int qmin = std::numeric_limits<int>::max();
+            int qmax = std::numeric_limits<int>::min();
+            int rmin = qmin;
+            int rmax = qmax;
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                const float fq = (morph::mathconst<float>::one_over_root_3 * this->hg->d_x[hi] - this->hg->d_y[hi] / 3.0f) / lr;
+                const float fr = (2.0f * this->hg->d_y[hi] / 3.0f) / lr;
+                const float fs = -fq - fr;
+                float q = std::round (fq);
+                float r = std::round (fr);
+                const float sround = std::round (fs);
+                const float dq = std::abs (q - fq);
+                const float dr = std::abs (r - fr);
+                const float ds = std::abs (sround - fs);
+                if (dq > dr && dq > ds) {
+                    q = -r - sround;
+                } else if (dr > ds) {
+                    r = -q - sround;
+                }
+                qr[2u * hi] = static_cast<int>(q);
+                qr[2u * hi + 1u] = static_cast<int>(r);
+                qmin = std::min (qmin, qr[2u * hi]);
+                qmax = std::max (qmax, qr[2u * hi]);
+                rmin = std::min (rmin, qr[2u * hi + 1u]);
+                rmax = std::max (rmax, qr[2u * hi + 1u]);
+            }
+
+            // Number the occupied super-hexes, looking them up in a dense (q, r) table
+            const int nq = qmax - qmin + 1;
+            const int nr = rmax - rmin + 1;
+            std::vector<int> bin_at (static_cast<std::size_t>(nq) * static_cast<std::size_t>(nr), -1);
+            auto bin = [&bin_at, qmin, qmax, rmin, rmax, nq](int q, int r) {
+                if (q < qmin || q > qmax || r < rmin || r > rmax) { return -1; }
+                return bin_at[static_cast<std::size_t>(r - rmin) * nq + (q - qmin)];
+            };
+            this->lod_bins.resize (nhex);
+            std::vector<morph::vec<float, 2>> centroid;
+            std::vector<unsigned int> count;
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                int& b = bin_at[static_cast<std::size_t>(qr[2u * hi + 1u] - rmin) * nq + (qr[2u * hi] - qmin)];
+                if (b == -1) {
+                    b = static_cast<int>(centroid.size());
+                    centroid.push_back ({ 0.0f, 0.0f });
+                    count.push_back (0u);
+                }
+                this->lod_bins[hi] = static_cast<unsigned int>(b);
+                centroid[b] += morph::vec<float, 2>{ this->hg->d_x[hi], this->hg->d_y[hi] };
+                ++count[b];
+            }
+            const unsigned int nbins = centroid.size();
+
+            std::vector<float> z;
+            std::vector<std::array<float, 3>> clr;
+            this->lod_means (nbins, this->dcopy, [this](unsigned int hi) { return this->setColour (hi); }, z, clr);
+            for (unsigned int b = 0; b < nbins; ++b) {
+                centroid[b] /= static_cast<float>(count[b]);
+                this->vertex_push (this->zoom * centroid[b][0], this->zoom * centroid[b][1], this->zoom * z[b], this->vertexPositions);
+                this->vertex_push (clr[b], this->vertexColors);
+                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
+            }
+
+            // The same two triangles per vertex as initializeVerticesTris: to NNE and NE and to NW and NSW
+            for (int r = rmin; r <= rmax; ++r) {
+                for (int q = qmin; q <= qmax; ++q) {
+                    const int c = bin (q, r);
+                    if (c == -1) { continue; }
+                    const int nne = bin (q, r + 1);
+                    const int ne = bin (q + 1, r);
+                    if (nne != -1 && ne != -1) {
+                        this->indices.push_back (c);
+                        this->indices.push_back (nne);
+                        this->indices.push_back (ne);
+                    }
+                    const int nw = bin (q - 1, r);
+                    const int nsw = bin (q, r - 1);
+                    if (nw != -1 && nsw != -1) {
+                        this->indices.push_back (c);
+                        this->indices.push_back (nw);
+                        this->indices.push_back (nsw);
+                    }
+                }
+            }
+            this->idx = nbins;
+        }
+
         //! Initialize as hexes, with z position of each of the 6
         //! outer edges of the hexes interpolated, but a single colour
         //! for each hex. Gives a smooth surface.
         void initializeVerticesHexesInterpolated()
         {
-            if (this->showhexes == true) {
+            if (this->showhexes == true && this->hexVisMode == HexVisMode::HexShared) {
+                this->computeHexesShared();
+            } else if (this->showhexes == true) {
                 this->computeHexes();
             }
 
@@ -263,32 +397,43 @@ namespace morph {
 
             this->setupScaling();
 
-            // x and y coords on the HexGrid. May be replaced if dataCoords has been set.
-            float _x = 0.0f;
-            float _y = 0.0f;
-            // These Ts are all floats, right?
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f; // etc
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNSE = 0.0f;
-
-            float datum = 0.0f;
-            float third = 0.3333333f;
-            float half = 0.5f;
-            morph::vec<float> vtx_0, vtx_1, vtx_2, vtx_tmp;
-
-            morph::vec<float> coordC = { 0.0f, 0.0f, 0.0f };
-            morph::vec<float> coordNE = coordC;
-            morph::vec<float> coordNNE = coordC;
-            morph::vec<float> coordNNW = coordC;
-            morph::vec<float> coordNW = coordC;
-            morph::vec<float> coordNSW = coordC;
-            morph::vec<float> coordNSE = coordC;
-
+            // Mark any boundary and centre hexes first, as the hexes are built in parallel
             for (unsigned int hi = 0; hi < nhex; ++hi) {
+                if (this->showboundary && (this->hg->vhexen[hi])->boundaryHex() == true) {
+                    this->markHex (hi);
+                }
+                const float hx = this->dataCoords == nullptr ? this->hg->d_x[hi] : (*this->dataCoords)[hi][0];
+                const float hy = this->dataCoords == nullptr ? this->hg->d_y[hi] : (*this->dataCoords)[hi][1];
+                if (this->showcentre && hx == 0.0f && hy == 0.0f) {
+                    this->markHex (hi);
+                }
+            }
+
+            this->build_elements (nhex, [this, sr, vne, lr](morph::mesh_chunk& m, std::size_t hi) {
+                // x and y coords on the HexGrid. May be replaced if dataCoords has been set.
+                float _x = 0.0f;
+                float _y = 0.0f;
+                // These Ts are all floats, right?
+                float datumC = 0.0f;   // datum at the centre
+                float datumNE = 0.0f;  // datum at the hex to the east.
+                float datumNNE = 0.0f; // etc
+                float datumNNW = 0.0f;
+                float datumNW = 0.0f;
+                float datumNSW = 0.0f;
+                float datumNSE = 0.0f;
+
+                float datum = 0.0f;
+                float third = 0.3333333f;
+                float half = 0.5f;
+                morph::vec<float> vtx_0, vtx_1, vtx_2, vtx_tmp;
+
+                morph::vec<float> coordC = { 0.0f, 0.0f, 0.0f };
+                morph::vec<float> coordNE = coordC;
+                morph::vec<float> coordNNE = coordC;
+                morph::vec<float> coordNNW = coordC;
+                morph::vec<float> coordNW = coordC;
+                morph::vec<float> coordNSW = coordC;
+                morph::vec<float> coordNSE = coordC;
 
                 if (this->dataCoords == nullptr) {
                     _x = this->hg->d_x[hi];
@@ -326,19 +471,13 @@ namespace morph {
                 // Use a single colour for each hex, even though hex z positions are
                 // interpolated. Do the _colour_ scaling:
                 std::array<float, 3> clr = this->setColour (hi);
-                if (this->showboundary && (this->hg->vhexen[hi])->boundaryHex() == true) {
-                    this->markHex (hi);
-                }
-                if (this->showcentre && _x == 0.0f && _y == 0.0f) {
-                    this->markHex (hi);
-                }
                 std::array<float, 3> blkclr = {0,0,0};
 
                 // First push the 7 positions of the triangle vertices, starting with the centre
 
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = this->dataCoords == nullptr ? morph::vec<float>{ _x, _y, datumC } : coordC;
-                this->vertex_push (this->zoom * vtx_0, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_0, m.positions);
 
                 // NE vertex
                 if (this->dataCoords == nullptr) {
@@ -370,7 +509,7 @@ namespace morph {
                         vtx_1 = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_1, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_1, m.positions);
 
 
                 // SE vertex
@@ -400,7 +539,7 @@ namespace morph {
                         vtx_2 = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_2, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_2, m.positions);
 
 
                 // S
@@ -430,7 +569,7 @@ namespace morph {
                         vtx_tmp = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_tmp, m.positions);
 
                 // SW
                 if (this->dataCoords == nullptr) {
@@ -459,7 +598,7 @@ namespace morph {
                         vtx_tmp = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_tmp, m.positions);
 
                 // NW
                 if (this->dataCoords == nullptr) {
@@ -488,7 +627,7 @@ namespace morph {
                         vtx_tmp = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_tmp, m.positions);
 
                 // N
                 if (this->dataCoords == nullptr) {
@@ -517,7 +656,7 @@ namespace morph {
                         vtx_tmp = coordC;
                     }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                this->vertex_push (this->zoom * vtx_tmp, m.positions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note
                 // that there is only one 'layer' of vertices; the back of the
@@ -528,75 +667,212 @@ namespace morph {
                 morph::vec<float> plane2 = vtx_2 - vtx_0;
                 morph::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
+                this->vertex_push (vnorm, m.normals);
 
                 // Usually seven vertices with the same colour, but if the hex is
                 // marked, then three of the vertices are given the colour black,
                 // marking the hex out visually.
                 if (std::isnan(dcolour[hi])) {
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
+                    this->vertex_push (blkclr, m.colors);
                 } else {
-                    this->vertex_push (clr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        this->vertex_push (blkclr, m.colors);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        this->vertex_push (clr, m.colors);
                     }
 
-                    this->vertex_push (clr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
 
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        this->vertex_push (blkclr, m.colors);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        this->vertex_push (clr, m.colors);
                     }
-                    this->vertex_push (clr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        this->vertex_push (blkclr, m.colors);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        this->vertex_push (clr, m.colors);
                     }
-                    this->vertex_push (clr, this->vertexColors);
+                    this->vertex_push (clr, m.colors);
                 }
 
                 // Define indices now to produce the 6 triangles in the hex
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                m.indices.push_back (m.idx+1);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+2);
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                m.indices.push_back (m.idx+2);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+3);
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                m.indices.push_back (m.idx+3);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+4);
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+5);
+                m.indices.push_back (m.idx+4);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+5);
 
-                this->indices.push_back (this->idx+5);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+6);
+                m.indices.push_back (m.idx+5);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+6);
 
-                this->indices.push_back (this->idx+6);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                m.indices.push_back (m.idx+6);
+                m.indices.push_back (m.idx);
+                m.indices.push_back (m.idx+1);
 
-                this->idx += 7; // 7 vertices (each of 3 floats for x/y/z), 18 indices.
+                m.idx += 7; // 7 vertices (each of 3 floats for x/y/z), 18 indices.
+            }, 7u, 18u);
+        }
+
+        /*!
+         * Compute the hexes of HexShared mode as an indexed mesh. Each hex has a vertex at
+         * its centre and each hex corner is one vertex, shared by the (up to three) hexes that
+         * meet there, so there are about three vertices per hex rather than computeHexes'
+         * seven. The corners have the same positions as in computeHexes. Each hex is six
+         * triangles that end on its centre vertex, so that with flat_faces each is drawn with
+         * the colour and normal of its hex. markedHexes are not marked in this mode.
+         */
+        void computeHexesShared()
+        {
+            this->setupScaling();
+            const unsigned int nhex = this->hg->num();
+            this->shared_first_vertex = this->idx;
+            this->shared_first_index = this->indices.size();
+
+            // Corner j of a hex (NE, SE, S, SW, NW, N) is also corner nbc[j][k] of the hex nb[j][k]
+            const std::array<std::array<const std::vector<int>*, 2>, 6> nb = {{
+                { &this->hg->d_nne, &this->hg->d_ne }, { &this->hg->d_ne, &this->hg->d_nse },
+                { &this->hg->d_nse, &this->hg->d_nsw }, { &this->hg->d_nsw, &this->hg->d_nw },
+                { &this->hg->d_nw, &this->hg->d_nnw }, { &this->hg->d_nnw, &this->hg->d_nne }
+            }};
+            constexpr std::array<std::array<unsigned int, 2>, 6> nbc = {{ {2, 4}, {3, 5}, {4, 0}, {5, 1}, {0, 2}, {1, 3} }};
+            // Number the corners, hex by hex. Centre vertices come first, then corners.
+            constexpr GLuint none = std::numeric_limits<GLuint>::max();
+            std::vector<GLuint> corner (6u * nhex, none);
+            this->corner_hexes.clear();
+            this->corner_dirn.clear();
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                for (unsigned int j = 0; j < 6; ++j) {
+                    if (corner[6u * hi + j] != none) { continue; }
+                    const GLuint v = this->shared_first_vertex + nhex + static_cast<GLuint>(this->corner_dirn.size());
+                    const int n1 = (*nb[j][0])[hi];
+                    const int n2 = (*nb[j][1])[hi];
+                    corner[6u * hi + j] = v;
+                    if (n1 != -1) { corner[6u * n1 + nbc[j][0]] = v; }
+                    if (n2 != -1) { corner[6u * n2 + nbc[j][1]] = v; }
+                    this->corner_hexes.insert (this->corner_hexes.end(), { static_cast<int>(hi), n1, n2 });
+                    this->corner_dirn.push_back (static_cast<unsigned char>(j));
+                }
+            }
+
+            // The 6 triangles of each hex, in the order of computeHexes, each ending on the centre vertex
+            this->indices.reserve (this->indices.size() + 18u * nhex);
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                for (unsigned int j = 0; j < 6; ++j) {
+                    this->indices.push_back (corner[6u * hi + (j + 1u) % 6u]);
+                    this->indices.push_back (corner[6u * hi + j]);
+                    this->indices.push_back (this->shared_first_vertex + hi);
+                }
+            }
+
+            const std::size_t nv = nhex + this->corner_dirn.size();
+            this->vertexPositions.resize (this->vertexPositions.size() + 3u * nv);
+            this->vertexNormals.resize (this->vertexNormals.size() + 3u * nv);
+            this->vertexColors.resize (this->vertexColors.size() + 3u * nv);
+            this->idx += static_cast<GLuint>(nv);
+            this->set_shared_vertices();
+        }
+
+        //! Set the positions, normals and colours of the vertices made by computeHexesShared() from the data
+        void set_shared_vertices()
+        {
+            const unsigned int nhex = this->hg->num();
+            const std::size_t ncorners = this->corner_dirn.size();
+            const std::size_t c0 = this->shared_first_vertex;
+            const float sr = this->hg->getSR();
+            const float vne = this->hg->getVtoNE();
+            const float lr = this->hg->getLR();
+            const std::array<morph::vec<float, 2>, 6> offs = {{ {sr, vne}, {sr, -vne}, {0.0f, -lr}, {-sr, -vne}, {-sr, vne}, {0.0f, lr} }};
+            auto centre = [this](int hi) {
+                return this->dataCoords == nullptr ? morph::vec<float>{ this->hg->d_x[hi], this->hg->d_y[hi], this->dcopy[hi] }
+                                                   : (*this->dataCoords)[hi];
+            };
+
+            // Corners are at the mean z (or, with dataCoords, the mean position) of their hexes
+            std::vector<morph::vec<float>> cpos (ncorners);
+#pragma omp parallel for schedule(static)
+            for (std::size_t c = 0; c < ncorners; ++c) {
+                morph::vec<float> sum = { 0.0f, 0.0f, 0.0f };
+                float n = 0.0f;
+                for (unsigned int k = 0; k < 3; ++k) {
+                    const int h = this->corner_hexes[3u * c + k];
+                    if (h != -1) { sum += centre (h); n += 1.0f; }
+                }
+                cpos[c] = sum / n;
+                if (this->dataCoords == nullptr) {
+                    const int h0 = this->corner_hexes[3u * c];
+                    const morph::vec<float, 2>& o = offs[this->corner_dirn[c]];
+                    cpos[c] = { this->hg->d_x[h0] + o[0], this->hg->d_y[h0] + o[1], cpos[c][2] };
+                }
+                this->vertex_set (c0 + nhex + c, this->zoom * cpos[c], this->vertexPositions);
+            }
+
+            // Each hex's normal is that of its centre and NE and SE corners, as in computeHexes.
+            // The first triangle of hex hi is (SE corner, NE corner, centre).
+            std::vector<morph::vec<float>> hexnorm (nhex);
+            std::vector<std::array<float, 3>> hexclr (nhex);
+#pragma omp parallel for schedule(static)
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                const morph::vec<float> vtx_0 = centre (hi);
+                const morph::vec<float>& vtx_1 = cpos[this->indices[this->shared_first_index + 18u * hi + 1u] - c0 - nhex];
+                const morph::vec<float>& vtx_2 = cpos[this->indices[this->shared_first_index + 18u * hi] - c0 - nhex];
+                hexnorm[hi] = (vtx_2 - vtx_0).cross (vtx_1 - vtx_0);
+                hexnorm[hi].renormalize();
+                hexclr[hi] = this->setColour (hi);
+                this->vertex_set (c0 + hi, this->zoom * vtx_0, this->vertexPositions);
+                this->vertex_set (c0 + hi, hexnorm[hi], this->vertexNormals);
+                this->vertex_set (c0 + hi, hexclr[hi], this->vertexColors);
+            }
+
+            // Corners take the mean normal and colour of their hexes (seen only with interpolate_colours)
+            std::array<float, 3> blkclr = {0,0,0};
+#pragma omp parallel for schedule(static)
+            for (std::size_t c = 0; c < ncorners; ++c) {
+                morph::vec<float> nsum = { 0.0f, 0.0f, 0.0f };
+                std::array<float, 3> csum = { 0.0f, 0.0f, 0.0f };
+                float nc = 0.0f;
+                for (unsigned int k = 0; k < 3; ++k) {
+                    const int h = this->corner_hexes[3u * c + k];
+                    if (h == -1) { continue; }
+                    nsum += hexnorm[h];
+                    const std::array<float, 3>& hc = hexclr[h];
+                    if (std::isnan (hc[0]) || std::isnan (hc[1]) || std::isnan (hc[2])) { continue; }
+                    for (unsigned int i = 0; i < 3; ++i) { csum[i] += hc[i]; }
+                    nc += 1.0f;
+                }
+                nsum.renormalize();
+                this->vertex_set (c0 + nhex + c, nsum, this->vertexNormals);
+                if (nc > 0.0f) {
+                    for (unsigned int i = 0; i < 3; ++i) { csum[i] /= nc; }
+                    this->vertex_set (c0 + nhex + c, csum, this->vertexColors);
+                } else {
+                    this->vertex_set (c0 + nhex + c, blkclr, this->vertexColors);
+                }
             }
         }
 
@@ -1068,10 +1344,15 @@ namespace morph {
         //! the scale of the hexes in your sim
         HexVisMode hexVisMode = HexVisMode::HexInterp;
 
+        //! In HexShared mode, blend the hex colours across the hexes (to the mean colour at each corner)
+        bool interpolate_colours = false;
+
     protected:
         //! An overridable function to set the colour of hex hi
         virtual std::array<float, 3> setColour (unsigned int hi)
         {
+            // With gpu_colourmap, the shader applies the colour map
+            if (this->datum_dims > 0u) { return this->datum_at (hi); }
             std::array<float, 3> clr = { 0.0f, 0.0f, 0.0f };
             if (this->cm.numDatums() == 3) {
                 //if constexpr (std::is_same<std::decay_t<T>, unsigned char>::value == true) {
@@ -1090,15 +1371,170 @@ namespace morph {
             return clr;
         }
 
+        bool lod_supported() const override { return this->dataCoords == nullptr; }
+
+        //! The on-screen size of a hex, the greatest of those at the centre and corners of the HexGrid's bounding box
+        float lod_element_pixels() const override
+        {
+            unsigned int nhex = this->hg->num();
+            if (nhex == 0) { return -1.0f; }
+            if (this->lod_extents_n != nhex) {
+                auto [xmin, xmax] = std::minmax_element (this->hg->d_x.begin(), this->hg->d_x.end());
+                auto [ymin, ymax] = std::minmax_element (this->hg->d_y.begin(), this->hg->d_y.end());
+                this->lod_extents = { *xmin, *xmax, *ymin, *ymax };
+                this->lod_extents_n = nhex;
+            }
+            const morph::vec<float, 4> e = this->lod_extents * this->zoom;
+            const std::array<morph::vec<float>, 5> pts = {
+                morph::vec<float>{ 0.5f * (e[0] + e[1]), 0.5f * (e[2] + e[3]), 0.0f },
+                morph::vec<float>{ e[0], e[2], 0.0f }, morph::vec<float>{ e[1], e[2], 0.0f },
+                morph::vec<float>{ e[0], e[3], 0.0f }, morph::vec<float>{ e[1], e[3], 0.0f }
+            };
+            float px = -1.0f;
+            for (const morph::vec<float>& p : pts) { px = std::max (px, this->projected_size (p, this->zoom * this->hg->getd())); }
+            return px;
+        }
+
+        /*!
+         * Recompute the colours of the hexes, and their z positions and normals if dcopy has
+         * changed, in the vertices made by the last initializeVertices(). Any vertices after
+         * the hexes (showoverlap, zerogrid) are left as they are.
+         */
+        bool update_data_in_place() override
+        {
+            unsigned int nhex = this->hg->num();
+            this->set_datasize();
+            if (nhex == 0 || this->built_nhex != nhex || this->datasize != nhex || this->dataCoords != nullptr
+                || this->built_mode != this->hexVisMode || this->built_zoom != this->zoom
+                || this->built_lod_level != this->lod_level) {
+                return false;
+            }
+            if (this->built_lod_level > 0u) {
+                // The super-hexes of initializeVerticesCoarse(). Their normals do not change.
+                const unsigned int nbins = this->idx;
+                if (this->lod_bins.size() != nhex || this->vertexColors.size() < 3u * nbins) { return false; }
+                this->setupScaling();
+                std::vector<float> z;
+                std::vector<std::array<float, 3>> clr;
+                this->lod_means (nbins, this->dcopy, [this](unsigned int hi) { return this->setColour (hi); }, z, clr);
+                for (unsigned int b = 0; b < nbins; ++b) {
+                    this->vertex_set (b, clr[b], this->vertexColors);
+                    this->vertexPositions[3u * b + 2u] = this->zoom * z[b];
+                }
+                this->reinit_vertex_buffers();
+                return true;
+            }
+            if (this->hexVisMode == HexVisMode::HexShared) {
+                if (this->vertexColors.size() < 3u * (this->shared_first_vertex + nhex + this->corner_dirn.size())) { return false; }
+                this->setupScaling();
+                this->set_shared_vertices();
+                this->reinit_vertex_buffers();
+                return true;
+            }
+            const bool tris = (this->hexVisMode == HexVisMode::Triangles);
+            const std::size_t nv = tris ? 1u : 7u; // vertices per hex
+            if (this->vertexColors.size() < 3u * nv * nhex) { return false; }
+
+            // Keep the z values of the existing vertices to compare with the new ones
+            this->dcopy.swap (this->dcopy_prev);
+            this->setupScaling();
+
+            std::array<float, 3> blkclr = {0,0,0};
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                std::array<float, 3> clr = this->setColour (hi);
+                const std::size_t v0 = nv * hi;
+                if (tris) {
+                    this->vertex_set (v0, (this->markedHexes.count(hi) ? blkclr : clr), this->vertexColors);
+                } else if (std::isnan(dcolour[hi])) {
+                    this->vertex_set (v0, clr, this->vertexColors);
+                    for (std::size_t j = 1; j < 7; ++j) { this->vertex_set (v0 + j, blkclr, this->vertexColors); }
+                } else {
+                    const std::array<float, 3>& oddclr = this->markedHexes.count(hi) ? blkclr : clr;
+                    for (std::size_t j = 0; j < 7; ++j) { this->vertex_set (v0 + j, (j % 2 ? oddclr : clr), this->vertexColors); }
+                }
+            }
+
+            if (std::equal (this->dcopy.begin(), this->dcopy.end(), this->dcopy_prev.begin(), this->dcopy_prev.end())) {
+                this->reinit_colour_buffer();
+                return true;
+            }
+
+            if (tris) {
+                for (unsigned int hi = 0; hi < nhex; ++hi) { this->vertexPositions[3u * hi + 2u] = this->zoom * dcopy[hi]; }
+            } else {
+                // As in computeHexes. The neighbours whose data is averaged for each of the
+                // outer vertices NE, SE, S, SW, NW and N.
+                const std::array<const std::vector<int>*, 12> nb = {
+                    &this->hg->d_nne, &this->hg->d_ne,  &this->hg->d_ne,  &this->hg->d_nse,
+                    &this->hg->d_nse, &this->hg->d_nsw, &this->hg->d_nw,  &this->hg->d_nsw,
+                    &this->hg->d_nnw, &this->hg->d_nw,  &this->hg->d_nnw, &this->hg->d_nne
+                };
+                float sr = this->hg->getSR();
+                float vne = this->hg->getVtoNE();
+                float third = 0.3333333f;
+                float half = 0.5f;
+                std::array<float, 7> z;
+                for (unsigned int hi = 0; hi < nhex; ++hi) {
+                    float datumC = dcopy[hi];
+                    z[0] = datumC;
+                    for (unsigned int j = 0; j < 6; ++j) {
+                        int n1 = (*nb[2*j])[hi];
+                        int n2 = (*nb[2*j+1])[hi];
+                        if (n1 != -1 && n2 != -1) {
+                            z[j+1] = third * (datumC + dcopy[n1] + dcopy[n2]);
+                        } else if (n1 != -1) {
+                            z[j+1] = half * (datumC + dcopy[n1]);
+                        } else if (n2 != -1) {
+                            z[j+1] = half * (datumC + dcopy[n2]);
+                        } else {
+                            z[j+1] = datumC;
+                        }
+                    }
+                    const std::size_t v0 = 7u * hi;
+                    for (std::size_t j = 0; j < 7; ++j) { this->vertexPositions[3u * (v0 + j) + 2u] = this->zoom * z[j]; }
+
+                    float _x = this->hg->d_x[hi];
+                    float _y = this->hg->d_y[hi];
+                    morph::vec<float> vtx_0 = { _x, _y, z[0] };
+                    morph::vec<float> vtx_1 = { (_x+sr), (_y+vne), z[1] };
+                    morph::vec<float> vtx_2 = { (_x+sr), (_y-vne), z[2] };
+                    morph::vec<float> vnorm = (vtx_2 - vtx_0).cross (vtx_1 - vtx_0);
+                    vnorm.renormalize();
+                    for (std::size_t j = 0; j < 7; ++j) { this->vertex_set (v0 + j, vnorm, this->vertexNormals); }
+                }
+            }
+            this->reinit_vertex_buffers();
+            return true;
+        }
+
         //! The HexGrid to visualize
         const HexGrid* hg;
 
         //! A copy of the scalarData which can be transformed suitably to be the z value of the surface
         morph::vvec<float> dcopy;
+        //! The previous dcopy, kept by update_data_in_place()
+        morph::vvec<float> dcopy_prev;
         //! A copy of the scalarData, scaled to be a colour value
         std::vector<float> dcolour;
         std::vector<float> dcolour2;
         std::vector<float> dcolour3;
+
+        //! The number of hexes, mode and zoom of the vertices made by initializeVertices()
+        unsigned int built_nhex = 0;
+        HexVisMode built_mode = HexVisMode::HexInterp;
+        float built_zoom = 1.0f;
+        unsigned int built_lod_level = 0u;
+
+        //! The (up to) three hexes that meet at each HexShared corner vertex (-1 for none). The first made the corner.
+        std::vector<int> corner_hexes;
+        //! Which corner (NE, SE, S, SW, NW, N) of its first hex each HexShared corner vertex is
+        std::vector<unsigned char> corner_dirn;
+        //! The first vertex and index of the HexShared hexes
+        GLuint shared_first_vertex = 0u;
+        std::size_t shared_first_index = 0u;
+        //! The extents {xmin, xmax, ymin, ymax} of the hex centres, for lod_element_pixels(), and the number of hexes they are for
+        mutable morph::vec<float, 4> lod_extents = { 0.0f, 0.0f, 0.0f, 0.0f };
+        mutable unsigned int lod_extents_n = 0u;
     };
 
     //! Extended HexGridVisual class for plotting with individual red, green and blue
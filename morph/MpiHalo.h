@@ -0,0 +1,139 @@
+/*
+ * Halo exchange and gather over MPI for fields distributed according to a
+ * morph::GridPartition.
+ *
+ * Each process holds only the nowned values that its part owns. The values of the halo
+ * elements (owned by neighbouring parts) are exchanged into a separate halo buffer, so that
+ * the field vectors themselves never change size or need to be written during a stencil
+ * computation. The exchange is split into start() and finish() so that computation on the
+ * interior elements can overlap the communication:
+ *
+ * \code
+ *   halo.start (F);
+ *   for (auto i : part.interior) { ... }   // only reads F
+ *   halo.finish();
+ *   for (auto i : part.border) { ... }     // reads F and halo.values
+ * \endcode
+ *
+ * Values are sent as bytes, so T may be any trivially copyable type (including the 16 bit
+ * types in morph/halffloat.h).
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <mpi.h>
+#include <morph/GridPartition.h>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+namespace morph {
+
+    template <typename T>
+    class MpiHalo
+    {
+        static_assert (std::is_trivially_copyable<T>::value, "MpiHalo<T> requires a trivially copyable T");
+
+    public:
+        MpiHalo() {}
+        MpiHalo (const GridPartition& _gp, MPI_Comm _comm = MPI_COMM_WORLD) { this->init (_gp, _comm); }
+
+        void init (const GridPartition& _gp, MPI_Comm _comm = MPI_COMM_WORLD)
+        {
+            this->gp = &_gp;
+            this->comm = _comm;
+            this->values.assign (this->gp->nhalo(), T{});
+            this->sendbufs.resize (this->gp->links.size());
+            this->recvbufs.resize (this->gp->links.size());
+            for (unsigned int l = 0; l < this->gp->links.size(); ++l) {
+                this->sendbufs[l].resize (this->gp->links[l].send.size());
+                this->recvbufs[l].resize (this->gp->links[l].recv.size());
+            }
+            this->requests.resize (2 * this->gp->links.size());
+        }
+
+        /*!
+         * Begin the exchange of the halo values of the field F, which holds the nowned
+         * values owned by this part. F may be read, but must not be changed, until finish().
+         */
+        void start (const std::vector<T>& F)
+        {
+            if (this->gp == nullptr) { throw std::runtime_error ("MpiHalo::start: not initialised"); }
+            if (F.size() < this->gp->nowned) { throw std::runtime_error ("MpiHalo::start: field is smaller than the owned part"); }
+            const unsigned int nl = this->gp->links.size();
+            for (unsigned int l = 0; l < nl; ++l) {
+                const GridPartition::link& lk = this->gp->links[l];
+                MPI_Irecv (this->recvbufs[l].data(), static_cast<int>(lk.recv.size() * sizeof(T)), MPI_BYTE,
+                           static_cast<int>(lk.part), tag, this->comm, &this->requests[l]);
+            }
+            for (unsigned int l = 0; l < nl; ++l) {
+                const GridPartition::link& lk = this->gp->links[l];
+                for (unsigned int k = 0; k < lk.send.size(); ++k) { this->sendbufs[l][k] = F[lk.send[k]]; }
+                MPI_Isend (this->sendbufs[l].data(), static_cast<int>(lk.send.size() * sizeof(T)), MPI_BYTE,
+                           static_cast<int>(lk.part), tag, this->comm, &this->requests[nl + l]);
+            }
+        }
+
+        //! Complete the exchange begun by start(). The halo values are then in values.
+        void finish()
+        {
+            MPI_Waitall (static_cast<int>(this->requests.size()), this->requests.data(), MPI_STATUSES_IGNORE);
+            const unsigned int nowned = this->gp->nowned;
+            for (unsigned int l = 0; l < this->gp->links.size(); ++l) {
+                const GridPartition::link& lk = this->gp->links[l];
+                for (unsigned int k = 0; k < lk.recv.size(); ++k) { this->values[lk.recv[k] - nowned] = this->recvbufs[l][k]; }
+            }
+        }
+
+        //! Exchange without overlap
+        void exchange (const std::vector<T>& F) { this->start (F); this->finish(); }
+
+        //! The value of local element li of F, which may be owned or halo
+        T at (const std::vector<T>& F, unsigned int li) const
+        {
+            return li < this->gp->nowned ? F[li] : this->values[li - this->gp->nowned];
+        }
+
+        /*!
+         * Gather the owned values of F from every part into global, in global element order,
+         * on the process with rank root. global is unchanged on other processes.
+         */
+        void gather (const std::vector<T>& F, std::vector<T>& global, int root = 0) const
+        {
+            int rank = 0;
+            int nranks = 1;
+            MPI_Comm_rank (this->comm, &rank);
+            MPI_Comm_size (this->comm, &nranks);
+            if (static_cast<unsigned int>(nranks) != this->gp->nparts) {
+                throw std::runtime_error ("MpiHalo::gather: communicator size differs from the number of parts");
+            }
+            std::vector<int> counts (nranks, 0);
+            std::vector<int> displs (nranks, 0);
+            for (unsigned int i = 0; i < this->gp->nglobal; ++i) { counts[this->gp->owner[i]] += static_cast<int>(sizeof(T)); }
+            for (int p = 1; p < nranks; ++p) { displs[p] = displs[p-1] + counts[p-1]; }
+            std::vector<T> bypart;
+            if (rank == root) { bypart.resize (this->gp->nglobal); }
+            MPI_Gatherv (F.data(), static_cast<int>(this->gp->nowned * sizeof(T)), MPI_BYTE,
+                         bypart.data(), counts.data(), displs.data(), MPI_BYTE, root, this->comm);
+            if (rank != root) { return; }
+            // bypart holds each part's values, each in ascending global order
+            global.resize (this->gp->nglobal);
+            std::vector<std::size_t> cursor (nranks, 0);
+            for (int p = 0; p < nranks; ++p) { cursor[p] = static_cast<std::size_t>(displs[p]) / sizeof(T); }
+            for (unsigned int i = 0; i < this->gp->nglobal; ++i) { global[i] = bypart[cursor[this->gp->owner[i]]++]; }
+        }
+
+        //! The values of the halo elements, indexed by local index - nowned
+        std::vector<T> values;
+
+    private:
+        static constexpr int tag = 0x4a10;
+        const GridPartition* gp = nullptr;
+        MPI_Comm comm = MPI_COMM_WORLD;
+        std::vector<std::vector<T>> sendbufs;
+        std::vector<std::vector<T>> recvbufs;
+        std::vector<MPI_Request> requests;
+    };
+
+} // namespace morph
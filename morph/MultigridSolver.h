@@ -0,0 +1,555 @@
+/*
+ * A geometric multigrid solver for the Poisson and (screened) Helmholtz equations on the
+ * domains described by morph::HexGrid and morph::CartGrid.
+ *
+ * The solver is constructed from a grid, from which it builds a hierarchy of successively
+ * coarser levels by 2x decimation of the integer lattice coordinates of the elements. The
+ * elements with even lattice coordinates form the next level; on both the Cartesian and the
+ * hexagonal lattice these have the same connectivity as the finest level, with twice the
+ * spacing. Corrections are prolongated by linear interpolation along the lattice, restricted
+ * with the transpose of the interpolation (full weighting) and the coarse level operators are
+ * formed by the Galerkin product, which gives the correct treatment of irregular boundaries
+ * on all levels. Boundary flags are carried down to the coarse levels.
+ *
+ * Smoothing is by multi-colour Gauss-Seidel (red-black on the finest level of a CartGrid;
+ * three colours are needed on a HexGrid), with each colour processed by an OpenMP parallel
+ * loop. V-cycles are repeated until the residual norm has fallen by the requested tolerance.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <vector>
+#include <array>
+#include <map>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <morph/Hex.h>
+#include <morph/Rect.h>
+
+namespace morph {
+
+    // Forward declarations; client code includes whichever grid header it needs.
+    class HexGrid;
+    class CartGrid;
+
+    //! The boundary condition that the MultigridSolver applies at the edge of the domain
+    enum class MultigridBoundary
+    {
+        //! Zero flux. A missing neighbour takes the value of the element (the 'ghost' scheme
+        //! used in RD_Base::compute_laplace).
+        Neumann,
+        //! Elements flagged as boundary elements hold their value fixed at whatever was
+        //! passed in the initial guess.
+        Dirichlet
+    };
+
+    /*!
+     * Solve
+     *
+     *   del^2 u - lambda u = f
+     *
+     * on a HexGrid or CartGrid domain. With lambda = 0 this is the Poisson equation; with
+     * lambda > 0 it is the screened Poisson (or modified Helmholtz) equation that arises from
+     * implicit diffusion steps and quasi-steady chemoattractant fields.
+     *
+     * Usage:
+     *
+     * \code
+     *   morph::MultigridSolver<float> mg (*hg); // hg is a morph::HexGrid
+     *   mg.lambda = 1.0f;
+     *   mg.solve (u, f); // u holds the initial guess on entry and the solution on exit
+     * \endcode
+     */
+    template <typename Flt>
+    class MultigridSolver
+    {
+        static_assert (std::is_floating_point<Flt>::value, "MultigridSolver requires a floating point type");
+
+        //! Flag used internally to mark elements whose value is held fixed
+        static constexpr unsigned int fixed_flag = 0x1;
+        //! Flag used internally to mark boundary elements (on every level)
+        static constexpr unsigned int boundary_flag = 0x2;
+
+        //! A sparse matrix in compressed row format
+        struct csr
+        {
+            std::vector<unsigned int> row_start;
+            std::vector<unsigned int> col;
+            std::vector<Flt> val;
+        };
+
+        /*!
+         * One level of the multigrid hierarchy. Level 0 is the grid itself. The operator on
+         * each level is stored as A = lambda I - del^2, which is symmetric and positive
+         * (semi-)definite. Its diagonal is held in diag and the negated off-diagonal terms in
+         * offd.
+         */
+        struct level
+        {
+            //! Number of elements in this level
+            unsigned int n = 0;
+            //! Diagonal of the operator
+            std::vector<Flt> diag;
+            //! Negated off-diagonal terms of the operator (positive for a Laplacian)
+            csr offd;
+            //! Integer lattice coordinates, used to form the next, coarser level
+            std::vector<int> ci;
+            std::vector<int> cj;
+            //! Boundary and fixed flags for each element
+            std::vector<unsigned int> flags;
+            //! Elements listed by colour. Elements in one colour are not coupled to each other.
+            std::vector<std::vector<unsigned int>> colours;
+            //! Interpolation from the next coarser level to this one (one row per element here)
+            csr prolong;
+            //! Restriction from this level to the next coarser level (one row per coarse element)
+            csr restrict;
+            //! Solution (or correction), right hand side and residual
+            std::vector<Flt> u;
+            std::vector<Flt> b;
+            std::vector<Flt> r;
+        };
+
+    public:
+        //! The Helmholtz term. lambda >= 0 for a well posed problem.
+        Flt lambda = Flt{0};
+        //! Gauss-Seidel sweeps before coarse grid correction
+        unsigned int pre_sweeps = 2;
+        //! Gauss-Seidel sweeps after coarse grid correction
+        unsigned int post_sweeps = 2;
+        //! Gauss-Seidel sweeps used to solve the coarsest level
+        unsigned int coarsest_sweeps = 100;
+        //! Maximum number of V-cycles in a call to solve()
+        unsigned int max_cycles = 100;
+        //! Stop when the L2 norm of the residual has fallen by this factor (relative to the
+        //! norm of the right hand side)
+        Flt tolerance = std::is_same<Flt, float>::value ? Flt{1e-5} : Flt{1e-10};
+        //! Stop coarsening when a level has this many elements or fewer
+        unsigned int min_coarse_size = 32;
+        //! Never build more than this many levels
+        unsigned int max_levels = 16;
+
+        //! The number of V-cycles carried out in the last call to solve()
+        unsigned int cycles = 0;
+        //! The relative residual norm after the last call to solve()
+        Flt residual_norm = Flt{0};
+
+        MultigridSolver() {}
+
+        //! Construct, building the level hierarchy from the HexGrid or CartGrid \a g.
+        template <typename G>
+        MultigridSolver (const G& g, MultigridBoundary bc = MultigridBoundary::Neumann) { this->init (g, bc); }
+
+        //! Build the level hierarchy from the HexGrid or CartGrid \a g.
+        template <typename G>
+        void init (const G& g, MultigridBoundary bc = MultigridBoundary::Neumann)
+        {
+            this->boundary = bc;
+            this->levels.clear();
+            this->levels.resize (1);
+            level& l0 = this->levels[0];
+            l0.n = g.num();
+
+            if constexpr (std::is_same<std::decay_t<G>, morph::HexGrid>::value) {
+                // Hex Laplacian is 2/(3d^2) times the sum of the differences to the six neighbours
+                const Flt hw = Flt{2} / (Flt{3} * g.getd() * g.getd());
+                const std::array<const std::vector<int>*, 6> nb = { &g.d_ne, &g.d_nne, &g.d_nnw, &g.d_nw, &g.d_nsw, &g.d_nse };
+                this->init_finest (nb, { hw, hw, hw, hw, hw, hw });
+                l0.ci = g.d_ri;
+                l0.cj = g.d_gi;
+                this->hexlattice = true;
+                for (unsigned int i = 0; i < l0.n; ++i) {
+                    if (g.d_flags[i] & HEX_IS_BOUNDARY) { l0.flags[i] |= boundary_flag; }
+                }
+            } else if constexpr (std::is_same<std::decay_t<G>, morph::CartGrid>::value) {
+                const Flt wx = Flt{1} / (g.getd() * g.getd());
+                const Flt wy = Flt{1} / (g.getv() * g.getv());
+                const std::array<const std::vector<int>*, 4> nb = { &g.d_ne, &g.d_nn, &g.d_nw, &g.d_ns };
+                this->init_finest (nb, { wx, wy, wx, wy });
+                l0.ci = g.d_xi;
+                l0.cj = g.d_yi;
+                this->hexlattice = false;
+                for (unsigned int i = 0; i < l0.n; ++i) {
+                    if (g.d_flags[i] & RECT_IS_BOUNDARY) { l0.flags[i] |= boundary_flag; }
+                }
+            } else {
+                static_assert (std::is_same<std::decay_t<G>, morph::HexGrid>::value,
+                               "MultigridSolver can be initialised from a HexGrid or a CartGrid");
+            }
+            this->build_hierarchy();
+        }
+
+        //! Change the boundary condition. This rebuilds the coarse levels.
+        void set_boundary (MultigridBoundary bc)
+        {
+            this->boundary = bc;
+            if (!this->levels.empty()) { this->build_hierarchy(); }
+        }
+        MultigridBoundary get_boundary() const { return this->boundary; }
+
+        //! The number of levels in the hierarchy (including the finest level)
+        unsigned int num_levels() const { return this->levels.size(); }
+
+        //! The number of elements in level \a l
+        unsigned int level_size (unsigned int l) const { return this->levels.at(l).n; }
+
+        /*!
+         * Solve del^2 u - lambda u = f. On entry \a u is the initial guess (and, for Dirichlet
+         * conditions, it contains the boundary values). On exit it contains the solution.
+         *
+         * \return the number of V-cycles carried out.
+         */
+        unsigned int solve (std::vector<Flt>& u, const std::vector<Flt>& f)
+        {
+            if (this->levels.empty()) { throw std::runtime_error ("MultigridSolver: call init() before solve()"); }
+            // Coarse operators depend on lambda, so rebuild them if lambda has changed
+            if (this->lambda != this->built_lambda) { this->build_hierarchy(); }
+
+            level& l0 = this->levels[0];
+            if (u.size() != l0.n || f.size() != l0.n) {
+                throw std::runtime_error ("MultigridSolver: u and f must have the same size as the grid");
+            }
+            l0.u = u;
+            for (unsigned int i = 0; i < l0.n; ++i) { l0.b[i] = -f[i]; }
+            // A singular problem requires a right hand side with zero mean
+            if (this->singular()) { remove_mean (l0.b); }
+
+            Flt bnorm = norm (l0.b);
+            if (bnorm == Flt{0}) { bnorm = Flt{1}; }
+
+            this->residual (l0);
+            this->residual_norm = norm (l0.r) / bnorm;
+            this->cycles = 0;
+            while (this->residual_norm > this->tolerance && this->cycles < this->max_cycles) {
+                this->vcycle (0);
+                if (this->singular()) { remove_mean (l0.u); }
+                this->residual (l0);
+                this->residual_norm = norm (l0.r) / bnorm;
+                ++this->cycles;
+            }
+            u = l0.u;
+            return this->cycles;
+        }
+
+        //! Compute lapu = del^2 u - lambda u with the finest level discretisation
+        void apply (const std::vector<Flt>& u, std::vector<Flt>& lapu)
+        {
+            if (this->lambda != this->built_lambda) { this->build_hierarchy(); }
+            const level& l0 = this->levels.at(0);
+            lapu.resize (l0.n);
+#pragma omp parallel for schedule(static)
+            for (unsigned int i = 0; i < l0.n; ++i) {
+                lapu[i] = row_sum (l0.offd, u, i) - l0.diag[i] * u[i];
+            }
+        }
+
+    protected:
+        //! The level hierarchy
+        std::vector<level> levels;
+        //! The sum of the Laplacian weights for each element of the finest level
+        std::vector<Flt> wsum0;
+        //! The value of lambda for which the hierarchy was built
+        Flt built_lambda = Flt{0};
+        //! True for a HexGrid, false for a CartGrid
+        bool hexlattice = true;
+        //! Boundary condition
+        MultigridBoundary boundary = MultigridBoundary::Neumann;
+
+        //! Is the problem singular (pure Neumann Poisson)?
+        bool singular() const
+        {
+            return this->lambda == Flt{0} && this->boundary == MultigridBoundary::Neumann;
+        }
+
+        //! Set up the finest level operator from the grid's d_ neighbour vectors
+        template <size_t N>
+        void init_finest (const std::array<const std::vector<int>*, N>& nb, const std::array<Flt, N>& wts)
+        {
+            level& l = this->levels[0];
+            l.flags.assign (l.n, 0u);
+            this->wsum0.assign (l.n, Flt{0});
+            l.offd.row_start.assign (1, 0u);
+            for (unsigned int i = 0; i < l.n; ++i) {
+                for (unsigned int k = 0; k < N; ++k) {
+                    int j = (*nb[k])[i];
+                    if (j < 0) { continue; } // Missing neighbour contributes nothing: zero flux
+                    l.offd.col.push_back (static_cast<unsigned int>(j));
+                    l.offd.val.push_back (wts[k]);
+                    this->wsum0[i] += wts[k];
+                }
+                l.offd.row_start.push_back (l.offd.col.size());
+            }
+            this->colour_level (l);
+            l.u.assign (l.n, Flt{0});
+            l.b.assign (l.n, Flt{0});
+            l.r.assign (l.n, Flt{0});
+        }
+
+        //! Floor division by 2 which works for negative lattice coordinates
+        static int half (int c) { return (c >= 0) ? c / 2 : -((1 - c) / 2); }
+
+        //! Set the finest level diagonal and fixed flags, then coarsen to build the other levels
+        void build_hierarchy()
+        {
+            this->levels.resize (1);
+            level& l0 = this->levels[0];
+            l0.diag.resize (l0.n);
+            for (unsigned int i = 0; i < l0.n; ++i) {
+                l0.diag[i] = this->wsum0[i] + this->lambda;
+                l0.flags[i] &= ~fixed_flag;
+                if (this->boundary == MultigridBoundary::Dirichlet && (l0.flags[i] & boundary_flag)) {
+                    l0.flags[i] |= fixed_flag;
+                }
+            }
+            this->built_lambda = this->lambda;
+
+            // Coarsen until small enough, or until coarsening no longer reduces the size
+            while (this->levels.back().n > this->min_coarse_size && this->levels.size() < this->max_levels) {
+                level coarse = this->coarsen (this->levels.back());
+                if (coarse.n == 0 || coarse.n == this->levels.back().n) { break; }
+                this->levels.push_back (std::move (coarse));
+            }
+        }
+
+        /*!
+         * Create the next coarser level from \a fine. The fine elements with even lattice
+         * coordinates become the coarse elements; each of the other free fine elements is
+         * interpolated from the coarse elements that lie either side of it on the lattice.
+         * Fixed elements are carried down, too, so that interpolation next to a Dirichlet
+         * boundary tends to zero on every level.
+         */
+        level coarsen (level& fine)
+        {
+            level coarse;
+            std::map<std::pair<int, int>, unsigned int> lookup;
+            std::vector<int> injected (fine.n, -1);
+            unsigned int nfree = 0;
+            for (unsigned int i = 0; i < fine.n; ++i) {
+                if ((fine.ci[i] & 1) || (fine.cj[i] & 1)) { continue; }
+                lookup[{ fine.ci[i], fine.cj[i] }] = coarse.n;
+                injected[i] = static_cast<int>(coarse.n++);
+                coarse.ci.push_back (half (fine.ci[i]));
+                coarse.cj.push_back (half (fine.cj[i]));
+                // Boundary and fixed flags are carried down with the element
+                coarse.flags.push_back (fine.flags[i]);
+                if (!(fine.flags[i] & fixed_flag)) { ++nfree; }
+            }
+            if (nfree == 0) { coarse.n = 0; }
+            if (coarse.n == 0) { return coarse; }
+
+            // Build the interpolation operator, one row per fine element
+            csr& P = fine.prolong;
+            P = csr{};
+            P.row_start.assign (1, 0u);
+            std::vector<std::pair<int, int>> partners;
+            for (unsigned int i = 0; i < fine.n; ++i) {
+                if (!(fine.flags[i] & fixed_flag)) {
+                    if (injected[i] >= 0) {
+                        P.col.push_back (static_cast<unsigned int>(injected[i]));
+                        P.val.push_back (Flt{1});
+                    } else {
+                        const int a = fine.ci[i];
+                        const int b = fine.cj[i];
+                        if ((a & 1) && !(b & 1)) {
+                            partners = { { a - 1, b }, { a + 1, b } };
+                        } else if (!(a & 1) && (b & 1)) {
+                            partners = { { a, b - 1 }, { a, b + 1 } };
+                        } else if (this->hexlattice) {
+                            // The midpoint of a coarse edge in the (-1,1) direction
+                            partners = { { a + 1, b - 1 }, { a - 1, b + 1 } };
+                        } else {
+                            // The centre of a coarse square
+                            partners = { { a - 1, b - 1 }, { a + 1, b - 1 }, { a - 1, b + 1 }, { a + 1, b + 1 } };
+                        }
+                        // Equal weights. Partners outside the domain are left out (so that the
+                        // correction is extrapolated as a constant) but fixed partners count,
+                        // contributing a zero correction.
+                        unsigned int found = 0;
+                        unsigned int nfp = 0;
+                        for (auto& pt : partners) {
+                            auto li = lookup.find (pt);
+                            if (li == lookup.end()) { continue; }
+                            ++found;
+                            if (coarse.flags[li->second] & fixed_flag) { continue; }
+                            P.col.push_back (li->second);
+                            ++nfp;
+                        }
+                        for (unsigned int k = 0; k < nfp; ++k) { P.val.push_back (Flt{1} / static_cast<Flt>(found)); }
+                    }
+                }
+                P.row_start.push_back (P.col.size());
+            }
+
+            // Restriction is the transpose of the interpolation, scaled for full weighting
+            csr& R = fine.restrict;
+            R = csr{};
+            R.row_start.assign (coarse.n + 1, 0u);
+            for (unsigned int k = 0; k < P.col.size(); ++k) { ++R.row_start[P.col[k] + 1]; }
+            for (unsigned int c = 0; c < coarse.n; ++c) { R.row_start[c + 1] += R.row_start[c]; }
+            R.col.resize (P.col.size());
+            R.val.resize (P.col.size());
+            std::vector<unsigned int> fill (R.row_start.begin(), R.row_start.end() - 1);
+            for (unsigned int i = 0; i < fine.n; ++i) {
+                for (unsigned int k = P.row_start[i]; k < P.row_start[i + 1]; ++k) {
+                    unsigned int f = fill[P.col[k]]++;
+                    R.col[f] = i;
+                    R.val[f] = P.val[k] / Flt{4};
+                }
+            }
+
+            // Galerkin coarse operator: A_c = R A P
+            std::vector<std::map<unsigned int, Flt>> ac (coarse.n);
+            for (unsigned int i = 0; i < fine.n; ++i) {
+                for (unsigned int kI = P.row_start[i]; kI < P.row_start[i + 1]; ++kI) {
+                    const unsigned int I = P.col[kI];
+                    const Flt rI = P.val[kI] / Flt{4};
+                    for (unsigned int kJ = P.row_start[i]; kJ < P.row_start[i + 1]; ++kJ) {
+                        ac[I][P.col[kJ]] += rI * fine.diag[i] * P.val[kJ];
+                    }
+                    for (unsigned int kj = fine.offd.row_start[i]; kj < fine.offd.row_start[i + 1]; ++kj) {
+                        const unsigned int j = fine.offd.col[kj];
+                        for (unsigned int kJ = P.row_start[j]; kJ < P.row_start[j + 1]; ++kJ) {
+                            ac[I][P.col[kJ]] -= rI * fine.offd.val[kj] * P.val[kJ];
+                        }
+                    }
+                }
+            }
+            coarse.diag.assign (coarse.n, Flt{0});
+            coarse.offd.row_start.assign (1, 0u);
+            for (unsigned int c = 0; c < coarse.n; ++c) {
+                // Fixed elements have no row in the coarse operator
+                if (coarse.flags[c] & fixed_flag) { coarse.diag[c] = Flt{1}; }
+                for (auto& e : ac[c]) {
+                    if (e.first == c) {
+                        coarse.diag[c] = e.second;
+                    } else if (e.second != Flt{0}) {
+                        coarse.offd.col.push_back (e.first);
+                        coarse.offd.val.push_back (-e.second);
+                    }
+                }
+                coarse.offd.row_start.push_back (coarse.offd.col.size());
+            }
+
+            this->colour_level (coarse);
+            coarse.u.assign (coarse.n, Flt{0});
+            coarse.b.assign (coarse.n, Flt{0});
+            coarse.r.assign (coarse.n, Flt{0});
+            return coarse;
+        }
+
+        //! Greedy colouring of a level so that no two coupled elements share a colour.
+        void colour_level (level& l)
+        {
+            std::vector<int> col (l.n, -1);
+            std::vector<bool> used;
+            int ncol = 0;
+            for (unsigned int i = 0; i < l.n; ++i) {
+                used.assign (ncol + 1, false);
+                for (unsigned int k = l.offd.row_start[i]; k < l.offd.row_start[i + 1]; ++k) {
+                    int cj = col[l.offd.col[k]];
+                    if (cj >= 0) { used[cj] = true; }
+                }
+                int c = 0;
+                while (used[c]) { ++c; }
+                col[i] = c;
+                ncol = std::max (ncol, c + 1);
+            }
+            l.colours.assign (ncol, std::vector<unsigned int>{});
+            for (unsigned int i = 0; i < l.n; ++i) { l.colours[col[i]].push_back (i); }
+        }
+
+        //! Row i of the sparse matrix m multiplied by u
+        static Flt row_sum (const csr& m, const std::vector<Flt>& u, unsigned int i)
+        {
+            Flt s = Flt{0};
+            for (unsigned int k = m.row_start[i]; k < m.row_start[i + 1]; ++k) { s += m.val[k] * u[m.col[k]]; }
+            return s;
+        }
+
+        //! Multi-colour Gauss-Seidel sweeps on level l
+        void smooth (level& l, unsigned int sweeps)
+        {
+            for (unsigned int s = 0; s < sweeps; ++s) {
+                for (auto& colour : l.colours) {
+                    const unsigned int nc = colour.size();
+#pragma omp parallel for schedule(static)
+                    for (unsigned int ii = 0; ii < nc; ++ii) {
+                        unsigned int i = colour[ii];
+                        if ((l.flags[i] & fixed_flag) || l.diag[i] == Flt{0}) { continue; }
+                        l.u[i] = (l.b[i] + row_sum (l.offd, l.u, i)) / l.diag[i];
+                    }
+                }
+            }
+        }
+
+        //! r = b - A u on level l
+        void residual (level& l)
+        {
+#pragma omp parallel for schedule(static)
+            for (unsigned int i = 0; i < l.n; ++i) {
+                if (l.flags[i] & fixed_flag) { l.r[i] = Flt{0}; continue; }
+                l.r[i] = l.b[i] + row_sum (l.offd, l.u, i) - l.diag[i] * l.u[i];
+            }
+        }
+
+        //! L2 norm of x
+        static Flt norm (const std::vector<Flt>& x)
+        {
+            const unsigned int n = x.size();
+            Flt s = Flt{0};
+#pragma omp parallel for reduction(+:s) schedule(static)
+            for (unsigned int i = 0; i < n; ++i) { s += x[i] * x[i]; }
+            return std::sqrt (s);
+        }
+
+        //! Subtract the mean of x
+        static void remove_mean (std::vector<Flt>& x)
+        {
+            const unsigned int n = x.size();
+            if (n == 0) { return; }
+            Flt s = Flt{0};
+#pragma omp parallel for reduction(+:s) schedule(static)
+            for (unsigned int i = 0; i < n; ++i) { s += x[i]; }
+            const Flt mean = s / static_cast<Flt>(n);
+#pragma omp parallel for schedule(static)
+            for (unsigned int i = 0; i < n; ++i) { x[i] -= mean; }
+        }
+
+        //! One V-cycle starting at level li
+        void vcycle (unsigned int li)
+        {
+            level& l = this->levels[li];
+            if (li + 1 == this->levels.size()) {
+                this->smooth (l, this->coarsest_sweeps);
+                if (this->singular()) { remove_mean (l.u); }
+                return;
+            }
+
+            this->smooth (l, this->pre_sweeps);
+            this->residual (l);
+
+            // Restrict the residual to the coarse level
+            level& c = this->levels[li + 1];
+            const csr& R = l.restrict;
+#pragma omp parallel for schedule(static)
+            for (unsigned int ci = 0; ci < c.n; ++ci) {
+                c.b[ci] = row_sum (R, l.r, ci);
+                c.u[ci] = Flt{0};
+            }
+            if (this->singular()) { remove_mean (c.b); }
+
+            this->vcycle (li + 1);
+
+            // Interpolate the correction back to this level
+            const csr& P = l.prolong;
+#pragma omp parallel for schedule(static)
+            for (unsigned int i = 0; i < l.n; ++i) { l.u[i] += row_sum (P, c.u, i); }
+
+            this->smooth (l, this->post_sweeps);
+        }
+    };
+
+} // namespace morph
@@ -6,6 +6,7 @@
 #include <morph/Scale.h>
 #include <morph/vec.h>
 #include <morph/vvec.h>
+#include <morph/Quaternion.h>
 #include <morph/colour.h>
 #include <morph/graphstyles.h>
 #include <iostream>
@@ -13,6 +14,7 @@
 #include <array>
 #include <algorithm>
 #include <functional>
+#include <cmath>
 
 namespace morph {
 
@@ -44,6 +46,72 @@ namespace morph {
 
         //! Do the computations to initialize the vertices that will represent the Quivers.
         void initializeVertices()
+        {
+            if (this->instanced == true) {
+                // A unit arrow from the origin along z, and a unit sphere
+                const std::size_t i0 = this->indices.size();
+                const float shaft = 1.0f - this->quiver_arrowhead_prop;
+                this->computeTube (morph::vec<float>{ 0.0f, 0.0f, 0.0f }, morph::vec<float>{ 0.0f, 0.0f, shaft },
+                                   morph::colour::white, morph::colour::white, 1.0f, shapesides);
+                this->computeCone (morph::vec<float>{ 0.0f, 0.0f, shaft }, morph::vec<float>{ 0.0f, 0.0f, 1.0f },
+                                   0.0f, morph::colour::white, 2.0f, shapesides);
+                this->make_glyph (i0);
+                const std::size_t i1 = this->indices.size();
+                this->computeSphere (morph::vec<float>{ 0.0f, 0.0f, 0.0f }, morph::colour::white, 1.0f, shapesides/2, shapesides);
+                this->make_glyph (i1);
+            }
+            this->computeQuivers();
+        }
+
+        /*!
+         * Set true (before finalize()) to draw the quivers as instances of one arrow mesh
+         * (and the coordinate and zero vector spheres as instances of one sphere mesh). Each
+         * quiver then costs 13 floats for the arrow (and 13 for its sphere), and
+         * reinit_data() re-uploads only these instances.
+         */
+        bool instanced = false;
+
+    protected:
+        //! The instanced glyphs
+        static constexpr unsigned int arrow_glyph = 0u;
+        static constexpr unsigned int sphere_glyph = 1u;
+
+        //! Recompute the quiver instances from the current coordinates and vectors
+        bool update_data_in_place() override
+        {
+            if (this->instanced == false || this->glyphs.size() != 2u) { return false; }
+            for (auto& g : this->glyphs) { g.instances.clear(); }
+            this->computeQuivers();
+            this->reinit_instance_buffer();
+            return true;
+        }
+
+        //! A sphere at so, or, with instancing, an instance of the sphere glyph
+        void sphere (const vec<float>& so, const std::array<float, 3>& clr, float r, int rings, int segments)
+        {
+            if (this->instanced == true) {
+                this->instance_push (sphere_glyph, so, vec<float>{ r, r, r }, morph::Quaternion<float>{}, clr);
+            } else {
+                this->computeSphere (so, clr, r, rings, segments);
+            }
+        }
+
+        //! The rotation that takes the z axis to the direction of the non-zero vector v
+        static morph::Quaternion<float> rotation_from_z (const vec<float>& v)
+        {
+            const vec<float> uz = { 0.0f, 0.0f, 1.0f };
+            const vec<float> vn = v / v.length();
+            vec<float> axis = uz.cross (vn);
+            const float c = std::min (std::max (uz.dot (vn), -1.0f), 1.0f);
+            if (axis.length() < 1e-6f) {
+                // Parallel or anti-parallel to z
+                axis = { 1.0f, 0.0f, 0.0f };
+            }
+            return morph::Quaternion<float> (axis, std::acos (c));
+        }
+
+        //! Compute the quivers (or their instances)
+        void computeQuivers()
         {
             unsigned int ncoords = this->dataCoords->size();
             unsigned int nquiv = this->vectorData->size();
@@ -114,7 +182,7 @@ namespace morph {
                 float len = nrmlzedlengths[i] * this->quiver_length_gain;
                 if ((std::isnan(dlengths[i]) || dlengths[i] == Flt{0}) && this->show_zero_vectors) {
                     // NaNs denote zero vectors when the lengths have been log scaled.
-                    this->computeSphere (coords_i, zero_vector_colour, this->zero_vector_marker_size * quiver_thickness_gain);
+                    this->sphere (coords_i, zero_vector_colour, this->zero_vector_marker_size * quiver_thickness_gain, 10, 12);
                     continue;
                 }
 
@@ -142,6 +210,17 @@ namespace morph {
 
                 // The right way to draw an arrow.
                 vec<float> arrow_line = end - start;
+                if (this->instanced == true) {
+                    const float alen = arrow_line.length();
+                    if (alen > 0.0f && std::isfinite (alen)) {
+                        this->instance_push (arrow_glyph, start, vec<float>{ quiv_thick, quiv_thick, alen },
+                                             rotation_from_z (arrow_line), clr);
+                    }
+                    if (this->show_coordinate_sphere == true) {
+                        this->sphere (coords_i, clr, quiv_thick*2.0f, shapesides/2, shapesides);
+                    }
+                    continue;
+                }
                 vec<float> cone_start = arrow_line.shorten (len*quiver_arrowhead_prop);
                 cone_start += start;
                 this->computeTube (start, cone_start, clr, clr, quiv_thick, shapesides);
@@ -157,6 +236,7 @@ namespace morph {
             }
         }
 
+    public:
         //! An enumerated type to say whether we draw quivers with coord at mid point; start point or end point
         QuiverGoes qgoes = QuiverGoes::FromCoord;
 
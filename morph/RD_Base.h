@@ -2,10 +2,13 @@
 
 #include <morph/tools.h>
 #include <morph/Random.h>
+#include <morph/RandPhilox.h>
+#include <morph/halffloat.h>
 #include <morph/ReadCurves.h>
 #define HEXGRID_COMPILE_LOAD_AND_SAVE 1
 #include <morph/HexGrid.h>
 #include <morph/HdfData.h>
+#include <morph/RD_Profiler.h>
 #include <memory>
 #include <sstream>
 #include <vector>
@@ -179,6 +182,26 @@ namespace morph {
         float ellipse_a = 1.0f;
         float ellipse_b = 1.0f;
 
+        /*!
+         * Per-phase timings for the model. Timers are only compiled in if MORPH_RD_PROFILE
+         * is defined; see morph/RD_Profiler.h.
+         */
+        RD_Profiler profiler;
+
+        /*!
+         * Counter-based generator for noiseify_vector_variable. Its output depends only on
+         * noise.seed, the step count and the hex index, so set noise.seed for runs which are
+         * reproducible whatever the number of threads.
+         */
+        RandPhilox<Flt> noise;
+
+        /*!
+         * The step for which noise was last generated and the number of noise streams used
+         * in that step.
+         */
+        unsigned int noise_step = 0;
+        unsigned int noise_stream = 0;
+
         /*!
          * Simple constructor; no arguments.
          */
@@ -258,10 +281,13 @@ namespace morph {
         }
 
         /*!
-         * Resize/zero a variable that'll be nhex elements long
+         * Resize/zero a variable that'll be nhex elements long. The storage type S defaults to
+         * Flt, but may be a lower precision type such as morph::bfloat16 or morph::float16.
          */
-        void resize_vector_variable (std::vector<Flt>& v) { v.resize (this->nhex, Flt{0}); }
-        void zero_vector_variable (std::vector<Flt>& v) { v.assign (this->nhex, Flt{0}); }
+        template <typename S = Flt>
+        void resize_vector_variable (std::vector<S>& v) { v.resize (this->nhex, S{0}); }
+        template <typename S = Flt>
+        void zero_vector_variable (std::vector<S>& v) { v.assign (this->nhex, S{0}); }
 
         /*!
          * Resize/zero a parameter that'll be N elements long
@@ -351,19 +377,41 @@ namespace morph {
          * I apply a sigmoid to the boundary hexes, so that the noise
          * drops away towards the edge of the domain.
          */
-        void noiseify_vector_variable (std::vector<Flt>& v, Flt offset, Flt gain)
+        template <typename S = Flt>
+        void noiseify_vector_variable (std::vector<S>& v, Flt offset, Flt gain)
         {
-            morph::RandUniform<Flt> rng;
-            for (auto h : this->hg->hexen) {
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::noise, this->nhex * sizeof(S));
+            // Each call within one step uses a new stream, so that variables noised in the
+            // same step get independent noise.
+            if (this->stepCount != this->noise_step) {
+                this->noise_step = this->stepCount;
+                this->noise_stream = 0;
+            }
+            std::vector<Flt> vf;
+            Flt* vp = nullptr;
+            if constexpr (std::is_same<S, Flt>::value) {
+                vp = v.data();
+            } else {
+                vf.resize (this->nhex);
+                vp = vf.data();
+            }
+            this->noise.fill_uniform (vp, this->nhex, this->stepCount, this->noise_stream++, offset, offset + gain);
+
+            // hexen is a list, so copy distances to boundary out for the parallel loop
+            std::vector<float> dist (this->nhex, -1.0f);
+            for (const auto& h : this->hg->hexen) { dist[h.vi] = h.distToBoundary; }
+
+#pragma omp parallel for schedule(static)
+            for (unsigned int hi = 0; hi < this->nhex; ++hi) {
                 // boundarySigmoid. Jumps sharply (100, larger is
                 // sharper) over length scale 0.05 to 1. So if
                 // distance from boundary > 0.05, noise has normal
                 // value. Close to boundary, noise is less.
-                v[h.vi] = rng.get() * gain + offset;
-                if (h.distToBoundary > -0.5) { // It's possible that distToBoundary is set to -1.0
-                    Flt bSig = Flt{1} / ( Flt{1} + std::exp (-Flt{100}*(h.distToBoundary-this->boundaryFalloffDist)) );
-                    v[h.vi] = v[h.vi] * bSig;
+                if (dist[hi] > -0.5f) { // It's possible that distToBoundary is set to -1.0
+                    Flt bSig = Flt{1} / ( Flt{1} + std::exp (-Flt{100}*(dist[hi]-this->boundaryFalloffDist)) );
+                    vp[hi] = vp[hi] * bSig;
                 }
+                if constexpr (!std::is_same<S, Flt>::value) { v[hi] = static_cast<S>(vp[hi]); }
             }
         }
 
@@ -599,6 +647,10 @@ namespace morph {
          */
         void spacegrad2D (std::vector<Flt>& f, std::array<std::vector<Flt>, 2>& gradf) {
 
+            // Compulsory traffic: read f and six neighbour indices, write two components
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::spacegrad,
+                                    this->nhex * (3 * sizeof(Flt) + 6 * sizeof(int)));
+
             // Note - East is positive x; North is positive y.
 #pragma omp parallel for schedule(static)
             for (unsigned int hi=0; hi<this->nhex; ++hi) {
@@ -639,7 +691,23 @@ namespace morph {
         /*!
          * Compute laplacian of scalar field F, with result placed in lapF.
          */
-        virtual void compute_laplace (const std::vector<Flt>& F, std::vector<Flt>& lapF) {
+        virtual void compute_laplace (const std::vector<Flt>& F, std::vector<Flt>& lapF)
+        {
+            this->compute_laplace_stored (F, lapF);
+        }
+
+        /*!
+         * Compute laplacian of scalar field F, stored with type S, with result placed in
+         * lapF. S may have less precision than Flt (morph::bfloat16, morph::float16 or float
+         * with Flt double). Each value is converted to Flt as it is loaded, so the stencil
+         * sum accumulates at Flt precision, while the memory traffic is that of S.
+         */
+        template <typename S>
+        void compute_laplace_stored (const std::vector<S>& F, std::vector<Flt>& lapF)
+        {
+            // Compulsory traffic: read F and six neighbour indices, write lapF
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::laplace,
+                                    this->nhex * (sizeof(S) + sizeof(Flt) + 6 * sizeof(int)));
 
             Flt norm  = Flt{2} / (Flt{3.0} * this->d * this->d);
 
@@ -647,39 +715,17 @@ namespace morph {
             for (unsigned int hi=0; hi<this->nhex; ++hi) {
 
                 // 1. The D Del^2 term
-
-                // Compute the sum around the neighbours
-                Flt thesum = Flt{-6} * F[hi];
-                if (HAS_NE(hi)) {
-                    thesum += F[NE(hi)];
-                } else {
-                    thesum += F[hi]; // A ghost neighbour-east with same value as Hex_0
-                }
-                if (HAS_NNE(hi)) {
-                    thesum += F[NNE(hi)];
-                } else {
-                    thesum += F[hi];
-                }
-                if (HAS_NNW(hi)) {
-                    thesum += F[NNW(hi)];
-                } else {
-                    thesum += F[hi];
-                }
-                if (HAS_NW(hi)) {
-                    thesum += F[NW(hi)];
-                } else {
-                    thesum += F[hi];
-                }
-                if (HAS_NSW(hi)) {
-                    thesum += F[NSW(hi)];
-                } else {
-                    thesum += F[hi];
-                }
-                if (HAS_NSE(hi)) {
-                    thesum += F[NSE(hi)];
-                } else {
-                    thesum += F[hi];
-                }
+                const Flt Fhi = static_cast<Flt>(F[hi]);
+
+                // Compute the sum around the neighbours. Missing neighbours are ghosts with
+                // the same value as Hex_0
+                Flt thesum = Flt{-6} * Fhi;
+                thesum += HAS_NE(hi) ? static_cast<Flt>(F[NE(hi)]) : Fhi;
+                thesum += HAS_NNE(hi) ? static_cast<Flt>(F[NNE(hi)]) : Fhi;
+                thesum += HAS_NNW(hi) ? static_cast<Flt>(F[NNW(hi)]) : Fhi;
+                thesum += HAS_NW(hi) ? static_cast<Flt>(F[NW(hi)]) : Fhi;
+                thesum += HAS_NSW(hi) ? static_cast<Flt>(F[NSW(hi)]) : Fhi;
+                thesum += HAS_NSE(hi) ? static_cast<Flt>(F[NSE(hi)]) : Fhi;
 
                 lapF[hi] = norm * thesum;
             }
@@ -0,0 +1,247 @@
+/*
+ * Run an RD_Base reaction-diffusion model across several MPI processes.
+ *
+ * RD_Mpi<Flt> is a drop-in base class for RD_Base<Flt> models. Each process builds the
+ * full HexGrid, as before, and a GridPartition divides it into one subdomain per
+ * process. this->nhex then becomes the number of hexes that this process owns, so that
+ * the model's state vectors (sized with resize_vector_variable) and its reaction loops
+ * cover only the owned hexes. compute_laplace and spacegrad2D are overridden to exchange
+ * the halo of their input field with the neighbouring processes, overlapping the exchange
+ * with the computation on interior hexes.
+ *
+ * A model converts from serial to distributed by deriving from RD_Mpi in place of RD_Base,
+ * calling MPI_Init/MPI_Finalize in main() and writing its save() with save_fields():
+ *
+ * \code
+ *   void save()
+ *   {
+ *       this->save_fields (this->logpath + "/dat_" + std::to_string (this->stepCount),
+ *                          { {"/A", &this->A}, {"/B", &this->B} });
+ *   }
+ * \endcode
+ *
+ * Run with, for example, mpirun -np 4 ./model params.json
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <mpi.h>
+#include <morph/RD_Base.h>
+#include <morph/GridPartition.h>
+#include <morph/MpiHalo.h>
+#include <morph/HdfData.h>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cmath>
+#include <type_traits>
+
+namespace morph {
+
+    //! How RD_Mpi::save_fields writes out distributed fields
+    enum class RD_MpiOutput
+    {
+        //! Gather to rank 0, which writes one file in global hex order
+        Gathered,
+        //! Each rank writes its owned values and their global indices to its own file. Rank
+        //! 0 also writes an index file holding the owning rank of every hex.
+        PerRank
+    };
+
+    template <typename Flt>
+    class RD_Mpi : public RD_Base<Flt>
+    {
+    public:
+        //! The communicator over which the model is distributed
+        MPI_Comm comm = MPI_COMM_WORLD;
+        int rank = 0;
+        int nranks = 1;
+
+        //! This process's part of the HexGrid
+        GridPartition partition;
+
+        //! Halo exchange for Flt fields
+        MpiHalo<Flt> halo;
+
+        RD_MpiOutput output_mode = RD_MpiOutput::Gathered;
+
+        /*!
+         * Build the HexGrid and partition it. After this, nhex is the number of hexes owned by
+         * this process and hg->num() is the number in the whole domain.
+         */
+        void allocate() override
+        {
+            RD_Base<Flt>::allocate();
+            MPI_Comm_rank (this->comm, &this->rank);
+            MPI_Comm_size (this->comm, &this->nranks);
+            this->partition.init (*this->hg, static_cast<unsigned int>(this->nranks), static_cast<unsigned int>(this->rank));
+            this->halo.init (this->partition, this->comm);
+            this->nhex = this->partition.nowned;
+        }
+
+        //! Compute the Laplacian of the owned values in F, exchanging F's halo as needed.
+        void compute_laplace (const std::vector<Flt>& F, std::vector<Flt>& lapF) override
+        {
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::laplace,
+                                    this->nhex * (2 * sizeof(Flt) + 6 * sizeof(int)));
+            const Flt norm = Flt{2} / (Flt{3} * this->d * this->d);
+            const std::vector<std::vector<int>>& nb = this->partition.neighbours;
+            this->halo_stencil (F, [&](unsigned int li, auto val) {
+                const Flt Fhi = F[li];
+                Flt thesum = Flt{-6} * Fhi;
+                for (unsigned int dir = 0; dir < 6; ++dir) {
+                    int lj = nb[dir][li];
+                    thesum += lj >= 0 ? val (static_cast<unsigned int>(lj)) : Fhi;
+                }
+                lapF[li] = norm * thesum;
+            });
+        }
+
+        /*!
+         * Hides RD_Base::compute_laplace_stored, which indexes F through the whole grid's
+         * neighbour arrays (reading past the ends of the owned-size fields of a partitioned
+         * model) and does not exchange the halo. The halo exchange is of Flt values, so a
+         * field must be stored as Flt here, and this is the same as compute_laplace.
+         */
+        template <typename S>
+        void compute_laplace_stored (const std::vector<S>& F, std::vector<Flt>& lapF)
+        {
+            static_assert (std::is_same_v<S, Flt>, "RD_Mpi exchanges halos of Flt fields only, so F must be stored as Flt");
+            this->compute_laplace (F, lapF);
+        }
+
+        //! The distributed equivalent of RD_Base::spacegrad2D
+        void spacegrad2D (const std::vector<Flt>& f, std::array<std::vector<Flt>, 2>& gradf)
+        {
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::spacegrad,
+                                    this->nhex * (3 * sizeof(Flt) + 6 * sizeof(int)));
+            const std::vector<std::vector<int>>& nb = this->partition.neighbours;
+            this->halo_stencil (f, [&](unsigned int li, auto val) {
+                // Neighbour directions are ne, nne, nnw, nw, nsw, nse
+                const int ne = nb[0][li], nne = nb[1][li], nnw = nb[2][li];
+                const int nw = nb[3][li], nsw = nb[4][li], nse = nb[5][li];
+                auto v = [&val](int lj) { return val (static_cast<unsigned int>(lj)); };
+
+                if (ne >= 0 && nw >= 0) {
+                    gradf[0][li] = (v(ne) - v(nw)) * this->oneover2d;
+                } else if (ne >= 0) {
+                    gradf[0][li] = (v(ne) - f[li]) * this->oneoverd;
+                } else if (nw >= 0) {
+                    gradf[0][li] = (f[li] - v(nw)) * this->oneoverd;
+                } else {
+                    gradf[0][li] = Flt{0};
+                }
+
+                if (nnw >= 0 && nne >= 0 && nsw >= 0 && nse >= 0) {
+                    gradf[1][li] = ( (v(nne) - v(nse)) + (v(nnw) - v(nsw)) ) * this->oneover4v;
+                } else if (nnw >= 0 && nne >= 0) {
+                    gradf[1][li] = ( (v(nne) + v(nnw)) * Flt{0.5} - f[li]) * this->oneoverv;
+                } else if (nsw >= 0 && nse >= 0) {
+                    gradf[1][li] = (f[li] - (v(nse) + v(nsw)) * Flt{0.5}) * this->oneoverv;
+                } else if (nnw >= 0 && nsw >= 0) {
+                    gradf[1][li] = (v(nnw) - v(nsw)) * this->oneover2v;
+                } else if (nne >= 0 && nse >= 0) {
+                    gradf[1][li] = (v(nne) - v(nse)) * this->oneover2v;
+                } else {
+                    gradf[1][li] = Flt{0};
+                }
+            });
+        }
+
+        /*!
+         * Fill the owned values of v with noise, exactly as RD_Base::noiseify_vector_variable
+         * would for the same hexes in a serial run; the random numbers are keyed on the global
+         * hex index, so results do not depend on the number of processes.
+         */
+        void noiseify_vector_variable (std::vector<Flt>& v, Flt offset, Flt gain)
+        {
+            MORPH_RD_PROFILE_SCOPE (this->profiler, rd_phase::noise, this->nhex * sizeof(Flt));
+            if (this->stepCount != this->noise_step) {
+                this->noise_step = this->stepCount;
+                this->noise_stream = 0;
+            }
+            const std::uint32_t stream = this->noise_stream++;
+
+            std::vector<float> dist (this->hg->num(), -1.0f);
+            for (const auto& h : this->hg->hexen) { dist[h.vi] = h.distToBoundary; }
+
+            const Flt range = (offset + gain) - offset;
+#pragma omp parallel for schedule(static)
+            for (unsigned int li = 0; li < this->nhex; ++li) {
+                const unsigned int gi = this->partition.global_index[li];
+                v[li] = offset + range * this->noise.uniform (this->stepCount, stream, gi);
+                if (dist[gi] > -0.5f) {
+                    Flt bSig = Flt{1} / ( Flt{1} + std::exp (-Flt{100}*(dist[gi]-this->boundaryFalloffDist)) );
+                    v[li] = v[li] * bSig;
+                }
+            }
+        }
+
+        //! Gather the owned values of the field local into global (in global hex order) on rank 0
+        void gather (const std::vector<Flt>& local, std::vector<Flt>& global) { this->halo.gather (local, global, 0); }
+
+        /*!
+         * Write fields to HDF5, according to output_mode. basename has no suffix. Gathered output
+         * goes to basename.h5; per-rank output goes to basename_rank<N>.h5 for each rank, with
+         * an index in basename_index.h5. Collective; call on every rank.
+         */
+        void save_fields (const std::string& basename,
+                          const std::vector<std::pair<std::string, const std::vector<Flt>*>>& fields)
+        {
+            if (this->output_mode == RD_MpiOutput::Gathered) {
+                std::vector<std::vector<Flt>> globals (fields.size());
+                for (unsigned int f = 0; f < fields.size(); ++f) { this->gather (*fields[f].second, globals[f]); }
+                if (this->rank == 0) {
+                    HdfData data (basename + ".h5");
+                    for (unsigned int f = 0; f < fields.size(); ++f) {
+                        data.add_contained_vals (fields[f].first.c_str(), globals[f]);
+                    }
+                }
+            } else {
+                {
+                    HdfData data (basename + "_rank" + std::to_string (this->rank) + ".h5");
+                    data.add_val ("/rank", this->rank);
+                    // The global indices of the owned hexes only, to match the fields
+                    std::vector<unsigned int> owned_index (this->partition.global_index.begin(),
+                                                           this->partition.global_index.begin() + this->nhex);
+                    data.add_contained_vals ("/global_index", owned_index);
+                    for (const auto& fld : fields) {
+                        std::vector<Flt> owned (fld.second->begin(), fld.second->begin() + this->nhex);
+                        data.add_contained_vals (fld.first.c_str(), owned);
+                    }
+                }
+                if (this->rank == 0) {
+                    HdfData index (basename + "_index.h5");
+                    index.add_val ("/nranks", this->nranks);
+                    index.add_val ("/nhex", this->hg->num());
+                    index.add_contained_vals ("/owner", this->partition.owner);
+                }
+            }
+        }
+
+        //! Only rank 0 saves the (global) hex positions
+        void savePositions() { if (this->rank == 0) { RD_Base<Flt>::savePositions(); } }
+
+    protected:
+        /*!
+         * Apply kernel (li, val) to every owned hex li, where val(lj) returns the value of F
+         * at local hex lj. Interior hexes are computed while the halo of F is in flight.
+         */
+        template <typename K>
+        void halo_stencil (const std::vector<Flt>& F, K kernel)
+        {
+            const std::vector<unsigned int>& interior = this->partition.interior;
+            const std::vector<unsigned int>& border = this->partition.border;
+            this->halo.start (F);
+            auto owned_val = [&F](unsigned int lj) { return F[lj]; };
+#pragma omp parallel for schedule(static)
+            for (unsigned int k = 0; k < interior.size(); ++k) { kernel (interior[k], owned_val); }
+            this->halo.finish();
+            auto any_val = [&F, this](unsigned int lj) { return this->halo.at (F, lj); };
+#pragma omp parallel for schedule(static)
+            for (unsigned int k = 0; k < border.size(); ++k) { kernel (border[k], any_val); }
+        }
+    };
+
+} // namespace morph
@@ -0,0 +1,272 @@
+/*
+ * A lightweight per-phase profiler for reaction-diffusion models derived from
+ * morph::RD_Base.
+ *
+ * Phases of a step (the Laplacian stencil, gradients, reaction, noise, saving and
+ * visualisation) are timed with scoped timers. The scoped timers are only compiled in if
+ * MORPH_RD_PROFILE is defined before this file is included, otherwise the
+ * MORPH_RD_PROFILE_* macros expand to nothing and the cost is zero.
+ *
+ * Usage, in a model derived from RD_Base:
+ *
+ *   void step()
+ *   {
+ *       MORPH_RD_PROFILE_STEP (this->profiler, this->nhex);
+ *       this->compute_laplace (this->A, lapA); // RD_Base times this phase itself
+ *       {
+ *           MORPH_RD_PROFILE_SCOPE (this->profiler, morph::rd_phase::reaction, 0);
+ *           // reaction loop...
+ *       }
+ *   }
+ *
+ * and at the end of the run: RD.profiler.save_json ("logs/profile.json");
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <array>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#ifdef MORPH_RD_PROFILE
+//! Time the enclosing scope as the given phase. bytes is the (estimated) memory traffic.
+# define MORPH_RD_PROFILE_SCOPE(prof, phase, bytes) morph::RD_Profiler::scoped_timer rd_profile_scope_timer_ (prof, phase, bytes)
+//! Time the enclosing scope as one whole step, which updated ncells cells
+# define MORPH_RD_PROFILE_STEP(prof, ncells) morph::RD_Profiler::step_timer rd_profile_step_timer_ (prof, ncells)
+#else
+# define MORPH_RD_PROFILE_SCOPE(prof, phase, bytes)
+# define MORPH_RD_PROFILE_STEP(prof, ncells)
+#endif
+
+namespace morph {
+
+    //! The phases of an RD step that can be timed
+    enum class rd_phase : unsigned int
+    {
+        laplace,
+        spacegrad,
+        reaction,
+        noise,
+        save,
+        visualise,
+        other,
+        n_phases
+    };
+
+    /*!
+     * Accumulates timings for the phases of an RD step, along with a histogram of the
+     * latency of whole steps.
+     *
+     * Phase timings are inclusive, so if the reaction scope encloses a call to
+     * compute_laplace, then the laplace time is counted in both phases. Timers are
+     * expected to be started and stopped from the thread that calls step(), not from
+     * within OpenMP parallel regions.
+     */
+    struct RD_Profiler
+    {
+        using clock = std::chrono::steady_clock;
+
+        //! Number of log2 buckets in the step latency histogram
+        static constexpr unsigned int n_hist_buckets = 32;
+
+        //! Statistics for one phase
+        struct phase_stats
+        {
+            unsigned long long calls = 0;
+            unsigned long long total_ns = 0;
+            unsigned long long min_ns = std::numeric_limits<unsigned long long>::max();
+            unsigned long long max_ns = 0;
+            unsigned long long bytes = 0;
+        };
+
+        //! Per-phase statistics, indexed by rd_phase
+        std::array<phase_stats, static_cast<unsigned int>(rd_phase::n_phases)> phases;
+
+        //! Statistics for whole steps
+        phase_stats steps;
+
+        /*!
+         * Histogram of step latency. Bucket 0 counts steps that took less than 1 us and
+         * bucket b counts steps that took [2^(b-1), 2^b) us. The last bucket also takes
+         * any longer steps.
+         */
+        std::array<unsigned long long, n_hist_buckets> step_hist = {};
+
+        //! The total number of cell updates (cells x steps) recorded by step timers
+        unsigned long long cell_updates = 0;
+
+        //! The name of a phase, for output
+        static std::string phase_name (rd_phase p)
+        {
+            switch (p) {
+            case rd_phase::laplace: return "laplace";
+            case rd_phase::spacegrad: return "spacegrad";
+            case rd_phase::reaction: return "reaction";
+            case rd_phase::noise: return "noise";
+            case rd_phase::save: return "save";
+            case rd_phase::visualise: return "visualise";
+            case rd_phase::other: return "other";
+            default: return "unknown";
+            }
+        }
+
+        //! Record one timing of duration ns for phase p, which moved bytes of memory
+        void record (rd_phase p, unsigned long long ns, unsigned long long bytes)
+        {
+            phase_stats& ps = this->phases[static_cast<unsigned int>(p)];
+            RD_Profiler::accumulate (ps, ns);
+            ps.bytes += bytes;
+        }
+
+        //! Record one step of duration ns, which updated ncells cells
+        void record_step (unsigned long long ns, unsigned long long ncells)
+        {
+            RD_Profiler::accumulate (this->steps, ns);
+            this->cell_updates += ncells;
+            unsigned long long us = ns / 1000ULL;
+            unsigned int b = 0;
+            while (us > 0ULL && b < n_hist_buckets - 1U) { us >>= 1; ++b; }
+            this->step_hist[b] += 1ULL;
+        }
+
+        //! Clear all statistics
+        void reset()
+        {
+            for (auto& ps : this->phases) { ps = phase_stats{}; }
+            this->steps = phase_stats{};
+            this->step_hist.fill (0ULL);
+            this->cell_updates = 0;
+        }
+
+        //! Total time in seconds spent in phase p
+        double seconds (rd_phase p) const
+        {
+            return static_cast<double>(this->phases[static_cast<unsigned int>(p)].total_ns) * 1e-9;
+        }
+
+        //! The mean throughput of the recorded steps in cell updates per second
+        double cell_updates_per_second() const
+        {
+            if (this->steps.total_ns == 0ULL) { return 0.0; }
+            return static_cast<double>(this->cell_updates) / (static_cast<double>(this->steps.total_ns) * 1e-9);
+        }
+
+        //! The memory bandwidth achieved in phase p, in GB/s (1 GB = 1e9 bytes)
+        double gigabytes_per_second (rd_phase p) const
+        {
+            const phase_stats& ps = this->phases[static_cast<unsigned int>(p)];
+            if (ps.total_ns == 0ULL) { return 0.0; }
+            return static_cast<double>(ps.bytes) / static_cast<double>(ps.total_ns);
+        }
+
+        //! The memory bandwidth over all phases for which bytes were recorded, in GB/s
+        double gigabytes_per_second() const
+        {
+            unsigned long long bytes = 0;
+            unsigned long long ns = 0;
+            for (const auto& ps : this->phases) {
+                if (ps.bytes > 0ULL) {
+                    bytes += ps.bytes;
+                    ns += ps.total_ns;
+                }
+            }
+            if (ns == 0ULL) { return 0.0; }
+            return static_cast<double>(bytes) / static_cast<double>(ns);
+        }
+
+        //! Return all the statistics as a json object
+        nlohmann::json to_json() const
+        {
+            nlohmann::json j;
+            j["steps"] = RD_Profiler::stats_json (this->steps);
+            j["cell_updates"] = this->cell_updates;
+            j["cell_updates_per_second"] = this->cell_updates_per_second();
+            j["gigabytes_per_second"] = this->gigabytes_per_second();
+            for (unsigned int i = 0; i < static_cast<unsigned int>(rd_phase::n_phases); ++i) {
+                rd_phase p = static_cast<rd_phase>(i);
+                if (this->phases[i].calls == 0ULL) { continue; }
+                nlohmann::json pj = RD_Profiler::stats_json (this->phases[i]);
+                pj["bytes"] = this->phases[i].bytes;
+                pj["gigabytes_per_second"] = this->gigabytes_per_second (p);
+                j["phases"][RD_Profiler::phase_name (p)] = pj;
+            }
+            // Histogram, with the upper edge of each bucket in microseconds
+            nlohmann::json hj;
+            hj["bucket_upper_us"] = nlohmann::json::array();
+            hj["counts"] = nlohmann::json::array();
+            for (unsigned int b = 0; b < n_hist_buckets; ++b) {
+                hj["bucket_upper_us"].push_back (1ULL << b);
+                hj["counts"].push_back (this->step_hist[b]);
+            }
+            j["step_latency_histogram"] = hj;
+            return j;
+        }
+
+        //! Write the statistics to the json file at path
+        void save_json (const std::string& path) const
+        {
+            std::ofstream f (path, std::ios::out | std::ios::trunc);
+            if (!f.is_open()) {
+                throw std::runtime_error ("RD_Profiler::save_json: Failed to open file " + path);
+            }
+            f << this->to_json().dump (4) << std::endl;
+        }
+
+        //! Times the lifetime of the object as one call to a phase
+        struct scoped_timer
+        {
+            scoped_timer (RD_Profiler& _prof, rd_phase _p, unsigned long long _bytes)
+                : prof(_prof), p(_p), bytes(_bytes), t0(clock::now()) {}
+            ~scoped_timer()
+            {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - this->t0).count();
+                this->prof.record (this->p, static_cast<unsigned long long>(ns), this->bytes);
+            }
+            RD_Profiler& prof;
+            rd_phase p;
+            unsigned long long bytes;
+            clock::time_point t0;
+        };
+
+        //! Times the lifetime of the object as one step
+        struct step_timer
+        {
+            step_timer (RD_Profiler& _prof, unsigned long long _ncells)
+                : prof(_prof), ncells(_ncells), t0(clock::now()) {}
+            ~step_timer()
+            {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - this->t0).count();
+                this->prof.record_step (static_cast<unsigned long long>(ns), this->ncells);
+            }
+            RD_Profiler& prof;
+            unsigned long long ncells;
+            clock::time_point t0;
+        };
+
+    private:
+        static void accumulate (phase_stats& ps, unsigned long long ns)
+        {
+            ps.calls += 1ULL;
+            ps.total_ns += ns;
+            if (ns < ps.min_ns) { ps.min_ns = ns; }
+            if (ns > ps.max_ns) { ps.max_ns = ns; }
+        }
+
+        static nlohmann::json stats_json (const phase_stats& ps)
+        {
+            nlohmann::json j;
+            j["calls"] = ps.calls;
+            j["total_s"] = static_cast<double>(ps.total_ns) * 1e-9;
+            j["mean_s"] = ps.calls > 0ULL ? static_cast<double>(ps.total_ns) * 1e-9 / static_cast<double>(ps.calls) : 0.0;
+            j["min_s"] = ps.calls > 0ULL ? static_cast<double>(ps.min_ns) * 1e-9 : 0.0;
+            j["max_s"] = static_cast<double>(ps.max_ns) * 1e-9;
+            return j;
+        }
+    };
+
+} // namespace morph
@@ -10,6 +10,8 @@
 #include <morph/VisualDataModel.h>
 #include <morph/Scale.h>
 #include <morph/vec.h>
+#include <morph/Quaternion.h>
+#include <morph/colour.h>
 #include <iostream>
 #include <vector>
 #include <array>
@@ -31,22 +33,67 @@ namespace morph {
         }
 
         //! Quick hack to add an additional point
-        void add (morph::vec<float> coord, Flt value)
-        {
-            std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
-            this->computeSphere (coord, clr, this->radiusFixed, 16, 20);
-            this->reinit_buffers();
-        }
+        void add (morph::vec<float> coord, Flt value) { this->add (coord, value, this->radiusFixed); }
         //! Additional point with variable size
         void add (morph::vec<float> coord, Flt value, Flt size)
         {
             std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
+            if (this->instanced == true && !this->glyphs.empty()) {
+                this->instance_push (0u, coord, morph::vec<float>{ 1.0f, 1.0f, 1.0f } * static_cast<float>(size), morph::Quaternion<float>{}, clr);
+                this->reinit_instance_buffer();
+                return;
+            }
             this->computeSphere (coord, clr, size, 16, 20);
             this->reinit_buffers();
         }
 
         //! Compute spheres for a scatter plot
         void initializeVertices()
+        {
+            if (this->instanced == true) {
+                // One unit sphere, drawn at every point
+                const std::size_t i0 = this->indices.size();
+                this->computeSphere (morph::vec<float>{ 0.0f, 0.0f, 0.0f }, morph::colour::white, 1.0f, 16, 20);
+                this->make_glyph (i0);
+            }
+            this->computePoints (this->labelIndices);
+        }
+
+        /*!
+         * Set true (before finalize()) to draw the points as instances of a single sphere
+         * mesh. Each point then costs 13 floats in place of a few hundred vertices, and
+         * reinit_data() (after a change to the coordinates or data, but not to their number
+         * unless labelIndices is false) re-uploads only the instances.
+         */
+        bool instanced = false;
+
+    protected:
+        //! Draw a sphere at so, or, with instancing, add an instance of the sphere glyph
+        void sphere (const morph::vec<float>& so, const std::array<float, 3>& clr, float r)
+        {
+            if (this->instanced == true && !this->glyphs.empty()) {
+                this->instance_push (0u, so, morph::vec<float>{ r, r, r }, morph::Quaternion<float>{}, clr);
+            } else if constexpr (draw_spheres_as_geodesics) {
+                // Slower than regular computeSphere(). 2 iterations gives 320 faces
+                this->template computeSphereGeoFast<float, 2> (so, clr, r);
+            } else {
+                // (16+2) * 20 gives 360 faces
+                this->computeSphere (so, clr, r, 16, 20);
+            }
+        }
+
+        //! Recompute the instances of the sphere glyph from the current coordinates and data
+        bool update_data_in_place() override
+        {
+            if (this->instanced == false || this->glyphs.empty() || this->labelIndices == true) { return false; }
+            this->glyphs[0].instances.clear();
+            this->computePoints (false);
+            this->reinit_instance_buffer();
+            return true;
+        }
+
+        //! Compute the spheres (or sphere instances) and, if labels is true, index labels, for the points
+        void computePoints (bool labels)
         {
             unsigned int ncoords = this->dataCoords == nullptr ? 0 : this->dataCoords->size();
             if (ncoords == 0) { return; }
@@ -112,28 +159,19 @@ namespace morph {
                     clr = this->cm.convert (vdcopy1[i], vdcopy2[i]);
                 }
                 if (this->sizeFactor == Flt{0}) {
-                    if constexpr (draw_spheres_as_geodesics) {
-                        // Slower than regular computeSphere(). 2 iterations gives 320 faces
-                        this->template computeSphereGeoFast<float, 2> ((*this->dataCoords)[i], clr, this->radiusFixed);
-                    } else {
-                        // (16+2) * 20 gives 360 faces
-                        this->computeSphere ((*this->dataCoords)[i], clr, this->radiusFixed, 16, 20);
-                    }
+                    this->sphere ((*this->dataCoords)[i], clr, this->radiusFixed);
                 } else {
-                    if constexpr (draw_spheres_as_geodesics) {
-                        this->template computeSphereGeoFast<float, 2> ((*this->dataCoords)[i], clr, dcopy[i]*this->sizeFactor);
-                    } else {
-                        this->computeSphere ((*this->dataCoords)[i], clr, dcopy[i]*this->sizeFactor, 16, 20);
-                    }
+                    this->sphere ((*this->dataCoords)[i], clr, dcopy[i]*this->sizeFactor);
                 }
 
-                if (this->labelIndices == true) {
+                if (labels == true) {
                     // Draw an index label...
                     this->addLabel (std::to_string (i), (*this->dataCoords)[i] + labelOffset, morph::TextFeatures(labelSize) );
                 }
             }
         }
 
+    public:
         // The constexpr, unordered geodesic code is no slower than the regular
         // VisualModel::computeSphere(), but leave this off for now (if true, C++-20 is
         // required)
@@ -79,6 +79,12 @@
 #include <functional>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
 
 #include <morph/VisualDefaultShaders.h>
 
@@ -171,20 +177,16 @@ namespace morph {
         {
 #ifndef OWNED_MODE
             this->setContext();
+#endif
+            // Leave the resource group. The shader programs and fonts belong to the group and
+            // are freed (while our context is still current) if this is its last Visual.
+            morph::VisualResources<glver>::i().leave_group (this);
+            this->shaders.gprog = 0;
+            this->shaders.tprog = 0;
+            this->active_gprog = morph::visgl::graphics_shader_type::none;
+#ifndef OWNED_MODE
             glfwDestroyWindow (this->window);
 #endif
-            if (this->shaders.gprog) {
-                glDeleteProgram (this->shaders.gprog);
-                this->shaders.gprog = 0;
-                this->active_gprog = morph::visgl::graphics_shader_type::none;
-            }
-            if (this->shaders.tprog) {
-                glDeleteProgram (this->shaders.tprog);
-                this->shaders.tprog = 0;
-            }
-
-            // Free up the Fonts associated with this morph::Visual
-            morph::VisualResources<glver>::i().freetype_deinit (this);
         }
 
         // Public init that is given a context (window or widget) and then sets up the
@@ -205,11 +207,24 @@ namespace morph {
             morph::VisualResources<glver>::i().create();
 
             // Set up the window that will present the OpenGL graphics. No-op in Qt-managed Visual,
-            // but this has to happen BEFORE the call to VisualResources::freetype_init()
+            // but this has to happen BEFORE the call to VisualResources::join_group()
             this->init_window();
 
-            // Now make sure that Freetype is set up
-            morph::VisualResources<glver>::i().freetype_init (this);
+            // Join the resource group of our context, which holds the shared shader programs and
+            // fonts (and sets up Freetype for a new group)
+#ifndef OWNED_MODE
+            const void* group = nullptr;
+            if (morph::VisualResources<glver>::i().share_contexts) {
+                group = morph::VisualResources<glver>::i().glfw_group();
+            }
+            morph::VisualResources<glver>::i().join_group (this, group, this->window);
+#else
+# ifdef MORPH_OWNED_SHARE_GROUP
+            morph::VisualResources<glver>::i().join_group (this, MORPH_OWNED_SHARE_GROUP(), this->window);
+# else
+            morph::VisualResources<glver>::i().join_group (this, nullptr, this->window);
+# endif
+#endif
         }
 
         //! Take a screenshot of the window. Return vec containing width * height or {-1, -1} on
@@ -266,6 +281,7 @@ namespace morph {
         void bindmodel (std::unique_ptr<T>& model)
         {
             model->set_parent (this);
+            model->profiling = this->profiling;
             model->get_shaderprogs = &morph::Visual<glver>::get_shaderprogs;
             model->get_gprog = &morph::Visual<glver>::get_gprog;
             model->get_tprog = &morph::Visual<glver>::get_tprog;
@@ -283,6 +299,7 @@ namespace morph {
         {
             std::unique_ptr<morph::VisualModel<glver>> vmp = std::move(model);
             this->vm.push_back (std::move(vmp));
+            this->dirty = true;
             unsigned int rtn = (this->vm.size()-1);
             return rtn;
         }
@@ -295,6 +312,7 @@ namespace morph {
         {
             std::unique_ptr<morph::VisualModel<glver>> vmp = std::move(model);
             this->vm.push_back (std::move(vmp));
+            this->dirty = true;
             return static_cast<T*>(this->vm.back().get());
         }
 
@@ -308,7 +326,7 @@ namespace morph {
         morph::VisualModel<glver>* getVisualModel (unsigned int modelId) { return (this->vm[modelId].get()); }
 
         //! Remove the VisualModel with ID \a modelId from the scene.
-        void removeVisualModel (unsigned int modelId) { this->vm.erase (this->vm.begin() + modelId); }
+        void removeVisualModel (unsigned int modelId) { this->vm.erase (this->vm.begin() + modelId); this->dirty = true; }
 
         //! Remove the VisualModel whose pointer matches the VisualModel* modelPtr
         void removeVisualModel (morph::VisualModel<glver>* modelPtr)
@@ -321,7 +339,48 @@ namespace morph {
                     break;
                 }
             }
-            if (found_model == true) { this->vm.erase (this->vm.begin() + modelId); }
+            if (found_model == true) { this->vm.erase (this->vm.begin() + modelId); this->dirty = true; }
+        }
+
+        /*!
+         * Switch the recording of per-model costs (see morph::visual_model_profile) on or
+         * off, for the models in the scene and for those bound from now on. To include the
+         * time taken by initializeVertices in finalize(), switch profiling on before binding
+         * the models.
+         */
+        void setProfiling (const bool on)
+        {
+            this->profiling = on;
+            for (auto& m : this->vm) { m->profiling = on; }
+            this->profile_sums.clear();
+            this->profile_means.clear();
+            this->profile_frames = 0u;
+        }
+
+        //! The costs of each VisualModel (in the order of Visual::vm) in the most recent frame
+        const std::vector<morph::visual_model_profile>& getProfiles() const { return this->profiles; }
+
+        /*!
+         * A table of the mean costs of each VisualModel over the last profile_interval frames
+         * (or the frames so far, if fewer have been rendered). Times are in ms. This is the
+         * text shown on screen if showProfile is true.
+         */
+        std::string profileReport() const
+        {
+            // Until the first interval is complete, average the frames collected so far
+            const std::vector<morph::visual_model_profile> means = this->profile_means.empty() && this->profile_frames > 0u
+            ? this->profile_sum_means() : (this->profile_means.empty() ? this->profiles : this->profile_means);
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision (3);
+            ss << "model: vertices indices kbytes bytes/vertex | init upload cpu gpu (ms)\n";
+            for (std::size_t i = 0; i < means.size(); ++i) {
+                const morph::visual_model_profile& p = means[i];
+                ss << i << ": " << p.n_vertices << " " << p.n_indices << " " << (p.buffer_bytes / 1024u) << " " << p.vertex_bytes << " | "
+                   << p.vertices_ms << " " << p.upload_ms << " " << p.draw_ms << " ";
+                if (p.gpu_ms < 0.0) { ss << "-"; } else { ss << p.gpu_ms; }
+                ss << "\n";
+            }
+            return ss.str();
         }
 
         //! Add a label _text to the scene at position _toffset. Font features are
@@ -342,6 +401,7 @@ namespace morph {
             }
             morph::VisualTextModel<glver>* tm = tmup.get();
             this->texts.push_back (std::move(tmup));
+            this->dirty = true;
             return tm->getTextGeometry();
         }
 
@@ -365,6 +425,7 @@ namespace morph {
             }
             tm = tmup.get();
             this->texts.push_back (std::move(tmup));
+            this->dirty = true;
             return tm->getTextGeometry();
         }
 
@@ -413,9 +474,44 @@ namespace morph {
         //! A callback function
         static void callback_render (morph::Visual<glver>* _v) { _v->render(); };
 
-        //! Render the scene
+        /*!
+         * True if the scene must be drawn on the next call to render() (when render_on_demand
+         * is true): if the view has changed, the window has been resized, a model has been
+         * added or removed, markDirty() has been called or any model is dirty.
+         */
+        bool needsRender() const
+        {
+            if (this->dirty == true) { return true; }
+            for (const auto& m : this->vm) { if (m->dirty == true) { return true; } }
+            return false;
+        }
+
+        //! Mark the scene as needing to be drawn. Call after changing it in a way that Visual can't see.
+        void markDirty() { this->dirty = true; }
+
+        /*!
+         * True if max_fps would allow render() to draw a frame now. A loop that calls render()
+         * more often than max_fps can use this to skip costly model updates that would not be
+         * seen.
+         */
+        bool frameDue() const
+        {
+            if (this->max_fps <= 0.0f || this->frames_drawn == 0u) { return true; }
+            return std::chrono::duration<float>(sc::now() - this->last_frame).count() >= 1.0f / this->max_fps;
+        }
+
+        /*!
+         * Render the scene. If render_on_demand is true, nothing is done unless needsRender().
+         * If max_fps is non-zero, nothing is done if the last frame was drawn less than
+         * 1/max_fps seconds ago (the scene stays dirty, and is drawn by a later call).
+         */
         void render()
         {
+            if (this->render_on_demand == true && this->needsRender() == false) { return; }
+            if (this->frameDue() == false) { return; }
+            this->last_frame = sc::now();
+            ++this->frames_drawn;
+
 #ifndef OWNED_MODE
             this->setContext();
 #endif
@@ -428,14 +524,12 @@ namespace morph {
 #endif
             if (this->ptype == perspective_type::orthographic || this->ptype == perspective_type::perspective) {
                 if (this->active_gprog != morph::visgl::graphics_shader_type::projection2d) {
-                    if (this->shaders.gprog) { glDeleteProgram (this->shaders.gprog); }
-                    this->shaders.gprog = morph::gl::LoadShaders (this->proj2d_shader_progs);
+                    this->shaders.gprog = morph::VisualResources<glver>::i().program (this, this->proj2d_shader_progs);
                     this->active_gprog = morph::visgl::graphics_shader_type::projection2d;
                 }
             } else if (this->ptype == perspective_type::cylindrical) {
                 if (this->active_gprog != morph::visgl::graphics_shader_type::cylindrical) {
-                    if (this->shaders.gprog) { glDeleteProgram (this->shaders.gprog); }
-                    this->shaders.gprog = morph::gl::LoadShaders (this->cyl_shader_progs);
+                    this->shaders.gprog = morph::VisualResources<glver>::i().program (this, this->cyl_shader_progs);
                     this->active_gprog = morph::visgl::graphics_shader_type::cylindrical;
                 }
             }
@@ -522,15 +616,21 @@ namespace morph {
 
             auto vmi = this->vm.begin();
             while (vmi != this->vm.end()) {
+                // A model whose mesh is being built on another thread is left alone
+                if ((*vmi)->mesh_building == true) { ++vmi; continue; }
                 if ((*vmi)->twodimensional == true) {
                     // It's a two-d thing. Now what?
                     (*vmi)->setSceneMatrix (scenetransonly);
                 } else {
                     (*vmi)->setSceneMatrix (sceneview);
                 }
+                (*vmi)->setProjection (this->projection, morph::vec<int, 2>{ this->window_w, this->window_h });
                 (*vmi)->render();
+                (*vmi)->dirty = false;
                 ++vmi;
             }
+            this->dirty = false;
+            if (this->profiling == true) { this->collect_profiles(); }
 
             morph::gl::Util::checkError (__FILE__, __LINE__);
 
@@ -550,6 +650,12 @@ namespace morph {
                 ++ti;
             }
 
+            if (this->showProfile == true && this->profiling == true && this->profileText != nullptr) {
+                this->profileText->setSceneTranslation (this->textPosition ({-0.8f, 0.7f}));
+                this->profileText->setVisibleOn (this->bgcolour);
+                this->profileText->render();
+            }
+
 #ifndef OWNED_MODE
             glfwSwapBuffers (this->window);
 #endif
@@ -678,6 +784,25 @@ namespace morph {
         //! Set to true to show the title text within the scene
         bool showTitle = false;
 
+        /*!
+         * If true, render() draws the scene only if needsRender(), so that a simulation loop
+         * can call render() after every step at little cost when nothing has changed. Changes
+         * made through Visual's and VisualModel's member functions (and user input) are
+         * tracked. After changing a public attribute (such as bgcolour or showTitle, or a
+         * model's vertices), call markDirty().
+         */
+        bool render_on_demand = false;
+        /*!
+         * If non-zero, render() draws at most max_fps frames per second, returning at once if
+         * it is called sooner. Use this to decouple a fast simulation loop from the display.
+         */
+        float max_fps = 0.0f;
+
+        //! Set to true to show profileReport() within the scene (if profiling; see setProfiling)
+        bool showProfile = false;
+        //! The number of frames over which profileReport() averages the costs of the models
+        unsigned int profile_interval = 30u;
+
         //! If true, output some user information to stdout (e.g. user requested quit)
         bool user_info_stdout = true;
 
@@ -704,26 +829,28 @@ namespace morph {
          */
 
         //! Set a white background colour for the Visual scene
-        void backgroundWhite() { this->bgcolour = { 1.0f, 1.0f, 1.0f, 0.5f }; }
+        void backgroundWhite() { this->bgcolour = { 1.0f, 1.0f, 1.0f, 0.5f }; this->dirty = true; }
         //! Set a black background colour for the Visual scene
-        void backgroundBlack() { this->bgcolour = { 0.0f, 0.0f, 0.0f, 0.0f }; }
+        void backgroundBlack() { this->bgcolour = { 0.0f, 0.0f, 0.0f, 0.0f }; this->dirty = true; }
 
         //! Set the scene's x and y values at the same time.
         void setSceneTransXY (const float _x, const float _y)
         {
+            this->dirty = true;
             this->scenetrans[0] = _x;
             this->scenetrans[1] = _y;
             this->scenetrans_default[0] = _x;
             this->scenetrans_default[1] = _y;
         }
         //! Set the scene's y value. Use this to shift your scene objects left or right
-        void setSceneTransX (const float _x) { this->scenetrans[0] = _x; this->scenetrans_default[0] = _x; }
+        void setSceneTransX (const float _x) { this->scenetrans[0] = _x; this->scenetrans_default[0] = _x; this->dirty = true; }
         //! Set the scene's y value. Use this to shift your scene objects up and down
-        void setSceneTransY (const float _y) { this->scenetrans[1] = _y; this->scenetrans_default[1] = _y; }
+        void setSceneTransY (const float _y) { this->scenetrans[1] = _y; this->scenetrans_default[1] = _y; this->dirty = true; }
         //! Set the scene's z value. Use this to bring the 'camera' closer to your scene
         //! objects (that is, your morph::VisualModel objects).
         void setSceneTransZ (const float _z)
         {
+            this->dirty = true;
             if (_z > 0.0f) {
                 std::cerr << "WARNING setSceneTransZ(): Normally, the default z value is negative.\n";
             }
@@ -732,6 +859,7 @@ namespace morph {
         }
         void setSceneTrans (float _x, float _y, float _z)
         {
+            this->dirty = true;
             if (_z > 0.0f) {
                 std::cerr << "WARNING setSceneTrans(): Normally, the default z value is negative.\n";
             }
@@ -744,6 +872,7 @@ namespace morph {
         }
         void setSceneTrans (const morph::vec<float, 3>& _xyz)
         {
+            this->dirty = true;
             if (_xyz[2] > 0.0f) {
                 std::cerr << "WARNING setSceneTrans(vec<>&): Normally, the default z value is negative.\n";
             }
@@ -753,19 +882,26 @@ namespace morph {
 
         void setSceneRotation (const morph::Quaternion<float>& _rotn)
         {
+            this->dirty = true;
             this->rotation = _rotn;
             this->rotation_default = _rotn;
         }
 
         void lightingEffects (const bool effects_on = true)
         {
+            this->dirty = true;
             this->ambient_intensity = effects_on ? 0.4f : 1.0f;
             this->diffuse_intensity = effects_on ? 0.6f : 0.0f;
         }
 
-        //! Save all the VisualModels in this Visual out to a GLTF format file
+        //! Save all the VisualModels in this Visual out to a GLTF format file. If gltf_file ends
+        //! in .glb, the binary format is written (see saveglb).
         virtual void savegltf (const std::string& gltf_file)
         {
+            if (gltf_file.size() > 4u && gltf_file.compare (gltf_file.size() - 4u, 4u, ".glb") == 0) {
+                this->saveglb (gltf_file);
+                return;
+            }
             std::ofstream fout;
             fout.open (gltf_file, std::ios::out|std::ios::trunc);
             if (!fout.is_open()) { throw std::runtime_error ("Visual::savegltf(): Failed to open file for writing"); }
@@ -901,7 +1037,106 @@ namespace morph {
             fout.close();
         }
 
-        void set_winsize (int _w, int _h) { this->window_w = _w; this->window_h = _h; }
+        /*!
+         * Save all the VisualModels in this Visual out to a binary glTF (.glb) file. The file's
+         * binary chunk holds, for each model, its indices, vertex positions, colours and
+         * normals, streamed straight from the VisualModel's vectors. Models with no triangles
+         * are left out, as glTF accessors may not be empty.
+         */
+        virtual void saveglb (const std::string& glb_file)
+        {
+            // The models to save, with their extents (which the POSITION accessors must give)
+            std::vector<morph::VisualModel<glver>*> models;
+            for (auto& m : this->vm) {
+                if (m->indices_size() == 0u || m->vpos_size() == 0u) { continue; }
+                m->computeVertexMaxMins();
+                models.push_back (m.get());
+            }
+
+            // Each model has four bufferViews (and accessors): indices, position, colour and normal
+            std::ostringstream json;
+            json << "{\"asset\":{\"generator\":\"https://github.com/ABRG-Models/morphologica: morph::Visual::saveglb() (ver "
+                 << morph::version_string() << ")\",\"version\":\"2.0\"},";
+            std::size_t bin_bytes = 0u;
+            if (models.empty()) {
+                json << "\"scene\":0,\"scenes\":[{}]}"; // glTF arrays may not be empty
+            } else {
+                json << "\"scene\":0,\"scenes\":[{\"nodes\":[";
+                for (std::size_t i = 0u; i < models.size(); ++i) { json << (i ? "," : "") << i; }
+                json << "]}],\"nodes\":[";
+                for (std::size_t i = 0u; i < models.size(); ++i) {
+                    json << (i ? "," : "") << "{\"mesh\":" << i << ",\"translation\":" << models[i]->translation_str() << "}";
+                }
+                json << "],\"meshes\":[";
+                for (std::size_t i = 0u; i < models.size(); ++i) {
+                    json << (i ? "," : "") << "{\"primitives\":[{\"attributes\":{\"POSITION\":" << 4*i+1
+                         << ",\"COLOR_0\":" << 4*i+2 << ",\"NORMAL\":" << 4*i+3 << "},\"indices\":" << 4*i
+                         << ",\"material\":0}]}";
+                }
+                json << "],\"bufferViews\":[";
+                std::size_t offset = 0u;
+                for (std::size_t i = 0u; i < models.size(); ++i) {
+                    const std::size_t lengths[4] = { models[i]->indices_bytes(), models[i]->vpos_bytes(),
+                                                     models[i]->vcol_bytes(), models[i]->vnorm_bytes() };
+                    for (std::size_t b = 0u; b < 4u; ++b) {
+                        // 34963 is ELEMENT_ARRAY_BUFFER, 34962 ARRAY_BUFFER
+                        json << (i || b ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << offset
+                             << ",\"byteLength\":" << lengths[b] << ",\"target\":" << (b == 0u ? 34963 : 34962) << "}";
+                        offset += lengths[b];
+                    }
+                }
+                bin_bytes = offset;
+                json << "],\"accessors\":[";
+                for (std::size_t i = 0u; i < models.size(); ++i) {
+                    // 5125 is unsigned int, 5126 float
+                    json << (i ? "," : "") << "{\"bufferView\":" << 4*i << ",\"componentType\":5125,\"type\":\"SCALAR\",\"count\":"
+                         << models[i]->indices_size() << "}";
+                    json << ",{\"bufferView\":" << 4*i+1 << ",\"componentType\":5126,\"type\":\"VEC3\",\"count\":"
+                         << models[i]->vpos_size() / 3u << ",\"max\":" << models[i]->vpos_max() << ",\"min\":" << models[i]->vpos_min() << "}";
+                    json << ",{\"bufferView\":" << 4*i+2 << ",\"componentType\":5126,\"type\":\"VEC3\",\"count\":"
+                         << models[i]->vcol_size() / 3u << "}";
+                    json << ",{\"bufferView\":" << 4*i+3 << ",\"componentType\":5126,\"type\":\"VEC3\",\"count\":"
+                         << models[i]->vnorm_size() / 3u << "}";
+                }
+                json << "],\"buffers\":[{\"byteLength\":" << bin_bytes << "}],";
+                // Default material is single sided, so make it double sided
+                json << "\"materials\":[{\"doubleSided\":true}]}";
+            }
+
+            // Chunks are padded to 4 bytes: JSON with spaces. The binary data is all 4 byte words.
+            std::string json_chunk = json.str();
+            json_chunk.append ((4u - json_chunk.size() % 4u) % 4u, ' ');
+            const std::uint64_t total = 12u + 8u + json_chunk.size() + (bin_bytes > 0u ? 8u + bin_bytes : 0u);
+            if (total > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error ("Visual::saveglb(): The scene is too large for the .glb format (4 GB)");
+            }
+
+            std::ofstream fout (glb_file, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!fout.is_open()) { throw std::runtime_error ("Visual::saveglb(): Failed to open file for writing"); }
+            auto write_u32 = [&fout](const std::uint32_t w) {
+                const char b[4] = { static_cast<char>(w & 0xff), static_cast<char>(w >> 8 & 0xff),
+                                    static_cast<char>(w >> 16 & 0xff), static_cast<char>(w >> 24 & 0xff) };
+                fout.write (b, 4);
+            };
+            // Header: magic "glTF", version 2 and total length
+            write_u32 (0x46546C67u);
+            write_u32 (2u);
+            write_u32 (static_cast<std::uint32_t>(total));
+            // JSON chunk
+            write_u32 (static_cast<std::uint32_t>(json_chunk.size()));
+            write_u32 (0x4E4F534Au);
+            fout.write (json_chunk.data(), static_cast<std::streamsize>(json_chunk.size()));
+            // BIN chunk
+            if (bin_bytes > 0u) {
+                write_u32 (static_cast<std::uint32_t>(bin_bytes));
+                write_u32 (0x004E4942u);
+                for (auto m : models) { m->write_glb_buffers (fout); }
+            }
+            fout.close();
+            if (!fout) { throw std::runtime_error ("Visual::saveglb(): Failed to write " + glb_file); }
+        }
+
+        void set_winsize (int _w, int _h) { this->window_w = _w; this->window_h = _h; this->dirty = true; }
 
     protected:
         //! A vector of pointers to all the morph::VisualModels (HexGridVisual,
@@ -913,7 +1148,11 @@ namespace morph {
         void init_window()
         {
 #ifndef OWNED_MODE
-            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, NULL);
+            // Share GL objects (programs, font textures) with the other windows, if required
+            auto& vr = morph::VisualResources<glver>::i();
+            GLFWwindow* share = nullptr;
+            if (vr.share_contexts) { share = static_cast<GLFWwindow*>(vr.share_context (vr.glfw_group())); }
+            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, share);
             if (!this->window) {
                 // Window or OpenGL context creation failed
                 throw std::runtime_error("GLFW window creation failed!");
@@ -965,7 +1204,7 @@ namespace morph {
                 {GL_VERTEX_SHADER, "Visual.vert.glsl", morph::getDefaultVtxShader(glver), 0 },
                 {GL_FRAGMENT_SHADER, "Visual.frag.glsl", morph::getDefaultFragShader(glver), 0 }
             };
-            this->shaders.gprog = morph::gl::LoadShaders (this->proj2d_shader_progs);
+            this->shaders.gprog = morph::VisualResources<glver>::i().program (this, this->proj2d_shader_progs);
             this->active_gprog = morph::visgl::graphics_shader_type::projection2d;
 
             // Alternative cylindrical shader for possible later use. (NB: not loaded immediately)
@@ -979,7 +1218,7 @@ namespace morph {
                 {GL_VERTEX_SHADER, "VisText.vert.glsl", morph::getDefaultTextVtxShader(glver), 0 },
                 {GL_FRAGMENT_SHADER, "VisText.frag.glsl" , morph::getDefaultTextFragShader(glver), 0 }
             };
-            this->shaders.tprog = morph::gl::LoadShaders (this->text_shader_progs);
+            this->shaders.tprog = morph::VisualResources<glver>::i().program (this, this->text_shader_progs);
 
             // OpenGL options
             glEnable (GL_DEPTH_TEST);
@@ -1064,6 +1303,88 @@ namespace morph {
         //! Text models for labels
         std::vector<std::unique_ptr<morph::VisualTextModel<glver>>> texts;
 
+        //! True if the scene must be drawn (see needsRender)
+        bool dirty = true;
+        //! The time at which render() last drew the scene (see max_fps)
+        sc::time_point last_frame;
+        //! The number of frames drawn by render()
+        unsigned long long frames_drawn = 0u;
+
+        //! If true, VisualModels record their costs and render() collects them (see setProfiling)
+        bool profiling = false;
+        //! The costs of each model in the last frame
+        std::vector<morph::visual_model_profile> profiles;
+        //! Sums of the costs of each model over the current interval
+        std::vector<morph::visual_model_profile> profile_sums;
+        //! The number of frames (and of frames with a GPU time) of each model in profile_sums
+        std::vector<unsigned int> profile_gpu_frames;
+        unsigned int profile_frames = 0u;
+        //! The mean costs of each model over the last complete interval
+        std::vector<morph::visual_model_profile> profile_means;
+        //! The text model for the on-screen profile (see showProfile)
+        std::unique_ptr<morph::VisualTextModel<glver>> profileText = nullptr;
+
+        //! The mean costs of each model over the profile_frames frames summed in profile_sums
+        std::vector<morph::visual_model_profile> profile_sum_means() const
+        {
+            const double nf = static_cast<double>(std::max (this->profile_frames, 1u));
+            std::vector<morph::visual_model_profile> means = this->profile_sums;
+            for (std::size_t i = 0; i < means.size(); ++i) {
+                morph::visual_model_profile& m = means[i];
+                m.vertices_ms /= nf;
+                m.upload_ms /= nf;
+                m.draw_ms /= nf;
+                if (this->profile_gpu_frames[i] > 0u) { m.gpu_ms /= static_cast<double>(this->profile_gpu_frames[i]); }
+            }
+            return means;
+        }
+
+        //! Take the costs of the frame just rendered from the models and update the means
+        void collect_profiles()
+        {
+            const std::size_t n = this->vm.size();
+            this->profiles.resize (n);
+            for (std::size_t i = 0; i < n; ++i) { this->profiles[i] = this->vm[i]->take_profile(); }
+
+            if (this->profile_sums.size() != n) {
+                // Models were added or removed, so start a new interval
+                this->profile_sums.assign (n, morph::visual_model_profile{});
+                this->profile_gpu_frames.assign (n, 0u);
+                this->profile_frames = 0u;
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                morph::visual_model_profile& s = this->profile_sums[i];
+                const morph::visual_model_profile& p = this->profiles[i];
+                s.vertices_ms += p.vertices_ms;
+                s.upload_ms += p.upload_ms;
+                s.draw_ms += p.draw_ms;
+                if (p.gpu_ms >= 0.0) {
+                    s.gpu_ms = (this->profile_gpu_frames[i] == 0u ? 0.0 : s.gpu_ms) + p.gpu_ms;
+                    ++this->profile_gpu_frames[i];
+                }
+                s.n_vertices = p.n_vertices;
+                s.n_indices = p.n_indices;
+                s.buffer_bytes = p.buffer_bytes;
+                s.vertex_bytes = p.vertex_bytes;
+                s.index_bytes = p.index_bytes;
+                s.mesh_bytes = p.mesh_bytes;
+            }
+            if (++this->profile_frames < std::max (this->profile_interval, 1u)) { return; }
+
+            this->profile_means = this->profile_sum_means();
+            this->profile_sums.assign (n, morph::visual_model_profile{});
+            this->profile_gpu_frames.assign (n, 0u);
+            this->profile_frames = 0u;
+
+            if (this->showProfile == true) {
+                if (this->profileText == nullptr) {
+                    this->profileText = std::make_unique<morph::VisualTextModel<glver>> (this, this->shaders.tprog,
+                                                                                         morph::TextFeatures (0.015f));
+                }
+                this->profileText->setupText (this->profileReport());
+            }
+        }
+
         /*
          * Variables to manage projection and rotation of the scene
          */
@@ -1128,6 +1449,7 @@ namespace morph {
         {
             Visual<glver>* self = static_cast<Visual<glver>*>(glfwGetWindowUserPointer (_window));
             if (self->key_callback (key, scancode, action, mods)) {
+                self->dirty = true;
                 self->render();
             }
         }
@@ -1140,6 +1462,7 @@ namespace morph {
         {
             Visual<glver>* self = static_cast<Visual<glver>*>(glfwGetWindowUserPointer (_window));
             if (self->cursor_position_callback (x, y)) {
+                self->dirty = true;
                 self->render();
             }
         }
@@ -1147,6 +1470,7 @@ namespace morph {
         {
             Visual<glver>* self = static_cast<Visual<glver>*>(glfwGetWindowUserPointer (_window));
             if (self->window_size_callback (width, height)) {
+                self->dirty = true;
                 self->render();
             }
         }
@@ -1159,6 +1483,7 @@ namespace morph {
         {
             Visual<glver>* self = static_cast<Visual<glver>*>(glfwGetWindowUserPointer (_window));
             if (self->scroll_callback (xoffset, yoffset)) {
+                self->dirty = true;
                 self->render();
             }
         }
@@ -1387,6 +1712,7 @@ namespace morph {
 
             this->key_callback_extra (_key, scancode, action, mods);
 
+            if (needs_render == true) { this->dirty = true; }
             return needs_render;
         }
 
@@ -1494,6 +1820,7 @@ namespace morph {
                 needs_render = true; // updates viewproj; uses this->scenetrans
             }
 
+            if (needs_render == true) { this->dirty = true; }
             return needs_render;
         }
 
@@ -1529,6 +1856,7 @@ namespace morph {
         {
             this->window_w = width;
             this->window_h = height;
+            this->dirty = true;
             return true; // needs_render
         }
 
@@ -1573,6 +1901,7 @@ namespace morph {
                 sceneview_rotn.rotate (this->rotation);
                 this->cyl_cam_pos += sceneview_rotn * scroll_move_y;
             }
+            this->dirty = true;
             return true; // needs_render
         }
 
@@ -38,20 +38,27 @@ namespace morph {
         };
 
         //! The locations for the position, normal and colour vertex attributes in the
-        //! morph::Visual GLSL programs
-        enum AttribLocn { posnLoc = 0, normLoc = 1, colLoc = 2, textureLoc = 3 };
+        //! morph::Visual GLSL programs. datumLoc is for colour map datums (see
+        //! VisualModel::datum_dims) and fixedColLoc for the fixed colours of vertices that are
+        //! not colour mapped. The inst* locations are the per-instance attributes of glyphs
+        //! (see VisualModel::make_glyph).
+        enum AttribLocn { posnLoc = 0, normLoc = 1, colLoc = 2, textureLoc = 3, datumLoc = 4,
+                          instPosnLoc = 5, instScaleLoc = 6, instRotnLoc = 7, instColLoc = 8,
+                          fixedColLoc = 9 };
 
         //! A struct to hold information about font glyph properties
         struct CharInfo
         {
-            //! ID handle of the glyph texture
-            unsigned int textureID;
+            //! ID handle of the atlas texture that holds the glyph
+            unsigned int textureID = 0;
             //! Size of glyph
-            morph::vec<int,2>  size;
+            morph::vec<int,2>  size = { 0, 0 };
             //! Offset from baseline to left/top of glyph
-            morph::vec<int,2>  bearing;
+            morph::vec<int,2>  bearing = { 0, 0 };
             //! Offset to advance to next glyph
-            unsigned int advance;
+            unsigned int advance = 0;
+            //! The glyph's texture coordinates in the atlas: left, top, right, bottom
+            morph::vec<float, 4> uv = { 0.0f, 0.0f, 0.0f, 0.0f };
         };
 
     } // namespace gl
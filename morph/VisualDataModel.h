@@ -4,10 +4,16 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <morph/vec.h>
 #include <morph/VisualModel.h>
 #include <morph/ColourMap.h>
 #include <morph/Scale.h>
+#include <algorithm>
+#include <cmath>
 
 namespace morph {
 
@@ -24,7 +30,11 @@ namespace morph {
             : morph::VisualModel<glver>::VisualModel (_offset) {}
 
         //! Deconstructor should *not* deallocate data - client code should do that
-        ~VisualDataModel() {}
+        ~VisualDataModel()
+        {
+            if (this->colourmap_texture != 0) { glDeleteTextures (1, &this->colourmap_texture); }
+            if (this->data_texture != 0) { glDeleteTextures (1, &this->data_texture); }
+        }
 
         //! Reset the autoscaled flags so that the next time data is transformed by
         //! the Scale objects they will autoscale again (assuming they have
@@ -56,13 +66,18 @@ namespace morph {
         void updateZScale (const Scale<T, float>& zscale)
         {
             this->zScale = zscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         void updateCScale (const Scale<T, float>& cscale)
         {
             this->colourScale = cscale;
-            this->reinit();
+            // When the shader applies colourScale, there is nothing to rebuild, but the model must be re-drawn
+            if (this->datum_dims > 0u && this->datum_dims == this->datum_dims_wanted() && this->colourScale.ready()) {
+                this->dirty = true;
+                return;
+            }
+            this->reinit_data();
         }
 
         void setVectorScale (const Scale<vec<T>>& vscale)
@@ -75,13 +90,15 @@ namespace morph {
         {
             this->cm.setHue (_hue);
             this->cm.setType (_cmt);
+            this->colourmap_stale = true;
+            this->dirty = true;
         }
 
         //! Update the scalar data
         void updateData (const std::vector<T>* _data)
         {
             this->scalarData = _data;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update the scalar data with an associated z-scaling
@@ -89,7 +106,7 @@ namespace morph {
         {
             this->scalarData = _data;
             this->zScale = zscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update the scalar data, along with both the z-scaling and the colour-scaling
@@ -98,7 +115,7 @@ namespace morph {
             this->scalarData = _data;
             this->zScale = zscale;
             this->colourScale = cscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update coordinate data and scalar data along with z-scaling for scalar data
@@ -133,7 +150,7 @@ namespace morph {
         void updateData (const std::vector<vec<T>>* _vectors)
         {
             this->vectorData = _vectors;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update both coordinate and vector data
@@ -144,6 +161,66 @@ namespace morph {
             this->reinit();
         }
 
+        /*!
+         * Re-create the model after a change to the data values or to the z or colour
+         * scaling (but not to the coordinates). If the derived class can recompute its
+         * colours (and z positions) in the existing vertices, only the vertex buffers are
+         * re-uploaded, otherwise this is a full reinit().
+         */
+        void reinit_data()
+        {
+            if (this->datum_dims != this->datum_dims_wanted() || this->update_data_in_place() == false) {
+                this->reinit();
+            }
+        }
+
+        /*!
+         * Set true (before finalize()) to have the colour map applied in the shader. The
+         * model then uploads one float per vertex (two for the two dimensional Duochrome, HSV
+         * and Disc colour maps) in place of an RGB colour, and cm is uploaded as a texture.
+         * Changes to colourScale then need no rebuild of the model, and after a change to cm
+         * with setColourMap(), only the texture is re-made. Only HexGridVisual, GridVisual and
+         * CartGridVisual implement this, and not for the three dimensional colour maps
+         * (RGB, Trichrome etc), which are still applied on the CPU.
+         */
+        bool gpu_colourmap = false;
+
+        /*!
+         * In the Texture modes of GridVisual and CartGridVisual, interpolate the data
+         * linearly between the element centres. If false, each element is drawn as a flat
+         * pixel.
+         */
+        bool data_texture_linear = false;
+
+        /*!
+         * Level of detail. If true, HexGridVisual and GridVisual draw a coarsened mesh, in
+         * which blocks of elements are merged into one with averaged data, whenever their
+         * elements would be smaller than lod_pixels on screen. The level is chosen again on
+         * each render, from the projected size of an element, so the full resolution mesh is
+         * only built when the view is zoomed in far enough to see it. With lod set, the mesh
+         * is first built in the first render() rather than in finalize().
+         */
+        bool lod = false;
+        //! The smallest on-screen size (in pixels) of an element before elements are merged
+        float lod_pixels = 2.0f;
+        //! The coarsest level of detail. At level L, elements are merged in blocks 2^L elements across.
+        unsigned int lod_max_level = 8u;
+        //! The level of detail of the current mesh. 0 is full resolution.
+        unsigned int get_lod_level() const { return this->lod_level; }
+
+        //! Choose the level of detail for the current view (rebuilding the model if it changes), then render
+        void render() override
+        {
+            // Hold mesh_mutex across any LOD rebuild and the draw; skip the model during a build on another thread
+            std::unique_lock<std::recursive_mutex> lk (this->mesh_mutex, std::try_to_lock);
+            if (lk.owns_lock() == false) { return; }
+            if (this->lod == true && this->hide == false && this->lod_supported() == true) {
+                const unsigned int lvl = this->lod_choose_level (this->lod_element_pixels());
+                if (this->lod_deferred == true || lvl != this->lod_level) { this->reinit(); }
+            }
+            VisualModel<glver>::render();
+        }
+
         //! All data models use a a colour map. Change the type/hue of this colour map
         //! object to generate different types of map.
         ColourMap<float> cm;
@@ -178,6 +255,340 @@ namespace morph {
         //! graph, quiver plot). Note fixed type of float, which is suitable for
         //! OpenGL coordinates. Not const as child code may resize or update content.
         std::vector<vec<float>>* dataCoords = nullptr;
+
+    protected:
+        //! True if the colour map is to be applied in the shader. Models with modes that need it can override.
+        virtual bool colourmap_in_shader() const { return this->gpu_colourmap; }
+
+        //! The number of colour map datums per vertex that colourmap_in_shader() gives for the current data and cm
+        unsigned int datum_dims_wanted()
+        {
+            if (this->colourmap_in_shader() == false) { return 0u; }
+            int nd = this->cm.numDatums();
+            if (nd == 1 && (this->scalarData != nullptr || this->vectorData != nullptr)) { return 1u; }
+            if (nd == 2 && this->vectorData != nullptr) { return 2u; }
+            return 0u;
+        }
+
+        //! Call at the start of initializeVertices() in models that can push datum_at() colours
+        void setup_datums()
+        {
+            this->datum_dims = this->datum_dims_wanted();
+            this->colourmap_stale = true;
+            this->data_texture_on = false;
+        }
+
+        /*!
+         * Draw the data from a w by h data texture (call from initializeVertices(), after
+         * setup_datums(), when datum_dims > 0). Texel t holds the datums of element
+         * elems[t], or of element t if elems is empty. The vertices then carry texture
+         * coordinates as their datums (see texcoord_at()) and the shader reads the datums
+         * from the texture.
+         */
+        void setup_data_texture (GLsizei w, GLsizei h, std::vector<std::size_t>&& elems = {})
+        {
+            this->data_texture_dims = { w, h };
+            this->data_texel_elems = std::move (elems);
+            this->data_texture_on = true;
+            this->fill_data_texels();
+        }
+
+        //! Copy the datums of the current data into data_texels, for upload on the next render
+        void fill_data_texels()
+        {
+            const unsigned int nc = this->datum_dims;
+            const std::int64_t nt = static_cast<std::int64_t>(this->data_texture_dims[0]) * this->data_texture_dims[1];
+            this->data_texels.resize (nc * nt);
+#pragma omp parallel for schedule(static)
+            for (std::int64_t t = 0; t < nt; ++t) {
+                std::array<float, 3> d = this->datum_at (this->data_texel_elems.empty() ? t : this->data_texel_elems[t]);
+                for (unsigned int c = 0; c < nc; ++c) { this->data_texels[nc * t + c] = d[c]; }
+            }
+            this->data_texels_stale = true;
+            this->dirty = true;
+        }
+
+        //! With the data texture, the vertex datums are the texture coordinates (u, v)
+        unsigned int datum_stride() const override { return this->data_texture_on ? 2u : this->datum_dims; }
+
+        //! The vertex 'colour' that carries the data texture coordinates (u, v)
+        static std::array<float, 3> texcoord_at (float u, float v) { return { u, v, VisualModel<glver>::datum_tag }; }
+
+        /*!
+         * The vertex 'colour' for element i of the data when datum_dims > 0. This holds the
+         * unscaled datum(s), which the shader scales with colourScale (and colourScale2).
+         */
+        std::array<float, 3> datum_at (std::size_t i) const
+        {
+            std::array<float, 3> d = { 0.0f, 0.0f, VisualModel<glver>::datum_tag };
+            if (this->scalarData != nullptr) {
+                d[0] = static_cast<float>((*this->scalarData)[i]);
+            } else if (this->vectorData != nullptr) {
+                d[0] = static_cast<float>((*this->vectorData)[i][0]);
+                d[1] = static_cast<float>((*this->vectorData)[i][1]);
+            }
+            return d;
+        }
+
+        //! Bind the colour map texture (re-making it if cm has changed) and set the colour map uniforms
+        void bind_colourmap (GLuint prog) override
+        {
+            glActiveTexture (GL_TEXTURE0 + colourmap_unit);
+            if (this->colourmap_texture == 0 || this->colourmap_stale == true) { this->make_colourmap_texture(); }
+            glBindTexture (GL_TEXTURE_2D, this->colourmap_texture);
+            GLint filter = 0;
+            if (this->data_texture_on == true) {
+                glActiveTexture (GL_TEXTURE0 + data_texture_unit);
+                if (this->data_texture == 0 || this->data_texels_stale == true) { this->upload_data_texture(); }
+                glBindTexture (GL_TEXTURE_2D, this->data_texture);
+                filter = this->data_texture_linear ? 2 : 1;
+            }
+            glActiveTexture (GL_TEXTURE0);
+
+            std::array<float, 4> sc = this->colourmap_scale();
+            std::array<GLint, 2> lg = { this->colourScale.getType() == ScaleFn::Logarithmic ? 1 : 0,
+                                        this->datum_dims > 1u && this->colourScale2.getType() == ScaleFn::Logarithmic ? 1 : 0 };
+            std::array<float, 3> nanclr = ColourMap<float>::nanColour (this->cm.getType());
+            GLint loc = glGetUniformLocation (prog, static_cast<const GLchar*>("colourmap"));
+            if (loc != -1) { glUniform1i (loc, colourmap_unit); }
+            loc = glGetUniformLocation (prog, static_cast<const GLchar*>("colourmap_scale"));
+            if (loc != -1) { glUniform4fv (loc, 1, sc.data()); }
+            loc = glGetUniformLocation (prog, static_cast<const GLchar*>("colourmap_log"));
+            if (loc != -1) { glUniform2iv (loc, 1, lg.data()); }
+            loc = glGetUniformLocation (prog, static_cast<const GLchar*>("colourmap_nan"));
+            if (loc != -1) { glUniform3fv (loc, 1, nanclr.data()); }
+            loc = glGetUniformLocation (prog, static_cast<const GLchar*>("datamap_filter"));
+            if (loc != -1) { glUniform1i (loc, filter); }
+            loc = glGetUniformLocation (prog, static_cast<const GLchar*>("datamap"));
+            if (loc != -1) { glUniform1i (loc, data_texture_unit); }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! The colour that the shader gives to the datums (d1, d2)
+        std::array<float, 3> datum_colour (float d1, float d2) override
+        {
+            if (this->data_texture_on == true) {
+                // (d1, d2) are texture coordinates; use the datums of the nearest texel
+                const GLsizei tw = this->data_texture_dims[0];
+                const GLsizei th = this->data_texture_dims[1];
+                const std::size_t tx = static_cast<std::size_t>(std::min (std::max (static_cast<GLsizei>(d1 * tw), 0), tw - 1));
+                const std::size_t ty = static_cast<std::size_t>(std::min (std::max (static_cast<GLsizei>(d2 * th), 0), th - 1));
+                const std::size_t t = (ty * tw + tx) * this->datum_dims;
+                d1 = this->data_texels[t];
+                d2 = this->datum_dims > 1u ? this->data_texels[t + 1u] : 0.0f;
+            }
+            std::array<float, 4> sc = this->colourmap_scale();
+            if (this->colourScale.getType() == ScaleFn::Logarithmic) { d1 = std::log (d1); }
+            if (this->datum_dims > 1u && this->colourScale2.getType() == ScaleFn::Logarithmic) { d2 = std::log (d2); }
+            if (std::isnan (d1) || std::isnan (d2)) { return ColourMap<float>::nanColour (this->cm.getType()); }
+            float s1 = std::min (std::max (d1 * sc[0] + sc[1], 0.0f), 1.0f);
+            float s2 = std::min (std::max (d2 * sc[2] + sc[3], 0.0f), 1.0f);
+            return this->datum_dims > 1u ? this->cm.convert (s1, s2) : this->cm.convert (s1);
+        }
+
+        //! The scaling (m1, c1, m2, c2) of the datums, from colourScale and colourScale2
+        std::array<float, 4> colourmap_scale()
+        {
+            std::array<float, 4> sc = { 1.0f, 0.0f, 0.0f, 0.0f };
+            if (this->colourScale.ready()) { sc[0] = this->colourScale.getParams(0); sc[1] = this->colourScale.getParams(1); }
+            if (this->datum_dims > 1u) {
+                sc[2] = 1.0f;
+                if (this->colourScale2.ready()) { sc[2] = this->colourScale2.getParams(0); sc[3] = this->colourScale2.getParams(1); }
+            }
+            return sc;
+        }
+
+        /*!
+         * Sample cm into the colour map texture; colourmap_width colours for a one
+         * dimensional map or colourmap_width2 squared for a two dimensional map. The shader
+         * interpolates linearly between the samples.
+         */
+        void make_colourmap_texture()
+        {
+            const bool twod = this->datum_dims > 1u;
+            const GLsizei w = twod ? colourmap_width2 : colourmap_width;
+            const GLsizei h = twod ? colourmap_width2 : 1;
+            std::vector<unsigned char> texels (4u * w * h, 255u);
+            for (GLsizei j = 0; j < h; ++j) {
+                for (GLsizei i = 0; i < w; ++i) {
+                    const float u = static_cast<float>(i) / static_cast<float>(w - 1);
+                    const float v = h > 1 ? static_cast<float>(j) / static_cast<float>(h - 1) : 0.0f;
+                    std::array<float, 3> c = twod ? this->cm.convert (u, v) : this->cm.convert (u);
+                    for (unsigned int k = 0; k < 3u; ++k) {
+                        texels[4u * (j * w + i) + k] = static_cast<unsigned char>(std::min (std::max (c[k], 0.0f), 1.0f) * 255.0f + 0.5f);
+                    }
+                }
+            }
+            if (this->colourmap_texture == 0) { glGenTextures (1, &this->colourmap_texture); }
+            glBindTexture (GL_TEXTURE_2D, this->colourmap_texture);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+            this->colourmap_stale = false;
+        }
+
+        /*!
+         * Upload data_texels to the data texture (R32F, or RG32F for two datums), with
+         * glTexSubImage2D if its size and format are unchanged. The shader filters the
+         * texture itself, with texelFetch, so float textures need not be filterable.
+         */
+        void upload_data_texture()
+        {
+            const GLsizei w = this->data_texture_dims[0];
+            const GLsizei h = this->data_texture_dims[1];
+            const GLenum fmt = this->datum_dims > 1u ? GL_RG : GL_RED;
+            glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+            if (this->data_texture != 0 && this->data_texture_uploaded == vec<GLsizei, 3>{ w, h, static_cast<GLsizei>(fmt) }) {
+                glBindTexture (GL_TEXTURE_2D, this->data_texture);
+                glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, w, h, fmt, GL_FLOAT, this->data_texels.data());
+            } else {
+                if (this->data_texture == 0) { glGenTextures (1, &this->data_texture); }
+                glBindTexture (GL_TEXTURE_2D, this->data_texture);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexImage2D (GL_TEXTURE_2D, 0, this->datum_dims > 1u ? GL_RG32F : GL_R32F, w, h, 0, fmt, GL_FLOAT, this->data_texels.data());
+                this->data_texture_uploaded = { w, h, static_cast<GLsizei>(fmt) };
+            }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+            this->data_texels_stale = false;
+        }
+
+        //! The texture unit that the colour map texture is bound to (text uses unit 0)
+        static constexpr GLint colourmap_unit = 1;
+        //! The number of samples of a one dimensional colour map
+        static constexpr GLsizei colourmap_width = 512;
+        //! The number of samples along each axis of a two dimensional colour map
+        static constexpr GLsizei colourmap_width2 = 128;
+        //! The colour map texture, made when first needed
+        GLuint colourmap_texture = 0;
+        //! True if cm may have changed since colourmap_texture was made
+        bool colourmap_stale = true;
+
+        //! The texture unit of the data texture
+        static constexpr GLint data_texture_unit = 2;
+        //! True if the model draws its data from the data texture
+        bool data_texture_on = false;
+        //! The width and height of the data texture
+        vec<GLsizei, 2> data_texture_dims = { 0, 0 };
+        //! The element whose datums each texel holds (empty for texel t holds element t)
+        std::vector<std::size_t> data_texel_elems;
+        //! The datums (datum_dims per texel) for the data texture
+        std::vector<float> data_texels;
+        //! True if data_texels has changed since it was uploaded
+        bool data_texels_stale = true;
+        //! The data texture, made when first needed
+        GLuint data_texture = 0;
+        //! The width, height and format last given to glTexImage2D for data_texture
+        vec<GLsizei, 3> data_texture_uploaded = { 0, 0, 0 };
+
+        //! The level of detail of the mesh made by the last initializeVertices()
+        unsigned int lod_level = 0u;
+        //! True if initializeVertices() left the mesh to be built in render(), once the projection is known
+        bool lod_deferred = false;
+
+        //! Override to return true in models that implement lod
+        virtual bool lod_supported() const { return false; }
+
+        //! Override to return the on-screen size (pixels) of the model's largest-looking elements at full resolution
+        virtual float lod_element_pixels() const { return -1.0f; }
+
+        /*!
+         * The level of detail for elements that are px pixels across on screen: the least
+         * level L at which 2^L * px >= lod_pixels. The current level is kept until the ideal
+         * level moves a quarter of a level beyond its range, so that the mesh is not rebuilt
+         * over and over by small zooms about a boundary.
+         */
+        unsigned int lod_choose_level (const float px) const
+        {
+            if (!(px > 0.0f) || px >= this->lod_pixels) { return 0u; } // includes unknown (negative) px
+            const float l = std::log2 (this->lod_pixels / px);
+            constexpr float hysteresis = 0.25f;
+            const float cur = static_cast<float>(this->lod_level);
+            if (this->lod_level > 0u && this->lod_level <= this->lod_max_level
+                && l > cur - 1.0f - hysteresis && l <= cur + hysteresis) {
+                return this->lod_level;
+            }
+            return std::min (static_cast<unsigned int>(std::ceil (l)), this->lod_max_level);
+        }
+
+        /*!
+         * Call at the start of initializeVertices() in models that implement lod. Sets
+         * lod_level for the current view and returns false if the mesh should not be built
+         * yet, because the projection with which it will be drawn is not yet known.
+         */
+        bool lod_setup()
+        {
+            this->lod_deferred = false;
+            if (this->lod == false || this->lod_supported() == false) {
+                this->lod_level = 0u;
+                return true;
+            }
+            if (!this->projection_known()) {
+                this->lod_deferred = true;
+                return false;
+            }
+            this->lod_level = this->lod_choose_level (this->lod_element_pixels());
+            return true;
+        }
+
+        /*!
+         * The mean z (of zsrc) and colour (from colour_of) of the elements in each of the
+         * nbins blocks of a coarsened mesh, where element i is in block lod_bins[i]. NaNs are
+         * left out of the means, unless all of a block's elements have them.
+         */
+        template <typename F>
+        void lod_means (const unsigned int nbins, const std::vector<float>& zsrc, F colour_of,
+                        std::vector<float>& z, std::vector<std::array<float, 3>>& clr) const
+        {
+            z.assign (nbins, 0.0f);
+            clr.assign (nbins, { 0.0f, 0.0f, 0.0f });
+            std::vector<unsigned int> nz (nbins, 0u);
+            std::vector<unsigned int> nc (nbins, 0u);
+            std::vector<float> nanz (nbins, 0.0f);
+            std::vector<std::array<float, 3>> nanclr (nbins, { 0.0f, 0.0f, 0.0f });
+            for (std::size_t i = 0; i < this->lod_bins.size(); ++i) {
+                const unsigned int b = this->lod_bins[i];
+                if (std::isnan (zsrc[i])) {
+                    nanz[b] = zsrc[i];
+                } else {
+                    z[b] += zsrc[i];
+                    ++nz[b];
+                }
+                std::array<float, 3> c = colour_of (i);
+                if (std::isnan (c[0]) || std::isnan (c[1]) || std::isnan (c[2])) {
+                    nanclr[b] = c;
+                    continue;
+                }
+                for (unsigned int j = 0; j < 3; ++j) { clr[b][j] += c[j]; }
+                ++nc[b];
+            }
+            for (unsigned int b = 0; b < nbins; ++b) {
+                z[b] = nz[b] == 0u ? nanz[b] : z[b] / static_cast<float>(nz[b]);
+                if (nc[b] == 0u) {
+                    clr[b] = nanclr[b];
+                } else {
+                    for (unsigned int j = 0; j < 3; ++j) { clr[b][j] /= static_cast<float>(nc[b]); }
+                }
+            }
+        }
+
+        //! The block (and vertex) of a coarsened mesh that each element is in, when lod_level > 0
+        std::vector<unsigned int> lod_bins;
+
+        /*!
+         * Override to recompute the vertex colours (and, if the data sets z, the vertex
+         * positions and normals) from the current data, without changing the number or
+         * order of the vertices, then re-upload them with reinit_colour_buffer() or
+         * reinit_vertex_buffers(). Return false if the model has to be re-created instead,
+         * for example because its layout differs from that of the last initializeVertices().
+         */
+        virtual bool update_data_in_place() { return false; }
     };
 
 } // namespace morph
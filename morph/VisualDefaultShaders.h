@@ -107,19 +107,74 @@ namespace morph {
     "uniform float alpha;\n"
     "layout(location = 0) in vec4 position;\n"
     "layout(location = 1) in vec4 normalin;\n"
+    "uniform int colourmap_dims;\n"
+    "uniform vec3 colourmap_nan;\n"
     "layout(location = 2) in vec3 color;\n"
+    "layout(location = 4) in highp vec2 datum;\n"
+    "layout(location = 9) in float fixed_rgb;\n"
     "out VERTEX\n"
     "{\n"
     "    vec4 normal;\n"
     "    vec4 color;\n"
     "    vec3 fragpos;\n"
+    "    highp vec2 datum;\n"
+    "    float mapped;\n"
+    "    flat vec4 facenormal;\n"
+    "    flat vec4 facecolor;\n"
+    "    flat highp vec2 facedatum;\n"
+    "    flat float facemapped;\n"
     "} vertex;\n"
+    "void datum_colour()\n"
+    "{\n"
+    "    vertex.datum = datum;\n"
+    "    vertex.mapped = 0.0;\n"
+    "    if (colourmap_dims > 0) {\n"
+    "        if (fixed_rgb > 0.0) {\n"
+    "            uint b = uint(fixed_rgb) - 1u;\n"
+    "            vertex.color.rgb = vec3(float((b >> 16) & 0xffu), float((b >> 8) & 0xffu), float(b & 0xffu)) / 255.0;\n"
+    "            vertex.datum = vec2(0.0);\n"
+    "        } else if (isnan (datum.x) || isnan (datum.y)) {\n"
+    "            vertex.color.rgb = colourmap_nan;\n"
+    "            vertex.datum = vec2(0.0);\n"
+    "        } else {\n"
+    "            vertex.color.rgb = vec3(0.0);\n"
+    "            vertex.mapped = 1.0;\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "void face_values()\n"
+    "{\n"
+    "    vertex.facenormal = vertex.normal;\n"
+    "    vertex.facecolor = vertex.color;\n"
+    "    vertex.facedatum = vertex.datum;\n"
+    "    vertex.facemapped = vertex.mapped;\n"
+    "}\n"
+    "uniform int instanced;\n"
+    "layout(location = 5) in vec3 inst_posn;\n"
+    "layout(location = 6) in vec3 inst_scale;\n"
+    "layout(location = 7) in vec4 inst_rotn;\n"
+    "layout(location = 8) in vec3 inst_colour;\n"
+    "vec3 quat_rotate (vec4 q, vec3 v) { return v + 2.0 * cross (q.xyz, cross (q.xyz, v) + q.w * v); }\n"
+    "void instance_transform (inout vec4 p, inout vec4 n, inout vec3 c)\n"
+    "{\n"
+    "    if (instanced != 0) {\n"
+    "        p = vec4(quat_rotate (inst_rotn, p.xyz * inst_scale) + inst_posn, 1.0);\n"
+    "        n = vec4(normalize (quat_rotate (inst_rotn, n.xyz / inst_scale)), 0.0);\n"
+    "        c = inst_colour;\n"
+    "    }\n"
+    "}\n"
     "void main()\n"
     "{\n"
-    "    gl_Position = (p_matrix * v_matrix * m_matrix * position);\n"
-    "    vertex.color = vec4(color, alpha);\n"
-    "    vertex.fragpos = vec3(m_matrix * position);\n"
-    "    vertex.normal = normalin;\n"
+    "    vec4 posn = position;\n"
+    "    vec4 nrm = normalin;\n"
+    "    vec3 clr = color;\n"
+    "    instance_transform (posn, nrm, clr);\n"
+    "    gl_Position = (p_matrix * v_matrix * m_matrix * posn);\n"
+    "    vertex.color = vec4(clr, alpha);\n"
+    "    vertex.fragpos = vec3(m_matrix * posn);\n"
+    "    vertex.normal = nrm;\n"
+    "    datum_colour();\n"
+    "    face_values();\n"
     "}\n";
 
     std::string getDefaultVtxShader (const int glver)
@@ -136,21 +191,66 @@ namespace morph {
     "    vec4 normal;\n"
     "    vec4 color;\n"
     "    vec3 fragpos;\n"
+    "    highp vec2 datum;\n"
+    "    float mapped;\n"
+    "    flat vec4 facenormal;\n"
+    "    flat vec4 facecolor;\n"
+    "    flat highp vec2 facedatum;\n"
+    "    flat float facemapped;\n"
     "} vertex;\n"
+    "uniform int colourmap_dims;\n"
+    "uniform sampler2D colourmap;\n"
+    "uniform highp vec4 colourmap_scale;\n"
+    "uniform ivec2 colourmap_log;\n"
+    "uniform vec3 colourmap_nan;\n"
+    "uniform int datamap_filter;\n"
+    "uniform highp sampler2D datamap;\n"
+    "highp vec2 sample_datamap (highp vec2 uv)\n"
+    "{\n"
+    "    ivec2 sz = textureSize (datamap, 0);\n"
+    "    highp vec2 p = uv * vec2(sz) - 0.5;\n"
+    "    if (datamap_filter == 1) {\n"
+    "        return texelFetch (datamap, clamp (ivec2(floor (p + 0.5)), ivec2(0), sz - 1), 0).rg;\n"
+    "    }\n"
+    "    ivec2 i0 = ivec2(floor (p));\n"
+    "    highp vec2 f = p - floor (p);\n"
+    "    ivec2 i1 = clamp (i0 + 1, ivec2(0), sz - 1);\n"
+    "    i0 = clamp (i0, ivec2(0), sz - 1);\n"
+    "    highp vec2 d0 = mix (texelFetch (datamap, i0, 0).rg, texelFetch (datamap, ivec2(i1.x, i0.y), 0).rg, f.x);\n"
+    "    highp vec2 d1 = mix (texelFetch (datamap, ivec2(i0.x, i1.y), 0).rg, texelFetch (datamap, i1, 0).rg, f.x);\n"
+    "    return mix (d0, d1, f.y);\n"
+    "}\n"
     "uniform vec3 light_colour;\n"
     "uniform float ambient_intensity;\n"
     "uniform vec3 diffuse_position;\n"
     "uniform float diffuse_intensity;\n"
+    "uniform int flat_faces;\n"
     "out vec4 finalcolor;\n"
     "void main()\n"
     "{\n"
-    "    vec3 norm = normalize(vec3(vertex.normal));\n"
+    "    bool ff = flat_faces != 0;\n"
+    "    vec4 vnormal = ff ? vertex.facenormal : vertex.normal;\n"
+    "    vec4 vcolor = ff ? vertex.facecolor : vertex.color;\n"
+    "    highp vec2 vdatum = ff ? vertex.facedatum : vertex.datum;\n"
+    "    float vmapped = ff ? vertex.facemapped : vertex.mapped;\n"
+    "    vec3 norm = normalize(vec3(vnormal));\n"
     "    vec3 light_dirn = normalize(diffuse_position - vertex.fragpos);\n"
     "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
     "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
     "    vec3 ambient = ambient_intensity * light_colour;\n"
-    "    vec3 result = (ambient+diffuse) * vec3(vertex.color);\n"
-    "    finalcolor = vec4(result, vertex.color.w);\n"
+    "    vec3 colour = vec3(vcolor);\n"
+    "    if (colourmap_dims > 0 && vmapped > 0.0) {\n"
+    "        highp vec2 dm = vdatum / vmapped;\n"
+    "        highp vec2 d = datamap_filter > 0 ? sample_datamap (dm) : dm;\n"
+    "        if (colourmap_log.x != 0) { d.x = log (d.x); }\n"
+    "        if (colourmap_log.y != 0) { d.y = log (d.y); }\n"
+    "        highp vec2 s = clamp (colourmap_scale.xz * d + colourmap_scale.yw, 0.0, 1.0);\n"
+    "        vec2 n = vec2(textureSize (colourmap, 0));\n"
+    "        vec3 mapped_colour = (isnan (d.x) || isnan (d.y)) ? colourmap_nan : texture (colourmap, (s * (n - 1.0) + 0.5) / n).rgb;\n"
+    "        colour += min (vmapped, 1.0) * mapped_colour;\n"
+    "    }\n"
+    "    vec3 result = (ambient+diffuse) * colour;\n"
+    "    finalcolor = vec4(result, vcolor.w);\n"
     "}\n";
 
     std::string getDefaultFragShader (const int glver)
@@ -214,19 +314,72 @@ namespace morph {
     "uniform vec4 cyl_cam_pos = vec4(0);\n"
     "layout(location = 0) in vec4 position;\n"
     "layout(location = 1) in vec4 normalin;\n"
+    "uniform int colourmap_dims;\n"
+    "uniform vec3 colourmap_nan;\n"
     "layout(location = 2) in vec3 color;\n"
+    "layout(location = 4) in highp vec2 datum;\n"
+    "layout(location = 9) in float fixed_rgb;\n"
     "out VERTEX\n"
     "{\n"
     "    vec4 normal;\n"
     "    vec4 color;\n"
     "    vec3 fragpos;\n"
+    "    highp vec2 datum;\n"
+    "    float mapped;\n"
+    "    flat vec4 facenormal;\n"
+    "    flat vec4 facecolor;\n"
+    "    flat highp vec2 facedatum;\n"
+    "    flat float facemapped;\n"
     "} vertex;\n"
+    "void datum_colour()\n"
+    "{\n"
+    "    vertex.datum = datum;\n"
+    "    vertex.mapped = 0.0;\n"
+    "    if (colourmap_dims > 0) {\n"
+    "        if (fixed_rgb > 0.0) {\n"
+    "            uint b = uint(fixed_rgb) - 1u;\n"
+    "            vertex.color.rgb = vec3(float((b >> 16) & 0xffu), float((b >> 8) & 0xffu), float(b & 0xffu)) / 255.0;\n"
+    "            vertex.datum = vec2(0.0);\n"
+    "        } else if (isnan (datum.x) || isnan (datum.y)) {\n"
+    "            vertex.color.rgb = colourmap_nan;\n"
+    "            vertex.datum = vec2(0.0);\n"
+    "        } else {\n"
+    "            vertex.color.rgb = vec3(0.0);\n"
+    "            vertex.mapped = 1.0;\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "void face_values()\n"
+    "{\n"
+    "    vertex.facenormal = vertex.normal;\n"
+    "    vertex.facecolor = vertex.color;\n"
+    "    vertex.facedatum = vertex.datum;\n"
+    "    vertex.facemapped = vertex.mapped;\n"
+    "}\n"
+    "uniform int instanced;\n"
+    "layout(location = 5) in vec3 inst_posn;\n"
+    "layout(location = 6) in vec3 inst_scale;\n"
+    "layout(location = 7) in vec4 inst_rotn;\n"
+    "layout(location = 8) in vec3 inst_colour;\n"
+    "vec3 quat_rotate (vec4 q, vec3 v) { return v + 2.0 * cross (q.xyz, cross (q.xyz, v) + q.w * v); }\n"
+    "void instance_transform (inout vec4 p, inout vec4 n, inout vec3 c)\n"
+    "{\n"
+    "    if (instanced != 0) {\n"
+    "        p = vec4(quat_rotate (inst_rotn, p.xyz * inst_scale) + inst_posn, 1.0);\n"
+    "        n = vec4(normalize (quat_rotate (inst_rotn, n.xyz / inst_scale)), 0.0);\n"
+    "        c = inst_colour;\n"
+    "    }\n"
+    "}\n"
     "void main()\n"
     "{\n"
+    "    vec4 posn = position;\n"
+    "    vec4 nrm = normalin;\n"
+    "    vec3 clr = color;\n"
+    "    instance_transform (posn, nrm, clr);\n"
     "    const float pi = 3.1415927;\n"
     "    const float two_pi = 6.283185307;\n"
     "    const float heading_offset = 1.570796327;\n"
-    "    vec4 pv = (v_matrix * m_matrix * position);\n"
+    "    vec4 pv = (v_matrix * m_matrix * posn);\n"
     "    vec4 ray = pv - (v_matrix * cyl_cam_pos);\n"
     "    vec3 rho_phi_z;\n"
     "    rho_phi_z[0] = sqrt (ray.x * ray.x + ray.y * ray.y);\n"
@@ -241,15 +394,17 @@ namespace morph {
     "        y_s = (cyl_radius * tan (theta)) / cyl_height;\n"
     "        gl_PointSize = 1;\n"
     "        gl_Position = vec4(x_s, y_s, -1.0, 1.0);\n"
-    "        vertex.color = vec4(color, alpha);\n"
-    "        vertex.fragpos = vec3(m_matrix * position);\n"
-    "        vertex.normal = normalin;\n"
+    "        vertex.color = vec4(clr, alpha);\n"
+    "        vertex.fragpos = vec3(m_matrix * posn);\n"
+    "        vertex.normal = nrm;\n"
     "    } else {\n"
     "        gl_Position = vec4(0.0, 0.0, -100.0, 1.0);\n"
-    "        vertex.color = vec4(color, 0.0);\n"
-    "        vertex.fragpos = vec3(m_matrix * position);\n"
-    "        vertex.normal = normalin;\n"
+    "        vertex.color = vec4(clr, 0.0);\n"
+    "        vertex.fragpos = vec3(m_matrix * posn);\n"
+    "        vertex.normal = nrm;\n"
     "    }\n"
+    "    datum_colour();\n"
+    "    face_values();\n"
     "}\n";
 
     std::string getDefaultCylVtxShader (const int glver)
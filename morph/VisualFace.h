@@ -2,7 +2,8 @@
  * \file
  *
  * Declares a VisualFace class to hold the information about a (Freetype-managed) font
- * face and the GL-textures that will reproduce it.
+ * face and the GL-textures that will reproduce it. Glyphs are rasterised when they are
+ * first used and packed into shared atlas textures.
  *
  * \author Seb James
  * \date November 2020
@@ -11,9 +12,13 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include <iostream>
 #include <utility>
 #include <fstream>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
 
 #include <morph/tools.h>
 #include <morph/VisualCommon.h> // for visgl::CharInfo
@@ -412,73 +417,150 @@ namespace morph {
 
                 FT_Set_Pixel_Sizes (this->face, 0, fontpixels);
 
-                // Can I check this->face for how many glyphs it has? Yes:
-                // std::cout << "This face has " << this->face->num_glyphs << " glyphs.\n";
-
-                // How far to loop. In principle, up to 21 bits worth - that's 2097151 possible characters!
-                for (char32_t c = 0; c < 2097151; c++) {
-                    // Check glyph index first, if it's 0 it's a blank so skip.
-                    if (FT_Get_Char_Index (this->face, c) == 0) { continue; }
+                // Glyphs are rasterised as they are first used, into atlas pages big enough for
+                // a few hundred glyphs at this size
+                GLint max_tex = 0;
+                glGetIntegerv (GL_MAX_TEXTURE_SIZE, &max_tex);
+                const int page_max = std::min (4096, std::max (max_tex, 256));
+                this->page_size = 256;
+                while (this->page_size < 16 * static_cast<int>(fontpixels + 2 * glyph_padding)
+                       && this->page_size < page_max) {
+                    this->page_size *= 2;
+                }
+            }
 
-                    // load character glyph
-                    if (FT_Load_Char (this->face, c, FT_LOAD_RENDER)) {
-                        std::cout << "ERROR::FREETYPE: Failed to load Glyph for Unicode 0x"
-                                  << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
-                        continue;
-                    }
+            //! The FT_Face is kept open so that glyphs can be rasterised as they are needed
+            ~VisualFace()
+            {
+                // The atlas textures go with the GL context, which is destroyed before the faces
+                if (this->face != nullptr) { FT_Done_Face (this->face); }
+            }
 
-                    // generate texture
-                    unsigned int texture;
-                    glGenTextures (1, &texture);
-                    glBindTexture (GL_TEXTURE_2D, texture);
-                    glTexImage2D(
-                        GL_TEXTURE_2D,
-                        0,
-                        GL_RED,
-                        this->face->glyph->bitmap.width,
-                        this->face->glyph->bitmap.rows,
-                        0,
-                        GL_RED,
-                        GL_UNSIGNED_BYTE,
-                        this->face->glyph->bitmap.buffer
-                        );
-                    // set texture options
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
-                    // now store character for later use
-                    morph::visgl::CharInfo glchar = {
-                        texture,
-                        {static_cast<int>(this->face->glyph->bitmap.width), static_cast<int>(this->face->glyph->bitmap.rows)}, // size
-                        {this->face->glyph->bitmap_left, this->face->glyph->bitmap_top}, // bearing
-                        static_cast<unsigned int>(this->face->glyph->advance.x)          // advance
-                    };
+            VisualFace (const VisualFace&) = delete;
+            VisualFace& operator= (const VisualFace&) = delete;
 
-                    if constexpr (debug_visualface == true) {
-                        std::cout << "Inserting character into this->glchars with info: ID:" << glchar.textureID
-                                  << ", Size:" << glchar.size << ", Bearing:" << glchar.bearing
-                                  << ", Advance:" << glchar.advance << std::endl;
+            /*!
+             * Return the info for the glyph for the Unicode character c, rasterising it into
+             * the atlas if this is its first use. This calls OpenGL, so the face's GL context
+             * must be current. A character that the font does not have gets an empty glyph.
+             */
+            const morph::visgl::CharInfo& glyph (const char32_t c)
+            {
+                auto gi = this->glchars.find (c);
+                if (gi != this->glchars.end()) { return gi->second; }
+
+                morph::visgl::CharInfo glchar = {};
+                // Check glyph index first, if it's 0 it's a blank.
+                if (this->face == nullptr || FT_Get_Char_Index (this->face, c) == 0) {
+                    return this->glchars.emplace (c, glchar).first->second;
+                }
+                // load character glyph
+                if (FT_Load_Char (this->face, c, FT_LOAD_RENDER)) {
+                    std::cout << "ERROR::FREETYPE: Failed to load Glyph for Unicode 0x"
+                              << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
+                    return this->glchars.emplace (c, glchar).first->second;
+                }
+
+                const FT_Bitmap& bm = this->face->glyph->bitmap;
+                const int w = static_cast<int>(bm.width);
+                const int h = static_cast<int>(bm.rows);
+                glchar.size = { w, h };
+                glchar.bearing = { this->face->glyph->bitmap_left, this->face->glyph->bitmap_top };
+                glchar.advance = static_cast<unsigned int>(this->face->glyph->advance.x);
+
+                if (w > 0 && h > 0) {
+                    morph::vec<int, 2> at = this->atlas_place (w, h);
+                    glBindTexture (GL_TEXTURE_2D, this->pages.back());
+                    // Rows are copied one at a time in case the bitmap's pitch is not its width
+                    for (int r = 0; r < h; ++r) {
+                        glTexSubImage2D (GL_TEXTURE_2D, 0, at[0], at[1] + r, w, 1, GL_RED, GL_UNSIGNED_BYTE,
+                                         bm.buffer + static_cast<std::ptrdiff_t>(r) * bm.pitch);
                     }
-                    this->glchars.insert (std::pair<char32_t, morph::visgl::CharInfo>(c, glchar));
+                    glBindTexture (GL_TEXTURE_2D, 0);
+                    const float ps = static_cast<float>(this->page_size);
+                    glchar.textureID = this->pages.back();
+                    glchar.uv = { at[0] / ps, at[1] / ps, (at[0] + w) / ps, (at[1] + h) / ps };
+                }
+
+                if constexpr (debug_visualface == true) {
+                    std::cout << "Inserting character into this->glchars with info: ID:" << glchar.textureID
+                              << ", Size:" << glchar.size << ", Bearing:" << glchar.bearing
+                              << ", Advance:" << glchar.advance << ", uv:" << glchar.uv << std::endl;
                 }
-                glBindTexture(GL_TEXTURE_2D, 0);
-                // At this point could FT_Done_Face() etc, I think. as we no longer do anything Freetypey with it.
-                FT_Done_Face (this->face);
+                return this->glchars.emplace (c, glchar).first->second;
             }
 
-            ~VisualFace() { /* GL deconstruction? */ }
+            //! The number of glyphs rasterised so far
+            std::size_t num_glyphs() const { return this->glchars.size(); }
+
+            //! The atlas page textures created so far
+            const std::vector<GLuint>& atlas_pages() const { return this->pages; }
 
             //! Set true for informational/debug messages
             static constexpr bool debug_visualface = false;
 
+            //! Empty texels between glyphs in the atlas, so that linear filtering does not bleed
+            static constexpr int glyph_padding = 1;
+
             //! The FT_Face that we're managing
-            FT_Face face;
+            FT_Face face = nullptr;
 
-            //! The OpenGL character info stuff
+        private:
+            //! The character info for the glyphs rasterised so far
             std::map<char32_t, morph::visgl::CharInfo> glchars;
 
-        private:
+            //! The atlas textures, each page_size square. Glyphs are added to the last one.
+            std::vector<GLuint> pages;
+            int page_size = 256;
+            //! The shelf packing position in the last page: the current shelf's left edge
+            //! for the next glyph, its top and its height so far
+            int shelf_x = 0;
+            int shelf_y = 0;
+            int shelf_h = 0;
+
+            //! Find room for a w by h glyph in the atlas, starting a new shelf or page if necessary
+            morph::vec<int, 2> atlas_place (const int w, const int h)
+            {
+                const int pw = w + glyph_padding;
+                const int ph = h + glyph_padding;
+                if (pw + glyph_padding > this->page_size || ph + glyph_padding > this->page_size) {
+                    throw std::runtime_error ("VisualFace: glyph is larger than the atlas page size");
+                }
+                if (!this->pages.empty() && this->shelf_x + pw + glyph_padding > this->page_size) {
+                    // Start a new shelf
+                    this->shelf_y += this->shelf_h;
+                    this->shelf_x = 0;
+                    this->shelf_h = 0;
+                }
+                if (this->pages.empty() || this->shelf_y + ph + glyph_padding > this->page_size) {
+                    this->add_page();
+                }
+                morph::vec<int, 2> at = { this->shelf_x + glyph_padding, this->shelf_y + glyph_padding };
+                this->shelf_x += pw;
+                this->shelf_h = std::max (this->shelf_h, ph);
+                return at;
+            }
+
+            //! Create a new, cleared, atlas page texture
+            void add_page()
+            {
+                GLuint texture = 0;
+                glGenTextures (1, &texture);
+                glBindTexture (GL_TEXTURE_2D, texture);
+                std::vector<unsigned char> blank (static_cast<std::size_t>(this->page_size) * this->page_size, 0u);
+                glTexImage2D (GL_TEXTURE_2D, 0, GL_R8, this->page_size, this->page_size, 0,
+                              GL_RED, GL_UNSIGNED_BYTE, blank.data());
+                // set texture options
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
+                glBindTexture (GL_TEXTURE_2D, 0);
+                this->pages.push_back (texture);
+                this->shelf_x = 0;
+                this->shelf_y = 0;
+                this->shelf_h = 0;
+            }
 
             //! Create a temporary font file at fontpath, using the embedded data
             //! starting from filestart and extending to filenend
@@ -0,0 +1,354 @@
+/*!
+ * \file
+ *
+ * CPU-side mesh building for VisualModels, with no OpenGL calls.
+ *
+ * A model whose mesh is made of many similar elements (the hexes of a HexGridVisual, the
+ * rectangles of a GridVisual and so on) can build the elements in parallel with
+ * morph::build_mesh_chunks. The elements are divided into contiguous chunks; each chunk is
+ * built into its own morph::mesh_chunk by one OpenMP thread, and the chunks are then joined,
+ * in order, onto the model's vertex and index arrays. The result is identical to building the
+ * elements one after another, whatever the number of threads.
+ *
+ * Also here is a cache of unit primitive meshes (spheres, tubes, cones and circles), so that
+ * the VisualModel::compute* functions that draw many of these need not recompute their
+ * trigonometry each time. A model copies a cached mesh into its arrays with
+ * morph::transform_append, which applies an affine transformation to a batch of vertices.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <morph/mathconst.h>
+#include <vector>
+#include <array>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+namespace morph {
+
+    /*!
+     * The vertices and indices of a contiguous run of mesh elements. Indices are numbered
+     * from the chunk's first vertex (0) and idx is the number of vertices pushed so far, just
+     * as VisualModel::idx is for the model's own arrays.
+     */
+    struct mesh_chunk
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> colors;
+        std::vector<unsigned int> indices;
+        unsigned int idx = 0u;
+    };
+
+    //! The number of elements per chunk in build_mesh_chunks. Fewer elements than this are built serially.
+    inline std::size_t mesh_chunk_elements = 4096u;
+
+    /*!
+     * Build n mesh elements in parallel. build_element (chunk, i) appends the vertices of
+     * element i to chunk.positions, chunk.normals and chunk.colors and its (chunk-local)
+     * indices to chunk.indices, advancing chunk.idx, and must not change anything else that
+     * is shared between elements. nv and ni are the expected numbers of vertices and indices
+     * per element, used to pre-allocate the chunks.
+     *
+     * The chunks are joined onto positions, normals, colors and indices, with their indices
+     * offset to follow the idx vertices that are already there; idx is then advanced past
+     * the new vertices.
+     */
+    template <typename F>
+    void build_mesh_chunks (const std::size_t n, F&& build_element,
+                            std::vector<float>& positions, std::vector<float>& normals,
+                            std::vector<float>& colors, std::vector<unsigned int>& indices,
+                            unsigned int& idx, const std::size_t nv = 0u, const std::size_t ni = 0u)
+    {
+        if (n == 0u) { return; }
+        const std::size_t per_chunk = std::max (mesh_chunk_elements, std::size_t{1});
+        const std::int64_t nchunks = static_cast<std::int64_t>((n + per_chunk - 1u) / per_chunk);
+        std::vector<mesh_chunk> chunks (nchunks);
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::int64_t c = 0; c < nchunks; ++c) {
+            const std::size_t i0 = static_cast<std::size_t>(c) * per_chunk;
+            const std::size_t i1 = std::min (i0 + per_chunk, n);
+            mesh_chunk& m = chunks[c];
+            m.positions.reserve (3u * nv * (i1 - i0));
+            m.normals.reserve (3u * nv * (i1 - i0));
+            m.colors.reserve (3u * nv * (i1 - i0));
+            m.indices.reserve (ni * (i1 - i0));
+            for (std::size_t i = i0; i < i1; ++i) { build_element (m, i); }
+        }
+
+        // Where each chunk goes in the model's arrays
+        std::vector<std::size_t> v0 (nchunks + 1, 0u);
+        std::vector<std::size_t> ii0 (nchunks + 1, 0u);
+        v0[0] = idx;
+        ii0[0] = indices.size();
+        for (std::int64_t c = 0; c < nchunks; ++c) {
+            v0[c + 1] = v0[c] + chunks[c].idx;
+            ii0[c + 1] = ii0[c] + chunks[c].indices.size();
+        }
+        positions.resize (3u * v0[nchunks]);
+        normals.resize (3u * v0[nchunks]);
+        colors.resize (3u * v0[nchunks]);
+        indices.resize (ii0[nchunks]);
+
+#pragma omp parallel for schedule(static)
+        for (std::int64_t c = 0; c < nchunks; ++c) {
+            const mesh_chunk& m = chunks[c];
+            std::copy (m.positions.begin(), m.positions.end(), positions.begin() + 3u * v0[c]);
+            std::copy (m.normals.begin(), m.normals.end(), normals.begin() + 3u * v0[c]);
+            std::copy (m.colors.begin(), m.colors.end(), colors.begin() + 3u * v0[c]);
+            const unsigned int base = static_cast<unsigned int>(v0[c]);
+            std::transform (m.indices.begin(), m.indices.end(), indices.begin() + ii0[c],
+                            [base](unsigned int i) { return base + i; });
+        }
+        idx = static_cast<unsigned int>(v0[nchunks]);
+    }
+
+    //! The unit primitives held by unit_mesh_cache
+    enum class unit_primitive
+    {
+        //! segments points (cos t, sin t, 0) around the unit circle. No indices.
+        circle,
+        //! The unit sphere of VisualModel::computeSphere. Its normals are its positions.
+        sphere,
+        /*!
+         * The tube of VisualModel::computeTube: a start cap centre, start cap ring, start side
+         * ring, end side ring, end cap ring and end cap centre. The ring points are (sin t,
+         * cos t, 0) and the centres (0, 0, 0); the first 2*segments+1 vertices are the start
+         * and the rest the end of the tube. The caps' normals are (0, 0, -1) and (0, 0, 1) and
+         * the sides' normals are the ring points.
+         */
+        tube,
+        /*!
+         * The cone of VisualModel::computeCone: the base centre (0, 0, 0), base ring and side
+         * ring, with ring points (sin t, cos t, 1), then the tip ring and tip, (0, 0, 0). The
+         * base normals are (0, 0, -1), the side and tip ring normals (sin t, cos t, 1) and the
+         * tip normal (0, 0, 1).
+         */
+        cone
+    };
+
+    //! A primitive mesh. Indices are numbered from the mesh's first vertex (0).
+    struct unit_mesh
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<unsigned int> indices;
+        std::size_t n_vertices() const { return this->positions.size() / 3u; }
+    };
+
+    namespace unit_meshes {
+
+        //! The angle of point j of a circle of n segments
+        inline float angle (const int j, const int n) { return j * morph::mathconst<float>::two_pi / static_cast<float>(n); }
+
+        inline void push (std::vector<float>& v, const float x, const float y, const float z)
+        {
+            v.push_back (x);
+            v.push_back (y);
+            v.push_back (z);
+        }
+
+        //! Indices for a triangle fan from vertex centre to the ring of n vertices from ring0
+        inline void fan (std::vector<unsigned int>& ind, const unsigned int centre, const unsigned int ring0, const int n)
+        {
+            for (int j = 0; j < n; j++) {
+                ind.push_back (centre);
+                ind.push_back (ring0 + j);
+                ind.push_back (j == n - 1 ? ring0 : ring0 + 1 + j);
+            }
+        }
+
+        //! Indices for nsections bands of quads between consecutive rings of n vertices from ring0
+        inline void bands (std::vector<unsigned int>& ind, const unsigned int ring0, const int n, const int nsections)
+        {
+            for (int lsection = 0; lsection < nsections; ++lsection) {
+                const unsigned int s0 = ring0 + lsection * n;
+                const unsigned int e0 = s0 + n;
+                for (int j = 0; j < n; j++) {
+                    const unsigned int jn = (j == n - 1) ? 0u : j + 1;
+                    ind.push_back (s0 + j);
+                    ind.push_back (s0 + jn);
+                    ind.push_back (e0 + j);
+                    ind.push_back (e0 + j);
+                    ind.push_back (e0 + jn);
+                    ind.push_back (s0 + jn);
+                }
+            }
+        }
+
+        //! Indices for the sphere's nrings bands between consecutive rings, with its winding
+        inline void sphere_bands (std::vector<unsigned int>& ind, const unsigned int ring0, const int n, const int nrings)
+        {
+            for (int i = 0; i < nrings; ++i) {
+                const unsigned int p0 = ring0 + i * n;
+                const unsigned int c0 = p0 + n;
+                for (int j = 0; j < n; j++) {
+                    const unsigned int jn = (j == n - 1) ? 0u : j + 1;
+                    ind.push_back (p0 + j);
+                    ind.push_back (c0 + j);
+                    ind.push_back (p0 + jn);
+                    ind.push_back (p0 + jn);
+                    ind.push_back (c0 + j);
+                    ind.push_back (c0 + jn);
+                }
+            }
+        }
+
+        inline unit_mesh circle (const int segments)
+        {
+            unit_mesh m;
+            for (int j = 0; j < segments; j++) {
+                const float t = angle (j, segments);
+                push (m.positions, std::cos (t), std::sin (t), 0.0f);
+                push (m.normals, 0.0f, 0.0f, 1.0f);
+            }
+            return m;
+        }
+
+        inline unit_mesh sphere (const int rings, const int segments)
+        {
+            unit_mesh m;
+            auto ring = [&m, segments](const float phi) {
+                const float z = std::sin (phi);
+                const float rr = std::cos (phi);
+                for (int j = 0; j < segments; j++) {
+                    const float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
+                    push (m.positions, std::cos (segment) * rr, std::sin (segment) * rr, z);
+                }
+            };
+            // Bottom cap centre (at z = -1), then rings 1 to rings-1, then the top cap centre
+            push (m.positions, 0.0f, 0.0f, std::sin (-morph::mathconst<float>::pi_over_2));
+            for (int i = 1; i < rings; i++) {
+                ring (morph::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings));
+            }
+            push (m.positions, 0.0f, 0.0f, std::sin (morph::mathconst<float>::pi_over_2));
+            m.normals = m.positions;
+            // The normals of the caps' centres are exactly on the axis
+            m.normals[2] = -1.0f;
+            m.normals.back() = 1.0f;
+
+            const unsigned int last = static_cast<unsigned int>(m.n_vertices()) - 1u;
+            fan (m.indices, 0u, 1u, segments);
+            sphere_bands (m.indices, 1u, segments, rings - 2);
+            fan (m.indices, last, last - segments, segments);
+            return m;
+        }
+
+        inline unit_mesh tube (const int segments)
+        {
+            unit_mesh m;
+            auto ring = [&m, segments](const bool cap, const float nz) {
+                for (int j = 0; j < segments; j++) {
+                    const float t = angle (j, segments);
+                    const float x = std::sin (t);
+                    const float y = std::cos (t);
+                    push (m.positions, x, y, 0.0f);
+                    if (cap) { push (m.normals, 0.0f, 0.0f, nz); } else { push (m.normals, x, y, 0.0f); }
+                }
+            };
+            push (m.positions, 0.0f, 0.0f, 0.0f);
+            push (m.normals, 0.0f, 0.0f, -1.0f);
+            ring (true, -1.0f);
+            ring (false, 0.0f);
+            ring (false, 0.0f);
+            ring (true, 1.0f);
+            push (m.positions, 0.0f, 0.0f, 0.0f);
+            push (m.normals, 0.0f, 0.0f, 1.0f);
+
+            const unsigned int last = static_cast<unsigned int>(m.n_vertices()) - 1u;
+            fan (m.indices, 0u, 1u, segments);
+            bands (m.indices, 1u, segments, 3);
+            fan (m.indices, last, 1u + 3u * segments, segments);
+            return m;
+        }
+
+        inline unit_mesh cone (const int segments)
+        {
+            unit_mesh m;
+            push (m.positions, 0.0f, 0.0f, 0.0f);
+            push (m.normals, 0.0f, 0.0f, -1.0f);
+            for (int r = 0; r < 3; ++r) {
+                for (int j = 0; j < segments; j++) {
+                    const float t = angle (j, segments);
+                    const float x = std::sin (t);
+                    const float y = std::cos (t);
+                    if (r < 2) { push (m.positions, x, y, 1.0f); } else { push (m.positions, 0.0f, 0.0f, 0.0f); }
+                    if (r == 0) { push (m.normals, 0.0f, 0.0f, -1.0f); } else { push (m.normals, x, y, 1.0f); }
+                }
+            }
+            push (m.positions, 0.0f, 0.0f, 0.0f);
+            push (m.normals, 0.0f, 0.0f, 1.0f);
+
+            const unsigned int last = static_cast<unsigned int>(m.n_vertices()) - 1u;
+            fan (m.indices, 0u, 1u, segments);
+            bands (m.indices, 1u, segments, 2);
+            fan (m.indices, last, 1u + 2u * segments, segments);
+            return m;
+        }
+
+    } // namespace unit_meshes
+
+    /*!
+     * The unit mesh of primitive p, with the given numbers of rings (used for spheres only) and
+     * segments. Meshes are made on first use and kept for the life of the program; this may be
+     * called from any thread.
+     */
+    inline const unit_mesh& unit_mesh_cache (const unit_primitive p, const int rings, const int segments)
+    {
+        static std::map<std::tuple<unit_primitive, int, int>, unit_mesh> cache;
+        static std::mutex cache_mutex;
+        const auto key = std::make_tuple (p, p == unit_primitive::sphere ? rings : 0, segments);
+        std::lock_guard<std::mutex> lock (cache_mutex);
+        auto m = cache.find (key);
+        if (m == cache.end()) {
+            unit_mesh um;
+            switch (p) {
+            case unit_primitive::circle: um = unit_meshes::circle (segments); break;
+            case unit_primitive::sphere: um = unit_meshes::sphere (rings, segments); break;
+            case unit_primitive::tube: um = unit_meshes::tube (segments); break;
+            case unit_primitive::cone: um = unit_meshes::cone (segments); break;
+            }
+            m = cache.emplace (key, std::move (um)).first;
+        }
+        return m->second;
+    }
+
+    /*!
+     * Append the n points from src (x, y, z triplets), each transformed to o + A p, to dst. A is
+     * a 3x3 matrix in column major order. If renormalize is true, each transformed point (a
+     * normal vector) is scaled to unit length.
+     */
+    inline void transform_append (const float* src, const std::size_t n,
+                                  const std::array<float, 3>& o, const std::array<float, 9>& A,
+                                  const bool renormalize, std::vector<float>& dst)
+    {
+        const std::size_t d0 = dst.size();
+        dst.resize (d0 + 3u * n);
+        float* d = dst.data() + d0;
+        for (std::size_t i = 0u; i < 3u * n; i += 3u) {
+            const float x = src[i];
+            const float y = src[i + 1u];
+            const float z = src[i + 2u];
+            d[i] = o[0] + A[0] * x + A[3] * y + A[6] * z;
+            d[i + 1u] = o[1] + A[1] * x + A[4] * y + A[7] * z;
+            d[i + 2u] = o[2] + A[2] * x + A[5] * y + A[8] * z;
+        }
+        if (renormalize) {
+            for (std::size_t i = 0u; i < 3u * n; i += 3u) {
+                const float len = std::sqrt (d[i] * d[i] + d[i + 1u] * d[i + 1u] + d[i + 2u] * d[i + 2u]);
+                const float s = len > 0.0f ? 1.0f / len : 0.0f;
+                d[i] *= s;
+                d[i + 1u] *= s;
+                d[i + 2u] *= s;
+            }
+        }
+    }
+
+} // namespace morph
@@ -35,6 +35,9 @@
 #include <morph/VisualCommon.h>
 #include <morph/VisualTextModel.h>
 #include <morph/VisualFace.h>
+#include <morph/VisualProfile.h>
+#include <morph/VisualMesh.h>
+#include <morph/halffloat.h>
 #include <morph/colour.h>
 #include <morph/base64.h>
 #include <iostream>
@@ -45,7 +48,15 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <utility>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
 
 // Switches on some changes where I carefully unbind gl buffers after calling
 // glBufferData() and rebind when changing the vertex model. Makes no difference on my
@@ -103,15 +114,121 @@ namespace morph {
         virtual ~VisualModel()
         {
             if (this->vbos != nullptr) {
+                for (auto& f : this->fences) { if (f != nullptr) { glDeleteSync (f); } }
                 glDeleteBuffers (numVBO, this->vbos.get());
                 glDeleteVertexArrays (1, &this->vao);
             }
+            if (this->time_queries[0] != 0u) { glDeleteQueries (2, this->time_queries.data()); }
         }
 
+        /*!
+         * If true, record the costs of this model (see morph::visual_model_profile). Set by
+         * Visual::setProfiling for the models it binds.
+         */
+        bool profiling = false;
+
+        /*!
+         * True if the model has changed since it was last drawn. The buffer upload
+         * functions (and so reinit(), updateData() and friends), finalize() and the setters
+         * for the model's view, alpha, size and visibility set this. Client code that changes
+         * the model in another way should set it too, if Visual::render_on_demand is used.
+         * It is atomic because build_mesh() may set it on a worker thread.
+         */
+        std::atomic<bool> dirty { true };
+
+        /*!
+         * True while build_mesh() is running. The model is not drawn (and Visual::render
+         * leaves it alone) until the build has finished.
+         */
+        std::atomic<bool> mesh_building { false };
+
+        /*!
+         * Held by build_mesh() while it re-creates the mesh, and by render() and the buffer
+         * upload functions while they read it, so that a build on a worker thread never
+         * changes the mesh under them. render() only tries to take it, and skips the model
+         * if a build holds it; the uploads wait for the build to finish. It is recursive
+         * because the uploads call each other (and render() may call them).
+         */
+        std::recursive_mutex mesh_mutex;
+
+        //! Return the costs of this model in the frame just rendered, and start recording the next frame
+        morph::visual_model_profile take_profile()
+        {
+            std::unique_lock<std::recursive_mutex> lk (this->mesh_mutex, std::try_to_lock);
+            if (lk.owns_lock() == false) { return morph::visual_model_profile{}; }
+            morph::visual_model_profile p = this->profile;
+            morph::visual_model_profile m = this->memory_profile();
+            p.n_vertices = m.n_vertices;
+            p.n_indices = m.n_indices;
+            p.buffer_bytes = m.buffer_bytes;
+            p.vertex_bytes = m.vertex_bytes;
+            p.index_bytes = m.index_bytes;
+            p.mesh_bytes = m.mesh_bytes;
+            this->profile = morph::visual_model_profile{};
+            return p;
+        }
+
+        //! Return the sizes of this model's mesh and buffers (the times in the returned profile are unset)
+        morph::visual_model_profile memory_profile() const
+        {
+            morph::visual_model_profile p;
+            p.n_vertices = this->vertexPositions.size() / 3u;
+            p.n_indices = this->indices.size();
+            for (auto c : this->buffer_capacity) { p.buffer_bytes += c; }
+            p.vertex_bytes = this->vertex_bytes;
+            p.index_bytes = this->index_bytes();
+            p.mesh_bytes = (this->vertexPositions.capacity() + this->vertexNormals.capacity()
+                            + this->vertexColors.capacity() + this->vertexDatums.capacity()
+                            + this->vertexFixedColours.capacity()) * sizeof(float)
+                           + this->indices.capacity() * sizeof(GLuint);
+            return p;
+        }
+
+        /*!
+         * Set true (before the first render) for models whose vertices are updated every
+         * frame. With OpenGL 4.4 or later, the position, normal and colour buffers are then
+         * created with persistent, coherent mappings, each divided into three regions. An
+         * update writes straight into the next region and re-points the vertex attributes at
+         * it, so the GPU can go on drawing from the other two regions. A wait (on a fence) is
+         * needed only if the region's draw from three updates ago has not completed. For
+         * earlier OpenGL versions, and for OpenGL ES, this is ignored and updates use
+         * glBufferSubData.
+         */
+        bool persistent_buffers = false;
+
+        /*!
+         * Set true to upload the vertices in a compact format, interleaved in one buffer
+         * object: positions as floats, normals packed into 10:10:10:2 signed normalized
+         * integers and colours as 8 bit RGBA. That is 20 bytes per vertex, in place of 36 in
+         * three separate buffers. If the model has no more than 65536 vertices, its indices
+         * are uploaded as 16 bit integers. The default shaders read the packed attributes
+         * unchanged. Models with colour map datums (datum_dims > 0) and persistently mapped
+         * buffers keep the float format for their vertices.
+         */
+        bool compact_vertices = false;
+
+        /*!
+         * If true, and compact_vertices is true, the positions of a flat, twodimensional model
+         * (one whose vertices all have the same z) are stored as half floats, for 16 bytes per
+         * vertex. Half floats have 11 significant bits, so this suits models whose coordinates
+         * are within a few units of the origin (a position of magnitude 10 is stored to within
+         * about 0.004). Models with relief, or with positions beyond the half float range,
+         * keep float positions.
+         */
+        bool half_positions = false;
+
         bool postVertexInitRequired = false;
+        /*!
+         * Set by build_mesh() when the mesh has changed but has not yet been uploaded. render()
+         * then uploads it (with reinit_buffers()) before drawing, so that it never draws the
+         * new mesh's index counts from the old buffers.
+         */
+        bool mesh_stale = false;
         //! Common code to call after the vertices have been set up. GL has to have been initialised.
         void postVertexInit()
         {
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
             // Do gl memory allocation of vertex array once only
             if (this->vbos == nullptr) {
                 // Create vertex array object
@@ -132,17 +249,13 @@ namespace morph {
             // Set up the indices buffer - bind and buffer the data in this->indices
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbos[idxVBO]);
             morph::gl::Util::checkError (__FILE__, __LINE__);
-
-            int sz = this->indices.size() * sizeof(GLuint);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
-            morph::gl::Util::checkError (__FILE__, __LINE__);
+            this->upload_indices();
 
             // Binds data from the "C++ world" to the OpenGL shader world for
             // "position", "normalin" and "color"
             // (bind, buffer and set vertex array object attribute)
-            this->setupVBO (this->vbos[posnVBO], this->vertexPositions, visgl::posnLoc);
-            this->setupVBO (this->vbos[normVBO], this->vertexNormals, visgl::normLoc);
-            this->setupVBO (this->vbos[colVBO], this->vertexColors, visgl::colLoc);
+            this->upload_vertices();
+            this->upload_instances();
 
 #ifdef CAREFULLY_UNBIND_AND_REBIND
             // Unbind only the vertex array (not the buffers, that causes GL_INVALID_ENUM errors)
@@ -150,6 +263,7 @@ namespace morph {
             morph::gl::Util::checkError (__FILE__, __LINE__);
 #endif
             this->postVertexInitRequired = false;
+            this->mesh_stale = false;
         }
 
         //! Initialize vertex buffer objects and vertex array object. Empty for 'text only' VisualModels.
@@ -162,6 +276,9 @@ namespace morph {
         void reinit_buffers()
         {
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
+            this->dirty = true;
             if (this->postVertexInitRequired == true) { this->postVertexInit(); }
             morph::gl::Util::checkError (__FILE__, __LINE__);
             // Now re-set up the VBOs
@@ -169,11 +286,10 @@ namespace morph {
             glBindVertexArray (this->vao);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbos[idxVBO]);
 #endif
-            int sz = this->indices.size() * sizeof(GLuint);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
-            this->setupVBO (this->vbos[posnVBO], this->vertexPositions, visgl::posnLoc);
-            this->setupVBO (this->vbos[normVBO], this->vertexNormals, visgl::normLoc);
-            this->setupVBO (this->vbos[colVBO], this->vertexColors, visgl::colLoc);
+            this->upload_indices();
+            this->upload_vertices();
+            this->upload_instances();
+            this->mesh_stale = false;
 
 #ifdef CAREFULLY_UNBIND_AND_REBIND
             glBindVertexArray(0);
@@ -181,33 +297,133 @@ namespace morph {
 #endif
         }
 
+        /*!
+         * Upload only the vertices and indices that client code has appended since the buffers
+         * were last filled; the vertices from number first_vertex and the indices from number
+         * first_index onwards. Buffer storage grows geometrically, so that appending a few
+         * vertices per frame costs time proportional to the number appended, rather than to
+         * the size of the whole model as with reinit_buffers(). The existing contents of
+         * vertexPositions/Normals/Colors and indices must not have changed.
+         */
+        void append_buffers (std::size_t first_vertex, std::size_t first_index)
+        {
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            // After build_mesh(), every buffer has to be uploaded
+            if (this->mesh_stale == true) { this->reinit_buffers(); return; }
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
+            this->dirty = true;
+            // postVertexInit uploads everything
+            if (this->postVertexInitRequired == true) { this->postVertexInit(); return; }
+            glBindVertexArray (this->vao);
+            if (this->buffers_mapped == true || this->datum_dims > 0u || this->compact_vertices == true
+                || this->short_indices == true) {
+                // Every region of the mapped buffers (or all of the datums, or the whole
+                // interleaved buffer, or indices whose type may change) has to be re-written anyway
+                this->upload_indices();
+                this->upload_vertices();
+                glBindVertexArray(0);
+                return;
+            }
+            this->append_to_buffer (GL_ELEMENT_ARRAY_BUFFER, idxVBO, this->indices.data(),
+                                    first_index * sizeof(GLuint), this->indices.size() * sizeof(GLuint));
+            this->append_to_buffer (GL_ARRAY_BUFFER, posnVBO, this->vertexPositions.data(),
+                                    3u * first_vertex * sizeof(float), this->vertexPositions.size() * sizeof(float));
+            this->append_to_buffer (GL_ARRAY_BUFFER, normVBO, this->vertexNormals.data(),
+                                    3u * first_vertex * sizeof(float), this->vertexNormals.size() * sizeof(float));
+            this->append_to_buffer (GL_ARRAY_BUFFER, colVBO, this->vertexColors.data(),
+                                    3u * first_vertex * sizeof(float), this->vertexColors.size() * sizeof(float));
+            glBindVertexArray(0);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
         //! reinit ONLY vertexColors buffer
         void reinit_colour_buffer()
         {
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            // After build_mesh(), every buffer has to be uploaded
+            if (this->mesh_stale == true) { this->reinit_buffers(); return; }
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
+            this->dirty = true;
             if (this->postVertexInitRequired == true) { this->postVertexInit(); }
             morph::gl::Util::checkError (__FILE__, __LINE__);
             // Now re-set up the VBOs
 #ifdef CAREFULLY_UNBIND_AND_REBIND // Experimenting with better buffer binding.
             glBindVertexArray (this->vao);
 #endif
-            this->setupVBO (this->vbos[colVBO], this->vertexColors, visgl::colLoc);
+            if (this->buffers_mapped == true || this->compact_layout() == true) {
+                // The new region (or the interleaved buffer) needs all of the vertex attributes
+                this->upload_vertices();
+            } else if (this->datum_dims > 0u) {
+                this->pack_datums();
+                this->setupVBO (datumVBO, this->vertexDatums, visgl::datumLoc, this->datum_stride());
+                this->setupVBO (fixedVBO, this->vertexFixedColours, visgl::fixedColLoc, 1);
+            } else {
+                this->setupVBO (colVBO, this->vertexColors, visgl::colLoc);
+            }
+
+#ifdef CAREFULLY_UNBIND_AND_REBIND
+            glBindVertexArray(0);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+#endif
+        }
 
+        /*!
+         * reinit the vertexPositions, vertexNormals and vertexColors buffers, but not the
+         * indices. For models that have changed their vertices in place, without adding or
+         * removing any.
+         */
+        void reinit_vertex_buffers()
+        {
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            // After build_mesh(), every buffer has to be uploaded
+            if (this->mesh_stale == true) { this->reinit_buffers(); return; }
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
+            this->dirty = true;
+            if (this->postVertexInitRequired == true) { this->postVertexInit(); }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+#ifdef CAREFULLY_UNBIND_AND_REBIND
+            glBindVertexArray (this->vao);
+#endif
+            this->upload_vertices();
 #ifdef CAREFULLY_UNBIND_AND_REBIND
             glBindVertexArray(0);
             morph::gl::Util::checkError (__FILE__, __LINE__);
 #endif
         }
 
+        /*!
+         * Re-upload only the instances of the model's glyphs. For models that have changed
+         * the instances (see instance_push) but not the glyph meshes.
+         */
+        void reinit_instance_buffer()
+        {
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            // After build_mesh(), every buffer has to be uploaded
+            if (this->mesh_stale == true) { this->reinit_buffers(); return; }
+            morph::profile_timer pt (this->profiling, this->profile.upload_ms, this->upload_depth);
+            this->dirty = true;
+            if (this->postVertexInitRequired == true) { this->postVertexInit(); return; }
+            glBindVertexArray (this->vao);
+            this->upload_instances();
+            glBindVertexArray(0);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
         void clearTexts() { this->texts.clear(); }
 
         //! Clear out the model, *including text models*
         void clear()
         {
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
+            this->glyphs.clear();
             this->clearTexts();
             this->idx = 0u;
             this->reinit_buffers();
@@ -217,17 +433,43 @@ namespace morph {
         void reinit()
         {
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
-            // Fixme: Better not to clear, then repeatedly pushback here:
-            this->vertexPositions.clear();
-            this->vertexNormals.clear();
-            this->vertexColors.clear();
-            this->indices.clear();
-            // NB: Do NOT call clearTexts() here! We're only updating the model itself.
-            this->idx = 0u;
-            this->initializeVertices();
+            this->build_mesh();
             this->reinit_buffers();
         }
 
+        /*!
+         * Re-create the model's mesh (its vertices, indices and glyphs, but not its texts)
+         * with initializeVertices(), without uploading it. This makes no OpenGL calls, so it
+         * may run on a worker thread while the scene is rendered on the main thread, as long
+         * as initializeVertices() adds no text labels (which need the GL context). It holds
+         * mesh_mutex throughout, so render() skips the model and the buffer uploads wait
+         * until it has finished. It leaves the model dirty and its mesh_stale, so the next
+         * render() uploads the new mesh before drawing it; or call reinit_buffers() on the
+         * thread that owns the GL context to upload it sooner. reinit() does both.
+         */
+        void build_mesh()
+        {
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            this->mesh_building = true;
+            try {
+                // Fixme: Better not to clear, then repeatedly pushback here:
+                this->vertexPositions.clear();
+                this->vertexNormals.clear();
+                this->vertexColors.clear();
+                this->indices.clear();
+                this->glyphs.clear();
+                // NB: Do NOT call clearTexts() here! We're only updating the model itself.
+                this->idx = 0u;
+                this->timed_initializeVertices();
+            } catch (...) {
+                this->mesh_building = false;
+                throw;
+            }
+            this->mesh_stale = true;
+            this->dirty = true;
+            this->mesh_building = false;
+        }
+
         /*!
          * For some models it's important to clear the texts when reinitialising. This is NOT the
          * same as VisualModel::clear() followed by initializeVertices(). For the same effect, you
@@ -236,13 +478,15 @@ namespace morph {
         void reinit_with_clearTexts()
         {
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
+            this->glyphs.clear();
             this->clearTexts();
             this->idx = 0u;
-            this->initializeVertices();
+            this->timed_initializeVertices();
             this->reinit_buffers();
         }
 
@@ -261,17 +505,26 @@ namespace morph {
         void finalize()
         {
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
-            this->initializeVertices();
+            std::lock_guard<std::recursive_mutex> lk (this->mesh_mutex);
+            this->timed_initializeVertices();
             this->postVertexInitRequired = true;
+            this->dirty = true;
         }
 
         //! Render the VisualModel
         virtual void render()
         {
-            if (this->hide == true) { return; }
+            // A model whose mesh is being built on another thread is not drawn
+            std::unique_lock<std::recursive_mutex> lk (this->mesh_mutex, std::try_to_lock);
+            if (this->hide == true || lk.owns_lock() == false) { return; }
 
             // Execute post-vertex init at render, as GL should be available.
             if (this->postVertexInitRequired == true) { this->postVertexInit(); }
+            // Upload a mesh that build_mesh() re-created on another thread
+            if (this->mesh_stale == true) { this->reinit_buffers(); }
+
+            morph::profile_timer pt (this->profiling, this->profile.draw_ms, this->draw_depth);
+            this->begin_gpu_timer();
 
             GLint prev_shader;
             glGetIntegerv (GL_CURRENT_PROGRAM, &prev_shader);
@@ -295,13 +548,44 @@ namespace morph {
                 GLint loc_m = glGetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("m_matrix"));
                 if (loc_m != -1) { glUniformMatrix4fv (loc_m, 1, GL_FALSE, (this->model_scaling * this->viewmatrix).mat.data()); }
 
+                // Colours from colour map datums are computed in the shader
+                GLint loc_cd = glGetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("colourmap_dims"));
+                if (loc_cd != -1) { glUniform1i (loc_cd, static_cast<GLint>(this->datum_dims)); }
+                if (this->datum_dims > 0u) { this->bind_colourmap (this->get_gprog(this->parentVis)); }
+
+                GLint loc_ff = glGetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("flat_faces"));
+                if (loc_ff != -1) { glUniform1i (loc_ff, this->flat_faces ? 1 : 0); }
+
                 if constexpr (debug_render) {
                     std::cout << "VisualModel::render: scenematrix:\n" << scenematrix << std::endl;
                     std::cout << "VisualModel::render: model viewmatrix:\n" << viewmatrix << std::endl;
                 }
 
-                // Draw the triangles
-                glDrawElements (GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0);
+                // Draw each glyph once per instance, then any other triangles
+                GLint loc_i = glGetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("instanced"));
+                std::size_t first_plain = 0u;
+                if (!this->glyphs.empty()) {
+                    if (loc_i != -1) { glUniform1i (loc_i, 1); }
+                    for (const glyph& g : this->glyphs) {
+                        first_plain = std::max (first_plain, g.first_index + g.n_indices);
+                        if (g.n_instances == 0u) { continue; }
+                        this->point_instance_attribs (g.first_instance);
+                        glDrawElementsInstanced (GL_TRIANGLES, static_cast<GLsizei>(g.n_indices), this->index_type,
+                                                 reinterpret_cast<void*>(g.first_index * this->index_bytes()),
+                                                 static_cast<GLsizei>(g.n_instances));
+                    }
+                }
+                if (loc_i != -1) { glUniform1i (loc_i, 0); }
+                if (first_plain < this->indices.size()) {
+                    glDrawElements (GL_TRIANGLES, static_cast<GLsizei>(this->indices.size() - first_plain), this->index_type,
+                                    reinterpret_cast<void*>(first_plain * this->index_bytes()));
+                }
+
+                // Mark the point at which the GPU has finished reading the current region
+                if (this->buffers_mapped == true) {
+                    if (this->fences[this->region] != nullptr) { glDeleteSync (this->fences[this->region]); }
+                    this->fences[this->region] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                }
 
                 // Unbind the VAO
                 glBindVertexArray(0);
@@ -314,6 +598,7 @@ namespace morph {
 
             glUseProgram (prev_shader);
 
+            this->end_gpu_timer();
             morph::gl::Util::checkError (__FILE__, __LINE__);
         }
 
@@ -377,7 +662,7 @@ namespace morph {
         }
 
         //! Setter for the viewmatrix
-        void setViewMatrix (const TransformMatrix<float>& mv) { this->viewmatrix = mv; }
+        void setViewMatrix (const TransformMatrix<float>& mv) { this->viewmatrix = mv; this->dirty = true; }
 
         //! When setting the scene matrix, also have to set the text's scene matrices.
         void setSceneMatrix (const TransformMatrix<float>& sv)
@@ -388,9 +673,43 @@ namespace morph {
             while (ti != this->texts.end()) { (*ti)->setSceneMatrix (sv); ti++; }
         }
 
+        //! Set the projection, and the size of the viewport in pixels, with which the model is drawn
+        void setProjection (const TransformMatrix<float>& p, const morph::vec<int, 2> vp)
+        {
+            this->projmatrix = p;
+            this->viewport = vp;
+        }
+
+        //! True once setProjection() has been called (by Visual::render)
+        bool projection_known() const { return this->viewport[0] > 0 && this->viewport[1] > 0; }
+
+        /*!
+         * The on-screen size, in pixels, of a length len along the model's x or y axis
+         * (whichever appears larger) at the model position p, given the projection and scene
+         * matrix of the last render. Returns -1 if no projection is known yet and infinity
+         * if p is not in front of the camera.
+         */
+        float projected_size (const morph::vec<float>& p, const float len) const
+        {
+            if (!this->projection_known()) { return -1.0f; }
+            const TransformMatrix<float> m = this->projmatrix * this->scenematrix * this->model_scaling * this->viewmatrix;
+            const morph::vec<float, 4> c0 = m * p;
+            const morph::vec<float, 4> cx = m * (p + morph::vec<float>{ len, 0.0f, 0.0f });
+            const morph::vec<float, 4> cy = m * (p + morph::vec<float>{ 0.0f, len, 0.0f });
+            if (c0[3] <= 0.0f || cx[3] <= 0.0f || cy[3] <= 0.0f) { return std::numeric_limits<float>::infinity(); }
+            // Normalized device coordinates span 2 across the viewport
+            auto pixels = [this, c0](const morph::vec<float, 4>& c) {
+                const float dx = 0.5f * static_cast<float>(this->viewport[0]) * (c[0] / c[3] - c0[0] / c0[3]);
+                const float dy = 0.5f * static_cast<float>(this->viewport[1]) * (c[1] / c[3] - c0[1] / c0[3]);
+                return std::sqrt (dx * dx + dy * dy);
+            };
+            return std::max (pixels (cx), pixels (cy));
+        }
+
         //! Set a translation into the scene and into any child texts
         void setSceneTranslation (const vec<float>& v0)
         {
+            this->dirty = true;
             this->scenematrix.setToIdentity();
             this->sv_offset = v0;
             this->scenematrix.translate (this->sv_offset);
@@ -402,6 +721,7 @@ namespace morph {
         //! Set a translation (only) into the scene view matrix
         void addSceneTranslation (const vec<float>& v0)
         {
+            this->dirty = true;
             this->sv_offset += v0;
             this->scenematrix.translate (v0);
         }
@@ -409,6 +729,7 @@ namespace morph {
         //! Set a rotation (only) into the scene view matrix
         void setSceneRotation (const Quaternion<float>& r)
         {
+            this->dirty = true;
             this->scenematrix.setToIdentity();
             this->sv_rotation = r;
             this->scenematrix.translate (this->sv_offset);
@@ -418,6 +739,7 @@ namespace morph {
         //! Add a rotation to the scene view matrix
         void addSceneRotation (const Quaternion<float>& r)
         {
+            this->dirty = true;
             this->sv_rotation.premultiply (r);
             this->scenematrix.rotate (r);
         }
@@ -425,6 +747,7 @@ namespace morph {
         //! Set a translation to the model view matrix
         void setViewTranslation (const vec<float>& v0)
         {
+            this->dirty = true;
             this->viewmatrix.setToIdentity();
             this->mv_offset = v0;
             this->viewmatrix.translate (this->mv_offset);
@@ -434,12 +757,14 @@ namespace morph {
         //! Add a translation to the model view matrix
         void addViewTranslation (const vec<float>& v0)
         {
+            this->dirty = true;
             this->mv_offset += v0;
             this->viewmatrix.translate (v0);
         }
 
         void setViewRotationFixTexts (const Quaternion<float>& r)
         {
+            this->dirty = true;
             this->viewmatrix.setToIdentity();
             this->mv_rotation = r;
             this->viewmatrix.translate (this->mv_offset);
@@ -449,6 +774,7 @@ namespace morph {
         //! Set a rotation (only) into the view
         void setViewRotation (const Quaternion<float>& r)
         {
+            this->dirty = true;
             this->viewmatrix.setToIdentity();
             this->mv_rotation = r;
             this->viewmatrix.translate (this->mv_offset);
@@ -473,6 +799,7 @@ namespace morph {
         //! Apply a further rotation to the model view matrix
         void addViewRotation (const Quaternion<float>& r)
         {
+            this->dirty = true;
             this->mv_rotation.premultiply (r);
             this->viewmatrix.rotate (r);
             std::cout << "VisualModel::addViewRotation: FIXME? or t->addSceneRotation(r)?\n";
@@ -481,22 +808,24 @@ namespace morph {
         }
 
         // The alpha attribute accessors
-        void setAlpha (const float _a) { this->alpha = _a; }
+        void setAlpha (const float _a) { this->alpha = _a; this->dirty = true; }
         float getAlpha() const { return this->alpha; }
         void incAlpha()
         {
+            this->dirty = true;
             this->alpha += 0.1f;
             this->alpha = this->alpha > 1.0f ? 1.0f : this->alpha;
         }
         void decAlpha()
         {
+            this->dirty = true;
             this->alpha -= 0.1f;
             this->alpha = this->alpha < 0.0f ? 0.0f : this->alpha;
         }
 
         // The hide attribute accessors
-        void setHide (const bool _h = true) { this->hide = _h; }
-        void toggleHide() { this->hide = this->hide ? false : true; }
+        void setHide (const bool _h = true) { this->hide = _h; this->dirty = true; }
+        void toggleHide() { this->hide = this->hide ? false : true; this->dirty = true; }
         float hidden() const { return this->hide; }
 
         /*
@@ -540,43 +869,77 @@ namespace morph {
 
         /*!
          * Compute the max and min values of indices and vertexPositions/Colors/Normals for use
-         * when saving gltf files
+         * when saving gltf files. The vertices and indices are searched in one pass, divided
+         * into chunks that are searched in parallel; the chunks' extents are then combined.
          */
         void computeVertexMaxMins()
         {
-            // Compute index maxmins
-            for (std::size_t i = 0u; i < this->indices.size(); ++i) {
-                idx_max = this->indices[i] > idx_max ? this->indices[i] : idx_max;
-                idx_min = this->indices[i] < idx_min ? this->indices[i] : idx_min;
-            }
-            // Check every 0th entry in vertex Positions, every 1st, etc for max in the
-
+            const std::size_t nv = this->vertexPositions.size() / 3u;
             if (this->vertexPositions.size() != this->vertexColors.size()
                 ||this->vertexPositions.size() != this->vertexNormals.size()) {
                 throw std::runtime_error ("Expect vertexPositions, Colors and Normals vectors all to have same size");
             }
-
-            for (std::size_t i = 0u; i < this->vertexPositions.size(); i+=3u) {
-                vpos_maxes[0] =  (vertexPositions[i] > vpos_maxes[0]) ? vertexPositions[i] : vpos_maxes[0];
-                vpos_maxes[1] =  (vertexPositions[i+1] > vpos_maxes[1]) ? vertexPositions[i+1] : vpos_maxes[1];
-                vpos_maxes[2] =  (vertexPositions[i+2] > vpos_maxes[2]) ? vertexPositions[i+2] : vpos_maxes[2];
-                vcol_maxes[0] =  (vertexColors[i] > vcol_maxes[0]) ? vertexColors[i] : vcol_maxes[0];
-                vcol_maxes[1] =  (vertexColors[i+1] > vcol_maxes[1]) ? vertexColors[i+1] : vcol_maxes[1];
-                vcol_maxes[2] =  (vertexColors[i+2] > vcol_maxes[2]) ? vertexColors[i+2] : vcol_maxes[2];
-                vnorm_maxes[0] =  (vertexNormals[i] > vnorm_maxes[0]) ? vertexNormals[i] : vnorm_maxes[0];
-                vnorm_maxes[1] =  (vertexNormals[i+1] > vnorm_maxes[1]) ? vertexNormals[i+1] : vnorm_maxes[1];
-                vnorm_maxes[2] =  (vertexNormals[i+2] > vnorm_maxes[2]) ? vertexNormals[i+2] : vnorm_maxes[2];
-
-                vpos_mins[0] =  (vertexPositions[i] < vpos_mins[0]) ? vertexPositions[i] : vpos_mins[0];
-                vpos_mins[1] =  (vertexPositions[i+1] < vpos_mins[1]) ? vertexPositions[i+1] : vpos_mins[1];
-                vpos_mins[2] =  (vertexPositions[i+2] < vpos_mins[2]) ? vertexPositions[i+2] : vpos_mins[2];
-                vcol_mins[0] =  (vertexColors[i] < vcol_mins[0]) ? vertexColors[i] : vcol_mins[0];
-                vcol_mins[1] =  (vertexColors[i+1] < vcol_mins[1]) ? vertexColors[i+1] : vcol_mins[1];
-                vcol_mins[2] =  (vertexColors[i+2] < vcol_mins[2]) ? vertexColors[i+2] : vcol_mins[2];
-                vnorm_mins[0] =  (vertexNormals[i] < vnorm_mins[0]) ? vertexNormals[i] : vnorm_mins[0];
-                vnorm_mins[1] =  (vertexNormals[i+1] < vnorm_mins[1]) ? vertexNormals[i+1] : vnorm_mins[1];
-                vnorm_mins[2] =  (vertexNormals[i+2] < vnorm_mins[2]) ? vertexNormals[i+2] : vnorm_mins[2];
+            const std::size_t ni = this->indices.size();
+
+            struct chunk_extents
+            {
+                morph::vec<float, 3> pmax = { _low, _low, _low };
+                morph::vec<float, 3> pmin = { _max, _max, _max };
+                morph::vec<float, 3> cmax = { _low, _low, _low };
+                morph::vec<float, 3> cmin = { _max, _max, _max };
+                morph::vec<float, 3> nmax = { _low, _low, _low };
+                morph::vec<float, 3> nmin = { _max, _max, _max };
+                GLuint imax = 0u;
+                GLuint imin = std::numeric_limits<GLuint>::max();
+            };
+            constexpr std::size_t per_chunk = 65536u;
+            const std::int64_t nchunks = static_cast<std::int64_t>((std::max (nv, ni) + per_chunk - 1u) / per_chunk);
+            std::vector<chunk_extents> ce (nchunks);
+
+#pragma omp parallel for schedule(static)
+            for (std::int64_t c = 0; c < nchunks; ++c) {
+                chunk_extents& e = ce[c];
+                const std::size_t c0 = static_cast<std::size_t>(c) * per_chunk;
+                for (std::size_t v = c0; v < std::min (c0 + per_chunk, nv); ++v) {
+                    const std::array<float, 3> col = this->export_colour (v);
+                    for (std::size_t j = 0u; j < 3u; ++j) {
+                        const float p = this->vertexPositions[3u * v + j];
+                        const float n = this->vertexNormals[3u * v + j];
+                        e.pmax[j] = p > e.pmax[j] ? p : e.pmax[j];
+                        e.pmin[j] = p < e.pmin[j] ? p : e.pmin[j];
+                        e.cmax[j] = col[j] > e.cmax[j] ? col[j] : e.cmax[j];
+                        e.cmin[j] = col[j] < e.cmin[j] ? col[j] : e.cmin[j];
+                        e.nmax[j] = n > e.nmax[j] ? n : e.nmax[j];
+                        e.nmin[j] = n < e.nmin[j] ? n : e.nmin[j];
+                    }
+                }
+                for (std::size_t i = c0; i < std::min (c0 + per_chunk, ni); ++i) {
+                    e.imax = this->indices[i] > e.imax ? this->indices[i] : e.imax;
+                    e.imin = this->indices[i] < e.imin ? this->indices[i] : e.imin;
+                }
             }
+
+            chunk_extents all;
+            for (const chunk_extents& e : ce) {
+                for (std::size_t j = 0u; j < 3u; ++j) {
+                    all.pmax[j] = std::max (all.pmax[j], e.pmax[j]);
+                    all.pmin[j] = std::min (all.pmin[j], e.pmin[j]);
+                    all.cmax[j] = std::max (all.cmax[j], e.cmax[j]);
+                    all.cmin[j] = std::min (all.cmin[j], e.cmin[j]);
+                    all.nmax[j] = std::max (all.nmax[j], e.nmax[j]);
+                    all.nmin[j] = std::min (all.nmin[j], e.nmin[j]);
+                }
+                all.imax = std::max (all.imax, e.imax);
+                all.imin = std::min (all.imin, e.imin);
+            }
+            this->vpos_maxes = all.pmax;
+            this->vpos_mins = all.pmin;
+            this->vcol_maxes = all.cmax;
+            this->vcol_mins = all.cmin;
+            this->vnorm_maxes = all.nmax;
+            this->vnorm_mins = all.nmin;
+            this->idx_max = all.imax;
+            this->idx_min = all.imin;
         }
 
         std::size_t vpos_size() { return this->vertexPositions.size(); }
@@ -597,6 +960,27 @@ namespace morph {
             }
             return base64::encode (_bytes);
         }
+        //! vertexColors, with the colours of any colour map datums (see datum_dims) computed
+        std::vector<float> export_colours()
+        {
+            std::vector<float> cols = this->vertexColors;
+            if (this->datum_dims == 0u) { return cols; }
+            for (std::size_t i = 0u; i + 2u < cols.size(); i += 3u) {
+                if (cols[i + 2u] != datum_tag) { continue; }
+                std::array<float, 3> c = this->datum_colour (cols[i], cols[i + 1u]);
+                std::copy (c.begin(), c.end(), cols.begin() + i);
+            }
+            return cols;
+        }
+
+        //! The exported colour of vertex v: its vertexColors entry or, for a colour map datum, its colour
+        std::array<float, 3> export_colour (const std::size_t v)
+        {
+            const float* c = this->vertexColors.data() + 3u * v;
+            if (this->datum_dims > 0u && c[2] == datum_tag) { return this->datum_colour (c[0], c[1]); }
+            return { c[0], c[1], c[2] };
+        }
+
         std::size_t vcol_size() { return this->vertexColors.size(); }
         std::string vcol_max() { return this->vcol_maxes.str_mat(); }
         std::string vcol_min() { return this->vcol_mins.str_mat(); }
@@ -606,7 +990,7 @@ namespace morph {
             std::vector<std::uint8_t> _bytes (this->vertexColors.size() << 2, 0);
             std::size_t b = 0u;
             float_bytes fb;
-            for (auto i : this->vertexColors) {
+            for (auto i : this->export_colours()) {
                 fb.f = i;
                 _bytes[b++] = fb.bytes[0];
                 _bytes[b++] = fb.bytes[1];
@@ -633,6 +1017,41 @@ namespace morph {
             }
             return base64::encode (_bytes);
         }
+
+        /*!
+         * Write the indices, vertexPositions, exported colours and vertexNormals, one after the
+         * other, to the binary chunk of a .glb file. The vectors are written straight from
+         * memory; only the colours of colour map datums are converted, a block at a time.
+         */
+        void write_glb_buffers (std::ostream& out)
+        {
+            // glTF binary data is little-endian
+            const std::uint16_t one = 1u;
+            if (*reinterpret_cast<const std::uint8_t*>(&one) != 1u) {
+                throw std::runtime_error ("VisualModel::write_glb_buffers: .glb output requires a little-endian host");
+            }
+            auto write_vector = [&out](const auto& vec) {
+                out.write (reinterpret_cast<const char*>(vec.data()), static_cast<std::streamsize>(vec.size() * sizeof (vec[0])));
+            };
+            write_vector (this->indices);
+            write_vector (this->vertexPositions);
+            if (this->datum_dims == 0u) {
+                write_vector (this->vertexColors);
+            } else {
+                constexpr std::size_t block_vertices = 4096u;
+                std::array<float, 3u * block_vertices> block;
+                const std::size_t nv = this->vertexColors.size() / 3u;
+                for (std::size_t v0 = 0u; v0 < nv; v0 += block_vertices) {
+                    const std::size_t n = std::min (block_vertices, nv - v0);
+                    for (std::size_t v = 0u; v < n; ++v) {
+                        const std::array<float, 3> c = this->export_colour (v0 + v);
+                        std::copy (c.begin(), c.end(), block.begin() + 3u * v);
+                    }
+                    out.write (reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(3u * n * sizeof (float)));
+                }
+            }
+            write_vector (this->vertexNormals);
+        }
         // end Visual::savegltf() methods
 
         //! If true, then this VisualModel should always be viewed in a plane - it's a 2D model
@@ -644,6 +1063,7 @@ namespace morph {
         //! Set scaling in all dimensions
         void setSizeScale (const float scl)
         {
+            this->dirty = true;
             this->model_scaling.setToIdentity();
             this->model_scaling[0] = scl;
             this->model_scaling[5] = scl;
@@ -652,6 +1072,7 @@ namespace morph {
         //! Set scaling in xy only
         void setSizeScale (const float xscl, const float yscl)
         {
+            this->dirty = true;
             this->model_scaling.setToIdentity();
             this->model_scaling[0] = xscl;
             this->model_scaling[5] = yscl;
@@ -683,6 +1104,10 @@ namespace morph {
         TransformMatrix<float> viewmatrix;
         //! The model-specific scene view matrix.
         TransformMatrix<float> scenematrix;
+        //! The projection of the last render (see setProjection())
+        TransformMatrix<float> projmatrix;
+        //! The size, in pixels, of the viewport of the last render
+        morph::vec<int, 2> viewport = { 0, 0 };
         //! An additional scaling applied to viewmatrix to scale the size of the model [see render()]
         TransformMatrix<float> model_scaling;
 
@@ -707,7 +1132,7 @@ namespace morph {
 
         //! This enum contains the positions within the vbo array of the different
         //! vertex buffer objects
-        enum VBOPos { posnVBO, normVBO, colVBO, idxVBO, numVBO };
+        enum VBOPos { posnVBO, normVBO, colVBO, datumVBO, fixedVBO, instVBO, idxVBO, numVBO };
 
         //! A unit vector in the x direction
         morph::vec<float, 3> ux = { 1.0f, 0.0f, 0.0f };
@@ -734,6 +1159,146 @@ namespace morph {
         std::vector<float> vertexNormals;
         //! CPU-side data for vertex colours
         std::vector<float> vertexColors;
+        /*!
+         * The number of colour map datums per vertex. If non-zero, the colour of each vertex
+         * whose vertexColors entry was made with datum_tag is computed in the shader from its
+         * datum(s) by the colour map texture that bind_colourmap() provides. vertexDatums and
+         * vertexFixedColours are uploaded in place of vertexColors.
+         */
+        unsigned int datum_dims = 0u;
+        //! Placed in the third element of a vertex colour to mark it as holding colour map datums
+        static constexpr float datum_tag = -1.0f;
+        //! The colour map datums of the vertices, datum_stride() per vertex (see pack_datums)
+        std::vector<float> vertexDatums;
+        /*!
+         * The colours of the vertices that are not colour mapped, for models with datum_dims >
+         * 0. Each is one plus the 24 bit RGB value of the colour, and 0 marks a colour mapped
+         * vertex. It is empty (and not uploaded) if every vertex is colour mapped.
+         */
+        std::vector<float> vertexFixedColours;
+        /*!
+         * If true, each triangle is drawn with the normal and colour of its last vertex (the
+         * 'provoking' vertex), with no interpolation across it. This lets a mesh share
+         * vertices between faces of different colours, as HexGridVisual's HexShared mode does.
+         */
+        bool flat_faces = false;
+        //! The size, in bytes, of the storage allocated to each of the buffer objects in vbos
+        std::array<std::size_t, numVBO> buffer_capacity = { 0u, 0u, 0u, 0u, 0u, 0u, 0u };
+        /*!
+         * If true, the indices are uploaded as 16 bit integers whenever the model has no more
+         * than 65536 vertices, as they are for compact_vertices models. For models with shared
+         * vertices, such as HexGridVisual's HexShared mode, whose indices are a large part of
+         * their buffers.
+         */
+        bool short_indices = false;
+        //! The type of the uploaded indices; GL_UNSIGNED_SHORT for small compact or short_indices models
+        GLenum index_type = GL_UNSIGNED_INT;
+        //! The bytes per vertex of the uploaded vertex attributes
+        std::size_t vertex_bytes = 0u;
+
+        /*!
+         * A glyph is a template mesh, made of the indices [first_index, first_index +
+         * n_indices), that render() draws once for each of its instances with
+         * glDrawElementsInstanced. Each instance has a position, a scale, a rotation and a
+         * colour, which the vertex shader applies to the template vertices (the template
+         * colours are not used).
+         */
+        struct glyph
+        {
+            std::size_t first_index = 0u;
+            std::size_t n_indices = 0u;
+            //! The instance attributes, instance_floats per instance
+            std::vector<float> instances;
+            //! The position of the first instance in the instance buffer
+            std::size_t first_instance = 0u;
+            //! The number of instances that were uploaded
+            std::size_t n_instances = 0u;
+        };
+        //! The glyphs of the model (see make_glyph)
+        std::vector<glyph> glyphs;
+        //! Floats per instance: position (3), scale (3), rotation quaternion (x, y, z, w) and colour (3)
+        static constexpr unsigned int instance_floats = 13u;
+
+        //! The number of regions in each persistently mapped buffer (see persistent_buffers)
+        static constexpr unsigned int n_regions = 3;
+        //! True if persistently mapped buffers can be used with this glver (OpenGL 4.4)
+        static constexpr bool persistent_capable = !morph::gl::version::gles (glver)
+        && (morph::gl::version::major (glver) > 4
+            || (morph::gl::version::major (glver) == 4 && morph::gl::version::minor (glver) >= 4));
+        //! True if the position, normal and colour buffers are persistently mapped
+        bool buffers_mapped = false;
+        //! The mapped storage of each buffer object (not instVBO or idxVBO)
+        std::array<char*, numVBO> mapped = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+        //! The size, in bytes, of one region of each mapped buffer
+        std::size_t region_bytes = 0u;
+        //! The region of the mapped buffers from which the vertex attributes are drawn
+        unsigned int region = 0u;
+        //! A fence for each region, placed after its most recent draw
+        std::array<GLsync, n_regions> fences = { nullptr, nullptr, nullptr };
+
+        //! The costs recorded so far in this frame, if profiling
+        morph::visual_model_profile profile;
+        //! Nesting depth of the upload and draw timers (see profile_timer)
+        unsigned int upload_depth = 0u;
+        unsigned int draw_depth = 0u;
+        //! Two GL_TIME_ELAPSED queries, used alternately so that reading a result never stalls
+        std::array<GLuint, 2> time_queries = { 0u, 0u };
+        //! True for each query that has been ended and whose result has not yet been read
+        std::array<bool, 2> query_issued = { false, false };
+        //! The number of queries issued. The next query to use is time_queries[query_count % 2].
+        unsigned int query_count = 0u;
+        //! True while this model's query is running
+        bool query_running = false;
+        //! True while any model's query is running (GL_TIME_ELAPSED queries can't be nested)
+        static inline bool any_query_running = false;
+
+        //! Call initializeVertices(), timing it if profiling
+        void timed_initializeVertices()
+        {
+            unsigned int depth = 0u;
+            morph::profile_timer pt (this->profiling, this->profile.vertices_ms, depth);
+            this->initializeVertices();
+        }
+
+        /*!
+         * Start timing this model's draw calls on the GPU. First, the result of the query
+         * issued two frames ago is read, if it is available. If it is not, this frame isn't
+         * timed, so that the CPU never waits for the GPU. There are no timer queries in
+         * OpenGL ES 3.x.
+         */
+        void begin_gpu_timer()
+        {
+            if constexpr (morph::gl::version::gles (glver) == false) {
+                if (this->profiling == false || any_query_running == true) { return; }
+                if (this->time_queries[0] == 0u) { glGenQueries (2, this->time_queries.data()); }
+                const unsigned int q = this->query_count % 2u;
+                if (this->query_issued[q] == true) {
+                    GLint available = 0;
+                    glGetQueryObjectiv (this->time_queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+                    if (available == 0) { return; }
+                    GLuint64 ns = 0u;
+                    glGetQueryObjectui64v (this->time_queries[q], GL_QUERY_RESULT, &ns);
+                    this->profile.gpu_ms = static_cast<double>(ns) * 1.0e-6;
+                    this->query_issued[q] = false;
+                }
+                glBeginQuery (GL_TIME_ELAPSED, this->time_queries[q]);
+                this->query_running = true;
+                any_query_running = true;
+            }
+        }
+
+        //! Stop the GPU timer started by begin_gpu_timer
+        void end_gpu_timer()
+        {
+            if constexpr (morph::gl::version::gles (glver) == false) {
+                if (this->query_running == false) { return; }
+                glEndQuery (GL_TIME_ELAPSED);
+                this->query_running = false;
+                any_query_running = false;
+                this->query_issued[this->query_count % 2u] = true;
+                ++this->query_count;
+            }
+        }
 
         static constexpr float _max = std::numeric_limits<float>::max();
         static constexpr float _low = std::numeric_limits<float>::lowest();
@@ -779,181 +1344,542 @@ namespace morph {
             std::copy (vec.begin(), vec.end(), std::back_inserter (vp));
         }
 
-        //! Set up a vertex buffer object - bind, buffer and set vertex array object attribute
-        void setupVBO (GLuint& buf, std::vector<float>& dat, unsigned int bufferAttribPosition)
+        //! Overwrite the three floats for vertex number vi in \a vp
+        void vertex_set (std::size_t vi, const std::array<float, 3>& arr, std::vector<float>& vp)
         {
-            int sz = dat.size() * sizeof(float);
-            glBindBuffer (GL_ARRAY_BUFFER, buf);
-            morph::gl::Util::checkError (__FILE__, __LINE__);
-            glBufferData (GL_ARRAY_BUFFER, sz, dat.data(), GL_STATIC_DRAW);
-            morph::gl::Util::checkError (__FILE__, __LINE__);
-            glVertexAttribPointer (bufferAttribPosition, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
-            morph::gl::Util::checkError (__FILE__, __LINE__);
-            glEnableVertexAttribArray (bufferAttribPosition);
-            morph::gl::Util::checkError (__FILE__, __LINE__);
+            std::copy (arr.begin(), arr.end(), vp.begin() + 3u * vi);
+        }
+
+        //! Push n copies of the colour clr onto vertexColors
+        void colour_append (const std::size_t n, const std::array<float, 3>& clr)
+        {
+            const std::size_t c0 = this->vertexColors.size();
+            this->vertexColors.resize (c0 + 3u * n);
+            for (std::size_t i = c0; i < this->vertexColors.size(); i += 3u) {
+                std::copy (clr.begin(), clr.end(), this->vertexColors.begin() + i);
+            }
+        }
+
+        //! Push the indices of the unit mesh um, for its vertices from this->idx, and advance idx past them
+        void unit_mesh_indices (const morph::unit_mesh& um)
+        {
+            const std::size_t i0 = this->indices.size();
+            this->indices.resize (i0 + um.indices.size());
+            const GLuint base = this->idx;
+            std::transform (um.indices.begin(), um.indices.end(), this->indices.begin() + i0,
+                            [base](unsigned int i) { return base + i; });
+            this->idx += static_cast<GLuint>(um.n_vertices());
+        }
+
+        //! A randomly oriented unit vector perpendicular to v
+        static vec<float> random_perpendicular (const vec<float>& v)
+        {
+            // One generator per thread, as seeding one for each tube or cone would be costly
+            thread_local morph::RandUniform<float> ru;
+            vec<float> rand_vec;
+            ru.get (rand_vec);
+            vec<float> inplane = rand_vec.cross (v);
+            inplane.renormalize();
+            return inplane;
         }
 
         /*!
-         * Create a tube from \a start to \a end, with radius \a r and a colour which
-         * transitions from the colour \a colStart to \a colEnd.
-         *
-         * This version simply sub-calls into computeFlaredTube which will randomly choose the angle
-         * of the vertices around the centre of each end cap.
-         *
-         * \param idx The index into the 'vertex array'
-         * \param start The start of the tube
-         * \param end The end of the tube
-         * \param colStart The tube starting colour
-         * \param colEnd The tube's ending colour
-         * \param r Radius of the tube
-         * \param segments Number of segments used to render the tube
+         * Append the cached unit tube from start (radius r, colour colStart) to end (radius r_end,
+         * colour colEnd). The vertices of its rings are placed at ux * sin(t) + uy * cos(t) times
+         * the radius from each end. v is the unit vector from start to end.
          */
-        void computeTube (vec<float> start, vec<float> end,
-                          std::array<float, 3> colStart, std::array<float, 3> colEnd,
-                          float r = 1.0f, int segments = 12)
-        {
-            this->computeFlaredTube (start, end, colStart, colEnd, r, r, segments);
+        void append_tube (const vec<float>& start, const vec<float>& end,
+                          const vec<float>& ux, const vec<float>& uy, const vec<float>& v,
+                          const std::array<float, 3>& colStart, const std::array<float, 3>& colEnd,
+                          const float r, const float r_end, const int segments)
+        {
+            const morph::unit_mesh& um = morph::unit_mesh_cache (morph::unit_primitive::tube, 0, segments);
+            const std::size_t n = um.n_vertices();
+            const std::size_t n_start = 1u + 2u * static_cast<std::size_t>(segments);
+            const std::array<float, 9> A0 = { ux[0] * r, ux[1] * r, ux[2] * r, uy[0] * r, uy[1] * r, uy[2] * r, 0.0f, 0.0f, 0.0f };
+            const std::array<float, 9> A1 = { ux[0] * r_end, ux[1] * r_end, ux[2] * r_end,
+                                              uy[0] * r_end, uy[1] * r_end, uy[2] * r_end, 0.0f, 0.0f, 0.0f };
+            morph::transform_append (um.positions.data(), n_start, start, A0, false, this->vertexPositions);
+            morph::transform_append (um.positions.data() + 3u * n_start, n - n_start, end, A1, false, this->vertexPositions);
+            // The caps' normals are -v and v; the sides' normals point out from the axis
+            const std::array<float, 9> B = { ux[0], ux[1], ux[2], uy[0], uy[1], uy[2], v[0], v[1], v[2] };
+            morph::transform_append (um.normals.data(), n, { 0.0f, 0.0f, 0.0f }, B, true, this->vertexNormals);
+            this->colour_append (n_start, colStart);
+            this->colour_append (n - n_start, colEnd);
+            this->unit_mesh_indices (um);
         }
 
         /*!
-         * Compute a tube. This version requires unit vectors for orientation of the
-         * tube end faces/vertices (useful for graph markers). The other version uses a
-         * randomly chosen vector to do this.
-         *
-         * Create a tube from \a start to \a end, with radius \a r and a colour which
-         * transitions from the colour \a colStart to \a colEnd.
-         *
-         * \param start The start of the tube
-         * \param end The end of the tube
-         * \param _ux a vector in the x axis direction for the end face
-         * \param _uy a vector in the y axis direction
-         * \param colStart The tube starting colour
-         * \param colEnd The tube's ending colour
-         * \param r Radius of the tube
-         * \param segments Number of segments used to render the tube
-         * \param rotation A rotation in the _ux/_uy plane to orient the vertices of the
-         * tube. Useful if this is to be a short tube used as a graph marker.
+         * Append n elements to the mesh, building them in parallel with
+         * morph::build_mesh_chunks. build_element (chunk, i) pushes the vertices and
+         * chunk-local indices of element i into chunk (see morph::mesh_chunk). nv and ni are
+         * the expected numbers of vertices and indices per element.
          */
-        void computeTube (vec<float> start, vec<float> end,
-                          vec<float> _ux, vec<float> _uy,
-                          std::array<float, 3> colStart, std::array<float, 3> colEnd,
-                          float r = 1.0f, int segments = 12, float rotation = 0.0f)
+        template <typename F>
+        void build_elements (std::size_t n, F&& build_element, std::size_t nv = 0u, std::size_t ni = 0u)
         {
-            // The vector from start to end defines direction of the tube
-            vec<float> vstart = start;
-            vec<float> vend = end;
-
-            // v is a face normal
-            vec<float> v = _uy.cross(_ux);
-            v.renormalize();
-
-            // Push the central point of the start cap - this is at location vstart
-            this->vertex_push (vstart, this->vertexPositions);
-            this->vertex_push (-v, this->vertexNormals);
-            this->vertex_push (colStart, this->vertexColors);
+            morph::build_mesh_chunks (n, std::forward<F>(build_element), this->vertexPositions, this->vertexNormals,
+                                      this->vertexColors, this->indices, this->idx, nv, ni);
+        }
 
-            // Start cap vertices (a triangle fan)
-            for (int j = 0; j < segments; j++) {
-                // t is the angle of the segment
-                float t = rotation + j * morph::mathconst<float>::two_pi/(float)segments;
-                vec<float> c = _ux * sin(t) * r + _uy * cos(t) * r;
-                this->vertex_push (vstart+c, this->vertexPositions);
-                this->vertex_push (-v, this->vertexNormals);
-                this->vertex_push (colStart, this->vertexColors);
+        /*!
+         * Copy bytes [from, to) of dat into the buffer object vbos[b], which is bound to
+         * target. If the buffer's storage is too small, it is re-allocated at (at least) twice
+         * its previous size and all of bytes [0, to) are copied.
+         */
+        void append_to_buffer (GLenum target, VBOPos b, const void* dat, std::size_t from, std::size_t to)
+        {
+            glBindBuffer (target, this->vbos[b]);
+            if (to > this->buffer_capacity[b]) {
+                std::size_t cap = std::max (to, std::max (std::size_t{4096}, 2u * this->buffer_capacity[b]));
+                glBufferData (target, cap, nullptr, GL_DYNAMIC_DRAW);
+                this->buffer_capacity[b] = cap;
+                from = 0;
+            }
+            if (to > from) {
+                glBufferSubData (target, from, to - from, static_cast<const char*>(dat) + from);
             }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
 
-            // Intermediate, near start cap. Normals point in direction c
-            for (int j = 0; j < segments; j++) {
-                float t = rotation + j * morph::mathconst<float>::two_pi/(float)segments;
-                vec<float> c = _ux * sin(t) * r + _uy * cos(t) * r;
-                this->vertex_push (vstart+c, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (colStart, this->vertexColors);
+        /*!
+         * Copy sz bytes from dat into the buffer object vbos[b], which is bound to target. If
+         * they fit in the storage that the buffer already has, they are copied with
+         * glBufferSubData. Otherwise (or if the storage is over four times larger than
+         * needed) the storage is re-allocated to fit.
+         */
+        void upload_buffer (GLenum target, VBOPos b, const void* dat, std::size_t sz)
+        {
+            std::size_t cap = this->buffer_capacity[b];
+            if (sz > cap || sz < cap / 4u) {
+                // A buffer that is re-allocated belongs to a model that changes
+                glBufferData (target, sz, dat, cap == 0u ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+                this->buffer_capacity[b] = sz;
+            } else if (sz > 0u) {
+                glBufferSubData (target, 0, sz, dat);
             }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
 
-            // Intermediate, near end cap. Normals point in direction c
-            for (int j = 0; j < segments; j++) {
-                float t = rotation + (float)j * morph::mathconst<float>::two_pi/(float)segments;
-                vec<float> c = _ux * sin(t) * r + _uy * cos(t) * r;
-                this->vertex_push (vend+c, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (colEnd, this->vertexColors);
+        /*!
+         * Set up a vertex buffer object - bind, buffer and set vertex array object attribute,
+         * with ncomp components per vertex. An empty dat disables the attribute, so that the
+         * shader sees its default value.
+         */
+        void setupVBO (VBOPos b, const std::vector<float>& dat, unsigned int bufferAttribPosition, GLint ncomp = 3)
+        {
+            glBindBuffer (GL_ARRAY_BUFFER, this->vbos[b]);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+            this->upload_buffer (GL_ARRAY_BUFFER, b, dat.data(), dat.size() * sizeof(float));
+            if (dat.empty()) {
+                glDisableVertexAttribArray (bufferAttribPosition);
+                return;
             }
+            glVertexAttribPointer (bufferAttribPosition, ncomp, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+            glEnableVertexAttribArray (bufferAttribPosition);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
 
-            // Bottom cap vertices
-            for (int j = 0; j < segments; j++) {
-                float t = rotation + (float)j * morph::mathconst<float>::two_pi/(float)segments;
-                vec<float> c = _ux * sin(t) * r + _uy * cos(t) * r;
-                this->vertex_push (vend+c, this->vertexPositions);
-                this->vertex_push (v, this->vertexNormals);
-                this->vertex_push (colEnd, this->vertexColors);
+        //! Upload the vertex positions, normals and colours (or datums). The vertex array must be bound.
+        void upload_vertices()
+        {
+            if (this->datum_dims > 0u) { this->pack_datums(); }
+#ifdef GL_MAP_PERSISTENT_BIT
+            if constexpr (persistent_capable == true) {
+                if (this->persistent_buffers == true) {
+                    this->upload_vertices_mapped();
+                    return;
+                }
             }
+#endif
+            if (this->compact_layout() == true) {
+                this->upload_vertices_compact();
+                return;
+            }
+            const std::vector<float> none;
+            this->setupVBO (posnVBO, this->vertexPositions, visgl::posnLoc);
+            this->setupVBO (normVBO, this->vertexNormals, visgl::normLoc);
+            this->setupVBO (colVBO, (this->datum_dims > 0u ? none : this->vertexColors), visgl::colLoc);
+            this->setupVBO (datumVBO, (this->datum_dims > 0u ? this->vertexDatums : none), visgl::datumLoc, this->datum_stride());
+            this->setupVBO (fixedVBO, (this->datum_dims > 0u ? this->vertexFixedColours : none), visgl::fixedColLoc, 1);
+            this->vertex_bytes = this->vertex_floats() * sizeof(float);
+        }
 
-            // Bottom cap. Push centre vertex as the last vertex.
-            this->vertex_push (vend, this->vertexPositions);
-            this->vertex_push (v, this->vertexNormals);
-            this->vertex_push (colEnd, this->vertexColors);
+        //! True if the vertices are to be uploaded in the compact format (see compact_vertices)
+        bool compact_layout() const
+        {
+            return this->compact_vertices == true && this->datum_dims == 0u
+            && this->vertexNormals.size() == this->vertexPositions.size()
+            && this->vertexColors.size() == this->vertexPositions.size();
+        }
 
-            // Number of vertices = segments * 4 + 2.
-            int nverts = (segments * 4) + 2;
+        //! The size, in bytes, of each uploaded index
+        std::size_t index_bytes() const { return this->index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
 
-            // After creating vertices, push all the indices.
-            GLuint capMiddle = this->idx;
-            GLuint capStartIdx = this->idx + 1u;
-            GLuint endMiddle = this->idx + (GLuint)nverts - 1u;
-            GLuint endStartIdx = capStartIdx + (3u * segments);
+        //! Upload the indices, as 16 bit integers if the model is compact (or short_indices) and small enough. The vertex array must be bound.
+        void upload_indices()
+        {
+            glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, this->vbos[idxVBO]);
+            if ((this->compact_vertices == true || this->short_indices == true) && this->vertexPositions.size() / 3u <= 65536u) {
+                std::vector<GLushort> short_indices (this->indices.begin(), this->indices.end());
+                this->index_type = GL_UNSIGNED_SHORT;
+                this->upload_buffer (GL_ELEMENT_ARRAY_BUFFER, idxVBO, short_indices.data(), short_indices.size() * sizeof(GLushort));
+            } else {
+                this->index_type = GL_UNSIGNED_INT;
+                this->upload_buffer (GL_ELEMENT_ARRAY_BUFFER, idxVBO, this->indices.data(), this->indices.size() * sizeof(GLuint));
+            }
+        }
 
-            // Start cap indices
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (capMiddle);
-                this->indices.push_back (capStartIdx + j);
-                this->indices.push_back (capStartIdx + 1 + j);
+        /*!
+         * Pack the vertices into the compact, interleaved format of compact_vertices and
+         * half_positions, returning the bytes per vertex. Each vertex is its position (3
+         * floats, or 4 half floats with w = 1), its normal (one 2_10_10_10 word with w = 1)
+         * and its colour (4 bytes, RGBA with A = 255).
+         */
+        std::size_t pack_compact (std::vector<std::uint8_t>& packed) const
+        {
+            const std::int64_t nv = static_cast<std::int64_t>(this->vertexPositions.size() / 3u);
+            bool half = this->half_positions == true && this->twodimensional == true;
+            if (half == true && nv > 0) {
+                // Only for flat models, with all their vertices at one z, within the half float range
+                const float z0 = this->vertexPositions[2];
+                for (std::int64_t i = 0; i < nv && half; ++i) {
+                    const float* p = this->vertexPositions.data() + 3 * i;
+                    half = std::abs (p[0]) <= 65504.0f && std::abs (p[1]) <= 65504.0f && p[2] == z0 && std::abs (z0) <= 65504.0f;
+                }
             }
-            // Last one
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (capStartIdx + segments - 1);
-            this->indices.push_back (capStartIdx);
+            const std::size_t posn_bytes = half ? 4u * sizeof(std::uint16_t) : 3u * sizeof(float);
+            const std::size_t stride = posn_bytes + 2u * sizeof(std::uint32_t);
+            packed.resize (nv * stride);
+            // A component in [-1, 1] as a 10 bit signed normalized integer
+            auto snorm10 = [](float f) -> std::uint32_t {
+                f = std::min (std::max (f, -1.0f), 1.0f);
+                return static_cast<std::uint32_t>(static_cast<std::int32_t>(std::round (f * 511.0f))) & 0x3ffu;
+            };
+            // A component in [0, 1] as an 8 bit unsigned normalized integer
+            auto unorm8 = [](float f) -> std::uint8_t {
+                return static_cast<std::uint8_t>(std::min (std::max (f, 0.0f), 1.0f) * 255.0f + 0.5f);
+            };
+#pragma omp parallel for schedule(static)
+            for (std::int64_t i = 0; i < nv; ++i) {
+                std::uint8_t* v = packed.data() + i * stride;
+                const float* p = this->vertexPositions.data() + 3 * i;
+                if (half) {
+                    const std::uint16_t h[4] = { morph::float16::from_float (p[0]), morph::float16::from_float (p[1]),
+                                                 morph::float16::from_float (p[2]), morph::float16::from_float (1.0f) };
+                    std::memcpy (v, h, sizeof(h));
+                } else {
+                    std::memcpy (v, p, 3u * sizeof(float));
+                }
+                const float* n = this->vertexNormals.data() + 3 * i;
+                const std::uint32_t nw = snorm10 (n[0]) | (snorm10 (n[1]) << 10) | (snorm10 (n[2]) << 20) | (1u << 30);
+                std::memcpy (v + posn_bytes, &nw, sizeof(nw));
+                const float* c = this->vertexColors.data() + 3 * i;
+                const std::uint8_t rgba[4] = { unorm8 (c[0]), unorm8 (c[1]), unorm8 (c[2]), 255u };
+                std::memcpy (v + posn_bytes + sizeof(nw), rgba, sizeof(rgba));
+            }
+            return stride;
+        }
 
-            // Middle sections
-            for (int lsection = 0; lsection < 3; ++lsection) {
-                capStartIdx = this->idx + 1 + lsection*segments;
-                endStartIdx = capStartIdx + segments;
-                for (int j = 0; j < segments; j++) {
-                    this->indices.push_back (capStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + 1 + j);
-                    }
-                    this->indices.push_back (endStartIdx + j);
-                    this->indices.push_back (endStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (endStartIdx);
-                    } else {
-                        this->indices.push_back (endStartIdx + 1 + j);
-                    }
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + j + 1);
+        //! Upload the vertices in the compact format into posnVBO. The vertex array must be bound.
+        void upload_vertices_compact()
+        {
+            std::vector<std::uint8_t> packed;
+            const std::size_t stride = this->pack_compact (packed);
+            const std::size_t posn_bytes = stride - 2u * sizeof(std::uint32_t);
+            const bool half = posn_bytes != 3u * sizeof(float);
+
+            // Release the storage of the separate attribute buffers
+            for (VBOPos b : { normVBO, colVBO, datumVBO, fixedVBO }) {
+                glBindBuffer (GL_ARRAY_BUFFER, this->vbos[b]);
+                this->upload_buffer (GL_ARRAY_BUFFER, b, nullptr, 0u);
+            }
+            glDisableVertexAttribArray (visgl::datumLoc);
+            glDisableVertexAttribArray (visgl::fixedColLoc);
+
+            glBindBuffer (GL_ARRAY_BUFFER, this->vbos[posnVBO]);
+            this->upload_buffer (GL_ARRAY_BUFFER, posnVBO, packed.data(), packed.size());
+            const GLsizei gl_stride = static_cast<GLsizei>(stride);
+            if (half) {
+                glVertexAttribPointer (visgl::posnLoc, 4, GL_HALF_FLOAT, GL_FALSE, gl_stride, reinterpret_cast<void*>(0));
+            } else {
+                glVertexAttribPointer (visgl::posnLoc, 3, GL_FLOAT, GL_FALSE, gl_stride, reinterpret_cast<void*>(0));
+            }
+            glVertexAttribPointer (visgl::normLoc, 4, GL_INT_2_10_10_10_REV, GL_TRUE, gl_stride, reinterpret_cast<void*>(posn_bytes));
+            glVertexAttribPointer (visgl::colLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, gl_stride,
+                                   reinterpret_cast<void*>(posn_bytes + sizeof(std::uint32_t)));
+            for (unsigned int loc : { visgl::posnLoc, visgl::normLoc, visgl::colLoc }) { glEnableVertexAttribArray (loc); }
+            this->vertex_bytes = stride;
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        /*!
+         * Make the triangles indexed since first_index into a glyph template and return its
+         * number. Glyphs must be made before any triangles that are to be drawn without
+         * instancing; render() draws every index after the last glyph in the usual way.
+         */
+        unsigned int make_glyph (std::size_t first_index)
+        {
+            glyph g;
+            g.first_index = first_index;
+            g.n_indices = this->indices.size() - first_index;
+            this->glyphs.push_back (std::move (g));
+            return static_cast<unsigned int>(this->glyphs.size() - 1u);
+        }
+
+        //! Add an instance of glyph gi at posn, scaled by scale (in the template's frame), then rotated by rotn
+        void instance_push (unsigned int gi, const vec<float>& posn, const vec<float>& scale,
+                            const morph::Quaternion<float>& rotn, const std::array<float, 3>& clr)
+        {
+            std::vector<float>& inst = this->glyphs[gi].instances;
+            inst.insert (inst.end(), { posn[0], posn[1], posn[2], scale[0], scale[1], scale[2],
+                                       rotn.x, rotn.y, rotn.z, rotn.w, clr[0], clr[1], clr[2] });
+        }
+
+        /*!
+         * Upload the instances of all the glyphs, one glyph after another, into the instance
+         * buffer. The vertex array must be bound.
+         */
+        void upload_instances()
+        {
+            std::size_t total = 0u;
+            for (const glyph& g : this->glyphs) { total += g.instances.size(); }
+            if (total == 0u) {
+                for (glyph& g : this->glyphs) { g.n_instances = 0u; }
+                for (unsigned int loc = visgl::instPosnLoc; loc <= visgl::instColLoc; ++loc) { glDisableVertexAttribArray (loc); }
+                return;
+            }
+            glBindBuffer (GL_ARRAY_BUFFER, this->vbos[instVBO]);
+            const std::size_t sz = total * sizeof(float);
+            if (sz > this->buffer_capacity[instVBO] || sz < this->buffer_capacity[instVBO] / 4u) {
+                glBufferData (GL_ARRAY_BUFFER, sz, nullptr, GL_DYNAMIC_DRAW);
+                this->buffer_capacity[instVBO] = sz;
+            }
+            std::size_t offset = 0u;
+            for (glyph& g : this->glyphs) {
+                g.first_instance = offset / instance_floats;
+                g.n_instances = g.instances.size() / instance_floats;
+                if (!g.instances.empty()) {
+                    glBufferSubData (GL_ARRAY_BUFFER, offset * sizeof(float), g.instances.size() * sizeof(float), g.instances.data());
+                }
+                offset += g.instances.size();
+            }
+            for (unsigned int loc = visgl::instPosnLoc; loc <= visgl::instColLoc; ++loc) {
+                glEnableVertexAttribArray (loc);
+                glVertexAttribDivisor (loc, 1);
+            }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! Point the instance attributes at the instances from number first onwards
+        void point_instance_attribs (std::size_t first)
+        {
+            constexpr GLsizei stride = instance_floats * sizeof(float);
+            const std::size_t base = first * stride;
+            glBindBuffer (GL_ARRAY_BUFFER, this->vbos[instVBO]);
+            glVertexAttribPointer (visgl::instPosnLoc, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(base));
+            glVertexAttribPointer (visgl::instScaleLoc, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(base + 3u * sizeof(float)));
+            glVertexAttribPointer (visgl::instRotnLoc, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(base + 6u * sizeof(float)));
+            glVertexAttribPointer (visgl::instColLoc, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(base + 10u * sizeof(float)));
+        }
+
+        /*!
+         * Fill vertexDatums and vertexFixedColours from vertexColors. A vertex colour made
+         * with datum_tag gives its datum(s) and a fixed colour of 0. Any other colour gives
+         * zero datums and a fixed colour of one plus its 24 bit RGB value (an integer, exact
+         * as a float, that the shader unpacks). vertexFixedColours is left empty if there are
+         * no fixed colours.
+         */
+        void pack_datums()
+        {
+            const std::int64_t nv = static_cast<std::int64_t>(this->vertexColors.size() / 3u);
+            const std::int64_t nd = this->datum_stride();
+            this->vertexDatums.resize (nv * nd);
+            this->vertexFixedColours.resize (nv);
+            std::int64_t nfixed = 0;
+#pragma omp parallel for schedule(static) reduction(+:nfixed)
+            for (std::int64_t i = 0; i < nv; ++i) {
+                const float* c = this->vertexColors.data() + 3 * i;
+                float* d = this->vertexDatums.data() + nd * i;
+                if (c[2] == datum_tag) {
+                    for (std::int64_t j = 0; j < nd; ++j) { d[j] = c[j]; }
+                    this->vertexFixedColours[i] = 0.0f;
+                } else {
+                    std::uint32_t rgb = 0u;
+                    for (unsigned int j = 0; j < 3u; ++j) {
+                        float cj = std::min (std::max (c[j], 0.0f), 1.0f);
+                        rgb = (rgb << 8) | static_cast<std::uint32_t>(cj * 255.0f + 0.5f);
                     }
+                    this->vertexFixedColours[i] = static_cast<float>(rgb + 1u);
+                    for (std::int64_t j = 0; j < nd; ++j) { d[j] = 0.0f; }
+                    ++nfixed;
                 }
             }
+            // With no fixed colours, the attribute is disabled and reads as 0 in the shader
+            if (nfixed == 0) { this->vertexFixedColours.clear(); }
+        }
 
-            // bottom cap
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (endMiddle);
-                this->indices.push_back (endStartIdx + j);
-                this->indices.push_back (endStartIdx + 1 + j);
+        //! The number of floats per vertex uploaded by upload_vertices()
+        std::size_t vertex_floats() const
+        {
+            if (this->datum_dims == 0u) { return 9u; }
+            return 6u + this->datum_stride() + (this->vertexFixedColours.empty() ? 0u : 1u);
+        }
+
+        /*!
+         * Bind the colour map texture and set the colour map uniforms for a model with
+         * datum_dims > 0. Called by render() with the shader program prog in use.
+         */
+        virtual void bind_colourmap (GLuint prog) { (void)prog; }
+
+        //! The number of floats per vertex in vertexDatums. Models whose datums are texture coordinates give 2.
+        virtual unsigned int datum_stride() const { return this->datum_dims; }
+
+        //! Convert colour map datums to a colour as the shader would (for export)
+        virtual std::array<float, 3> datum_colour (float d1, float d2) { (void)d1; (void)d2; return { 0.0f, 0.0f, 0.0f }; }
+
+#ifdef GL_MAP_PERSISTENT_BIT
+        /*!
+         * Copy the vertex positions, normals and colours into the next region of the
+         * persistently mapped buffers and point the vertex attributes at it. The buffers are
+         * (re-)created if the vertices do not fit.
+         */
+        void upload_vertices_mapped()
+        {
+            const std::vector<float> none;
+            const bool dtm = this->datum_dims > 0u;
+            const std::array<VBOPos, 5> bufs = { posnVBO, normVBO, colVBO, datumVBO, fixedVBO };
+            const std::array<const std::vector<float>*, 5> dat = { &this->vertexPositions, &this->vertexNormals,
+                                                                   (dtm ? &none : &this->vertexColors),
+                                                                   (dtm ? &this->vertexDatums : &none),
+                                                                   (dtm ? &this->vertexFixedColours : &none) };
+            const std::array<unsigned int, 5> locs = { visgl::posnLoc, visgl::normLoc, visgl::colLoc,
+                                                       visgl::datumLoc, visgl::fixedColLoc };
+            const std::array<GLint, 5> ncomp = { 3, 3, 3, static_cast<GLint>(this->datum_stride()), 1 };
+
+            std::size_t sz = 0u;
+            for (auto d : dat) { sz = std::max (sz, d->size() * sizeof(float)); }
+            if (this->buffers_mapped == false || sz > this->region_bytes) {
+                this->map_vertex_buffers (std::max (sz, 2u * this->region_bytes));
+            } else {
+                this->region = (this->region + 1u) % n_regions;
+                this->wait_region (this->region);
             }
-            this->indices.push_back (endMiddle);
-            this->indices.push_back (endStartIdx + segments - 1);
-            this->indices.push_back (endStartIdx);
 
-            // Update idx
-            this->idx += nverts;
+            const std::size_t offset = this->region * this->region_bytes;
+            for (unsigned int i = 0; i < bufs.size(); ++i) {
+                if (dat[i]->empty()) {
+                    glDisableVertexAttribArray (locs[i]);
+                    continue;
+                }
+                std::memcpy (this->mapped[bufs[i]] + offset, dat[i]->data(), dat[i]->size() * sizeof(float));
+                glBindBuffer (GL_ARRAY_BUFFER, this->vbos[bufs[i]]);
+                glVertexAttribPointer (locs[i], ncomp[i], GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(offset));
+                glEnableVertexAttribArray (locs[i]);
+            }
+            this->vertex_bytes = this->vertex_floats() * sizeof(float);
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! Replace the vertex attribute buffers with mapped buffers of n_regions regions of rbytes
+        void map_vertex_buffers (std::size_t rbytes)
+        {
+            // Orphan the old buffers; GL deletes them once any draws from them are complete
+            for (unsigned int r = 0; r < n_regions; ++r) {
+                if (this->fences[r] != nullptr) { glDeleteSync (this->fences[r]); }
+                this->fences[r] = nullptr;
+            }
+            rbytes = std::max (rbytes, std::size_t{256});
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            for (VBOPos b : { posnVBO, normVBO, colVBO, datumVBO, fixedVBO }) {
+                glDeleteBuffers (1, &this->vbos[b]);
+                glGenBuffers (1, &this->vbos[b]);
+                glBindBuffer (GL_ARRAY_BUFFER, this->vbos[b]);
+                glBufferStorage (GL_ARRAY_BUFFER, n_regions * rbytes, nullptr, flags);
+                this->mapped[b] = static_cast<char*>(glMapBufferRange (GL_ARRAY_BUFFER, 0, n_regions * rbytes, flags));
+                if (this->mapped[b] == nullptr) {
+                    throw std::runtime_error ("VisualModel: Failed to map a persistent vertex buffer");
+                }
+                this->buffer_capacity[b] = n_regions * rbytes;
+            }
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+            this->region_bytes = rbytes;
+            this->region = 0u;
+            this->buffers_mapped = true;
+        }
+
+        //! Wait until the GPU has finished any draws from region r
+        void wait_region (unsigned int r)
+        {
+            if (this->fences[r] == nullptr) { return; }
+            GLenum rtn = GL_TIMEOUT_EXPIRED;
+            while (rtn == GL_TIMEOUT_EXPIRED) {
+                rtn = glClientWaitSync (this->fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000u);
+            }
+            glDeleteSync (this->fences[r]);
+            this->fences[r] = nullptr;
+        }
+#endif
+
+        /*!
+         * Create a tube from \a start to \a end, with radius \a r and a colour which
+         * transitions from the colour \a colStart to \a colEnd.
+         *
+         * This version simply sub-calls into computeFlaredTube which will randomly choose the angle
+         * of the vertices around the centre of each end cap.
+         *
+         * \param idx The index into the 'vertex array'
+         * \param start The start of the tube
+         * \param end The end of the tube
+         * \param colStart The tube starting colour
+         * \param colEnd The tube's ending colour
+         * \param r Radius of the tube
+         * \param segments Number of segments used to render the tube
+         */
+        void computeTube (vec<float> start, vec<float> end,
+                          std::array<float, 3> colStart, std::array<float, 3> colEnd,
+                          float r = 1.0f, int segments = 12)
+        {
+            this->computeFlaredTube (start, end, colStart, colEnd, r, r, segments);
+        }
+
+        /*!
+         * Compute a tube. This version requires unit vectors for orientation of the
+         * tube end faces/vertices (useful for graph markers). The other version uses a
+         * randomly chosen vector to do this.
+         *
+         * Create a tube from \a start to \a end, with radius \a r and a colour which
+         * transitions from the colour \a colStart to \a colEnd.
+         *
+         * \param start The start of the tube
+         * \param end The end of the tube
+         * \param _ux a vector in the x axis direction for the end face
+         * \param _uy a vector in the y axis direction
+         * \param colStart The tube starting colour
+         * \param colEnd The tube's ending colour
+         * \param r Radius of the tube
+         * \param segments Number of segments used to render the tube
+         * \param rotation A rotation in the _ux/_uy plane to orient the vertices of the
+         * tube. Useful if this is to be a short tube used as a graph marker.
+         */
+        void computeTube (vec<float> start, vec<float> end,
+                          vec<float> _ux, vec<float> _uy,
+                          std::array<float, 3> colStart, std::array<float, 3> colEnd,
+                          float r = 1.0f, int segments = 12, float rotation = 0.0f)
+        {
+            // v is a face normal
+            vec<float> v = _uy.cross(_ux);
+            v.renormalize();
+
+            // Rotate _ux and _uy by rotation, so that the unit tube's vertices, at angles t, are
+            // placed at angles rotation + t
+            const float cr = std::cos (rotation);
+            const float sr = std::sin (rotation);
+            const vec<float> ux = _ux * cr - _uy * sr;
+            const vec<float> uy = _ux * sr + _uy * cr;
+
+            this->append_tube (start, end, ux, uy, v, colStart, colEnd, r, r, segments);
         } // end computeTube with ux/uy vectors for faces
 
         /*!
@@ -1046,139 +1972,18 @@ namespace morph {
         {
             // The vector from start to end defines a vector and a plane. Find a
             // 'circle' of points in that plane.
-            morph::vec<float> vstart = start;
-            morph::vec<float> vend = end;
-            morph::vec<float> v = vend - vstart;
+            morph::vec<float> v = end - start;
             v.renormalize();
 
-            // circle in a plane defined by a point (v0 = vstart or vend) and a normal
-            // (v) can be found: Choose random vector vr. A vector inplane = vr ^ v. The
-            // unit in-plane vector is inplane.normalise. Can now use that vector in the
-            // plan to define a point on the circle. Note that this starting point on
-            // the circle is at a random position, which means that this version of
-            // computeTube is useful for tubes that have quite a few segments.
-            morph::vec<float> rand_vec;
-            rand_vec.randomize();
-            morph::vec<float> inplane = rand_vec.cross(v);
-            inplane.renormalize();
-
-            // Now use parameterization of circle inplane = p1-x1 and
-            // c1(t) = ( (p1-x1).normalized sin(t) + v.normalized cross (p1-x1).normalized * cos(t) )
-            // c1(t) = ( inplane sin(t) + v * inplane * cos(t)
+            // circle in a plane defined by a point (v0 = vstart or vend) and a normal (v) can be
+            // found from a random unit vector in the plane. Note that this starting point on the
+            // circle is at a random position, which means that this version of computeTube is
+            // useful for tubes that have quite a few segments.
+            morph::vec<float> inplane = random_perpendicular (v);
+            // Now use parameterization of circle c1(t) = inplane sin(t) + v * inplane * cos(t)
             morph::vec<float> v_x_inplane = v.cross(inplane);
 
-            // Push the central point of the start cap - this is at location vstart
-            this->vertex_push (vstart, this->vertexPositions);
-            this->vertex_push (-v, this->vertexNormals);
-            this->vertex_push (colStart, this->vertexColors);
-
-            // Start cap vertices. Draw as a triangle fan, but record indices so that we
-            // only need a single call to glDrawElements.
-            for (int j = 0; j < segments; j++) {
-                // t is the angle of the segment
-                float t = j * morph::mathconst<float>::two_pi/(float)segments;
-                morph::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
-                this->vertex_push (vstart+c, this->vertexPositions);
-                this->vertex_push (-v, this->vertexNormals);
-                this->vertex_push (colStart, this->vertexColors);
-            }
-
-            // Intermediate, near start cap. Normals point in direction c
-            for (int j = 0; j < segments; j++) {
-                float t = j * morph::mathconst<float>::two_pi/(float)segments;
-                morph::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
-                this->vertex_push (vstart+c, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (colStart, this->vertexColors);
-            }
-
-            // Intermediate, near end cap. Normals point in direction c
-            for (int j = 0; j < segments; j++) {
-                float t = (float)j * morph::mathconst<float>::two_pi/(float)segments;
-                morph::vec<float> c = inplane * std::sin(t) * r_end + v_x_inplane * std::cos(t) * r_end;
-                this->vertex_push (vend+c, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (colEnd, this->vertexColors);
-            }
-
-            // Bottom cap vertices
-            for (int j = 0; j < segments; j++) {
-                float t = (float)j * morph::mathconst<float>::two_pi/(float)segments;
-                morph::vec<float> c = inplane * std::sin(t) * r_end + v_x_inplane * std::cos(t) * r_end;
-                this->vertex_push (vend+c, this->vertexPositions);
-                this->vertex_push (v, this->vertexNormals);
-                this->vertex_push (colEnd, this->vertexColors);
-            }
-
-            // Bottom cap. Push centre vertex as the last vertex.
-            this->vertex_push (vend, this->vertexPositions);
-            this->vertex_push (v, this->vertexNormals);
-            this->vertex_push (colEnd, this->vertexColors);
-
-            // Note: number of vertices = segments * 4 + 2.
-            int nverts = (segments * 4) + 2;
-
-            // After creating vertices, push all the indices.
-            GLuint capMiddle = this->idx;
-            GLuint capStartIdx = this->idx + 1u;
-            GLuint endMiddle = this->idx + (GLuint)nverts - 1u;
-            GLuint endStartIdx = capStartIdx + (3u * segments);
-
-            // Start cap
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (capMiddle);
-                this->indices.push_back (capStartIdx + j);
-                this->indices.push_back (capStartIdx + 1 + j);
-            }
-            // Last one
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (capStartIdx + segments - 1);
-            this->indices.push_back (capStartIdx);
-
-            // Middle sections
-            for (int lsection = 0; lsection < 3; ++lsection) {
-                capStartIdx = this->idx + 1 + lsection*segments;
-                endStartIdx = capStartIdx + segments;
-                // This does sides between start and end. I want to do this three times.
-                for (int j = 0; j < segments; j++) {
-                    // Triangle 1
-                    this->indices.push_back (capStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + 1 + j);
-                    }
-                    this->indices.push_back (endStartIdx + j);
-                    // Triangle 2
-                    this->indices.push_back (endStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (endStartIdx);
-                    } else {
-                        this->indices.push_back (endStartIdx + 1 + j);
-                    }
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + j + 1);
-                    }
-                }
-            }
-
-            // Bottom cap
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (endMiddle);
-                this->indices.push_back (endStartIdx + j);
-                this->indices.push_back (endStartIdx + 1 + j);
-            }
-            // Last one
-            this->indices.push_back (endMiddle);
-            this->indices.push_back (endStartIdx + segments - 1);
-            this->indices.push_back (endStartIdx);
-
-            // Update idx
-            this->idx += nverts;
+            this->append_tube (start, end, inplane, v_x_inplane, v, colStart, colEnd, r, r_end, segments);
         } // end computeFlaredTube with randomly initialized end vertices
 
         //! Compute a Quad from 4 arbitrary corners which must be ordered clockwise around the quad.
@@ -1287,25 +2092,18 @@ namespace morph {
         void computeRing (vec<float> ro, std::array<float, 3> rc, float r = 1.0f,
                           float t = 0.1f, int segments = 12)
         {
+            const morph::unit_mesh& circle = morph::unit_mesh_cache (morph::unit_primitive::circle, 0, segments);
+            const float* cs = circle.positions.data(); // (cos, sin, 0) for each segment
+            const float r_in = r - (t * 0.5f);
+            const float r_out = r + (t * 0.5f);
             for (int j = 0; j < segments; j++) {
-                float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                // x and y of inner point
-                float xin = (r-(t*0.5f)) * cos(segment);
-                float yin = (r-(t*0.5f)) * sin(segment);
-                float xout = (r+(t*0.5f)) * cos(segment);
-                float yout = (r+(t*0.5f)) * sin(segment);
-                int segjnext = (j+1) % segments;
-                float segnext = morph::mathconst<float>::two_pi * static_cast<float>(segjnext) / segments;
-                float xin_n = (r-(t*0.5f)) * cos(segnext);
-                float yin_n = (r-(t*0.5f)) * sin(segnext);
-                float xout_n = (r+(t*0.5f)) * cos(segnext);
-                float yout_n = (r+(t*0.5f)) * sin(segnext);
-
+                const float* c = cs + 3 * j;
+                const float* c_n = cs + 3 * ((j + 1) % segments);
                 // Now draw a quad
-                vec<float> c4 = { xin, yin, 0.0f };
-                vec<float> c3 = { xout, yout, 0.0f };
-                vec<float> c2 = { xout_n, yout_n, 0.0f };
-                vec<float> c1 = { xin_n, yin_n, 0.0f };
+                vec<float> c4 = { r_in * c[0], r_in * c[1], 0.0f };
+                vec<float> c3 = { r_out * c[0], r_out * c[1], 0.0f };
+                vec<float> c2 = { r_out * c_n[0], r_out * c_n[1], 0.0f };
+                vec<float> c1 = { r_in * c_n[0], r_in * c_n[1], 0.0f };
                 this->computeFlatQuad (ro+c1, ro+c2, ro+c3, ro+c4, rc);
             }
         }
@@ -1485,126 +2283,14 @@ namespace morph {
         void computeSphere (vec<float> so, std::array<float, 3> sc,
                             float r = 1.0f, int rings = 10, int segments = 12)
         {
-            // First cap, draw as a triangle fan, but record indices so that
-            // we only need a single call to glDrawElements.
-            float rings0 = -morph::mathconst<float>::pi_over_2;
-            float _z0  = sin(rings0);
-            float z0  = r * _z0;
-            float r0 =  cos(rings0);
-            float rings1 = morph::mathconst<float>::pi * (-0.5f + 1.0f / rings);
-            float _z1 = sin(rings1);
-            float z1 = r * _z1;
-            float r1 = cos(rings1);
-            // Push the central point
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, -1.0f, this->vertexNormals);
-            this->vertex_push (sc, this->vertexColors);
-
-            GLuint capMiddle = this->idx++;
-            GLuint ringStartIdx = this->idx;
-            GLuint lastRingStartIdx = this->idx;
-
-            bool firstseg = true;
-            for (int j = 0; j < segments; j++) {
-                float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                float x = cos(segment);
-                float y = sin(segment);
-
-                float _x1 = x*r1;
-                float x1 = _x1*r;
-                float _y1 = y*r1;
-                float y1 = _y1*r;
-
-                this->vertex_push (so[0]+x1, so[1]+y1, so[2]+z1, this->vertexPositions);
-                this->vertex_push (_x1, _y1, _z1, this->vertexNormals);
-                this->vertex_push (sc, this->vertexColors);
-
-                if (!firstseg) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (this->idx-1);
-                    this->indices.push_back (this->idx++);
-                } else {
-                    this->idx++;
-                    firstseg = false;
-                }
-            }
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (this->idx-1);
-            this->indices.push_back (capMiddle+1);
-
-            // Now add the triangles around the rings
-            for (int i = 2; i < rings; i++) {
-
-                rings0 = morph::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
-                _z0  = sin(rings0);
-                z0  = r * _z0;
-                r0 =  cos(rings0);
-
-                for (int j = 0; j < segments; j++) {
-
-                    // "current" segment
-                    float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                    float x = cos(segment);
-                    float y = sin(segment);
-
-                    // One vertex per segment
-                    float _x0 = x*r0;
-                    float x0 = _x0*r;
-                    float _y0 = y*r0;
-                    float y0 = _y0*r;
-
-                    // NB: Only add ONE vertex per segment. ALREADY have the first ring!
-                    this->vertex_push (so[0]+x0, so[1]+y0, so[2]+z0, this->vertexPositions);
-                    // The vertex normal of a vertex that makes up a sphere is
-                    // just a normal vector in the direction of the vertex.
-                    this->vertex_push (_x0, _y0, _z0, this->vertexNormals);
-                    this->vertex_push (sc, this->vertexColors);
-
-                    if (j == segments - 1) {
-                        // Last vertex is back to the start
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (lastRingStartIdx+segments);
-                    } else {
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (this->idx);
-                    }
-                }
-                lastRingStartIdx += segments;
-            }
-
-            // bottom cap
-            rings0 = morph::mathconst<float>::pi_over_2;
-            _z0  = sin(rings0);
-            z0  = r * _z0;
-            r0 =  cos(rings0);
-            // Push the central point of the bottom cap
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            this->vertex_push (sc, this->vertexColors);
-            capMiddle = this->idx++;
-            firstseg = true;
-            // No more vertices to push, just do the indices for the bottom cap
-            ringStartIdx = lastRingStartIdx;
-            for (int j = 0; j < segments; j++) {
-                if (j != segments - 1) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx++);
-                    this->indices.push_back (ringStartIdx);
-                } else {
-                    // Last segment
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx);
-                    this->indices.push_back (lastRingStartIdx);
-                }
-            }
+            // The cached unit sphere's vertices are scaled by r and moved to so. Its normals are unchanged.
+            const morph::unit_mesh& um = morph::unit_mesh_cache (morph::unit_primitive::sphere, rings, segments);
+            const std::size_t n = um.n_vertices();
+            morph::transform_append (um.positions.data(), n, so, { r, 0.0f, 0.0f, 0.0f, r, 0.0f, 0.0f, 0.0f, r },
+                                     false, this->vertexPositions);
+            this->vertexNormals.insert (this->vertexNormals.end(), um.normals.begin(), um.normals.end());
+            this->colour_append (n, sc);
+            this->unit_mesh_indices (um);
         } // end of sphere calculation
 
         /*!
@@ -1623,129 +2309,19 @@ namespace morph {
         void computeSphere (vec<float> so, std::array<float, 3> sc, std::array<float, 3> sc2,
                             float r = 1.0f, int rings = 10, int segments = 12)
         {
-            // First cap, draw as a triangle fan, but record indices so that
-            // we only need a single call to glDrawElements.
-            float rings0 = -morph::mathconst<float>::pi_over_2;
-            float _z0  = sin(rings0);
-            float z0  = r * _z0;
-            float r0 =  cos(rings0);
-            float rings1 = morph::mathconst<float>::pi * (-0.5f + 1.0f / rings);
-            float _z1 = sin(rings1);
-            float z1 = r * _z1;
-            float r1 = cos(rings1);
-            // Push the central point
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, -1.0f, this->vertexNormals);
-            this->vertex_push (sc2, this->vertexColors);
-
-            GLuint capMiddle = this->idx++;
-            GLuint ringStartIdx = this->idx;
-            GLuint lastRingStartIdx = this->idx;
-
-            bool firstseg = true;
-            for (int j = 0; j < segments; j++) {
-                float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                float x = cos(segment);
-                float y = sin(segment);
-
-                float _x1 = x*r1;
-                float x1 = _x1*r;
-                float _y1 = y*r1;
-                float y1 = _y1*r;
-
-                this->vertex_push (so[0]+x1, so[1]+y1, so[2]+z1, this->vertexPositions);
-                this->vertex_push (_x1, _y1, _z1, this->vertexNormals);
-                this->vertex_push (sc2, this->vertexColors);
-
-                if (!firstseg) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (this->idx-1);
-                    this->indices.push_back (this->idx++);
-                } else {
-                    this->idx++;
-                    firstseg = false;
-                }
-            }
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (this->idx-1);
-            this->indices.push_back (capMiddle+1);
-
-            // Now add the triangles around the rings
-            for (int i = 2; i < rings; i++) {
-
-                rings0 = morph::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
-                _z0  = sin(rings0);
-                z0  = r * _z0;
-                r0 =  cos(rings0);
-
-                for (int j = 0; j < segments; j++) {
-
-                    // "current" segment
-                    float segment = morph::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                    float x = cos(segment);
-                    float y = sin(segment);
-
-                    // One vertex per segment
-                    float _x0 = x*r0;
-                    float x0 = _x0*r;
-                    float _y0 = y*r0;
-                    float y0 = _y0*r;
-
-                    // NB: Only add ONE vertex per segment. ALREADY have the first ring!
-                    this->vertex_push (so[0]+x0, so[1]+y0, so[2]+z0, this->vertexPositions);
-                    // The vertex normal of a vertex that makes up a sphere is
-                    // just a normal vector in the direction of the vertex.
-                    this->vertex_push (_x0, _y0, _z0, this->vertexNormals);
-                    if (i == 2 || i > (rings-2)) {
-                        this->vertex_push (sc2, this->vertexColors);
-                    } else {
-                        this->vertex_push (sc, this->vertexColors);
-                    }
-                    if (j == segments - 1) {
-                        // Last vertex is back to the start
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (lastRingStartIdx+segments);
-                    } else {
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (this->idx);
-                    }
-                }
-                lastRingStartIdx += segments;
-            }
-
-            // bottom cap
-            rings0 = morph::mathconst<float>::pi_over_2;
-            _z0  = sin(rings0);
-            z0  = r * _z0;
-            r0 =  cos(rings0);
-            // Push the central point of the bottom cap
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            this->vertex_push (sc2, this->vertexColors);
-            capMiddle = this->idx++;
-            firstseg = true;
-            // No more vertices to push, just do the indices for the bottom cap
-            ringStartIdx = lastRingStartIdx;
-            for (int j = 0; j < segments; j++) {
-                if (j != segments - 1) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx++);
-                    this->indices.push_back (ringStartIdx);
-                } else {
-                    // Last segment
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx);
-                    this->indices.push_back (lastRingStartIdx);
-                }
-            }
+            const morph::unit_mesh& um = morph::unit_mesh_cache (morph::unit_primitive::sphere, rings, segments);
+            const std::size_t n = um.n_vertices();
+            morph::transform_append (um.positions.data(), n, so, { r, 0.0f, 0.0f, 0.0f, r, 0.0f, 0.0f, 0.0f, r },
+                                     false, this->vertexPositions);
+            this->vertexNormals.insert (this->vertexNormals.end(), um.normals.begin(), um.normals.end());
+            // The caps and their adjoining two rings are coloured sc2, the rest of the sphere sc
+            const std::size_t ns = static_cast<std::size_t>(segments);
+            const std::size_t n_cap = std::min (n, 1u + 2u * ns);
+            const std::size_t n_end = std::max (n_cap, rings > 2 ? 1u + (rings - 2u) * ns : n_cap);
+            this->colour_append (n_cap, sc2);
+            this->colour_append (n_end - n_cap, sc);
+            this->colour_append (n - n_end, sc2);
+            this->unit_mesh_indices (um);
         }
 
         /*!
@@ -1801,122 +2377,37 @@ namespace morph {
             // intermediate ring which is on the base ring, but has different normals, a
             // 'ring' around the tip (with suitable normals) and a 'tip' vertex
 
-            vec<float> vbase = centre;
-            vec<float> vtip = tip;
-            vec<float> v = vtip - vbase;
+            vec<float> v = tip - centre;
             v.renormalize();
 
             // circle in a plane defined by a point and a normal
-            vec<float> rand_vec;
-            rand_vec.randomize();
-            vec<float> inplane = rand_vec.cross(v);
-            inplane.renormalize();
+            vec<float> inplane = random_perpendicular (v);
             vec<float> v_x_inplane = v.cross(inplane);
 
-            // Push the central point of the start cap - this is at location vstart
-            this->vertex_push (vbase, this->vertexPositions);
-            this->vertex_push (-v, this->vertexNormals);
-            this->vertex_push (col, this->vertexColors);
-
-            // Base ring with normals in direction -v
-            for (int j = 0; j < segments; j++) {
-                float t = j * morph::mathconst<float>::two_pi / static_cast<float>(segments);
-                vec<float> c = inplane * sin(t) * r + v_x_inplane * cos(t) * r;
-                // Subtract the vector which makes this circle
-                c = c + (v * ringoffset);
-                this->vertex_push (vbase+c, this->vertexPositions);
-                this->vertex_push (-v, this->vertexNormals);
-                this->vertex_push (col, this->vertexColors);
-            }
-
-            // Intermediate ring of vertices around/aligned with the base ring with normals in direction c
-            for (int j = 0; j < segments; j++) {
-                float t = j * morph::mathconst<float>::two_pi / static_cast<float>(segments);
-                vec<float> c = inplane * sin(t) * r + v_x_inplane * cos(t) * r;
-                c = c + (v * ringoffset);
-                this->vertex_push (vbase+c, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (col, this->vertexColors);
-            }
-
-            // Intermediate ring of vertices around the tip with normals direction c
-            for (int j = 0; j < segments; j++) {
-                float t = j * morph::mathconst<float>::two_pi / static_cast<float>(segments);
-                vec<float> c = inplane * sin(t) * r + v_x_inplane * cos(t) * r;
-                c = c + (v * ringoffset);
-                this->vertex_push (vtip, this->vertexPositions);
-                c.renormalize();
-                this->vertex_push (c, this->vertexNormals);
-                this->vertex_push (col, this->vertexColors);
-            }
-
-            // Push tip vertex as the last vertex, normal is in direction v
-            this->vertex_push (vtip, this->vertexPositions);
-            this->vertex_push (v, this->vertexNormals);
-            this->vertex_push (col, this->vertexColors);
-
-            // Number of vertices = segments * 3 + 2.
-            int nverts = segments * 3 + 2;
-
-            // After creating vertices, push all the indices.
-            GLuint capMiddle = this->idx;
-            GLuint capStartIdx = this->idx + 1;
-            GLuint endMiddle = this->idx + (GLuint)nverts - 1u;
-            GLuint endStartIdx = capStartIdx;
-
-            // Base of the cone
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (capMiddle);
-                this->indices.push_back (capStartIdx + j);
-                this->indices.push_back (capStartIdx + 1 + j);
-            }
-            // Last tri of base
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (capStartIdx + segments - 1);
-            this->indices.push_back (capStartIdx);
-
-            // Middle sections
-            for (int lsection = 0; lsection < 2; ++lsection) {
-                capStartIdx = this->idx + 1 + lsection*segments;
-                endStartIdx = capStartIdx + segments;
-                for (int j = 0; j < segments; j++) {
-                    // Triangle 1:
-                    this->indices.push_back (capStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + 1 + j);
-                    }
-                    this->indices.push_back (endStartIdx + j);
-                    // Triangle 2:
-                    this->indices.push_back (endStartIdx + j);
-                    if (j == (segments-1)) {
-                        this->indices.push_back (endStartIdx);
-                    } else {
-                        this->indices.push_back (endStartIdx + 1 + j);
-                    }
-                    if (j == (segments-1)) {
-                        this->indices.push_back (capStartIdx);
-                    } else {
-                        this->indices.push_back (capStartIdx + j + 1);
-                    }
-                }
-            }
-
-            // tip
-            for (int j = 0; j < segments-1; j++) {
-                this->indices.push_back (endMiddle);
-                this->indices.push_back (endStartIdx + j);
-                this->indices.push_back (endStartIdx + 1 + j);
-            }
-            // Last triangle of tip
-            this->indices.push_back (endMiddle);
-            this->indices.push_back (endStartIdx + segments - 1);
-            this->indices.push_back (endStartIdx);
-
-            // Update idx
-            this->idx += nverts;
+            // The cached unit cone's rings are at (sin(t), cos(t), 1). Its base and side rings
+            // are placed at centre + inplane * sin(t) * r + v_x_inplane * cos(t) * r + v * ringoffset
+            // and its tip ring and tip at the tip.
+            const morph::unit_mesh& um = morph::unit_mesh_cache (morph::unit_primitive::cone, 0, segments);
+            const std::size_t ns = static_cast<std::size_t>(segments);
+            const std::size_t n = um.n_vertices();
+            const vec<float> ir = inplane * r;
+            const vec<float> vr = v_x_inplane * r;
+            const vec<float> vo = v * ringoffset;
+            const std::array<float, 9> ring = { ir[0], ir[1], ir[2], vr[0], vr[1], vr[2], vo[0], vo[1], vo[2] };
+            const std::array<float, 9> axes = { inplane[0], inplane[1], inplane[2],
+                                                v_x_inplane[0], v_x_inplane[1], v_x_inplane[2], v[0], v[1], v[2] };
+            const std::array<float, 9> zero = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            const float* up = um.positions.data();
+            const float* un = um.normals.data();
+            morph::transform_append (up, 1u + 2u * ns, centre, ring, false, this->vertexPositions);
+            morph::transform_append (up + 3u * (1u + 2u * ns), ns + 1u, tip, zero, false, this->vertexPositions);
+            // Base normals are -v, side and tip ring normals are in the direction of the ring
+            // point from the centre, and the tip normal is v
+            morph::transform_append (un, 1u + ns, { 0.0f, 0.0f, 0.0f }, axes, false, this->vertexNormals);
+            morph::transform_append (un + 3u * (1u + ns), 2u * ns, { 0.0f, 0.0f, 0.0f }, ring, true, this->vertexNormals);
+            morph::transform_append (un + 3u * (n - 1u), 1u, { 0.0f, 0.0f, 0.0f }, axes, false, this->vertexNormals);
+            this->colour_append (n, col);
+            this->unit_mesh_indices (um);
         } // end of cone calculation
 
         //! Compute a line with a single colour
@@ -0,0 +1,87 @@
+/*!
+ * \file
+ *
+ * Per-model profiling for morph::Visual scenes.
+ *
+ * When profiling is switched on with Visual::setProfiling (true), each VisualModel records
+ * the CPU time spent in initializeVertices(), in uploading its buffers and in its render()
+ * call, the GPU time taken by its draw calls (from GL_TIME_ELAPSED queries) and the size of
+ * its mesh and buffers. VisualModel::memory_profile() gives the sizes alone, whether or not
+ * profiling is on. Visual::render collects these once per frame; see
+ * Visual::getProfiles(), Visual::profileReport() and Visual::showProfile.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace morph {
+
+    //! The costs of one VisualModel in one frame
+    struct visual_model_profile
+    {
+        //! CPU time (ms) spent in initializeVertices() since the previous frame
+        double vertices_ms = 0.0;
+        //! CPU time (ms) spent uploading buffers since the previous frame
+        double upload_ms = 0.0;
+        //! CPU time (ms) spent in the model's render() call
+        double draw_ms = 0.0;
+        //! GPU time (ms) of the model's draw calls, from a recent frame. Negative if not (yet) known.
+        double gpu_ms = -1.0;
+        //! The number of vertices in the model's mesh
+        std::size_t n_vertices = 0u;
+        //! The number of indices in the model's mesh
+        std::size_t n_indices = 0u;
+        //! The total storage, in bytes, of the model's buffer objects
+        std::size_t buffer_bytes = 0u;
+        //! The bytes per vertex of the model's vertex attributes (see VisualModel::compact_vertices)
+        std::size_t vertex_bytes = 0u;
+        //! The bytes per index in the model's index buffer
+        std::size_t index_bytes = 0u;
+        //! The storage, in bytes, of the model's CPU-side mesh (positions, normals, colours and indices)
+        std::size_t mesh_bytes = 0u;
+    };
+
+    /*!
+     * Adds the time for which it exists (in ms) to a total, if enabled. depth counts the
+     * timers that are running on the same total, so that only the outermost of a set of
+     * nested timers (such as reinit_buffers calling postVertexInit) adds its time.
+     */
+    struct profile_timer
+    {
+        using clock = std::chrono::steady_clock;
+
+        profile_timer (const bool enabled, double& _total_ms, unsigned int& _depth)
+            : total_ms (_total_ms)
+            , depth (_depth)
+            , counted (enabled)
+        {
+            if (this->counted && this->depth++ == 0u) {
+                this->outermost = true;
+                this->t0 = clock::now();
+            }
+        }
+
+        ~profile_timer()
+        {
+            if (!this->counted) { return; }
+            --this->depth;
+            if (this->outermost) {
+                this->total_ms += std::chrono::duration<double, std::milli>(clock::now() - this->t0).count();
+            }
+        }
+
+        profile_timer (const profile_timer&) = delete;
+        profile_timer& operator= (const profile_timer&) = delete;
+
+    private:
+        double& total_ms;
+        unsigned int& depth;
+        bool counted = false;
+        bool outermost = false;
+        clock::time_point t0;
+    };
+
+} // namespace morph
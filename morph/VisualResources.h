@@ -4,6 +4,14 @@
  * Declares a VisualResource class to hold the information about Freetype and other
  * one-per-program resources.
  *
+ * Visuals whose GL contexts share objects form a resource group. The Visuals in a group use
+ * one FreeType library instance, one set of font faces (with their glyph atlases) and one
+ * copy of each shader program; these are freed when the last Visual of the group is
+ * destroyed. GLFW windows share with each other unless share_contexts is set false before
+ * they are created. For a Visual in OWNED_MODE, define MORPH_OWNED_SHARE_GROUP() to return a
+ * key (const void*) for the share group of the current context; if it is not defined, each
+ * Visual is its own group.
+ *
  * \author Seb James
  * \date November 2020
  */
@@ -23,10 +31,15 @@
 #include <iostream>
 #include <tuple>
 #include <set>
+#include <map>
+#include <string>
+#include <vector>
 #include <stdexcept>
 #include <memory>
 #include <morph/gl/version.h>
 #include <morph/gl/util.h>
+#include <morph/gl/shaders.h>
+#include <morph/gl/program_cache.h>
 #include <morph/VisualFace.h>
 // FreeType for text rendering
 #include <ft2build.h>
@@ -46,15 +59,13 @@ namespace morph {
         VisualResources() { this->init(); }
         ~VisualResources()
         {
-            // Normally, when each morph::Visual goes out of scope, the faces associated with that
-            // Visual get cleaned up (in VisualResources::freetype_deinit). So at this point, faces
-            // should be empty, and the following clear() should do nothing.
-            this->faces.clear();
-
-            // As with the case for faces, when each morph::Visual goes out of scope, the FreeType
-            // instance gets cleaned up. So at this stage freetypes should also be empy and nothing
-            // will happen here either.
-            for (auto& ft : this->freetypes) { FT_Done_FreeType (ft.second); }
+            // Normally, when each morph::Visual goes out of scope, it leaves its group, and the last
+            // Visual of a group frees the group's faces, programs and FreeType instance (in
+            // VisualResources::leave_group). So at this point, groups should be empty.
+            for (auto& g : this->groups) {
+                g.second.faces.clear();
+                if (g.second.freetype != nullptr) { FT_Done_FreeType (g.second.freetype); }
+            }
 
 #ifndef OWNED_MODE
 # ifdef VISUAL_MANAGES_GLFW
@@ -103,12 +114,26 @@ namespace morph {
 #endif
         }
 
-        //! The collection of VisualFaces generated for this instance of the
-        //! application. Create one VisualFace for each unique combination of VisualFont
-        //! and fontpixels (the texture resolution)
-        std::map<std::tuple<morph::VisualFont, unsigned int,
-                            morph::Visual<glver>*>,
-                 std::unique_ptr<morph::visgl::VisualFace>> faces;
+        //! The resources shared by the Visuals of one share group
+        struct resource_group
+        {
+            //! The FreeType library instance for the group
+            FT_Library freetype = nullptr;
+            //! One VisualFace for each unique combination of VisualFont and fontpixels (the
+            //! texture resolution)
+            std::map<std::tuple<morph::VisualFont, unsigned int>, std::unique_ptr<morph::visgl::VisualFace>> faces;
+            //! Linked shader programs, keyed by their shaders (see program_key)
+            std::map<std::string, GLuint> programs;
+            //! The Visuals in the group, with their native contexts (windows), if known
+            std::map<morph::Visual<glver>*, void*> members;
+        };
+
+        //! The share groups, keyed by MORPH_OWNED_SHARE_GROUP(), glfw_group() or, for a
+        //! Visual that shares with no other, the Visual itself
+        std::map<const void*, resource_group> groups;
+
+        //! The group key for each Visual
+        std::map<morph::Visual<glver>*, const void*> visual_groups;
 
         //! An error callback function for the GLFW windowing library
         static void errorCallback (int error, const char* description)
@@ -116,8 +141,25 @@ namespace morph {
             std::cerr << "Error: " << description << " (code "  << error << ")\n";
         }
 
-        //! FreeType library object, public for access by client code?
-        std::map<morph::Visual<glver>*, FT_Library> freetypes;
+        //! The group that Visual _vis belongs to
+        resource_group& group_of (morph::Visual<glver>* _vis)
+        {
+            auto vg = this->visual_groups.find (_vis);
+            if (vg == this->visual_groups.end()) {
+                throw std::runtime_error ("VisualResources: this morph::Visual has not joined a resource group");
+            }
+            return this->groups.at (vg->second);
+        }
+
+        //! A key identifying the program built from shader_info
+        static std::string program_key (const std::vector<morph::gl::ShaderInfo>& shader_info)
+        {
+            std::string key;
+            for (const auto& entry : shader_info) {
+                key += std::to_string (entry.type) + ":" + entry.filename + ":" + entry.compiledIn + "\n";
+            }
+            return key;
+        }
 
     public:
         VisualResources(const VisualResources<glver>&) = delete;
@@ -125,42 +167,94 @@ namespace morph {
         VisualResources(VisualResources<glver> &&) = delete;
         VisualResources & operator=(VisualResources<glver> &&) = delete;
 
-        //! Initialize a freetype library instance and add to this->freetypes. I wanted
-        //! to have only a single freetype library instance, but this didn't work, so I
-        //! create one FT_Library for each OpenGL context (i.e. one for each morph::Visual
-        //! window). Thus, arguably, the FT_Library should be a member of morph::Visual,
-        //! but that's a task for the future, as I coded it this way under the false
-        //! assumption that I'd only need one FT_Library.
-        void freetype_init (morph::Visual<glver>* _vis)
+        /*!
+         * If true (the default), each new GLFW window shares its GL objects with the existing
+         * windows, so that all the windows' Visuals form one resource group.
+         */
+        bool share_contexts = true;
+
+        //! The group key used for the GLFW windows that share their GL objects
+        const void* glfw_group() const { return &this->share_contexts; }
+
+        /*!
+         * Return the native context (GLFW window) of a Visual in the group \a group, for a new
+         * context in that group to share its objects with, or nullptr if the group has no
+         * Visuals yet.
+         */
+        void* share_context (const void* group) const
         {
-            FT_Library freetype = nullptr;
-            try {
-                freetype = this->freetypes.at (_vis);
-            } catch (const std::out_of_range& e) {
-                // Use of gl calls here may make it neat to set up GL/GLFW here in VisualResources.
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-                morph::gl::Util::checkError (__FILE__, __LINE__);
-                if (FT_Init_FreeType (&freetype)) {
+            auto g = this->groups.find (group);
+            if (g == this->groups.end()) { return nullptr; }
+            for (const auto& m : g->second.members) {
+                if (m.second != nullptr) { return m.second; }
+            }
+            return nullptr;
+        }
+
+        /*!
+         * Add the Visual _vis, whose GL context (native context _ctx) is current, to the
+         * resource group \a group (or, if group is nullptr, to a new group of its own). The
+         * first Visual of a group initializes the group's FreeType library instance. (I
+         * wanted to have only a single freetype library instance, but this didn't work, so
+         * there is one FT_Library for each group of OpenGL contexts.)
+         */
+        void join_group (morph::Visual<glver>* _vis, const void* group, void* _ctx = nullptr)
+        {
+            if (group == nullptr) { group = _vis; }
+            if (this->visual_groups.count (_vis) > 0) { this->leave_group (_vis); }
+
+            // Unpack alignment is per-context state, so set it for every context
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+            morph::gl::Util::checkError (__FILE__, __LINE__);
+
+            resource_group& g = this->groups[group];
+            if (g.freetype == nullptr) {
+                if (FT_Init_FreeType (&g.freetype)) {
                     std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-                } else {
-                    // Successfully initialized freetype
-                    this->freetypes[_vis] = freetype;
+                    g.freetype = nullptr;
                 }
             }
+            g.members[_vis] = _ctx;
+            this->visual_groups[_vis] = group;
         }
 
-        //! When a morph::Visual goes out of scope, its freetype library instance should be
-        //! deinitialized.
-        void freetype_deinit (morph::Visual<glver>* _vis)
+        /*!
+         * When a morph::Visual goes out of scope, it leaves its group. The last Visual of the
+         * group deletes the group's shader programs (its GL context should be current), font
+         * faces and FreeType library instance.
+         */
+        void leave_group (morph::Visual<glver>* _vis)
         {
-            // First clear the faces associated with Visual<>* _vis
-            this->clearVisualFaces (_vis);
-            // Second, clean up the FreeType library instance and erase from this->freetypes
-            auto freetype = this->freetypes.find (_vis);
-            if (freetype != this->freetypes.end()) {
-                FT_Done_FreeType (freetype->second);
-                this->freetypes.erase (freetype);
-            }
+            auto vg = this->visual_groups.find (_vis);
+            if (vg == this->visual_groups.end()) { return; }
+            auto g = this->groups.find (vg->second);
+            this->visual_groups.erase (vg);
+            if (g == this->groups.end()) { return; }
+            g->second.members.erase (_vis);
+            if (!g->second.members.empty()) { return; }
+
+            for (auto& p : g->second.programs) { if (p.second) { glDeleteProgram (p.second); } }
+            g->second.faces.clear();
+            if (g->second.freetype != nullptr) { FT_Done_FreeType (g->second.freetype); }
+            this->groups.erase (g);
+        }
+
+        //! The number of Visuals in the resource group of _vis
+        std::size_t group_size (morph::Visual<glver>* _vis) { return this->group_of (_vis).members.size(); }
+
+        /*!
+         * Return the shader program built from shader_info for the resource group of _vis,
+         * building it (via the program binary cache) if the group does not yet have it.
+         */
+        GLuint program (morph::Visual<glver>* _vis, const std::vector<morph::gl::ShaderInfo>& shader_info)
+        {
+            resource_group& g = this->group_of (_vis);
+            const std::string key = program_key (shader_info);
+            auto p = g.programs.find (key);
+            if (p != g.programs.end()) { return p->second; }
+            GLuint prog = morph::gl::LoadShadersCached (shader_info);
+            g.programs[key] = prog;
+            return prog;
         }
 
         //! The instance public function. Uses the very short name 'i' to keep code tidy.
@@ -175,31 +269,17 @@ namespace morph {
         void create() {}
 
         //! Return a pointer to a VisualFace for the given \a font at the given texture
-        //! resolution, \a fontpixels and the given window (i.e. OpenGL context) \a _win.
+        //! resolution, \a fontpixels, shared by the resource group of the Visual \a _vis.
         morph::visgl::VisualFace* getVisualFace (morph::VisualFont font, unsigned int fontpixels,
                                                  morph::Visual<glver>* _vis)
         {
-            morph::visgl::VisualFace* rtn = nullptr;
-            auto key = std::make_tuple(font, fontpixels, _vis);
-            try {
-                rtn = this->faces.at(key).get();
-            } catch (const std::out_of_range& e) {
-                this->faces[key] = std::make_unique<morph::visgl::VisualFace> (font, fontpixels, this->freetypes.at(_vis));
-                rtn = this->faces.at(key).get();
-            }
-            return rtn;
-        }
-
-        //! Loop through this->faces clearing out those associated with the given morph::Visual
-        void clearVisualFaces (morph::Visual<glver>* _vis)
-        {
-            auto f = this->faces.begin();
-            while (f != this->faces.end()) {
-                // f->first is a key. If its third, Visual<>* element == _vis, then delete and erase
-                if (std::get<morph::Visual<glver>*>(f->first) == _vis) {
-                    f = this->faces.erase (f);
-                } else { f++; }
+            resource_group& g = this->group_of (_vis);
+            auto key = std::make_tuple (font, fontpixels);
+            auto f = g.faces.find (key);
+            if (f == g.faces.end()) {
+                f = g.faces.emplace (key, std::make_unique<morph::visgl::VisualFace> (font, fontpixels, g.freetype)).first;
             }
+            return f->second.get();
         }
     };
 
@@ -175,16 +175,12 @@ namespace morph {
             // It is only necessary to bind the vertex array object before rendering
             glBindVertexArray (this->vao);
 
-            // We have a max of (2^32)-1 characters. Should be enough.
-            for (unsigned int i = 0U; i < quads.size(); ++i) {
-                // Bind the right texture for the quad.
-                glBindTexture (GL_TEXTURE_2D, this->quad_ids[i]);
-                // This is 'draw a subset of the elements from the vertex array
-                // object'. You say how many indices to draw and which base *vertex* you
-                // start from. In my scheme, I have 4 vertices for each two triangles
-                // that are constructed. Thus, I draw 6 indices, but increment the base
-                // vertex by 4 for each letter.
-                glDrawElementsBaseVertex (GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 4*i);
+            // All the glyphs usually share one atlas page, making this a single draw call. Each
+            // quad has 6 indices.
+            for (const std::array<unsigned int, 3>& run : this->draw_runs) {
+                glBindTexture (GL_TEXTURE_2D, run[0]);
+                glDrawElements (GL_TRIANGLES, static_cast<GLsizei>(6u * run[2]), GL_UNSIGNED_INT,
+                                reinterpret_cast<void*>(6u * run[1] * sizeof(GLuint)));
             }
 
             glBindVertexArray(0);
@@ -284,7 +280,7 @@ namespace morph {
             std::basic_string<char32_t> utxt = morph::unicode::fromUtf8(_txt);
             morph::TextGeometry geom;
             for (std::basic_string<char32_t>::const_iterator c = utxt.begin(); c != utxt.end(); c++) {
-                morph::visgl::CharInfo ci = this->face->glchars[*c];
+                const morph::visgl::CharInfo& ci = this->face->glyph (*c);
                 float drop = (ci.size.y() - ci.bearing.y()) * this->fontscale;
                 geom.max_drop = (drop > geom.max_drop) ? drop : geom.max_drop;
                 float bearingy = ci.bearing.y() * this->fontscale;
@@ -299,7 +295,7 @@ namespace morph {
         {
             morph::TextGeometry geom;
             for (std::basic_string<char32_t>::const_iterator c = this->txt.begin(); c != this->txt.end(); c++) {
-                morph::visgl::CharInfo ci = this->face->glchars[*c];
+                const morph::visgl::CharInfo& ci = this->face->glyph (*c);
                 float drop = (ci.size.y() - ci.bearing.y()) * this->fontscale;
                 geom.max_drop = (drop > geom.max_drop) ? drop : geom.max_drop;
                 float bearingy = ci.bearing.y() * this->fontscale;
@@ -347,6 +343,7 @@ namespace morph {
             // With glyph information from txt, set up this->quads.
             this->quads.clear();
             this->quad_ids.clear();
+            this->quad_uvs.clear();
             // Our string of letters starts at this location
             float letter_pos = 0.0f;
             float letter_y = 0.0f;
@@ -356,13 +353,13 @@ namespace morph {
                 if (*c == '\n') {
                     // Skip newline, but add a y offset and reset letter_pos
                     letter_pos = 0.0f;
-                    morph::visgl::CharInfo ch = this->face->glchars['h'];
+                    const morph::visgl::CharInfo& ch = this->face->glyph ('h');
                     letter_y += this->line_spacing * -ch.size.y() * this->fontscale;
                     continue;
                 }
 
                 // Add a quad to this->quads
-                morph::visgl::CharInfo ci = this->face->glchars[*c];
+                const morph::visgl::CharInfo& ci = this->face->glyph (*c);
 
                 float xpos = letter_pos + ci.bearing.x() * this->fontscale;
                 float ypos = letter_y /*this->mv_offset[1]*/ - (ci.size.y() - ci.bearing.y()) * this->fontscale;
@@ -393,6 +390,7 @@ namespace morph {
                 }
                 this->quads.push_back (tbox);
                 this->quad_ids.push_back (ci.textureID);
+                this->quad_uvs.push_back (ci.uv);
 
                 // The value in ci.advance has to be divided by 64 to bring it into the
                 // same units as the ci.size and ci.bearing values.
@@ -401,6 +399,19 @@ namespace morph {
 
             //std::cout << "After setupText, extents are: (LRBT): " << this->extents << std::endl;
 
+            // Successive quads whose glyphs are on the same atlas page are drawn together. Empty
+            // glyphs (such as spaces) have no page and can join any run.
+            this->draw_runs.clear();
+            for (unsigned int qi = 0; qi < this->quad_ids.size(); ++qi) {
+                const unsigned int tex = this->quad_ids[qi];
+                if (this->draw_runs.empty() || (tex != 0u && this->draw_runs.back()[0] != 0u && this->draw_runs.back()[0] != tex)) {
+                    this->draw_runs.push_back ({ tex, qi, 0u });
+                } else if (this->draw_runs.back()[0] == 0u) {
+                    this->draw_runs.back()[0] = tex;
+                }
+                ++this->draw_runs.back()[2];
+            }
+
             // Ensure we've cleared out vertex info
             this->vertexPositions.clear();
             this->vertexNormals.clear();
@@ -425,6 +436,7 @@ namespace morph {
             for (unsigned int qi = 0; qi < nquads; ++qi) {
 
                 std::array<float, 12> quad = this->quads[qi];
+                const vec<float, 4>& uv = this->quad_uvs[qi];
 
                 if constexpr (debug_textquads == true) {
                     std::cout << "Quad box from (" << quad[0] << "," << quad[1] << "," << quad[2]
@@ -438,11 +450,11 @@ namespace morph {
                 this->vertex_push (quad[6], quad[7],  quad[8],  this->vertexPositions); //3
                 this->vertex_push (quad[9], quad[10], quad[11], this->vertexPositions); //4
 
-                // Add the info for drawing the textures on the quads
-                this->vertex_push (0.0f, 1.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (0.0f, 0.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (1.0f, 0.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (1.0f, 1.0f, 0.0f, this->vertexTextures);
+                // Add the info for drawing the glyph's region of the atlas texture on the quad
+                this->vertex_push (uv[0], uv[3], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[0], uv[1], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[2], uv[1], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[2], uv[3], 0.0f, this->vertexTextures);
 
                 // All same colours
                 this->vertex_push (this->clr_backing, this->vertexColors);
@@ -579,6 +591,10 @@ namespace morph {
         vec<float, 4> extents = { 1e7, -1e7, 1e7, -1e7 };
         //! The texture ID for each quad - so that we draw the right texture image over each quad.
         std::vector<unsigned int> quad_ids;
+        //! The atlas texture coordinates (left, top, right, bottom) of each quad's glyph
+        std::vector<vec<float, 4>> quad_uvs;
+        //! Runs of quads drawn with one call: texture ID, first quad and number of quads
+        std::vector<std::array<unsigned int, 3>> draw_runs;
         //! Position within vertex buffer object (if I use an array of VBO)
         enum VBOPos { posnVBO, normVBO, colVBO, idxVBO, textureVBO, numVBO };
         //! A copy of the reference to the text shader program
@@ -0,0 +1,365 @@
+#pragma once
+
+/*
+ * Asynchronous frame capture for morph programs that save every frame of a movie.
+ *
+ * morph::Visual::saveImage() reads the framebuffer with a synchronous glReadPixels, then
+ * flips and PNG-encodes the image on the render thread. A frame_capture instead reads each
+ * frame into one of a ring of pixel buffer objects (PBOs). A PBO is mapped only when the
+ * ring comes round to it again, by which time the transfer has long completed, and the
+ * pixels are then handed to a pool of worker threads which encode and write the PNG files.
+ *
+ *   morph::gl::frame_capture cap;
+ *   for (int f = 0; f < nframes; ++f) {
+ *       // update models...
+ *       v.render();
+ *       cap.capture ("frame_" + std::to_string (f) + ".png");
+ *   }
+ *   cap.finish(); // Read out the last frames and wait for all the files to be written
+ *
+ * Memory is bounded: there are n_buffers PBOs on the GL side and at most max_images frames
+ * waiting for (or undergoing) encoding. capture() blocks if the encoders fall that far
+ * behind. The GL context in which capture() is called must be current whenever capture()
+ * and finish() are called, and when the frame_capture is destroyed.
+ *
+ * Note: You have to include GL3/gl3.h/GL/glext.h/GLEW3/gl31.h etc for the GL types and
+ * functions BEFORE including this file. Programs using this file must link with the threads
+ * library (Threads::Threads in cmake).
+ *
+ * Date: October 2026
+ */
+
+#include <morph/gl/util.h>
+#include <morph/lodepng.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace morph {
+    namespace gl {
+
+        //! Options for the PNG encoding carried out by a frame_capture
+        struct png_settings
+        {
+            //! The PNG row filter. LFS_ZERO is fastest; LFS_MINSUM (lodepng's default) gives smaller files.
+            LodePNGFilterStrategy filter = LFS_ZERO;
+            //! 0 stores the pixels uncompressed. 1 (fastest) to 9 (smallest) trade speed for size, as for zlib.
+            unsigned int compression = 1;
+            //! If false, write RGB files, dropping the alpha channel.
+            bool alpha = false;
+        };
+
+        class frame_capture
+        {
+        public:
+            /*!
+             * Construct with n_buffers PBOs in the ring (at least 2; with 3, each frame is read
+             * out two frames after it was captured), the PNG settings, the number of encoding
+             * threads (0 means one fewer than the number of hardware threads, but at least one)
+             * and the maximum number of frames to hold in memory for encoding (0 means twice
+             * the number of threads). No GL calls are made until the first capture().
+             */
+            frame_capture (const unsigned int n_buffers = 3, const png_settings& _png = png_settings{},
+                           const unsigned int n_threads = 0, const unsigned int max_images = 0)
+                : png (_png)
+            {
+                this->ring.resize (std::max (n_buffers, 2u));
+                unsigned int nt = n_threads;
+                if (nt == 0) {
+                    const unsigned int hw = std::thread::hardware_concurrency();
+                    nt = hw > 2u ? hw - 1u : 1u;
+                }
+                this->max_in_flight = max_images > 0 ? max_images : 2u * nt;
+                for (unsigned int i = 0; i < nt; ++i) {
+                    this->workers.emplace_back (&frame_capture::encode_loop, this);
+                }
+            }
+
+            ~frame_capture()
+            {
+                try {
+                    this->retire_all();
+                } catch (const std::exception& e) {
+                    std::cerr << "morph::gl::frame_capture: " << e.what() << std::endl;
+                }
+                {
+                    std::lock_guard<std::mutex> lk (this->m);
+                    this->stopping = true;
+                }
+                this->cv_job.notify_all();
+                for (auto& w : this->workers) { w.join(); } // Workers finish the queued jobs first
+                this->free_buffers();
+            }
+
+            frame_capture (const frame_capture&) = delete;
+            frame_capture& operator= (const frame_capture&) = delete;
+
+            /*!
+             * Start reading the current viewport of the framebuffer into the next PBO, to be
+             * saved as the PNG file img_filename. Call this in place of Visual::saveImage(), at
+             * the same point (after render()). If the viewport has changed size since the last
+             * capture, the frames already in the ring are read out before the PBOs are re-made.
+             */
+            void capture (const std::string& img_filename)
+            {
+                GLint viewport[4];
+                glGetIntegerv (GL_VIEWPORT, viewport);
+                if (viewport[2] < 1 || viewport[3] < 1) {
+                    throw std::runtime_error ("morph::gl::frame_capture: the viewport is empty");
+                }
+                if (viewport[2] != this->width || viewport[3] != this->height) {
+                    this->retire_all();
+                    this->allocate (viewport[2], viewport[3]);
+                }
+                // Make room in the ring by reading out the oldest frame
+                if (this->n_pending == this->ring.size()) { this->retire_oldest(); }
+
+                slot& s = this->ring[this->head];
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, s.pbo);
+                glPixelStorei (GL_PACK_ALIGNMENT, 1);
+                glPixelStorei (GL_PACK_ROW_LENGTH, 0);
+                glPixelStorei (GL_PACK_SKIP_ROWS, 0);
+                glPixelStorei (GL_PACK_SKIP_PIXELS, 0);
+                // With a PBO bound, the final argument is an offset into it, and glReadPixels returns at once
+                glReadPixels (viewport[0], viewport[1], this->width, this->height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                s.fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                morph::gl::Util::checkError (__FILE__, __LINE__);
+                s.filename = img_filename;
+                this->head = (this->head + 1) % this->ring.size();
+                ++this->n_pending;
+            }
+
+            /*!
+             * Read out every frame still in the ring and wait until all the PNG files have been
+             * written. Returns the number of files that could not be written since the last
+             * call to finish() (the reasons are reported on stderr).
+             */
+            unsigned int finish()
+            {
+                this->retire_all();
+                std::unique_lock<std::mutex> lk (this->m);
+                this->cv_space.wait (lk, [this]{ return this->in_flight == 0; });
+                unsigned int e = this->errors;
+                this->errors = 0;
+                return e;
+            }
+
+            //! The number of PNG files written so far
+            unsigned int saved()
+            {
+                std::lock_guard<std::mutex> lk (this->m);
+                return this->n_saved;
+            }
+
+        private:
+            //! A PBO in the ring, with the fence after its glReadPixels and the file it is for
+            struct slot
+            {
+                GLuint pbo = 0;
+                GLsync fence = nullptr;
+                std::string filename;
+            };
+
+            //! A frame waiting to be encoded. The rows are already in top-to-bottom order.
+            struct job
+            {
+                std::string filename;
+                std::vector<unsigned char> pixels;
+                unsigned int w = 0;
+                unsigned int h = 0;
+            };
+
+            std::size_t frame_bytes() const
+            {
+                return 4u * static_cast<std::size_t>(this->width) * static_cast<std::size_t>(this->height);
+            }
+
+            void allocate (const int w, const int h)
+            {
+                this->free_buffers();
+                this->width = w;
+                this->height = h;
+                for (auto& s : this->ring) {
+                    glGenBuffers (1, &s.pbo);
+                    glBindBuffer (GL_PIXEL_PACK_BUFFER, s.pbo);
+                    glBufferData (GL_PIXEL_PACK_BUFFER, this->frame_bytes(), nullptr, GL_STREAM_READ);
+                }
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                morph::gl::Util::checkError (__FILE__, __LINE__);
+                // The spare host buffers are the wrong size now
+                std::lock_guard<std::mutex> lk (this->m);
+                this->spare.clear();
+                this->spare_bytes = this->frame_bytes();
+            }
+
+            void free_buffers()
+            {
+                for (auto& s : this->ring) {
+                    if (s.fence != nullptr) { glDeleteSync (s.fence); s.fence = nullptr; }
+                    if (s.pbo != 0) { glDeleteBuffers (1, &s.pbo); s.pbo = 0; }
+                }
+                this->head = 0;
+                this->n_pending = 0;
+            }
+
+            void retire_all()
+            {
+                while (this->n_pending > 0) { this->retire_oldest(); }
+            }
+
+            //! Map the oldest PBO in the ring and pass its frame to the encoders
+            void retire_oldest()
+            {
+                const std::size_t n = this->ring.size();
+                slot& s = this->ring[(this->head + n - this->n_pending) % n];
+
+                // Normally the fence has long since signalled
+                GLenum ws = GL_TIMEOUT_EXPIRED;
+                while (ws == GL_TIMEOUT_EXPIRED) {
+                    ws = glClientWaitSync (s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, sync_timeout_ns);
+                }
+                glDeleteSync (s.fence);
+                s.fence = nullptr;
+                --this->n_pending;
+                if (ws == GL_WAIT_FAILED) {
+                    throw std::runtime_error ("morph::gl::frame_capture: glClientWaitSync failed");
+                }
+
+                job j;
+                j.filename = std::move (s.filename);
+                j.w = static_cast<unsigned int>(this->width);
+                j.h = static_cast<unsigned int>(this->height);
+                {
+                    // Wait for a free place, so that memory use is bounded
+                    std::unique_lock<std::mutex> lk (this->m);
+                    this->cv_space.wait (lk, [this]{ return this->in_flight < this->max_in_flight; });
+                    ++this->in_flight;
+                    if (!this->spare.empty()) {
+                        j.pixels = std::move (this->spare.back());
+                        this->spare.pop_back();
+                    }
+                }
+                j.pixels.resize (this->frame_bytes());
+
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, s.pbo);
+                const auto src = static_cast<const unsigned char*>(glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, this->frame_bytes(), GL_MAP_READ_BIT));
+                if (src == nullptr) {
+                    glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                    std::lock_guard<std::mutex> lk (this->m);
+                    --this->in_flight;
+                    throw std::runtime_error ("morph::gl::frame_capture: glMapBufferRange failed");
+                }
+                // Flip the rows as they are copied out, which costs no more than a straight copy
+                const std::size_t row = 4u * static_cast<std::size_t>(this->width);
+                for (unsigned int i = 0; i < j.h; ++i) {
+                    std::memcpy (j.pixels.data() + (j.h - 1u - i) * row, src + i * row, row);
+                }
+                glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                morph::gl::Util::checkError (__FILE__, __LINE__);
+
+                {
+                    std::lock_guard<std::mutex> lk (this->m);
+                    this->jobs.push_back (std::move (j));
+                }
+                this->cv_job.notify_one();
+            }
+
+            //! Set up a lodepng::State for this->png
+            void encoder_state (lodepng::State& st) const
+            {
+                st.info_raw.colortype = LCT_RGBA;
+                st.info_raw.bitdepth = 8;
+                st.info_png.color.colortype = this->png.alpha ? LCT_RGBA : LCT_RGB;
+                st.info_png.color.bitdepth = 8;
+                // Don't spend time searching the image for a smaller colour type
+                st.encoder.auto_convert = 0;
+                st.encoder.filter_palette_zero = 0;
+                st.encoder.filter_strategy = this->png.filter;
+                LodePNGCompressSettings& z = st.encoder.zlibsettings;
+                const unsigned int level = std::min (this->png.compression, 9u);
+                if (level == 0) {
+                    z.btype = 0;
+                    z.use_lz77 = 0;
+                } else {
+                    z.btype = 2;
+                    z.use_lz77 = 1;
+                    z.windowsize = std::min (128u << level, 32768u);
+                    z.nicematch = level < 4 ? 32 : (level < 7 ? 128 : 258);
+                    z.lazymatching = level < 4 ? 0 : 1;
+                }
+            }
+
+            //! The worker threads' loop: encode and save frames until stopping and there are no more jobs
+            void encode_loop()
+            {
+                lodepng::State st;
+                this->encoder_state (st);
+                std::vector<unsigned char> png_bytes;
+                for (;;) {
+                    job j;
+                    {
+                        std::unique_lock<std::mutex> lk (this->m);
+                        this->cv_job.wait (lk, [this]{ return this->stopping || !this->jobs.empty(); });
+                        if (this->jobs.empty()) { return; }
+                        j = std::move (this->jobs.front());
+                        this->jobs.pop_front();
+                    }
+                    png_bytes.clear();
+                    unsigned int error = lodepng::encode (png_bytes, j.pixels.data(), j.w, j.h, st);
+                    if (!error) { error = lodepng::save_file (png_bytes, j.filename); }
+                    {
+                        std::lock_guard<std::mutex> lk (this->m);
+                        if (error) {
+                            std::cerr << "morph::gl::frame_capture: encoder error " << error << " for '"
+                                      << j.filename << "': " << lodepng_error_text (error) << std::endl;
+                            ++this->errors;
+                        } else {
+                            ++this->n_saved;
+                        }
+                        if (j.pixels.size() == this->spare_bytes) { this->spare.push_back (std::move (j.pixels)); }
+                        --this->in_flight;
+                    }
+                    this->cv_space.notify_all();
+                }
+            }
+
+            //! How long each glClientWaitSync may block before it is called again
+            static constexpr GLuint64 sync_timeout_ns = 100000000;
+
+            png_settings png;
+            //! The PBOs and the ring position. Used only on the thread that calls capture().
+            std::vector<slot> ring;
+            std::size_t head = 0;
+            std::size_t n_pending = 0;
+            int width = 0;
+            int height = 0;
+
+            //! Everything below here is shared with the workers and protected by m
+            std::mutex m;
+            std::condition_variable cv_job;
+            std::condition_variable cv_space;
+            std::deque<job> jobs;
+            //! Host buffers returned by the workers for re-use
+            std::vector<std::vector<unsigned char>> spare;
+            std::size_t spare_bytes = 0;
+            //! Frames queued or being encoded
+            unsigned int in_flight = 0;
+            unsigned int max_in_flight = 2;
+            unsigned int errors = 0;
+            unsigned int n_saved = 0;
+            bool stopping = false;
+            std::vector<std::thread> workers;
+        };
+
+    } // gl
+} // morph
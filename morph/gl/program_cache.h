@@ -0,0 +1,156 @@
+/*!
+ * \file
+ *
+ * An on-disk cache of linked GL program binaries.
+ *
+ * LoadShadersCached() is a drop-in replacement for LoadShaders(). The first time a program
+ * is built it is compiled and linked as usual and its binary (from glGetProgramBinary) is
+ * written into the cache directory. On the next launch the binary is loaded with
+ * glProgramBinary, skipping the compile and link. The cache file is named from a hash of the
+ * shader sources and of the GL vendor, renderer and version strings, so an edited shader or
+ * a driver update simply misses the cache. A binary that the driver rejects is rebuilt and
+ * re-cached.
+ *
+ * The cache directory is $MORPH_PROGRAM_CACHE if that is set (set it empty to turn the cache
+ * off), otherwise morphologica/programs under $XDG_CACHE_HOME or $HOME/.cache (under
+ * %LOCALAPPDATA% on Windows).
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <morph/gl/shaders.h>
+#include <morph/tools.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <exception>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+namespace morph {
+    namespace gl {
+
+        //! The program binary cache directory, or an empty string if the cache is off
+        std::string program_cache_dir()
+        {
+            const char* mpc = std::getenv ("MORPH_PROGRAM_CACHE");
+            if (mpc != nullptr) { return std::string (mpc); }
+#ifdef __WIN__
+            const char* lad = std::getenv ("LOCALAPPDATA");
+            if (lad != nullptr && *lad != '\0') { return std::string (lad) + "\\morphologica\\programs"; }
+#else
+            const char* xch = std::getenv ("XDG_CACHE_HOME");
+            if (xch != nullptr && *xch != '\0') { return std::string (xch) + "/morphologica/programs"; }
+            const char* home = std::getenv ("HOME");
+            if (home != nullptr && *home != '\0') { return std::string (home) + "/.cache/morphologica/programs"; }
+#endif
+            return std::string();
+        }
+
+        //! The path of the cache file for the program made from shader_info in dir
+        std::string program_cache_path (const std::vector<morph::gl::ShaderInfo>& shader_info, const std::string& dir)
+        {
+            // FNV-1a hash of the context's identity and of the shaders' sources
+            std::uint64_t h = 14695981039346656037ull;
+            auto mix = [&h](const std::string& str) {
+                for (unsigned char c : str) { h = (h ^ c) * 1099511628211ull; }
+                h = (h ^ 0xffu) * 1099511628211ull; // separator
+            };
+            for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+                const GLubyte* str = glGetString (e);
+                mix (str != nullptr ? std::string (reinterpret_cast<const char*>(str)) : std::string());
+            }
+            for (const auto& entry : shader_info) {
+                mix (std::to_string (entry.type));
+                if (morph::Tools::fileExists (entry.filename)) {
+                    std::unique_ptr<GLchar[]> source = morph::gl::ReadShader (entry.filename);
+                    mix (source != nullptr ? std::string (source.get()) : std::string());
+                } else {
+                    mix (entry.compiledIn);
+                }
+            }
+            char name[24];
+            std::snprintf (name, sizeof (name), "%016llx.bin", static_cast<unsigned long long>(h));
+#ifdef __WIN__
+            return dir + "\\" + name;
+#else
+            return dir + "/" + name;
+#endif
+        }
+
+        /*!
+         * As LoadShaders(), but load the linked program from the binary cache in cache_dir if
+         * it is there, and store it there if not. An empty cache_dir, or a GL implementation
+         * with no program binary formats, just calls LoadShaders().
+         */
+        GLuint LoadShadersCached (const std::vector<morph::gl::ShaderInfo>& shader_info,
+                                  const std::string& cache_dir = morph::gl::program_cache_dir())
+        {
+            if (shader_info.empty()) { return 0; }
+            GLint nformats = 0;
+            glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &nformats);
+            if (cache_dir.empty() || nformats < 1) { return morph::gl::LoadShaders (shader_info); }
+
+            const std::string path = morph::gl::program_cache_path (shader_info, cache_dir);
+
+            // The file holds the binary format followed by the binary
+            std::ifstream fin (path, std::ios::in | std::ios::binary);
+            if (fin.is_open()) {
+                std::uint32_t format = 0;
+                fin.read (reinterpret_cast<char*>(&format), sizeof (format));
+                std::vector<char> binary ((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+                fin.close();
+                if (!binary.empty()) {
+                    GLuint program = glCreateProgram();
+                    glProgramBinary (program, static_cast<GLenum>(format), binary.data(), static_cast<GLsizei>(binary.size()));
+                    GLint linked = GL_FALSE;
+                    glGetProgramiv (program, GL_LINK_STATUS, &linked);
+                    if (linked == GL_TRUE) {
+                        if constexpr (debug_shaders == true) { std::cout << "Loaded program binary " << path << std::endl; }
+                        return program;
+                    }
+                    // The driver no longer accepts this binary (and may have raised an error
+                    // about its format); build the program afresh
+                    glDeleteProgram (program);
+                    while (glGetError() != GL_NO_ERROR) {}
+                }
+            }
+
+            GLuint program = morph::gl::LoadShaders (shader_info, true);
+            GLint len = 0;
+            glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &len);
+            if (len < 1) { return program; }
+            std::vector<char> binary (static_cast<std::size_t>(len));
+            GLenum format = 0;
+            glGetProgramBinary (program, len, &len, &format, binary.data());
+            if (len < 1) { return program; }
+
+            // Write to a temporary file and rename it, so that no reader sees a partial binary
+            try {
+                morph::Tools::createDirIf (cache_dir);
+            } catch (const std::exception& e) {
+                if constexpr (debug_shaders == true) { std::cout << e.what() << std::endl; }
+                return program;
+            }
+            const std::string tmppath = path + ".tmp";
+            std::ofstream fout (tmppath, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!fout.is_open()) { return program; }
+            const std::uint32_t format32 = static_cast<std::uint32_t>(format);
+            fout.write (reinterpret_cast<const char*>(&format32), sizeof (format32));
+            fout.write (binary.data(), len);
+            fout.close();
+            if (!fout || std::rename (tmppath.c_str(), path.c_str()) != 0) {
+                std::remove (tmppath.c_str());
+            } else if constexpr (debug_shaders == true) {
+                std::cout << "Saved program binary " << path << std::endl;
+            }
+            return program;
+        }
+
+    } // namespace gl
+} // namespace morph
@@ -100,8 +100,11 @@ namespace morph {
             return type;
         }
 
-        //! Shader loading code.
-        GLuint LoadShaders (const std::vector<morph::gl::ShaderInfo>& shader_info)
+        /*!
+         * Shader loading code. If retrievable is true, the program is linked with
+         * GL_PROGRAM_BINARY_RETRIEVABLE_HINT so that glGetProgramBinary can be used on it.
+         */
+        GLuint LoadShaders (const std::vector<morph::gl::ShaderInfo>& shader_info, const bool retrievable = false)
         {
             if (shader_info.empty()) { return 0; }
 
@@ -187,6 +190,7 @@ namespace morph {
                 glDeleteShader (shader); // Note it's correct to glDeleteShader after attaching it to program
             }
 
+            if (retrievable) { glProgramParameteri (program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
             glLinkProgram (program);
 
             GLint linked;
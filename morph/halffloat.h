@@ -0,0 +1,143 @@
+/*
+ * 16 bit floating point storage types.
+ *
+ * morph::float16 is the IEEE 754 binary16 format (1 sign, 5 exponent and 10 mantissa bits).
+ * morph::bfloat16 is the 'brain float' format (1 sign, 8 exponent and 7 mantissa bits)
+ * which has the range of a float but less precision than float16.
+ *
+ * These are storage types. They convert implicitly to and from float, so arithmetic is
+ * carried out in float (or double) and only the stored result is rounded. Use them to
+ * halve the memory (and memory bandwidth) of large state vectors, as in:
+ *
+ * \code
+ * std::vector<morph::bfloat16> A (n);
+ * A[i] = 0.5f * A[i] + b;   // loads convert to float, the store rounds to bfloat16
+ * \endcode
+ *
+ * Conversions round to nearest, ties to even. float16 conversions use the F16C
+ * instructions where the compiler targets them (e.g. -march=native on x86) and otherwise,
+ * like the bfloat16 conversions, are branch-free bit manipulations.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <vector>
+#ifdef __F16C__
+# include <immintrin.h>
+#endif
+
+namespace morph {
+
+    namespace halffloat_impl {
+        inline std::uint32_t float_bits (float f) { std::uint32_t u; std::memcpy (&u, &f, 4); return u; }
+        inline float bits_float (std::uint32_t u) { float f; std::memcpy (&f, &u, 4); return f; }
+    }
+
+    //! bfloat16: the top 16 bits of a float
+    struct bfloat16
+    {
+        std::uint16_t bits = 0;
+
+        bfloat16() = default;
+        bfloat16 (float f) : bits(bfloat16::from_float (f)) {}
+        operator float() const { return bfloat16::to_float (this->bits); }
+
+        bfloat16& operator+= (float f) { this->bits = bfloat16::from_float (float(*this) + f); return *this; }
+        bfloat16& operator-= (float f) { this->bits = bfloat16::from_float (float(*this) - f); return *this; }
+        bfloat16& operator*= (float f) { this->bits = bfloat16::from_float (float(*this) * f); return *this; }
+
+        //! Round f to the nearest bfloat16, ties to even. NaNs stay (quiet) NaNs.
+        static std::uint16_t from_float (float f)
+        {
+            std::uint32_t u = halffloat_impl::float_bits (f);
+            if ((u & 0x7fffffffU) > 0x7f800000U) { return static_cast<std::uint16_t>((u >> 16) | 0x40U); }
+            u += 0x7fffU + ((u >> 16) & 1U);
+            return static_cast<std::uint16_t>(u >> 16);
+        }
+        static float to_float (std::uint16_t b) { return halffloat_impl::bits_float (static_cast<std::uint32_t>(b) << 16); }
+    };
+
+    //! float16: IEEE 754 half precision
+    struct float16
+    {
+        std::uint16_t bits = 0;
+
+        float16() = default;
+        float16 (float f) : bits(float16::from_float (f)) {}
+        operator float() const { return float16::to_float (this->bits); }
+
+        float16& operator+= (float f) { this->bits = float16::from_float (float(*this) + f); return *this; }
+        float16& operator-= (float f) { this->bits = float16::from_float (float(*this) - f); return *this; }
+        float16& operator*= (float f) { this->bits = float16::from_float (float(*this) * f); return *this; }
+
+        /*!
+         * Round f to the nearest float16, ties to even. Values beyond the float16 range become
+         * infinity and small values become subnormal or zero. The float arithmetic here does
+         * the rounding (after M. Maratyszcza's FP16 library), so this must not be compiled
+         * with -ffast-math.
+         */
+        static std::uint16_t from_float (float f)
+        {
+#ifdef __F16C__
+            return static_cast<std::uint16_t>(_cvtss_sh (f, _MM_FROUND_TO_NEAREST_INT));
+#else
+            const float scale_to_inf = 0x1.0p+112f;
+            const float scale_to_zero = 0x1.0p-110f;
+            float base = ((f < 0.0f ? -f : f) * scale_to_inf) * scale_to_zero;
+            const std::uint32_t w = halffloat_impl::float_bits (f);
+            const std::uint32_t shl1_w = w + w;
+            const std::uint32_t sign = w & 0x80000000U;
+            std::uint32_t bias = shl1_w & 0xff000000U;
+            if (bias < 0x71000000U) { bias = 0x71000000U; }
+            base = halffloat_impl::bits_float ((bias >> 1) + 0x07800000U) + base;
+            const std::uint32_t bits = halffloat_impl::float_bits (base);
+            const std::uint32_t exp_bits = (bits >> 13) & 0x00007c00U;
+            const std::uint32_t mantissa_bits = bits & 0x00000fffU;
+            const std::uint32_t nonsign = exp_bits + mantissa_bits;
+            return static_cast<std::uint16_t>((sign >> 16) | (shl1_w > 0xff000000U ? 0x7e00U : nonsign));
+#endif
+        }
+
+        //! Expand the float16 h to float (exactly)
+        static float to_float (std::uint16_t h)
+        {
+#ifdef __F16C__
+            return _cvtsh_ss (h);
+#else
+            const std::uint32_t w = static_cast<std::uint32_t>(h) << 16;
+            const std::uint32_t sign = w & 0x80000000U;
+            const std::uint32_t two_w = w + w;
+            const float normalized = halffloat_impl::bits_float ((two_w >> 4) + (0xe0U << 23)) * 0x1.0p-112f;
+            const float denormalized = halffloat_impl::bits_float ((two_w >> 17) | (126U << 23)) - 0.5f;
+            const std::uint32_t result = sign | (two_w < (1U << 27) ? halffloat_impl::float_bits (denormalized)
+                                                 : halffloat_impl::float_bits (normalized));
+            return halffloat_impl::bits_float (result);
+#endif
+        }
+    };
+
+    /*!
+     * Convert n values from in to out. Either type may be a 16 bit storage type, float or
+     * double.
+     */
+    template <typename In, typename Out>
+    void convert_precision (const In* in, Out* out, std::size_t n)
+    {
+        const std::int64_t nn = static_cast<std::int64_t>(n);
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < nn; ++i) { out[i] = static_cast<Out>(in[i]); }
+    }
+
+    //! Convert the vector in to out, resizing out to match
+    template <typename In, typename Out>
+    void convert_precision (const std::vector<In>& in, std::vector<Out>& out)
+    {
+        out.resize (in.size());
+        convert_precision (in.data(), out.data(), in.size());
+    }
+
+} // namespace morph
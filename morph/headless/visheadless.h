@@ -0,0 +1,320 @@
+/*!
+ * \file
+ *
+ * A morph::Visual that renders offscreen, with no window system and no display.
+ *
+ * morph::headless::visual owns an EGL context, created on Mesa's 'surfaceless' platform
+ * where that is available, so that it runs on compute nodes with no X server and no GPU
+ * (Mesa's llvmpipe software rasterizer is fine). The scene is rendered into a framebuffer
+ * object of any size up to GL_MAX_RENDERBUFFER_SIZE. Apart from construction, it is used
+ * just like a GLFW-owned morph::Visual:
+ *
+ * \code
+ *   #include <morph/headless/visheadless.h>
+ *   morph::headless::visual<> v (1920, 1080, "frames");
+ *   auto hgv = std::make_unique<morph::HexGridVisual<float>>(&hg, offset);
+ *   v.bindmodel (hgv);
+ *   ...
+ *   for (int f = 0; f < nframes; ++f) {
+ *       // update data...
+ *       v.render();
+ *       v.saveImage ("frame_" + std::to_string (f) + ".png");
+ *   }
+ * \endcode
+ *
+ * The contexts of headless visuals share their GL objects (and so morph::VisualResources
+ * shares their shader programs and fonts) unless VisualResources<glver>::i().share_contexts
+ * is set false before they are created.
+ *
+ * Link with EGL and the OpenGL library (e.g. -lEGL -lGL, or OpenGL::EGL OpenGL::GL in cmake)
+ * but not glfw. This header defines OWNED_MODE, so it must be #included before (or in place
+ * of) morph/Visual.h. See examples/headless.
+ *
+ * Date: October 2026
+ */
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// The morph::Visual is owned by a headless::context rather than by a GLFW window
+#define OWNED_MODE 1
+namespace morph {
+    namespace headless {
+        struct context;
+        inline const void* current_share_group();
+    }
+    using win_t = headless::context;
+}
+// morph::VisualResources groups the Visuals whose contexts share objects by this key
+#define MORPH_OWNED_SHARE_GROUP() morph::headless::current_share_group()
+#include <morph/Visual.h>
+
+namespace morph {
+    namespace headless {
+
+        /*!
+         * An EGL context with a framebuffer object to render into. Construction makes the
+         * context current. If share is true, the context shares its objects with the other
+         * live contexts (of the same GL version) that were created with share true.
+         */
+        struct context
+        {
+            context (const int width, const int height, const int glver, const bool share = true)
+            {
+                this->init_egl (glver, share);
+                this->make_current();
+                this->resize_framebuffer (width, height);
+                context::live().push_back (this);
+            }
+
+            ~context()
+            {
+                auto& lc = context::live();
+                lc.erase (std::remove (lc.begin(), lc.end(), this), lc.end());
+                if (this->egl_display == EGL_NO_DISPLAY) { return; }
+                if (this->egl_context != EGL_NO_CONTEXT) {
+                    this->make_current();
+                    glBindFramebuffer (GL_FRAMEBUFFER, 0);
+                    if (this->fbo) { glDeleteFramebuffers (1, &this->fbo); }
+                    if (this->colour_rb) { glDeleteRenderbuffers (1, &this->colour_rb); }
+                    if (this->depth_rb) { glDeleteRenderbuffers (1, &this->depth_rb); }
+                    eglMakeCurrent (this->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                    eglDestroyContext (this->egl_display, this->egl_context);
+                }
+                if (this->egl_surface != EGL_NO_SURFACE) { eglDestroySurface (this->egl_display, this->egl_surface); }
+                // The display is not terminated, as other contexts may share it
+            }
+
+            context (const context&) = delete;
+            context& operator= (const context&) = delete;
+
+            //! Make this context current and bind its framebuffer for drawing and reading
+            void make_current()
+            {
+                if (eglMakeCurrent (this->egl_display, this->egl_surface, this->egl_surface, this->egl_context) == EGL_FALSE) {
+                    throw std::runtime_error ("headless::context: eglMakeCurrent failed");
+                }
+                if (this->fbo) { glBindFramebuffer (GL_FRAMEBUFFER, this->fbo); }
+            }
+
+            //! (Re)allocate the framebuffer's colour and depth storage at width x height
+            void resize_framebuffer (const int width, const int height)
+            {
+                GLint maxsz = 0;
+                glGetIntegerv (GL_MAX_RENDERBUFFER_SIZE, &maxsz);
+                if (width < 1 || height < 1 || width > maxsz || height > maxsz) {
+                    throw std::runtime_error ("headless::context: framebuffer size must be between 1 and "
+                                              + std::to_string (maxsz) + " pixels in each dimension");
+                }
+                if (this->fbo == 0) {
+                    glGenFramebuffers (1, &this->fbo);
+                    glGenRenderbuffers (1, &this->colour_rb);
+                    glGenRenderbuffers (1, &this->depth_rb);
+                }
+                glBindRenderbuffer (GL_RENDERBUFFER, this->colour_rb);
+                glRenderbufferStorage (GL_RENDERBUFFER, GL_RGBA8, width, height);
+                glBindRenderbuffer (GL_RENDERBUFFER, this->depth_rb);
+                glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+                glBindRenderbuffer (GL_RENDERBUFFER, 0);
+                glBindFramebuffer (GL_FRAMEBUFFER, this->fbo);
+                glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colour_rb);
+                glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->depth_rb);
+                if (glCheckFramebufferStatus (GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                    throw std::runtime_error ("headless::context: framebuffer is incomplete");
+                }
+                morph::gl::Util::checkError (__FILE__, __LINE__);
+                this->fb_w = width;
+                this->fb_h = height;
+            }
+
+            int framebuffer_width() const { return this->fb_w; }
+            int framebuffer_height() const { return this->fb_h; }
+            EGLContext egl_context_handle() const { return this->egl_context; }
+
+            //! The key of this context's share group, which lives as long as any of its contexts
+            const void* share_group() const { return this->group.get(); }
+
+            //! The live contexts
+            static std::vector<context*>& live()
+            {
+                static std::vector<context*> contexts;
+                return contexts;
+            }
+
+        protected:
+            EGLDisplay egl_display = EGL_NO_DISPLAY;
+            EGLContext egl_context = EGL_NO_CONTEXT;
+            //! Only used if the EGL implementation can't make a context current without a surface
+            EGLSurface egl_surface = EGL_NO_SURFACE;
+            GLuint fbo = 0;
+            GLuint colour_rb = 0;
+            GLuint depth_rb = 0;
+            int fb_w = 0;
+            int fb_h = 0;
+            int gl_version = 0;
+            bool shares = false;
+            //! Shared by the contexts that share objects with each other
+            std::shared_ptr<const int> group;
+
+        private:
+            static bool has_extension (const char* extensions, const char* name)
+            {
+                if (extensions == nullptr) { return false; }
+                const std::size_t len = std::strlen (name);
+                for (const char* p = std::strstr (extensions, name); p != nullptr; p = std::strstr (p + len, name)) {
+                    if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) { return true; }
+                }
+                return false;
+            }
+
+            void init_egl (const int glver, const bool share)
+            {
+                // Mesa's surfaceless platform needs neither a display server nor a GPU device
+                const char* client_ext = eglQueryString (EGL_NO_DISPLAY, EGL_EXTENSIONS);
+                if (has_extension (client_ext, "EGL_MESA_platform_surfaceless")) {
+                    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress ("eglGetPlatformDisplayEXT"));
+                    if (get_platform_display != nullptr) {
+                        this->egl_display = get_platform_display (EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                    }
+                }
+                if (this->egl_display == EGL_NO_DISPLAY) { this->egl_display = eglGetDisplay (EGL_DEFAULT_DISPLAY); }
+                if (this->egl_display == EGL_NO_DISPLAY) {
+                    throw std::runtime_error ("headless::context: no EGL display is available");
+                }
+                if (eglInitialize (this->egl_display, nullptr, nullptr) == EGL_FALSE) {
+                    throw std::runtime_error ("headless::context: eglInitialize failed");
+                }
+
+                const bool es = morph::gl::version::gles (glver);
+                if (eglBindAPI (es ? EGL_OPENGL_ES_API : EGL_OPENGL_API) == EGL_FALSE) {
+                    throw std::runtime_error ("headless::context: eglBindAPI failed");
+                }
+
+                // The scene is rendered into our own framebuffer object, so the config only has to
+                // support the API. A pbuffer-capable config is preferred, for the fallback below.
+                const EGLint renderable = es ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_BIT;
+                EGLint cfg_attribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, renderable, EGL_NONE };
+                EGLConfig cfg = nullptr;
+                EGLint count = 0;
+                if (eglChooseConfig (this->egl_display, cfg_attribs, &cfg, 1, &count) == EGL_FALSE || count < 1) {
+                    cfg_attribs[1] = EGL_DONT_CARE;
+                    if (eglChooseConfig (this->egl_display, cfg_attribs, &cfg, 1, &count) == EGL_FALSE || count < 1) {
+                        throw std::runtime_error ("headless::context: no suitable EGL config");
+                    }
+                }
+
+                const EGLint profile = morph::gl::version::compat (glver) ? EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT
+                                                                          : EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT;
+                const EGLint ctx_attribs[] = {
+                    EGL_CONTEXT_MAJOR_VERSION, morph::gl::version::major (glver),
+                    EGL_CONTEXT_MINOR_VERSION, morph::gl::version::minor (glver),
+                    es ? EGL_NONE : EGL_CONTEXT_OPENGL_PROFILE_MASK, profile,
+                    EGL_NONE
+                };
+                // Find a context to share objects with
+                context* sharer = nullptr;
+                if (share) {
+                    for (context* c : context::live()) {
+                        if (c->shares && c->gl_version == glver && c->egl_display == this->egl_display) {
+                            sharer = c;
+                            break;
+                        }
+                    }
+                }
+                EGLContext share_ctx = sharer != nullptr ? sharer->egl_context : EGL_NO_CONTEXT;
+                this->egl_context = eglCreateContext (this->egl_display, cfg, share_ctx, ctx_attribs);
+                if (this->egl_context == EGL_NO_CONTEXT && sharer != nullptr) {
+                    // The contexts are incompatible after all; don't share
+                    sharer = nullptr;
+                    this->egl_context = eglCreateContext (this->egl_display, cfg, EGL_NO_CONTEXT, ctx_attribs);
+                }
+                if (this->egl_context == EGL_NO_CONTEXT) {
+                    throw std::runtime_error ("headless::context: eglCreateContext failed for OpenGL "
+                                              + morph::gl::version::vstring (glver));
+                }
+                this->gl_version = glver;
+                this->shares = share;
+                this->group = sharer != nullptr ? sharer->group : std::make_shared<const int> (0);
+
+                if (!has_extension (eglQueryString (this->egl_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+                    // A context can't be made current without a surface, so make a minimal one
+                    const EGLint pb_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+                    this->egl_surface = eglCreatePbufferSurface (this->egl_display, cfg, pb_attribs);
+                    if (this->egl_surface == EGL_NO_SURFACE) {
+                        throw std::runtime_error ("headless::context: no surfaceless contexts and eglCreatePbufferSurface failed");
+                    }
+                }
+            }
+        };
+
+        /*!
+         * The share group of the current context, or nullptr if no headless::context is current
+         */
+        inline const void* current_share_group()
+        {
+            const EGLContext cur = eglGetCurrentContext();
+            for (const context* c : context::live()) {
+                if (c->egl_context_handle() == cur) { return c->share_group(); }
+            }
+            return nullptr;
+        }
+
+        /*!
+         * A morph::Visual which renders offscreen into a headless::context. render() and
+         * saveImage() make the context current first, so any number of these may be used in
+         * one program.
+         */
+        template <int glver = morph::gl::version_4_1>
+        class visual : public context, public morph::Visual<glver>
+        {
+        public:
+            //! Construct with the size of the framebuffer, a title and, optionally, no version message
+            visual (const int width, const int height, const std::string& _title, const bool _version_stdout = true)
+                : context (width, height, glver, morph::VisualResources<glver>::i().share_contexts)
+                , morph::Visual<glver> (width, height, _title, _version_stdout) {}
+
+            //! Construct, specifying the coordinate arrows as for morph::Visual
+            visual (const int width, const int height, const std::string& _title,
+                    const morph::vec<float, 2> caOffset, const morph::vec<float, 3> caLength,
+                    const float caThickness, const float caEm, const bool _version_stdout = true)
+                : context (width, height, glver, morph::VisualResources<glver>::i().share_contexts)
+                , morph::Visual<glver> (width, height, _title, caOffset, caLength, caThickness, caEm, _version_stdout) {}
+
+            //! The context must be current while morph::Visual frees its GL resources
+            ~visual() { this->make_current(); }
+
+            //! Make this visual's context current (as morph::Visual::setContext does for a window)
+            void setContext() { this->make_current(); }
+
+            //! Render the scene into the framebuffer
+            void render()
+            {
+                this->make_current();
+                morph::Visual<glver>::render();
+            }
+
+            //! Save the framebuffer as a PNG. Returns its width and height or {-1, -1} on failure.
+            morph::vec<int, 2> saveImage (const std::string& img_filename)
+            {
+                this->make_current();
+                return morph::Visual<glver>::saveImage (img_filename);
+            }
+
+            //! Change the size of the framebuffer (and so of the images saved)
+            void resize (const int width, const int height)
+            {
+                this->make_current();
+                this->resize_framebuffer (width, height);
+                this->set_winsize (width, height);
+            }
+        };
+
+    } // namespace headless
+} // namespace morph
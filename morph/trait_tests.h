@@ -61,6 +61,17 @@ namespace morph {
 	static constexpr bool value = std::is_same< decltype(test<T>(2)), std::true_type >::value;
     };
 
+    //! Traits approach to testing for a data() method, which gives a pointer to the contiguous
+    //! elements of containers such as std::vector, std::array and morph::vvec.
+    template<typename T>
+    class has_data_method
+    {
+	template<typename U> static auto test(int) -> decltype(std::declval<const U>().data() + 1, std::true_type());
+	template<typename> static std::false_type test(...);
+    public:
+	static constexpr bool value = std::is_same<decltype(test<T>(0)), std::true_type>::value;
+    };
+
     //! Traits approach to testing for x and y member attributes. I use this to detect a class like
     //! cv::Point which has its coordinates set/accessed with .x and .y
     template<typename T>
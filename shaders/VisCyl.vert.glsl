@@ -20,21 +20,92 @@ uniform vec4 cyl_cam_pos = vec4(0);
 layout(location = 0) in vec4 position; // Attrib location 0. vertex position
 layout(location = 1) in vec4 normalin; // Attrib location 1. vertex normal
 layout(location = 2) in vec3 color;    // Attrib location 2. vertex colour
+layout(location = 4) in highp vec2 datum; // Attrib location 4. colour map datums
+layout(location = 9) in float fixed_rgb; // 1 + rgb24 for a fixed colour, 0 for a colour mapped vertex
+uniform int colourmap_dims;
+// The colour of NaN datums
+uniform vec3 colourmap_nan;
 
 out VERTEX
 {
     vec4 normal;
     vec4 color;   // Could make vec4 and incorporate alpha
     vec3 fragpos; // fragment position
+    highp vec2 datum;
+    float mapped; // The weight of the colour mapped vertices (1 at a colour mapped vertex)
+    // The values of the last (provoking) vertex of each triangle, for flat_faces
+    flat vec4 facenormal;
+    flat vec4 facecolor;
+    flat highp vec2 facedatum;
+    flat float facemapped;
 } vertex;
 
+// A vertex with a non-zero fixed_rgb has that fixed colour. Any other vertex has its datum
+// passed on to the fragment shader to be colour mapped. A triangle may have both
+// kinds of vertex, so each vertex contributes only to its own kind: a fixed colour vertex
+// has a zero datum and a colour mapped vertex has a black color. The fragment shader divides
+// the interpolated datum by the interpolated mapped weight to get the mean datum of the
+// colour mapped vertices, and adds the colour it maps to, times that weight, to color.
+void datum_colour()
+{
+    vertex.datum = datum;
+    vertex.mapped = 0.0;
+    if (colourmap_dims > 0) {
+        if (fixed_rgb > 0.0) {
+            uint b = uint(fixed_rgb) - 1u;
+            vertex.color.rgb = vec3(float((b >> 16) & 0xffu), float((b >> 8) & 0xffu), float(b & 0xffu)) / 255.0;
+            vertex.datum = vec2(0.0);
+        } else if (isnan (datum.x) || isnan (datum.y)) {
+            // A NaN datum would spoil the interpolated datum of the whole triangle
+            vertex.color.rgb = colourmap_nan;
+            vertex.datum = vec2(0.0);
+        } else {
+            vertex.color.rgb = vec3(0.0);
+            vertex.mapped = 1.0;
+        }
+    }
+}
+
+// Copy the smoothly interpolated outputs into the flat ones
+void face_values()
+{
+    vertex.facenormal = vertex.normal;
+    vertex.facecolor = vertex.color;
+    vertex.facedatum = vertex.datum;
+    vertex.facemapped = vertex.mapped;
+}
+
+// Glyph instances (see VisualModel::make_glyph). If instanced is non-zero, each vertex of
+// the template mesh is scaled by inst_scale, rotated by the quaternion inst_rotn (x, y, z, w)
+// and moved to inst_posn, and takes the colour inst_colour.
+uniform int instanced;
+layout(location = 5) in vec3 inst_posn;
+layout(location = 6) in vec3 inst_scale;
+layout(location = 7) in vec4 inst_rotn;
+layout(location = 8) in vec3 inst_colour;
+
+vec3 quat_rotate (vec4 q, vec3 v) { return v + 2.0 * cross (q.xyz, cross (q.xyz, v) + q.w * v); }
+
+void instance_transform (inout vec4 p, inout vec4 n, inout vec3 c)
+{
+    if (instanced != 0) {
+        p = vec4(quat_rotate (inst_rotn, p.xyz * inst_scale) + inst_posn, 1.0);
+        n = vec4(normalize (quat_rotate (inst_rotn, n.xyz / inst_scale)), 0.0);
+        c = inst_colour;
+    }
+}
+
 void main (void)
 {
+    vec4 posn = position;
+    vec4 nrm = normalin;
+    vec3 clr = color;
+    instance_transform (posn, nrm, clr);
     const float pi = 3.1415927;
     const float two_pi = 6.283185307;
     const float heading_offset = 1.570796327; // pi/2 but maybe pass in?
     // Transform vertex position with scene view and model view matrices
-    vec4 pv = (v_matrix * m_matrix * position);
+    vec4 pv = (v_matrix * m_matrix * posn);
     vec4 ray = pv - (v_matrix * cyl_cam_pos);
     vec3 rho_phi_z; // polar coordinates of ray
     rho_phi_z[0] = sqrt (ray.x * ray.x + ray.y * ray.y);
@@ -52,13 +123,15 @@ void main (void)
         y_s = (cyl_radius * tan (theta)) / cyl_height;
         gl_PointSize = 1;
         gl_Position = vec4(x_s, y_s, -1.0, 1.0);
-        vertex.color = vec4(color, alpha);
-        vertex.fragpos = vec3(m_matrix * position); // within-model position of fragment, used for lighting
-        vertex.normal = normalin;
+        vertex.color = vec4(clr, alpha);
+        vertex.fragpos = vec3(m_matrix * posn); // within-model position of fragment, used for lighting
+        vertex.normal = nrm;
     } else {
         gl_Position = vec4(0.0, 0.0, -100.0, 1.0);
-        vertex.color = vec4(color, 0.0);
-        vertex.fragpos = vec3(m_matrix * position);
-        vertex.normal = normalin;
+        vertex.color = vec4(clr, 0.0);
+        vertex.fragpos = vec3(m_matrix * posn);
+        vertex.normal = nrm;
     }
+    datum_colour();
+    face_values();
 }
@@ -5,8 +5,48 @@ in VERTEX
     vec4 normal;
     vec4 color;
     vec3 fragpos;
+    highp vec2 datum;
+    float mapped;
+    // The values of the last (provoking) vertex of each triangle, for flat_faces
+    flat vec4 facenormal;
+    flat vec4 facecolor;
+    flat highp vec2 facedatum;
+    flat float facemapped;
 } vertex;
 
+// Colour mapping of datums (see Visual.vert.glsl). The datums are scaled by
+// colourmap_scale, (d.x * m1 + c1, d.y * m2 + c2), after taking the log of any flagged in
+// colourmap_log, then looked up in the colour map texture.
+uniform int colourmap_dims;
+uniform sampler2D colourmap;
+uniform highp vec4 colourmap_scale;
+uniform ivec2 colourmap_log;
+uniform vec3 colourmap_nan;
+
+// The data texture of GridVisual and CartGridVisual in their Texture modes. If
+// datamap_filter is non-zero, vertex.datum holds texture coordinates and the datums are
+// read from datamap, taking the nearest texel (datamap_filter 1) or interpolating
+// linearly between texel centres (2). texelFetch is used so that the float texture
+// need not be filterable.
+uniform int datamap_filter;
+uniform highp sampler2D datamap;
+
+highp vec2 sample_datamap (highp vec2 uv)
+{
+    ivec2 sz = textureSize (datamap, 0);
+    highp vec2 p = uv * vec2(sz) - 0.5; // in texels, from the centre of texel 0
+    if (datamap_filter == 1) {
+        return texelFetch (datamap, clamp (ivec2(floor (p + 0.5)), ivec2(0), sz - 1), 0).rg;
+    }
+    ivec2 i0 = ivec2(floor (p));
+    highp vec2 f = p - floor (p);
+    ivec2 i1 = clamp (i0 + 1, ivec2(0), sz - 1);
+    i0 = clamp (i0, ivec2(0), sz - 1);
+    highp vec2 d0 = mix (texelFetch (datamap, i0, 0).rg, texelFetch (datamap, ivec2(i1.x, i0.y), 0).rg, f.x);
+    highp vec2 d1 = mix (texelFetch (datamap, ivec2(i0.x, i1.y), 0).rg, texelFetch (datamap, i1, 0).rg, f.x);
+    return mix (d0, d1, f.y);
+}
+
 // To obtain the normal behaviour, set light_colour to white, ambient_intensity to 1 and
 // diffuse_intensity to 0. That means I have just one shader for objects and it's easy
 // to change the lighting.
@@ -19,19 +59,43 @@ uniform float diffuse_intensity; // Diffuse light intensity
 //uniform mat4 lv_matrix; // 'light' scene view matrix
 //uniform mat4 p_matrix; // projection matrix
 
+// If non-zero, each triangle takes the normal and colour of its last (provoking) vertex,
+// rather than interpolating them. HexGridVisual's HexShared mode uses this to give each hex
+// one colour, although its corner vertices are shared with its neighbours.
+uniform int flat_faces;
+
 out vec4 finalcolor;
 
 void main()
 {
-    vec3 norm = normalize(vec3(vertex.normal));
+    bool ff = flat_faces != 0;
+    vec4 vnormal = ff ? vertex.facenormal : vertex.normal;
+    vec4 vcolor = ff ? vertex.facecolor : vertex.color;
+    highp vec2 vdatum = ff ? vertex.facedatum : vertex.datum;
+    float vmapped = ff ? vertex.facemapped : vertex.mapped;
+    vec3 norm = normalize(vec3(vnormal));
     //vec3 dpos_trans = vec3(p_matrix * lv_matrix * vec4(diffuse_position, 1));
     //vec3 light_dirn = normalize(dpos_trans - vertex.fragpos);
     vec3 light_dirn = normalize(diffuse_position - vertex.fragpos);
     float effective_diffuse = max(dot(norm, light_dirn), 0.0);
     vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;
     vec3 ambient = ambient_intensity * light_colour;
-    vec3 result = (ambient+diffuse) * vec3(vertex.color);
-    finalcolor = vec4(result, vertex.color.w);
+    vec3 colour = vec3(vcolor);
+    if (colourmap_dims > 0 && vmapped > 0.0) {
+        // colour holds the weighted fixed colours; add the weighted colour of the mean datum
+        // of the colour mapped vertices (see datum_colour in Visual.vert.glsl)
+        highp vec2 dm = vdatum / vmapped;
+        highp vec2 d = datamap_filter > 0 ? sample_datamap (dm) : dm;
+        if (colourmap_log.x != 0) { d.x = log (d.x); }
+        if (colourmap_log.y != 0) { d.y = log (d.y); }
+        highp vec2 s = clamp (colourmap_scale.xz * d + colourmap_scale.yw, 0.0, 1.0);
+        // Sample at texel centres, so that s = 0 and s = 1 give the ends of the colour map
+        vec2 n = vec2(textureSize (colourmap, 0));
+        vec3 mapped_colour = (isnan (d.x) || isnan (d.y)) ? colourmap_nan : texture (colourmap, (s * (n - 1.0) + 0.5) / n).rgb;
+        colour += min (vmapped, 1.0) * mapped_colour;
+    }
+    vec3 result = (ambient+diffuse) * colour;
+    finalcolor = vec4(result, vcolor.w);
     // Compared with simple shader:
     // finalcolor = vertex.color;
 }
@@ -0,0 +1,107 @@
+// Test ColourMap::convert_batch against ColourMap::convert
+#include <vector>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <iostream>
+#include "morph/ColourMap.h"
+#include "morph/Random.h"
+
+// The colour that convert gives for the table entry nearest to datum
+template <typename T>
+std::array<float, 3> nearest_entry (const morph::ColourMap<T>& cm, float datum)
+{
+    if (std::isnan (datum)) { return cm.convert_unit (datum); }
+    datum = datum > 1.0f ? 1.0f : (datum < 0.0f ? 0.0f : datum);
+    constexpr float last = static_cast<float>(morph::ColourMap<T>::lut_size - 1u);
+    return cm.convert_unit (std::round (datum * last) / last);
+}
+
+// Compare convert_batch with nearest_entry for every datum. Return the number of mismatches.
+template <typename T>
+int check_batch (morph::ColourMap<T>& cm, const std::vector<T>& data, float inv_range)
+{
+    std::vector<float> rgb;
+    cm.convert_batch (data, rgb);
+    int fails = 0;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        std::array<float, 3> c = nearest_entry (cm, static_cast<float>(data[i]) * inv_range);
+        if (c[0] != rgb[3*i] || c[1] != rgb[3*i+1] || c[2] != rgb[3*i+2]) { ++fails; }
+    }
+    return fails;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::RandUniform<float> rng (-0.2f, 1.2f, 42);
+    std::vector<float> data = rng.get (10001);
+    data[0] = std::numeric_limits<float>::quiet_NaN();
+    data[1] = 0.0f;
+    data[2] = 1.0f;
+    data[3] = 0.5f;
+
+    const morph::ColourMapType types[] = {
+        morph::ColourMapType::Jet, morph::ColourMapType::Plasma, morph::ColourMapType::Viridis,
+        morph::ColourMapType::Greyscale, morph::ColourMapType::MonochromeRed, morph::ColourMapType::HSV1D,
+        morph::ColourMapType::Batlow, morph::ColourMapType::CET_L17, morph::ColourMapType::Fixed,
+        morph::ColourMapType::RainbowZeroWhite
+    };
+    for (auto t : types) {
+        morph::ColourMap<float> cm (t);
+        int f = check_batch (cm, data, 1.0f);
+        if (f) { std::cout << cm.getTypeStr() << ": " << f << " mismatches\n"; --rtn; }
+        // The table entries are within one step of the exact colours
+        std::vector<float> rgb;
+        cm.convert_batch (data, rgb);
+        for (std::size_t i = 0; i < 4; ++i) {
+            std::array<float, 3> c = cm.convert (data[i]);
+            for (unsigned int j = 0; j < 3; ++j) {
+                if (std::abs (c[j] - rgb[3*i+j]) > 0.01f) { std::cout << cm.getTypeStr() << " datum " << data[i] << " differs\n"; --rtn; }
+            }
+        }
+    }
+
+    // Changing the hue must re-make the table
+    morph::ColourMap<float> cmm (morph::ColourMapType::Monochrome);
+    std::vector<float> rgb1, rgb2;
+    cmm.convert_batch (data, rgb1);
+    cmm.setHue (0.5f);
+    cmm.convert_batch (data, rgb2);
+    if (rgb1 == rgb2) { std::cout << "setHue did not change the batch colours\n"; --rtn; }
+    if (check_batch (cmm, data, 1.0f)) { std::cout << "Monochrome after setHue mismatches\n"; --rtn; }
+
+    // Integral and double data
+    morph::ColourMap<unsigned char> cmuc (morph::ColourMapType::Plasma);
+    std::vector<unsigned char> ucdata (256);
+    for (unsigned int i = 0; i < 256; ++i) { ucdata[i] = static_cast<unsigned char>(i); }
+    if (check_batch (cmuc, ucdata, 1.0f / 255.0f)) { std::cout << "uchar mismatches\n"; --rtn; }
+
+    morph::ColourMap<int> cmi (morph::ColourMapType::Viridis);
+    cmi.range_max = 1000;
+    std::vector<int> idata = { -5, 0, 1, 499, 500, 999, 1000, 2000 };
+    if (check_batch (cmi, idata, 1.0f / 1000.0f)) { std::cout << "int mismatches\n"; --rtn; }
+
+    morph::ColourMap<double> cmd (morph::ColourMapType::Jet);
+    std::vector<double> ddata = { -1.0, 0.0, 0.25, 0.5, 1.0, 3.0, std::numeric_limits<double>::quiet_NaN() };
+    if (check_batch (cmd, ddata, 1.0f)) { std::cout << "double mismatches\n"; --rtn; }
+
+    // Time a large conversion
+    std::vector<float> big = rng.get (10000000);
+    morph::ColourMap<float> cmb (morph::ColourMapType::Plasma);
+    std::vector<float> bigrgb;
+    cmb.convert_batch (big, bigrgb);
+    auto t0 = std::chrono::steady_clock::now();
+    cmb.convert_batch (big, bigrgb);
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::array<float, 3>> bigclr (big.size());
+    for (std::size_t i = 0; i < big.size(); ++i) { bigclr[i] = cmb.convert (big[i]); }
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "10M datums: convert_batch " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms; convert " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
@@ -0,0 +1,129 @@
+/*
+ * Test the compact vertex format of VisualModel (see VisualModel::compact_vertices): the
+ * packed positions, normals and colours must decode to the model's vertices, and half float
+ * positions must be used only for flat, twodimensional models.
+ */
+#include <morph/Visual.h>
+#include <morph/VisualModel.h>
+#include <morph/halffloat.h>
+#include <morph/vec.h>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+// A grid of coloured quads, with relief if bumpy is true, that gives the test access to its packed vertices
+struct TestModel : public morph::VisualModel<>
+{
+    TestModel() : morph::VisualModel<> (morph::vec<float>{ 0.0f, 0.0f, 0.0f }) {}
+    bool bumpy = false;
+    void initializeVertices()
+    {
+        constexpr int n = 20;
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                float z = this->bumpy ? 0.1f * std::sin (0.5f * (i + j)) : 0.25f;
+                morph::vec<float> nrm = { 0.3f * std::cos (0.2f * i), -0.4f * std::sin (0.3f * j), 1.0f };
+                nrm.renormalize();
+                this->vertex_push (morph::vec<float>{ 0.1f * i - 1.0f, 0.05f * j - 0.5f, z }, this->vertexPositions);
+                this->vertex_push (nrm, this->vertexNormals);
+                this->vertex_push (std::array<float, 3>{ i / float(n), j / float(n), 0.5f }, this->vertexColors);
+                if (i > 0 && j > 0) {
+                    GLuint v = static_cast<GLuint>(j * n + i);
+                    this->indices.insert (this->indices.end(), { v - n - 1, v - n, v, v - n - 1, v, v - 1 });
+                }
+            }
+        }
+        this->idx = n * n;
+    }
+    std::size_t pack (std::vector<std::uint8_t>& packed) const { return this->pack_compact (packed); }
+    const std::vector<float>& positions() const { return this->vertexPositions; }
+    const std::vector<float>& normals() const { return this->vertexNormals; }
+    const std::vector<float>& colours() const { return this->vertexColors; }
+};
+
+// Decode a 10 bit signed normalized integer
+float snorm10 (std::uint32_t b)
+{
+    std::int32_t i = static_cast<std::int32_t>(b & 0x3ffu);
+    if (i > 511) { i -= 1024; }
+    return std::max (static_cast<float>(i) / 511.0f, -1.0f);
+}
+
+// Check the packed vertices of m, with posn_bytes bytes per position, against its mesh
+int check_packed (const TestModel& m, const std::vector<std::uint8_t>& packed, std::size_t stride, std::size_t posn_bytes)
+{
+    const std::size_t nv = m.positions().size() / 3u;
+    if (packed.size() != nv * stride) { std::cout << "Packed size is wrong\n"; return -1; }
+    for (std::size_t i = 0; i < nv; ++i) {
+        const std::uint8_t* v = packed.data() + i * stride;
+        for (unsigned int j = 0; j < 3u; ++j) {
+            float p = 0.0f;
+            if (posn_bytes == 8u) {
+                std::uint16_t h = 0;
+                std::memcpy (&h, v + 2u * j, sizeof(h));
+                p = morph::float16::to_float (h);
+            } else {
+                std::memcpy (&p, v + 4u * j, sizeof(p));
+            }
+            const float tol = posn_bytes == 8u ? 1e-3f : 0.0f;
+            if (std::abs (p - m.positions()[3 * i + j]) > tol) { std::cout << "Position " << i << " is wrong\n"; return -1; }
+        }
+        std::uint32_t nw = 0;
+        std::memcpy (&nw, v + posn_bytes, sizeof(nw));
+        for (unsigned int j = 0; j < 3u; ++j) {
+            if (std::abs (snorm10 (nw >> (10u * j)) - m.normals()[3 * i + j]) > 1.0f / 511.0f) {
+                std::cout << "Normal " << i << " is wrong\n";
+                return -1;
+            }
+        }
+        if ((nw >> 30) != 1u) { std::cout << "Normal w is wrong\n"; return -1; }
+        const std::uint8_t* c = v + posn_bytes + 4u;
+        for (unsigned int j = 0; j < 3u; ++j) {
+            if (std::abs (c[j] / 255.0f - m.colours()[3 * i + j]) > 0.501f / 255.0f) { std::cout << "Colour " << i << " is wrong\n"; return -1; }
+        }
+        if (c[3] != 255u) { std::cout << "Colour alpha is wrong\n"; return -1; }
+    }
+    return 0;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    TestModel m;
+    m.build_mesh();
+    std::vector<std::uint8_t> packed;
+
+    // Float positions: 12 + 4 + 4 bytes per vertex
+    m.compact_vertices = true;
+    std::size_t stride = m.pack (packed);
+    if (stride != 20u) { std::cout << "Expected 20 bytes per vertex, not " << stride << "\n"; --rtn; }
+    rtn += check_packed (m, packed, stride, 12u);
+
+    // Half positions are not used for a model that is not twodimensional...
+    m.half_positions = true;
+    if (m.pack (packed) != 20u) { std::cout << "Half positions used for a 3D model\n"; --rtn; }
+
+    // ...but are for a flat twodimensional model
+    m.twodimensional = true;
+    stride = m.pack (packed);
+    if (stride != 16u) { std::cout << "Expected 16 bytes per vertex, not " << stride << "\n"; --rtn; }
+    rtn += check_packed (m, packed, stride, 8u);
+
+    // A twodimensional model with relief keeps its float positions
+    TestModel b;
+    b.bumpy = true;
+    b.build_mesh();
+    b.compact_vertices = true;
+    b.half_positions = true;
+    b.twodimensional = true;
+    stride = b.pack (packed);
+    if (stride != 20u) { std::cout << "Half positions used for a model with relief\n"; --rtn; }
+    rtn += check_packed (b, packed, stride, 12u);
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
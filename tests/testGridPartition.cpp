@@ -0,0 +1,80 @@
+// Test GridPartition on a CartGrid: every element is owned by exactly one part, parts are
+// balanced, local neighbour arrays point at the right global elements and the send and
+// receive lists of neighbouring parts match up.
+
+#include <morph/CartGrid.h>
+#include <morph/GridPartition.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iostream>
+
+int main()
+{
+    int rtn = 0;
+
+    morph::CartGrid cg (0.02f, 1.0f);
+    cg.setBoundaryOnOuterEdge();
+    const std::array<const std::vector<int>*, 8> gnb = { &cg.d_ne, &cg.d_nne, &cg.d_nn, &cg.d_nnw,
+                                                         &cg.d_nw, &cg.d_nsw, &cg.d_ns, &cg.d_nse };
+
+    for (unsigned int np : { 1u, 3u, 4u, 7u }) {
+        std::vector<morph::GridPartition> parts (np);
+        for (unsigned int p = 0; p < np; ++p) { parts[p].init (cg, np, p); }
+
+        // Ownership and balance
+        std::vector<unsigned int> owners (cg.num(), 0);
+        unsigned int minown = cg.num();
+        unsigned int maxown = 0;
+        for (const auto& gp : parts) {
+            for (unsigned int li = 0; li < gp.nowned; ++li) { owners[gp.global_index[li]] += 1; }
+            minown = std::min (minown, gp.nowned);
+            maxown = std::max (maxown, gp.nowned);
+        }
+        for (auto o : owners) { if (o != 1) { std::cout << "Element not owned exactly once\n"; --rtn; break; } }
+        if (maxown - minown > 1) { std::cout << "Parts unbalanced: " << minown << " to " << maxown << std::endl; --rtn; }
+
+        for (const auto& gp : parts) {
+            // Interior and border together cover the owned elements
+            if (gp.interior.size() + gp.border.size() != gp.nowned) { std::cout << "interior + border != owned\n"; --rtn; }
+            if (np == 1 && gp.nhalo() != 0) { std::cout << "One part should have no halo\n"; --rtn; }
+
+            // Local neighbours map to the global neighbours
+            for (unsigned int li = 0; li < gp.nowned; ++li) {
+                for (unsigned int d = 0; d < 8; ++d) {
+                    int gj = (*gnb[d])[gp.global_index[li]];
+                    int lj = gp.neighbours[d][li];
+                    if ((gj < 0) != (lj < 0) || (lj >= 0 && gp.global_index[lj] != static_cast<unsigned int>(gj))) {
+                        std::cout << "Local neighbour mismatch\n";
+                        --rtn;
+                        li = gp.nowned;
+                        break;
+                    }
+                }
+            }
+
+            // What p receives from q is exactly what q sends to p, in the same order
+            for (const auto& lk : gp.links) {
+                const morph::GridPartition& q = parts[lk.part];
+                const morph::GridPartition::link* back = nullptr;
+                for (const auto& qlk : q.links) { if (qlk.part == gp.part) { back = &qlk; } }
+                if (back == nullptr || back->send.size() != lk.recv.size()) {
+                    std::cout << "Link sizes don't match\n";
+                    --rtn;
+                    continue;
+                }
+                for (unsigned int k = 0; k < lk.recv.size(); ++k) {
+                    if (gp.global_index[lk.recv[k]] != q.global_index[back->send[k]]) {
+                        std::cout << "Link order doesn't match\n";
+                        --rtn;
+                        break;
+                    }
+                }
+            }
+        }
+        std::cout << np << " parts: " << minown << " to " << maxown << " elements each, halo of part 0 has "
+                  << parts[0].nhalo() << " elements\n";
+    }
+
+    return rtn;
+}
@@ -0,0 +1,106 @@
+/*
+ * Test that a HexGridVisual with gpu_colourmap renders its marked hexes and its NaN hexes
+ * as the CPU colour map does. Their black corners are fixed colours that share triangles
+ * with colour mapped vertices, so each triangle blends the two kinds of vertex. The data are
+ * also drawn scaled up into [2^118, 2^122), where every value is a colour mapped datum.
+ *
+ * This test needs a display.
+ */
+#include <morph/Visual.h>
+#include <morph/HexGridVisual.h>
+#include <morph/HexGrid.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+
+// Render v and return its pixels (RGBA), read back as Visual::saveImage does
+std::vector<unsigned char> render_pixels (morph::Visual<>& v)
+{
+    v.render();
+    GLint viewport[4];
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    std::vector<unsigned char> px (4u * viewport[2] * viewport[3]);
+    glFinish();
+    glPixelStorei (GL_PACK_ALIGNMENT, 1);
+    glReadPixels (0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    return px;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::HexGrid hg (0.04f, 2.0f, 0.0f);
+    hg.setCircularBoundary (0.4f);
+    std::vector<float> data (hg.num(), 0.0f);
+    for (unsigned int hi = 0; hi < hg.num(); ++hi) {
+        data[hi] = 0.5f + 0.4f * std::sin (10.0f * hg.d_x[hi]) * std::sin (8.0f * hg.d_y[hi]);
+    }
+    // A NaN hex and a marked hex near the centre of the grid
+    const unsigned int nan_hex = hg.num() / 2u;
+    const unsigned int marked_hex = hg.num() / 2u + 3u;
+    data[nan_hex] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> big_data (data);
+    for (float& d : big_data) { d = std::ldexp (d, 122); }
+
+    const morph::HexVisMode modes[2] = { morph::HexVisMode::HexInterp, morph::HexVisMode::Triangles };
+    const std::string mode_names[2] = { "HexInterp", "Triangles" };
+    const std::vector<float>* datasets[2] = { &data, &big_data };
+    const std::string data_names[2] = { "", " (data scaled by 2^122)" };
+
+    try {
+        morph::Visual v (600, 600, "HexGridVisual gpu_colourmap with marked hexes", false);
+        v.showCoordArrows = false;
+        v.showTitle = false;
+        v.backgroundWhite();
+        v.setSceneTrans (morph::vec<float, 3>{ 0.0f, 0.0f, -1.6f });
+
+        for (unsigned int m = 0; m < 4; ++m) {
+            const std::string name = mode_names[m % 2u] + data_names[m / 2u];
+            morph::HexGridVisual<float>* models[2] = { nullptr, nullptr };
+            for (unsigned int g = 0; g < 2; ++g) {
+                auto hgv = std::make_unique<morph::HexGridVisual<float>> (&hg, morph::vec<float>{ 0.0f, 0.0f, 0.0f });
+                v.bindmodel (hgv);
+                hgv->gpu_colourmap = (g == 1u);
+                hgv->hexVisMode = modes[m % 2u];
+                hgv->zScale.setParams (0.0f, 0.0f);
+                hgv->cm.setType (morph::ColourMapType::Plasma);
+                hgv->markHex (marked_hex);
+                hgv->setScalarData (datasets[m / 2u]);
+                hgv->finalize();
+                models[g] = v.addVisualModel (hgv);
+            }
+
+            models[1]->setHide (true);
+            std::vector<unsigned char> cpu = render_pixels (v);
+            models[0]->setHide (true);
+            models[1]->setHide (false);
+            std::vector<unsigned char> gpu = render_pixels (v);
+
+            // The colour map is sampled from a texture on the GPU, so allow small differences
+            std::size_t ndiff = 0u;
+            for (std::size_t i = 0; i + 3u < cpu.size() && i + 3u < gpu.size(); i += 4u) {
+                for (unsigned int c = 0; c < 3u; ++c) {
+                    if (std::abs (int(cpu[i + c]) - int(gpu[i + c])) > 16) { ++ndiff; break; }
+                }
+            }
+            std::cout << name << ": " << ndiff << " pixels differ\n";
+            if (cpu.empty() || cpu.size() != gpu.size() || ndiff > cpu.size() / 4000u) {
+                std::cout << name << ": gpu_colourmap rendering differs from the CPU colour map\n";
+                --rtn;
+            }
+            v.removeVisualModel (models[0]);
+            v.removeVisualModel (models[1]);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
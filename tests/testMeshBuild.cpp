@@ -0,0 +1,182 @@
+/*
+ * Test that VisualModel::build_mesh() builds a GridVisual's mesh without a GL context (here,
+ * on a worker thread) and that the mesh is the same whether its elements are built in one
+ * chunk or in many chunks on parallel threads. Then check that a larger mesh rebuilt on a
+ * worker thread is uploaded by the next render (in an offscreen morph::headless::visual).
+ */
+#include <morph/headless/visheadless.h>
+#include <morph/GridVisual.h>
+#include <morph/Grid.h>
+#include <morph/VisualMesh.h>
+#include <morph/vec.h>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+// Give the test access to the mesh arrays
+struct TestGridVisual : public morph::GridVisual<float>
+{
+    TestGridVisual (const morph::Grid<>* _grid) : morph::GridVisual<float> (_grid, morph::vec<float>{0.0f, 0.0f, 0.0f}) {}
+    std::vector<float> positions() const { return this->vertexPositions; }
+    std::vector<float> normals() const { return this->vertexNormals; }
+    std::vector<float> colours() const { return this->vertexColors; }
+    std::vector<GLuint> mesh_indices() const { return this->indices; }
+    unsigned int n_vertices() const { return this->idx; }
+    void set_grid (const morph::Grid<>* _grid) { this->grid = _grid; }
+};
+
+struct mesh_copy
+{
+    std::vector<float> p;
+    std::vector<float> n;
+    std::vector<float> c;
+    std::vector<GLuint> i;
+    unsigned int idx = 0u;
+    bool operator== (const mesh_copy& rhs) const
+    {
+        return p == rhs.p && n == rhs.n && c == rhs.c && i == rhs.i && idx == rhs.idx;
+    }
+};
+
+// Render v and read back its pixels
+std::vector<unsigned char> render_pixels (morph::headless::visual<>& v)
+{
+    v.render();
+    GLint viewport[4];
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    std::vector<unsigned char> px (4u * viewport[2] * viewport[3]);
+    glFinish();
+    glPixelStorei (GL_PACK_ALIGNMENT, 1);
+    glReadPixels (0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    return px;
+}
+
+// Build gv's mesh on a worker thread and return a copy of it
+mesh_copy build_on_thread (TestGridVisual& gv, double& ms)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    std::thread builder ([&gv]() { gv.build_mesh(); });
+    builder.join();
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return mesh_copy{ gv.positions(), gv.normals(), gv.colours(), gv.mesh_indices(), gv.n_vertices() };
+}
+
+int main()
+{
+    int rtn = 0;
+
+    constexpr unsigned int Nside = 300;
+    morph::Grid<> grid (Nside, Nside, morph::vec<float, 2>{0.01f, 0.01f});
+    std::vector<float> data (grid.n, 0.0f);
+    for (unsigned int ri = 0; ri < grid.n; ++ri) {
+        data[ri] = 0.5f + 0.5f * std::sin (20.0f * grid[ri][0]) * std::sin (10.0f * grid[ri][1]);
+    }
+
+    const morph::GridVisMode modes[4] = {
+        morph::GridVisMode::Triangles, morph::GridVisMode::RectInterp,
+        morph::GridVisMode::Columns, morph::GridVisMode::Pixels
+    };
+    const std::string mode_names[4] = { "Triangles", "RectInterp", "Columns", "Pixels" };
+
+    for (unsigned int m = 0; m < 4; ++m) {
+        TestGridVisual gv (&grid);
+        gv.gridVisMode = modes[m];
+        gv.setScalarData (&data);
+
+        // All the elements in a single chunk is the same as building them serially
+        morph::mesh_chunk_elements = grid.n;
+        double ms_serial = 0.0;
+        mesh_copy serial = build_on_thread (gv, ms_serial);
+
+        morph::mesh_chunk_elements = 1000u;
+        double ms_chunked = 0.0;
+        mesh_copy chunked = build_on_thread (gv, ms_chunked);
+
+        // And a rebuild must replace, not add to, the mesh
+        double ms_rebuild = 0.0;
+        mesh_copy rebuilt = build_on_thread (gv, ms_rebuild);
+
+        std::cout << mode_names[m] << ": " << serial.idx << " vertices, " << serial.i.size()
+                  << " indices. One chunk: " << ms_serial << " ms; chunks of "
+                  << morph::mesh_chunk_elements << ": " << ms_chunked << " ms\n";
+
+        if (serial.idx == 0u || serial.p.size() != 3u * serial.idx || serial.c.size() != serial.p.size()) {
+            std::cout << mode_names[m] << ": mesh was not built\n";
+            --rtn;
+        }
+        if (!(serial == chunked)) {
+            std::cout << mode_names[m] << ": chunked mesh differs from the single chunk mesh\n";
+            --rtn;
+        }
+        if (!(chunked == rebuilt)) {
+            std::cout << mode_names[m] << ": rebuilt mesh differs\n";
+            --rtn;
+        }
+    }
+
+    // Rebuild a model that has been drawn with a larger mesh on a worker thread. The next
+    // render must upload it before drawing, and look just like a model built with it.
+    try {
+        morph::headless::visual<> v (200, 200, "testMeshBuild", false);
+        v.showCoordArrows = false;
+        v.showTitle = false;
+        v.backgroundWhite();
+        v.render_on_demand = true;
+
+        morph::Grid<> small_grid (10, 10, morph::vec<float, 2>{0.02f, 0.02f});
+        morph::Grid<> large_grid (60, 60, morph::vec<float, 2>{0.02f, 0.02f});
+        std::vector<float> small_data (small_grid.n, 0.5f);
+        std::vector<float> large_data (large_grid.n, 0.0f);
+        for (unsigned int ri = 0; ri < large_grid.n; ++ri) { large_data[ri] = large_grid[ri][0]; }
+
+        // Fix the scales, so that the data's range does not change the model's appearance
+        auto set_scales = [](TestGridVisual* m) {
+            m->zScale.compute_scaling (0.0f, 1.2f);
+            m->colourScale.compute_scaling (0.0f, 1.2f);
+        };
+
+        auto gv = std::make_unique<TestGridVisual> (&small_grid);
+        v.bindmodel (gv);
+        set_scales (gv.get());
+        gv->setScalarData (&small_data);
+        gv->finalize();
+        auto gvp = v.addVisualModel (gv);
+        render_pixels (v);
+
+        gvp->set_grid (&large_grid);
+        gvp->setScalarData (&large_data);
+        std::thread builder ([gvp]() { gvp->build_mesh(); });
+        builder.join();
+        if (!v.needsRender()) {
+            std::cout << "A mesh rebuilt on a worker thread did not make the scene dirty\n";
+            --rtn;
+        }
+        std::vector<unsigned char> rebuilt = render_pixels (v);
+
+        auto gv2 = std::make_unique<TestGridVisual> (&large_grid);
+        v.bindmodel (gv2);
+        set_scales (gv2.get());
+        gv2->setScalarData (&large_data);
+        gv2->finalize();
+        gvp->setHide (true);
+        v.addVisualModel (gv2);
+        std::vector<unsigned char> built = render_pixels (v);
+
+        std::size_t ndiff = 0u;
+        for (std::size_t i = 0; i < rebuilt.size() && i < built.size(); ++i) { if (rebuilt[i] != built[i]) { ++ndiff; } }
+        std::cout << "Rebuilt on a worker thread then rendered: " << ndiff << " bytes differ from a model built with the larger grid\n";
+        if (rebuilt.empty() || rebuilt.size() != built.size() || ndiff > 0u) {
+            std::cout << "A mesh rebuilt on a worker thread was not uploaded before it was drawn\n";
+            --rtn;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Caught exception: " << e.what() << std::endl;
+        --rtn;
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
@@ -0,0 +1,75 @@
+// Test the geometric multigrid solver on a CartGrid. Manufacture a solution, compute its
+// right hand side, then check that the solver recovers the solution in a number of V-cycles
+// that does not grow with the size of the grid.
+
+#include <morph/CartGrid.h>
+#include <morph/MultigridSolver.h>
+#include <morph/vvec.h>
+#include <iostream>
+#include <cmath>
+
+// Solve on a w x w CartGrid. Return the number of V-cycles, or -1 on error.
+int test_solve (float d, float span, float lambda, morph::MultigridBoundary bc)
+{
+    morph::CartGrid cg (d, span);
+    cg.setBoundaryOnOuterEdge();
+
+    morph::MultigridSolver<double> mg (cg);
+    mg.lambda = lambda;
+    mg.set_boundary (bc);
+
+    // A smooth, but non-trivial target solution
+    std::vector<double> u_true (cg.num(), 0.0);
+    for (unsigned int i = 0; i < cg.num(); ++i) {
+        u_true[i] = std::cos (3.0 * cg.d_x[i]) * std::sin (2.0 * cg.d_y[i]) + 0.5 * cg.d_x[i] * cg.d_y[i];
+    }
+    std::vector<double> f;
+    mg.apply (u_true, f);
+
+    // Initial guess is zero, except on the boundary for Dirichlet conditions
+    std::vector<double> u (cg.num(), 0.0);
+    if (bc == morph::MultigridBoundary::Dirichlet) {
+        for (unsigned int i = 0; i < cg.num(); ++i) {
+            if (cg.d_flags[i] & RECT_IS_BOUNDARY) { u[i] = u_true[i]; }
+        }
+    }
+
+    unsigned int cycles = mg.solve (u, f);
+
+    // For the singular Neumann Poisson problem, the solution is determined up to a constant
+    morph::vvec<double> err (cg.num(), 0.0);
+    for (unsigned int i = 0; i < cg.num(); ++i) { err[i] = u[i] - u_true[i]; }
+    if (lambda == 0.0f && bc == morph::MultigridBoundary::Neumann) { err -= err.mean(); }
+
+    double maxerr = err.abs().max();
+    std::cout << cg.num() << " elements, " << mg.num_levels() << " levels, lambda=" << lambda
+              << (bc == morph::MultigridBoundary::Neumann ? " Neumann" : " Dirichlet")
+              << ": " << cycles << " V-cycles to residual " << mg.residual_norm
+              << ", max error " << maxerr << std::endl;
+
+    if (mg.residual_norm > mg.tolerance) { return -1; }
+    if (maxerr > 1e-6) { return -1; }
+    return static_cast<int>(cycles);
+}
+
+int main()
+{
+    int rtn = 0;
+
+    for (auto bc : { morph::MultigridBoundary::Neumann, morph::MultigridBoundary::Dirichlet }) {
+        for (float lambda : { 0.0f, 10.0f }) {
+            int c_small = test_solve (0.05f, 2.0f, lambda, bc);  // 41 x 41
+            int c_large = test_solve (0.0125f, 2.0f, lambda, bc); // 161 x 161
+            if (c_small < 0 || c_large < 0) {
+                std::cout << "Failed to solve\n";
+                rtn -= 1;
+            } else if (c_large > 2 * c_small + 2) {
+                // Multigrid convergence rate should be roughly independent of grid size
+                std::cout << "V-cycle count grew too much with grid size\n";
+                rtn -= 1;
+            }
+        }
+    }
+
+    return rtn;
+}
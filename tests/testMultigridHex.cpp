@@ -0,0 +1,71 @@
+// Test the geometric multigrid solver on a HexGrid with a circular boundary. Manufacture a
+// solution, compute its right hand side, then check that the solver recovers the solution in
+// a number of V-cycles that does not grow much with the size of the grid.
+
+#include <morph/HexGrid.h>
+#include <morph/MultigridSolver.h>
+#include <morph/vvec.h>
+#include <iostream>
+#include <cmath>
+
+// Solve on a circular HexGrid with hex to hex distance d. Return the number of V-cycles, or -1
+// on error.
+int test_solve (float d, float lambda, morph::MultigridBoundary bc)
+{
+    morph::HexGrid hg (d, 3.0f, 0.0f);
+    hg.setCircularBoundary (1.0f);
+
+    morph::MultigridSolver<double> mg (hg, bc);
+    mg.lambda = lambda;
+
+    std::vector<double> u_true (hg.num(), 0.0);
+    for (unsigned int i = 0; i < hg.num(); ++i) {
+        u_true[i] = std::cos (3.0 * hg.d_x[i]) * std::sin (2.0 * hg.d_y[i]);
+    }
+    std::vector<double> f;
+    mg.apply (u_true, f);
+
+    std::vector<double> u (hg.num(), 0.0);
+    if (bc == morph::MultigridBoundary::Dirichlet) {
+        for (unsigned int i = 0; i < hg.num(); ++i) {
+            if (hg.d_flags[i] & HEX_IS_BOUNDARY) { u[i] = u_true[i]; }
+        }
+    }
+
+    unsigned int cycles = mg.solve (u, f);
+
+    morph::vvec<double> err (hg.num(), 0.0);
+    for (unsigned int i = 0; i < hg.num(); ++i) { err[i] = u[i] - u_true[i]; }
+    if (lambda == 0.0f && bc == morph::MultigridBoundary::Neumann) { err -= err.mean(); }
+
+    double maxerr = err.abs().max();
+    std::cout << hg.num() << " hexes, " << mg.num_levels() << " levels, lambda=" << lambda
+              << (bc == morph::MultigridBoundary::Neumann ? " Neumann" : " Dirichlet")
+              << ": " << cycles << " V-cycles to residual " << mg.residual_norm
+              << ", max error " << maxerr << std::endl;
+
+    if (mg.residual_norm > mg.tolerance) { return -1; }
+    if (maxerr > 1e-6) { return -1; }
+    return static_cast<int>(cycles);
+}
+
+int main()
+{
+    int rtn = 0;
+
+    for (auto bc : { morph::MultigridBoundary::Neumann, morph::MultigridBoundary::Dirichlet }) {
+        for (float lambda : { 0.0f, 5.0f }) {
+            int c_small = test_solve (0.02f, lambda, bc);
+            int c_large = test_solve (0.005f, lambda, bc);
+            if (c_small < 0 || c_large < 0) {
+                std::cout << "Failed to solve\n";
+                rtn -= 1;
+            } else if (c_large > 2 * c_small + 2) {
+                std::cout << "V-cycle count grew too much with grid size\n";
+                rtn -= 1;
+            }
+        }
+    }
+
+    return rtn;
+}
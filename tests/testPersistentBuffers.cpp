@@ -0,0 +1,116 @@
+/*
+ * Test VisualModel::persistent_buffers. A GridVisual whose data are updated over several
+ * frames (so that every region of its mapped buffers is written, and re-written) must render
+ * just as the same GridVisual does with ordinary buffer uploads, with colours from the CPU
+ * colour map and with gpu_colourmap. Renders offscreen in an OpenGL 4.5 headless::visual.
+ */
+#include <morph/headless/visheadless.h>
+#include <morph/GridVisual.h>
+#include <morph/Grid.h>
+#include <morph/vec.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+constexpr int glv = morph::gl::version_4_5;
+
+// Give the test access to whether the model's buffers are persistently mapped
+struct TestGridVisual : public morph::GridVisual<float, unsigned int, float, glv>
+{
+    TestGridVisual (const morph::Grid<unsigned int, float>* _grid)
+        : morph::GridVisual<float, unsigned int, float, glv> (_grid, morph::vec<float>{ -0.5f, -0.5f, 0.0f }) {}
+    bool mapped() const { return this->buffers_mapped; }
+};
+
+// Render v and read back its pixels
+std::vector<unsigned char> render_pixels (morph::headless::visual<glv>& v)
+{
+    v.render();
+    GLint viewport[4];
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    std::vector<unsigned char> px (4u * viewport[2] * viewport[3]);
+    glFinish();
+    glPixelStorei (GL_PACK_ALIGNMENT, 1);
+    glReadPixels (0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    return px;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::Grid<unsigned int, float> grid (50, 50, morph::vec<float, 2>{ 0.02f, 0.02f });
+    auto wave = [&grid](std::vector<float>& d, float t) {
+        for (unsigned int ri = 0; ri < grid.n; ++ri) {
+            d[ri] = 0.5f + 0.4f * std::sin (10.0f * grid[ri][0] - t) * std::cos (8.0f * grid[ri][1] + t);
+        }
+    };
+
+    try {
+        morph::headless::visual<glv> v (400, 400, "testPersistentBuffers", false);
+        v.showCoordArrows = false;
+        v.showTitle = false;
+        v.backgroundWhite();
+        v.setSceneTrans (morph::vec<float, 3>{ 0.0f, 0.0f, -2.0f });
+        v.setSceneRotation (morph::Quaternion<float>(morph::vec<float>{ 1.0f, 0.0f, 0.0f }, -0.6f));
+
+        const std::string names[2] = { "CPU colour map", "gpu_colourmap" };
+        for (unsigned int g = 0; g < 2; ++g) {
+            // models[0] has persistently mapped buffers; models[1] is the reference
+            std::vector<float> data[2] = { std::vector<float>(grid.n), std::vector<float>(grid.n) };
+            TestGridVisual* models[2] = { nullptr, nullptr };
+            for (unsigned int p = 0; p < 2; ++p) {
+                wave (data[p], 0.0f);
+                auto gv = std::make_unique<TestGridVisual> (&grid);
+                v.bindmodel (gv);
+                gv->gridVisMode = morph::GridVisMode::Triangles;
+                gv->gpu_colourmap = (g == 1u);
+                gv->persistent_buffers = (p == 0u);
+                gv->zScale.compute_scaling (0.0f, 1.0f);
+                gv->colourScale.compute_scaling (0.0f, 1.0f);
+                gv->setScalarData (&data[p]);
+                gv->finalize();
+                models[p] = v.addVisualModel (gv);
+            }
+
+            // Over more updates than there are regions in the mapped buffers
+            for (unsigned int f = 0; f < 7; ++f) {
+                if (f > 0) {
+                    for (unsigned int p = 0; p < 2; ++p) {
+                        wave (data[p], 0.3f * f);
+                        models[p]->updateData (&data[p]);
+                    }
+                }
+                models[0]->setHide (false);
+                models[1]->setHide (true);
+                std::vector<unsigned char> persistent = render_pixels (v);
+                models[0]->setHide (true);
+                models[1]->setHide (false);
+                std::vector<unsigned char> reference = render_pixels (v);
+
+                std::size_t ndiff = 0u;
+                for (std::size_t i = 0; i < persistent.size() && i < reference.size(); ++i) {
+                    if (persistent[i] != reference[i]) { ++ndiff; }
+                }
+                if (persistent.empty() || persistent.size() != reference.size() || ndiff > 0u) {
+                    std::cout << names[g] << ", frame " << f << ": " << ndiff
+                              << " bytes differ between persistent and ordinary buffers\n";
+                    --rtn;
+                }
+            }
+            if (models[0]->mapped() == false || models[1]->mapped() == true) {
+                std::cout << names[g] << ": persistent_buffers did not select the mapped buffers\n";
+                --rtn;
+            }
+            v.removeVisualModel (models[0]);
+            v.removeVisualModel (models[1]);
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Caught exception: " << e.what() << std::endl;
+        --rtn;
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
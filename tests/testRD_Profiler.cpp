@@ -0,0 +1,78 @@
+// Test the per-phase RD profiler: timers, the step latency histogram and json output.
+
+#define MORPH_RD_PROFILE 1
+#include <morph/RD_Profiler.h>
+#include <vector>
+#include <iostream>
+#include <cmath>
+
+// A stand-in for a Laplacian sweep, so that there is something to time
+void sweep (morph::RD_Profiler& prof, std::vector<double>& f)
+{
+    MORPH_RD_PROFILE_SCOPE (prof, morph::rd_phase::laplace, 2 * f.size() * sizeof(double));
+    for (unsigned int i = 1; i < f.size() - 1; ++i) { f[i] = 0.5 * (f[i-1] + f[i+1]) + std::sin (f[i]); }
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::RD_Profiler prof;
+    std::vector<double> f (10000, 1.0);
+    constexpr unsigned int nsteps = 50;
+    for (unsigned int s = 0; s < nsteps; ++s) {
+        MORPH_RD_PROFILE_STEP (prof, f.size());
+        sweep (prof, f);
+        sweep (prof, f);
+        {
+            MORPH_RD_PROFILE_SCOPE (prof, morph::rd_phase::reaction, 0);
+            for (auto& v : f) { v *= 0.999; }
+        }
+    }
+
+    const auto& lap = prof.phases[static_cast<unsigned int>(morph::rd_phase::laplace)];
+    const auto& rea = prof.phases[static_cast<unsigned int>(morph::rd_phase::reaction)];
+    if (lap.calls != 2 * nsteps || rea.calls != nsteps || prof.steps.calls != nsteps) {
+        std::cout << "Wrong call counts\n";
+        --rtn;
+    }
+    if (lap.bytes != 2ULL * nsteps * 2 * f.size() * sizeof(double)) {
+        std::cout << "Wrong byte count\n";
+        --rtn;
+    }
+    if (prof.cell_updates != nsteps * f.size()) {
+        std::cout << "Wrong cell update count\n";
+        --rtn;
+    }
+    if (lap.min_ns > lap.max_ns || prof.steps.total_ns < lap.total_ns + rea.total_ns) {
+        std::cout << "Inconsistent timings\n";
+        --rtn;
+    }
+    unsigned long long histsum = 0;
+    for (auto c : prof.step_hist) { histsum += c; }
+    if (histsum != nsteps) {
+        std::cout << "Histogram doesn't sum to the number of steps\n";
+        --rtn;
+    }
+    if (!(prof.cell_updates_per_second() > 0.0) || !(prof.gigabytes_per_second() > 0.0)) {
+        std::cout << "Throughput not computed\n";
+        --rtn;
+    }
+
+    nlohmann::json j = prof.to_json();
+    if (j["steps"]["calls"].get<unsigned long long>() != nsteps
+        || j["phases"]["laplace"]["calls"].get<unsigned long long>() != 2 * nsteps
+        || j["phases"].contains ("save")
+        || j["step_latency_histogram"]["counts"].size() != morph::RD_Profiler::n_hist_buckets) {
+        std::cout << "Unexpected json content:\n" << j.dump (4) << std::endl;
+        --rtn;
+    }
+
+    std::cout << prof.cell_updates_per_second() << " cell updates/s; laplace "
+              << prof.gigabytes_per_second (morph::rd_phase::laplace) << " GB/s\n";
+
+    prof.reset();
+    if (prof.steps.calls != 0 || prof.cell_updates != 0) { --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,112 @@
+// Test mixed precision state storage for RD_Base models. A Fisher-KPP system is run with
+// its state stored in double, float, float16 and bfloat16, with float or double compute,
+// and the error against the full double precision run is reported.
+
+#include <morph/RD_Base.h>
+#include <morph/halffloat.h>
+#include <morph/vvec.h>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// du/dt = D del^2 u + r u (1 - u), with u stored as S and computed with Flt
+template <typename Flt, typename S>
+class RD_Fisher : public morph::RD_Base<Flt>
+{
+public:
+    std::vector<S> u;
+    std::vector<Flt> lapu;
+    Flt D = Flt{0.01};
+    Flt r = Flt{1};
+
+    void allocate()
+    {
+        morph::RD_Base<Flt>::allocate();
+        this->resize_vector_variable (this->u);
+        this->resize_vector_variable (this->lapu);
+    }
+
+    void init()
+    {
+        for (unsigned int h = 0; h < this->nhex; ++h) {
+            double x = this->hg->d_x[h];
+            double y = this->hg->d_y[h];
+            this->u[h] = static_cast<S>(0.5 + 0.3 * std::sin (5.0 * x) * std::cos (4.0 * y));
+        }
+    }
+
+    void step()
+    {
+        this->stepCount++;
+        this->compute_laplace_stored (this->u, this->lapu);
+#pragma omp parallel for schedule(static)
+        for (unsigned int h = 0; h < this->nhex; ++h) {
+            Flt uh = static_cast<Flt>(this->u[h]);
+            this->u[h] = static_cast<S>(uh + this->dt * (this->D * this->lapu[h] + this->r * uh * (Flt{1} - uh)));
+        }
+    }
+};
+
+static constexpr unsigned int nsteps = 200;
+
+template <typename Flt, typename S>
+morph::vvec<double> run (double& seconds)
+{
+    RD_Fisher<Flt, S> model;
+    model.svgpath = "";
+    model.hextohex_d = 0.01f;
+    model.hexspan = 3.0f;
+    model.set_dt (Flt{0.002});
+    model.allocate();
+    model.init();
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < nsteps; ++i) { model.step(); }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    morph::vvec<double> result (model.nhex);
+    morph::convert_precision (model.u.data(), result.data(), model.nhex);
+    return result;
+}
+
+template <typename Flt, typename S>
+int compare (const std::string& name, const morph::vvec<double>& ref, double ref_s, double tolerance)
+{
+    double s = 0.0;
+    morph::vvec<double> res = run<Flt, S> (s);
+    double maxerr = (res - ref).abs().max();
+    std::cout << name << ": max error " << maxerr << ", " << s << " s (reference " << ref_s << " s)\n";
+    return maxerr < tolerance ? 0 : -1;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    // The conversions themselves
+    if (float(morph::bfloat16(1.0f)) != 1.0f || float(morph::float16(-2.5f)) != -2.5f
+        || float(morph::float16(1.0f + 1.0f / 4096.0f)) != 1.0f   // rounds to even
+        || float(morph::float16(65520.0f)) != INFINITY             // overflows
+        || float(morph::float16(std::ldexp (1.0f, -24))) != std::ldexp (1.0f, -24) // smallest subnormal
+        || float(morph::bfloat16(1.0f + 1.0f / 256.0f)) != 1.0f    // rounds to even
+        || float(morph::bfloat16(1.0f + 3.0f / 256.0f)) != 1.0f + 1.0f / 64.0f) {
+        std::cout << "16 bit conversion error\n";
+        --rtn;
+    }
+    for (unsigned int b = 0; b < 0x7c00; ++b) { // Every finite positive float16 round trips
+        morph::float16 h;
+        h.bits = static_cast<std::uint16_t>(b);
+        if (morph::float16(float(h)).bits != h.bits) { std::cout << "float16 round trip failed at " << b << "\n"; --rtn; break; }
+    }
+
+    double ref_s = 0.0;
+    morph::vvec<double> ref = run<double, double> (ref_s);
+
+    // Per-step increments here are ~1e-3, which is close to half an ulp of bfloat16 at u ~ 1,
+    // so many bfloat16 updates round away and its error is dominated by that stagnation.
+    rtn += compare<double, float> ("double compute, float storage", ref, ref_s, 1e-6);
+    rtn += compare<float, float> ("float compute, float storage", ref, ref_s, 1e-5);
+    rtn += compare<float, morph::float16> ("float compute, float16 storage", ref, ref_s, 2e-2);
+    rtn += compare<float, morph::bfloat16> ("float compute, bfloat16 storage", ref, ref_s, 0.15);
+
+    return rtn;
+}
@@ -0,0 +1,98 @@
+// Test the counter-based RandPhilox generator: known answers for the Philox4x32-10
+// bijection, independence from the thread count, and the statistics of the output.
+
+#include <morph/RandPhilox.h>
+#include <morph/vvec.h>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <cmath>
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+// Check the bijection against the known answer vectors from the Random123 distribution
+int test_kat()
+{
+    int rtn = 0;
+    struct kat { std::array<std::uint32_t, 4> ctr; std::array<std::uint32_t, 2> key; std::array<std::uint32_t, 4> out; };
+    std::array<kat, 3> kats = {{
+        { {0x0, 0x0, 0x0, 0x0}, {0x0, 0x0}, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8} },
+        { {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}, {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd} },
+        { {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1} }
+    }};
+    for (auto k : kats) {
+        morph::RandPhilox<float>::philox4x32 (k.ctr[0], k.ctr[1], k.ctr[2], k.ctr[3], k.key[0], k.key[1]);
+        if (k.ctr != k.out) {
+            std::cout << "Philox4x32-10 known answer test failed\n";
+            --rtn;
+        }
+    }
+    return rtn;
+}
+
+template <typename T>
+int test_fills()
+{
+    int rtn = 0;
+    morph::RandPhilox<T> rng (1234);
+    constexpr std::size_t n = 1000003; // Not a multiple of per_block
+
+    // The same bits, whatever the number of threads
+    std::vector<T> u1 (n), u4 (n), nrm (n);
+#ifdef _OPENMP
+    omp_set_num_threads (1);
+#endif
+    rng.fill_uniform (u1, 7, 0);
+#ifdef _OPENMP
+    omp_set_num_threads (4);
+#endif
+    rng.fill_uniform (u4, 7, 0);
+    if (u1 != u4) { std::cout << "Output depends on thread count\n"; --rtn; }
+
+    // Single values match the bulk fill, including in the remainder
+    for (std::size_t i : { std::size_t{0}, std::size_t{5}, n / 2, n - 1 }) {
+        if (rng.uniform (7, 0, i) != u1[i]) { std::cout << "uniform(i) != fill_uniform[i]\n"; --rtn; }
+    }
+
+    // A different step, stream or seed gives different numbers
+    std::vector<T> other (n);
+    rng.fill_uniform (other, 8, 0);
+    if (other == u1) { std::cout << "Steps not independent\n"; --rtn; }
+    rng.fill_uniform (other, 7, 1);
+    if (other == u1) { std::cout << "Streams not independent\n"; --rtn; }
+
+    // Uniform statistics: open interval, mean 1/2, variance 1/12
+    morph::vvec<T> uv (u1.begin(), u1.end());
+    if (uv.min() <= T{0} || uv.max() >= T{1}) { std::cout << "Uniform out of (0,1)\n"; --rtn; }
+    T umean = uv.mean();
+    T uvar = (uv - umean).sq().mean();
+    if (std::abs (umean - T{0.5}) > T{0.002} || std::abs (uvar - T{1}/T{12}) > T{0.002}) {
+        std::cout << "Uniform mean " << umean << " var " << uvar << std::endl;
+        --rtn;
+    }
+
+    // Normal statistics
+    rng.fill_normal (nrm, 3, 2, T{1}, T{2});
+    if (rng.normal (3, 2, n - 1) * T{2} + T{1} != nrm[n - 1]) { std::cout << "normal(i) != fill_normal[i]\n"; --rtn; }
+    morph::vvec<T> nv (nrm.begin(), nrm.end());
+    T nmean = nv.mean();
+    T nsd = std::sqrt ((nv - nmean).sq().mean());
+    if (std::abs (nmean - T{1}) > T{0.01} || std::abs (nsd - T{2}) > T{0.01}) {
+        std::cout << "Normal mean " << nmean << " sd " << nsd << std::endl;
+        --rtn;
+    }
+
+    return rtn;
+}
+
+int main()
+{
+    int rtn = 0;
+    rtn += test_kat();
+    rtn += test_fills<float>();
+    rtn += test_fills<double>();
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
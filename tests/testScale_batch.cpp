@@ -0,0 +1,102 @@
+// Test the contiguous (batch) path of morph::Scale::transform and the parallel autoscale range
+#include <vector>
+#include <list>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <iostream>
+#include "morph/Scale.h"
+#include "morph/MathAlgo.h"
+#include "morph/Random.h"
+#include "morph/vvec.h"
+
+// Transform data with a vector (batch path) and with a list (element-wise path) and compare
+template <typename T, typename S>
+int compare_paths (const std::vector<T>& data, morph::ScaleFn fn)
+{
+    morph::Scale<T, S> s1;
+    s1.setType (fn);
+    s1.do_autoscale = true;
+    std::vector<S> out1 (data.size());
+    s1.transform (data, out1);
+
+    morph::Scale<T, S> s2;
+    s2.setType (fn);
+    s2.do_autoscale = true;
+    std::list<T> ldata (data.begin(), data.end());
+    std::list<S> out2 (data.size());
+    s2.transform (ldata, out2);
+
+    int fails = 0;
+    if (s1.getParams(0) != s2.getParams(0) || s1.getParams(1) != s2.getParams(1)) { ++fails; }
+    auto o2 = out2.begin();
+    for (std::size_t i = 0; i < data.size(); ++i, ++o2) {
+        if (std::abs (out1[i] - *o2) > S{1e-5} * (S{1} + std::abs (*o2))) { ++fails; }
+        if (std::abs (out1[i] - s1.transform_one (data[i])) > S{1e-5} * (S{1} + std::abs (out1[i]))) { ++fails; }
+    }
+    return fails;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::RandUniform<float> rngf (0.01f, 100.0f, 17);
+    std::vector<float> fdata = rngf.get (200000);
+    if (compare_paths<float, float> (fdata, morph::ScaleFn::Linear)) { std::cout << "float linear fails\n"; --rtn; }
+    if (compare_paths<float, float> (fdata, morph::ScaleFn::Logarithmic)) { std::cout << "float log fails\n"; --rtn; }
+
+    morph::RandUniform<double> rngd (0.5, 5000.0, 18);
+    std::vector<double> ddata = rngd.get (1001);
+    if (compare_paths<double, double> (ddata, morph::ScaleFn::Linear)) { std::cout << "double linear fails\n"; --rtn; }
+    if (compare_paths<double, float> (ddata, morph::ScaleFn::Logarithmic)) { std::cout << "double to float log fails\n"; --rtn; }
+
+    morph::RandUniform<int> rngi (-1000, 1000, 19);
+    std::vector<int> idata = rngi.get (100000);
+    if (compare_paths<int, float> (idata, morph::ScaleFn::Linear)) { std::cout << "int to float linear fails\n"; --rtn; }
+
+    // For integral types, transform_one truncates log(datum) to T; the batch path must too
+    morph::RandUniform<int> rngp (1, 100000, 20);
+    std::vector<int> pdata = rngp.get (100000);
+    if (compare_paths<int, float> (pdata, morph::ScaleFn::Logarithmic)) { std::cout << "int to float log fails\n"; --rtn; }
+
+    // The parallel range must match MathAlgo::maxmin, ignoring NaNs
+    fdata[5] = std::numeric_limits<float>::quiet_NaN();
+    fdata[150000] = -3.0f;
+    fdata[199999] = 250.0f;
+    morph::range<float> r1 = morph::Scale<float>::minmax_n (fdata.data(), fdata.size());
+    morph::range<float> r2 = morph::MathAlgo::maxmin (fdata);
+    if (r1.min != r2.min || r1.max != r2.max || r1.min != -3.0f || r1.max != 250.0f) {
+        std::cout << "minmax_n gave " << r1 << ", maxmin gave " << r2 << std::endl;
+        --rtn;
+    }
+
+    // A fixed size container also takes the batch path
+    morph::Scale<float> sa;
+    sa.setParams (2.0f, 1.0f);
+    std::array<float, 3> a = { 0.0f, 1.0f, 2.0f };
+    std::array<float, 3> ao = {};
+    sa.transform (a, ao);
+    if (ao[0] != 1.0f || ao[1] != 3.0f || ao[2] != 5.0f) { std::cout << "std::array transform fails\n"; --rtn; }
+
+    // Time the batch transform against a loop of transform_one calls
+    morph::vvec<float> big (10000000);
+    big.randomize();
+    morph::vvec<float> bigout (big.size());
+    morph::Scale<float> sb;
+    sb.do_autoscale = true;
+    auto t0 = std::chrono::steady_clock::now();
+    sb.transform (big, bigout); // autoscales
+    auto t1 = std::chrono::steady_clock::now();
+    sb.transform (big, bigout);
+    auto t2 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < big.size(); ++i) { bigout[i] = sb.transform_one (big[i]); }
+    auto t3 = std::chrono::steady_clock::now();
+    std::cout << "10M floats: autoscale + transform " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms; transform " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+              << " ms; transform_one loop " << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms\n";
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
@@ -0,0 +1,125 @@
+/*
+ * Test the primitives that VisualModel copies from the cache of unit meshes: spheres, tubes
+ * and cones must have their vertices at the right distances from their centres and axes,
+ * unit normals and indices within the model's vertices.
+ */
+#include <morph/Visual.h>
+#include <morph/VisualModel.h>
+#include <morph/VisualMesh.h>
+#include <morph/vec.h>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <string>
+
+// Builds one sphere, one tube or one cone and gives the test access to the mesh
+struct TestModel : public morph::VisualModel<>
+{
+    TestModel() : morph::VisualModel<> (morph::vec<float>{ 0.0f, 0.0f, 0.0f }) {}
+    int which = 0;
+    void initializeVertices()
+    {
+        const std::array<float, 3> c1 = { 0.1f, 0.2f, 0.3f };
+        const std::array<float, 3> c2 = { 0.9f, 0.8f, 0.7f };
+        if (which == 0) {
+            this->computeSphere (morph::vec<float>{ 1.0f, 2.0f, 3.0f }, c1, 0.5f, 10, 12);
+        } else if (which == 1) {
+            this->computeFlaredTube (morph::vec<float>{ 1.0f, 0.0f, 0.0f }, morph::vec<float>{ 1.0f, 2.0f, 0.0f }, c1, c2, 0.1f, 0.3f, 16);
+        } else {
+            this->computeCone (morph::vec<float>{ 0.0f, 0.0f, 1.0f }, morph::vec<float>{ 0.0f, 0.0f, 3.0f }, 0.0f, c1, 0.5f, 18);
+        }
+    }
+    morph::vec<float> position (std::size_t i) const { return { this->vertexPositions[3*i], this->vertexPositions[3*i+1], this->vertexPositions[3*i+2] }; }
+    morph::vec<float> normal (std::size_t i) const { return { this->vertexNormals[3*i], this->vertexNormals[3*i+1], this->vertexNormals[3*i+2] }; }
+    std::size_t n_vertices() const { return this->vertexPositions.size() / 3u; }
+    bool valid_indices() const
+    {
+        if (this->indices.size() % 3u != 0u || this->vertexColors.size() != this->vertexPositions.size()) { return false; }
+        for (auto i : this->indices) { if (i >= this->idx) { return false; } }
+        return this->idx == this->n_vertices();
+    }
+    bool unit_normals() const
+    {
+        for (std::size_t i = 0; i < this->n_vertices(); ++i) {
+            if (std::abs (this->normal(i).length() - 1.0f) > 1e-5f) { return false; }
+        }
+        return true;
+    }
+};
+
+int main()
+{
+    int rtn = 0;
+
+    // The cache gives the same mesh for the same primitive, rings and segments
+    const morph::unit_mesh& s1 = morph::unit_mesh_cache (morph::unit_primitive::sphere, 10, 12);
+    const morph::unit_mesh& s2 = morph::unit_mesh_cache (morph::unit_primitive::sphere, 10, 12);
+    if (&s1 != &s2 || s1.n_vertices() != 2u + 9u * 12u) {
+        std::cout << "Sphere cache failed\n";
+        --rtn;
+    }
+
+    const std::string names[3] = { "sphere", "tube", "cone" };
+    for (int w = 0; w < 3; ++w) {
+        TestModel m;
+        m.which = w;
+        m.build_mesh();
+        if (!m.valid_indices() || !m.unit_normals()) {
+            std::cout << names[w] << ": invalid mesh\n";
+            --rtn;
+            continue;
+        }
+        if (w == 0) {
+            // Every vertex is on the sphere and its normal points out from the centre
+            morph::vec<float> so = { 1.0f, 2.0f, 3.0f };
+            for (std::size_t i = 0; i < m.n_vertices(); ++i) {
+                morph::vec<float> d = m.position(i) - so;
+                if (std::abs (d.length() - 0.5f) > 1e-5f || (d / 0.5f - m.normal(i)).length() > 1e-5f) {
+                    std::cout << "sphere: vertex " << i << " is misplaced\n";
+                    --rtn;
+                    break;
+                }
+            }
+        } else if (w == 1) {
+            // 4 * 16 + 2 vertices. The first half are around the start, radius 0.1, and the
+            // second around the end, radius 0.3. The tube is along y.
+            if (m.n_vertices() != 66u) { std::cout << "tube: wrong vertex count\n"; --rtn; }
+            for (std::size_t i = 1; i < 65u; ++i) {
+                morph::vec<float> c = i < 33u ? morph::vec<float>{ 1.0f, 0.0f, 0.0f } : morph::vec<float>{ 1.0f, 2.0f, 0.0f };
+                float r = i < 33u ? 0.1f : 0.3f;
+                morph::vec<float> d = m.position(i) - c;
+                if (std::abs (d.length() - r) > 1e-5f || std::abs (d[1]) > 1e-6f) {
+                    std::cout << "tube: vertex " << i << " is misplaced\n";
+                    --rtn;
+                    break;
+                }
+            }
+            if ((m.normal(0) - morph::vec<float>{ 0.0f, -1.0f, 0.0f }).length() > 1e-6f
+                || (m.normal(65) - morph::vec<float>{ 0.0f, 1.0f, 0.0f }).length() > 1e-6f) {
+                std::cout << "tube: cap normals are wrong\n";
+                --rtn;
+            }
+        } else {
+            // The base ring has radius 0.5 around (0,0,1); the tip ring is at the tip
+            for (std::size_t i = 1; i < 1u + 2u * 18u; ++i) {
+                morph::vec<float> d = m.position(i) - morph::vec<float>{ 0.0f, 0.0f, 1.0f };
+                if (std::abs (d.length() - 0.5f) > 1e-5f || std::abs (d[2]) > 1e-6f) {
+                    std::cout << "cone: base vertex " << i << " is misplaced\n";
+                    --rtn;
+                    break;
+                }
+            }
+            for (std::size_t i = 1u + 2u * 18u; i < m.n_vertices(); ++i) {
+                if ((m.position(i) - morph::vec<float>{ 0.0f, 0.0f, 3.0f }).length() > 1e-6f) {
+                    std::cout << "cone: tip vertex " << i << " is misplaced\n";
+                    --rtn;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
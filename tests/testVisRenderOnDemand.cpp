@@ -0,0 +1,84 @@
+/*
+ * Test that, with Visual::render_on_demand, changes to the data of a GridVisual in Texture
+ * mode, to its colour scale and to its colour map make the scene dirty, and that the next
+ * render() draws them.
+ *
+ * This test needs a display.
+ */
+#include <morph/Visual.h>
+#include <morph/GridVisual.h>
+#include <morph/Grid.h>
+#include <morph/Scale.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+// Render v (if it needs it) and return its pixels (RGBA), read back as Visual::saveImage does
+std::vector<unsigned char> render_pixels (morph::Visual<>& v)
+{
+    v.render();
+    GLint viewport[4];
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    std::vector<unsigned char> px (4u * viewport[2] * viewport[3]);
+    glFinish();
+    glPixelStorei (GL_PACK_ALIGNMENT, 1);
+    glReadPixels (0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    return px;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    morph::Grid<> grid (50, 50, morph::vec<float, 2>{ 0.02f, 0.02f });
+    std::vector<float> data (grid.n, 0.0f);
+    for (unsigned int ri = 0; ri < grid.n; ++ri) {
+        data[ri] = 0.5f + 0.5f * std::sin (10.0f * grid[ri][0]) * std::sin (8.0f * grid[ri][1]);
+    }
+
+    try {
+        morph::Visual v (400, 400, "Render on demand", false);
+        v.showCoordArrows = false;
+        v.showTitle = false;
+        v.render_on_demand = true;
+
+        auto gv = std::make_unique<morph::GridVisual<float>> (&grid, morph::vec<float>{ -0.5f, -0.5f, 0.0f });
+        v.bindmodel (gv);
+        gv->gridVisMode = morph::GridVisMode::Texture;
+        gv->setScalarData (&data);
+        gv->finalize();
+        morph::GridVisual<float>* gvp = v.addVisualModel (gv);
+
+        std::vector<unsigned char> first = render_pixels (v);
+        if (v.needsRender()) { std::cout << "Scene still dirty after render\n"; --rtn; }
+
+        // New data in Texture mode
+        for (auto& d : data) { d = 1.0f - d; }
+        gvp->updateData (&data);
+        if (!v.needsRender()) { std::cout << "updateData in Texture mode did not make the scene dirty\n"; --rtn; }
+        std::vector<unsigned char> second = render_pixels (v);
+        if (second == first) { std::cout << "updateData in Texture mode was not drawn\n"; --rtn; }
+
+        // A new colour scale, applied in the shader
+        morph::Scale<float, float> cs;
+        cs.setParams (0.5f, 0.25f);
+        gvp->updateCScale (cs);
+        if (!v.needsRender()) { std::cout << "updateCScale did not make the scene dirty\n"; --rtn; }
+        std::vector<unsigned char> third = render_pixels (v);
+        if (third == second) { std::cout << "updateCScale was not drawn\n"; --rtn; }
+
+        // A new colour map
+        gvp->setColourMap (morph::ColourMapType::Greyscale);
+        if (!v.needsRender()) { std::cout << "setColourMap did not make the scene dirty\n"; --rtn; }
+        std::vector<unsigned char> fourth = render_pixels (v);
+        if (fourth == third) { std::cout << "setColourMap was not drawn\n"; --rtn; }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}
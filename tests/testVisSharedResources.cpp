@@ -0,0 +1,68 @@
+/*
+ * Test that morph::Visual windows share their shader programs and fonts through
+ * morph::VisualResources, and that a window created with share_contexts false does not.
+ */
+#include <morph/Visual.h>
+#include <morph/VisualResources.h>
+#include <iostream>
+#include <memory>
+
+int main()
+{
+    int rtn = 0;
+
+    auto& vr = morph::VisualResources<morph::gl::version_4_1>::i();
+
+    try {
+        // v1 is held by pointer so that it can be destroyed before v2
+        auto v1p = std::make_unique<morph::Visual<>> (400, 300, "Shared resources 1", false);
+        morph::Visual<>& v1 = *v1p;
+        morph::Visual v2 (400, 300, "Shared resources 2", false);
+
+        if (vr.group_size (&v1) != 2u || vr.group_size (&v2) != 2u) {
+            std::cout << "Two windows should be in one resource group\n";
+            --rtn;
+        }
+        if (morph::Visual<>::get_gprog (&v1) != morph::Visual<>::get_gprog (&v2)
+            || morph::Visual<>::get_tprog (&v1) != morph::Visual<>::get_tprog (&v2)) {
+            std::cout << "Shared windows should use the same shader programs\n";
+            --rtn;
+        }
+        if (vr.getVisualFace (morph::VisualFont::DVSans, 24, &v1) != vr.getVisualFace (morph::VisualFont::DVSans, 24, &v2)) {
+            std::cout << "Shared windows should use the same font face\n";
+            --rtn;
+        }
+        v1.render();
+        v2.render();
+
+        vr.share_contexts = false;
+        {
+            morph::Visual v3 (400, 300, "Unshared resources", false);
+            if (vr.group_size (&v3) != 1u || vr.group_size (&v1) != 2u) {
+                std::cout << "An unshared window should be in a group of its own\n";
+                --rtn;
+            }
+            if (vr.getVisualFace (morph::VisualFont::DVSans, 24, &v3) == vr.getVisualFace (morph::VisualFont::DVSans, 24, &v1)) {
+                std::cout << "An unshared window should have its own font face\n";
+                --rtn;
+            }
+            v3.render();
+        }
+        vr.share_contexts = true;
+
+        // Text is still rendered from the shared fonts and programs after the other windows are gone
+        v1p.reset();
+        if (vr.group_size (&v2) != 1u) {
+            std::cout << "The last window should be alone in its group once the others are destroyed\n";
+            --rtn;
+        }
+        v2.render();
+
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    std::cout << (rtn == 0 ? "PASS\n" : "FAIL\n");
+    return rtn;
+}